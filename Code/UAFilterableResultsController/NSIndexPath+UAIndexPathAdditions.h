@@ -0,0 +1,34 @@
+//
+//  NSIndexPath+UAIndexPathAdditions.h
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#if !TARGET_OS_IPHONE
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * The section, row and item accessors that UIKit adds to NSIndexPath, for building the core without UIKit.
+ *
+ * On iOS these come from UIKit and this category isn't compiled at all. Everywhere else, such as OS X or GNUstep
+ * on Linux, they're implemented on top of -indexAtPosition: so the controller works unchanged.
+**/
+@interface NSIndexPath (UAIndexPathAdditions)
+
++ (instancetype)indexPathForRow:(NSInteger)row inSection:(NSInteger)section;
++ (instancetype)indexPathForItem:(NSInteger)item inSection:(NSInteger)section;
+
+@property (nonatomic, readonly) NSInteger section;
+@property (nonatomic, readonly) NSInteger row;
+@property (nonatomic, readonly) NSInteger item;
+
+@end
+
+NS_ASSUME_NONNULL_END
+
+#endif
@@ -0,0 +1,41 @@
+//
+//  NSIndexPath+UAIndexPathAdditions.m
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import "NSIndexPath+UAIndexPathAdditions.h"
+
+#if !TARGET_OS_IPHONE
+
+NS_ASSUME_NONNULL_BEGIN
+@implementation NSIndexPath (UAIndexPathAdditions)
+
++ (instancetype)indexPathForRow:(NSInteger)row inSection:(NSInteger)section {
+    // negative rows are used as section markers, they go through NSUInteger and come back out the same
+    NSUInteger indexes[2] = { (NSUInteger)section, (NSUInteger)row };
+    return [self indexPathWithIndexes:indexes length:2];
+}
+
++ (instancetype)indexPathForItem:(NSInteger)item inSection:(NSInteger)section {
+    return [self indexPathForRow:item inSection:section];
+}
+
+- (NSInteger)section {
+    return (NSInteger)[self indexAtPosition:0];
+}
+
+- (NSInteger)row {
+    return (NSInteger)[self indexAtPosition:1];
+}
+
+- (NSInteger)item {
+    return (NSInteger)[self indexAtPosition:1];
+}
+
+@end
+NS_ASSUME_NONNULL_END
+
+#endif
@@ -0,0 +1,53 @@
+//
+//  UACompiledPredicate.h
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * An NSPredicate compiled into a tree of specialised evaluators.
+ *
+ * The common predicate shapes are compiled: comparisons (==, !=, <, <=, >, >=), IN, BETWEEN, BEGINSWITH, ENDSWITH and CONTAINS
+ * with the [c] and [d] options, and AND, OR and NOT of any of those. Key paths are split up front and each key is read through
+ * a getter that is resolved once per class and cached, rather than going through valueForKeyPath: for every object.
+ *
+ * Anything that cannot be compiled, and any value the evaluators aren't sure how NSPredicate would treat, is handed to the
+ * original predicate so the results are always the same as -[NSPredicate evaluateWithObject:].
+**/
+@interface UACompiledPredicate : NSObject
+
+/**
+ * The predicate that was compiled.
+**/
+@property (nonatomic, strong, readonly) NSPredicate *predicate;
+
+/**
+ * Whether any part of the predicate could be compiled. When this is NO every evaluation goes straight to -predicate.
+**/
+@property (nonatomic, readonly, getter=isCompiled) BOOL compiled;
+
+/**
+ * Compiles the supplied predicate.
+ *
+ * @param   predicate               The NSPredicate to compile.
+ * @returns                         An initialised UACompiledPredicate.
+**/
++ (instancetype)compiledPredicateWithPredicate:(NSPredicate *)predicate;
+
+/**
+ * Evaluates the compiled predicate against the supplied object.
+ *
+ * @param   object                  The object to evaluate.
+ * @returns                         YES if the object matches the predicate, NO otherwise.
+**/
+- (BOOL)evaluateWithObject:(nullable id)object;
+
+@end
+
+NS_ASSUME_NONNULL_END
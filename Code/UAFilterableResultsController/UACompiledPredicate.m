@@ -0,0 +1,624 @@
+//
+//  UACompiledPredicate.m
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import "UACompiledPredicate.h"
+#import <objc/runtime.h>
+#import <stdatomic.h>
+
+#pragma mark Key Accessors
+
+typedef NS_ENUM(NSInteger, UAKeyAccessorType) {
+    UAKeyAccessorTypeKeyValueCoding = 0,
+    UAKeyAccessorTypeDictionary,
+    UAKeyAccessorTypeObject,
+    UAKeyAccessorTypeBool,
+    UAKeyAccessorTypeChar,
+    UAKeyAccessorTypeUnsignedChar,
+    UAKeyAccessorTypeShort,
+    UAKeyAccessorTypeUnsignedShort,
+    UAKeyAccessorTypeInt,
+    UAKeyAccessorTypeUnsignedInt,
+    UAKeyAccessorTypeLong,
+    UAKeyAccessorTypeUnsignedLong,
+    UAKeyAccessorTypeLongLong,
+    UAKeyAccessorTypeUnsignedLongLong,
+    UAKeyAccessorTypeFloat,
+    UAKeyAccessorTypeDouble
+};
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * How to read one key from instances of one class. Accessors are created once per class and key and are never released,
+ * which means the compiled keys can hold on to the last one they used without retaining it.
+**/
+@interface UAKeyAccessor : NSObject
+
+@property (nonatomic, unsafe_unretained) Class objectClass;
+@property (nonatomic, copy) NSString *key;
+@property (nonatomic) UAKeyAccessorType type;
+@property (nonatomic) SEL selector;
+@property (nonatomic) IMP implementation;
+
++ (UAKeyAccessor *)accessorForClass:(Class)objectClass key:(NSString *)key;
+
+- (nullable id)valueOfObject:(id)object;
+
+@end
+
+@implementation UAKeyAccessor
+
++ (UAKeyAccessor *)accessorForClass:(Class)objectClass key:(NSString *)key {
+    static NSMapTable *accessorsByClass = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        accessorsByClass = [[NSMapTable alloc] initWithKeyOptions:(NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality)
+                                                     valueOptions:NSPointerFunctionsStrongMemory
+                                                         capacity:0];
+    });
+
+    @synchronized (accessorsByClass) {
+        NSMutableDictionary *accessors = [accessorsByClass objectForKey:(id)objectClass];
+        if (accessors == nil) {
+            accessors = [[NSMutableDictionary alloc] init];
+            [accessorsByClass setObject:accessors forKey:(id)objectClass];
+        }
+
+        UAKeyAccessor *accessor = accessors[key];
+        if (accessor == nil) {
+            accessor = [[UAKeyAccessor alloc] initWithClass:objectClass key:key];
+            accessors[key] = accessor;
+        }
+        return accessor;
+    }
+}
+
+- (instancetype)initWithClass:(Class)objectClass key:(NSString *)key {
+    self = [super init];
+    if (self) {
+        self.objectClass = objectClass;
+        self.key = key;
+        self.type = UAKeyAccessorTypeKeyValueCoding;
+
+        // dictionaries (other than the @ keys) are just objectForKey:
+        if ([objectClass isSubclassOfClass:[NSDictionary class]]) {
+            if (![key hasPrefix:@"@"]) {
+                self.type = UAKeyAccessorTypeDictionary;
+            }
+
+        // anything that does its own thing in valueForKey: (collections, managed objects, proxies) is left to it
+        } else if (class_getMethodImplementation(objectClass, @selector(valueForKey:)) == class_getMethodImplementation([NSObject class], @selector(valueForKey:))) {
+            [self resolveGetterInClass:objectClass];
+        }
+    }
+    return self;
+}
+
+- (void)resolveGetterInClass:(Class)objectClass {
+    // the first of the getters valueForKey: looks for is the one it would call, anything else (ivars, collection proxies) is left to it
+    NSString *key = self.key;
+    if (key.length == 0) {
+        return;
+    }
+    NSString *capitalizedKey = [[[key substringToIndex:1] uppercaseString] stringByAppendingString:[key substringFromIndex:1]];
+    NSArray *getterNames = @[ [@"get" stringByAppendingString:capitalizedKey], key, [@"is" stringByAppendingString:capitalizedKey], [@"_" stringByAppendingString:key] ];
+
+    SEL selector = NULL;
+    Method method = NULL;
+    for (NSString *getterName in getterNames) {
+        selector = NSSelectorFromString(getterName);
+        method = class_getInstanceMethod(objectClass, selector);
+        if (method != NULL) {
+            break;
+        }
+    }
+    if (method == NULL || method_getNumberOfArguments(method) != 2) {
+        return;
+    }
+
+    char returnType[16];
+    method_getReturnType(method, returnType, sizeof(returnType));
+
+    // skip over any type qualifiers
+    const char *type = returnType;
+    while (*type != '\0' && strchr("rnNoORV", *type) != NULL) {
+        type++;
+    }
+
+    UAKeyAccessorType accessorType;
+    switch (*type) {
+        case '@': accessorType = UAKeyAccessorTypeObject; break;
+        case 'B': accessorType = UAKeyAccessorTypeBool; break;
+        case 'c': accessorType = UAKeyAccessorTypeChar; break;
+        case 'C': accessorType = UAKeyAccessorTypeUnsignedChar; break;
+        case 's': accessorType = UAKeyAccessorTypeShort; break;
+        case 'S': accessorType = UAKeyAccessorTypeUnsignedShort; break;
+        case 'i': accessorType = UAKeyAccessorTypeInt; break;
+        case 'I': accessorType = UAKeyAccessorTypeUnsignedInt; break;
+        case 'l': accessorType = UAKeyAccessorTypeLong; break;
+        case 'L': accessorType = UAKeyAccessorTypeUnsignedLong; break;
+        case 'q': accessorType = UAKeyAccessorTypeLongLong; break;
+        case 'Q': accessorType = UAKeyAccessorTypeUnsignedLongLong; break;
+        case 'f': accessorType = UAKeyAccessorTypeFloat; break;
+        case 'd': accessorType = UAKeyAccessorTypeDouble; break;
+
+        // structs, pointers and the like are boxed by KVC
+        default: return;
+    }
+
+    self.type = accessorType;
+    self.selector = selector;
+    self.implementation = method_getImplementation(method);
+}
+
+- (nullable id)valueOfObject:(id)object {
+    SEL selector = self.selector;
+    IMP implementation = self.implementation;
+
+    switch (self.type) {
+        case UAKeyAccessorTypeDictionary:       return [(NSDictionary *)object objectForKey:self.key];
+        case UAKeyAccessorTypeObject:           return ((id (*)(id, SEL))implementation)(object, selector);
+        case UAKeyAccessorTypeBool:             return @(((bool (*)(id, SEL))implementation)(object, selector));
+        case UAKeyAccessorTypeChar:             return @(((char (*)(id, SEL))implementation)(object, selector));
+        case UAKeyAccessorTypeUnsignedChar:     return @(((unsigned char (*)(id, SEL))implementation)(object, selector));
+        case UAKeyAccessorTypeShort:            return @(((short (*)(id, SEL))implementation)(object, selector));
+        case UAKeyAccessorTypeUnsignedShort:    return @(((unsigned short (*)(id, SEL))implementation)(object, selector));
+        case UAKeyAccessorTypeInt:              return @(((int (*)(id, SEL))implementation)(object, selector));
+        case UAKeyAccessorTypeUnsignedInt:      return @(((unsigned int (*)(id, SEL))implementation)(object, selector));
+        case UAKeyAccessorTypeLong:             return @(((long (*)(id, SEL))implementation)(object, selector));
+        case UAKeyAccessorTypeUnsignedLong:     return @(((unsigned long (*)(id, SEL))implementation)(object, selector));
+        case UAKeyAccessorTypeLongLong:         return @(((long long (*)(id, SEL))implementation)(object, selector));
+        case UAKeyAccessorTypeUnsignedLongLong: return @(((unsigned long long (*)(id, SEL))implementation)(object, selector));
+        case UAKeyAccessorTypeFloat:            return @(((float (*)(id, SEL))implementation)(object, selector));
+        case UAKeyAccessorTypeDouble:           return @(((double (*)(id, SEL))implementation)(object, selector));
+        case UAKeyAccessorTypeKeyValueCoding:   return [object valueForKey:self.key];
+    }
+    return nil;
+}
+
+@end
+
+
+#pragma mark - Compiled Keys and Expressions
+
+/**
+ * A single key in a key path. It remembers the accessor for the last class it saw, so a run of objects of the same class
+ * never touches the shared cache. Compiled predicates are evaluated from several threads at once when filtering in
+ * parallel, so the accessor is swapped atomically and every thread sees either the old one or the new one in full.
+**/
+@interface UACompiledKey : NSObject {
+    _Atomic(void *) _lastAccessor;
+}
+
+@property (nonatomic, copy) NSString *key;
+
+- (nullable id)valueOfObject:(id)object;
+
+@end
+
+@implementation UACompiledKey
+
+- (nullable id)valueOfObject:(id)object {
+    Class objectClass = object_getClass(object);
+    __unsafe_unretained UAKeyAccessor *accessor = (__bridge UAKeyAccessor *)atomic_load_explicit(&_lastAccessor, memory_order_acquire);
+    if (accessor == nil || accessor.objectClass != objectClass) {
+        accessor = [UAKeyAccessor accessorForClass:objectClass key:self.key];
+        atomic_store_explicit(&_lastAccessor, (__bridge void *)accessor, memory_order_release);
+    }
+    return [accessor valueOfObject:object];
+}
+
+@end
+
+typedef NS_ENUM(NSInteger, UACompiledExpressionType) {
+    UACompiledExpressionTypeConstant = 0,
+    UACompiledExpressionTypeEvaluatedObject,
+    UACompiledExpressionTypeKeyPath
+};
+
+@interface UACompiledExpression : NSObject
+
+@property (nonatomic) UACompiledExpressionType type;
+@property (nonatomic, strong, nullable) id constantValue;
+@property (nonatomic, strong, nullable) NSArray *keys;
+
++ (nullable UACompiledExpression *)compiledExpressionWithExpression:(NSExpression *)expression;
+
+- (nullable id)valueForObject:(nullable id)object;
+
+@end
+
+@implementation UACompiledExpression
+
++ (nullable UACompiledExpression *)compiledExpressionWithExpression:(NSExpression *)expression {
+    UACompiledExpression *compiled = [[UACompiledExpression alloc] init];
+
+    switch (expression.expressionType) {
+        case NSConstantValueExpressionType:
+            compiled.type = UACompiledExpressionTypeConstant;
+            compiled.constantValue = expression.constantValue;
+            return compiled;
+
+        case NSEvaluatedObjectExpressionType:
+            compiled.type = UACompiledExpressionTypeEvaluatedObject;
+            return compiled;
+
+        case NSKeyPathExpressionType: {
+            NSMutableArray *keys = [[NSMutableArray alloc] init];
+            for (NSString *component in [expression.keyPath componentsSeparatedByString:@"."]) {
+                // collection operators and SELF are left to NSPredicate
+                if (component.length == 0 || [component hasPrefix:@"@"] || [component isEqualToString:@"SELF"]) {
+                    return nil;
+                }
+                UACompiledKey *key = [[UACompiledKey alloc] init];
+                key.key = component;
+                [keys addObject:key];
+            }
+            compiled.type = UACompiledExpressionTypeKeyPath;
+            compiled.keys = keys;
+            return compiled;
+        }
+
+        // {1, 2} literals, as used by BETWEEN and IN
+        case NSAggregateExpressionType: {
+            NSMutableArray *values = [[NSMutableArray alloc] init];
+            for (NSExpression *subexpression in expression.collection) {
+                if (![subexpression isKindOfClass:[NSExpression class]] || subexpression.expressionType != NSConstantValueExpressionType || subexpression.constantValue == nil) {
+                    return nil;
+                }
+                [values addObject:subexpression.constantValue];
+            }
+            compiled.type = UACompiledExpressionTypeConstant;
+            compiled.constantValue = values;
+            return compiled;
+        }
+
+        default:
+            return nil;
+    }
+}
+
+- (nullable id)valueForObject:(nullable id)object {
+    switch (self.type) {
+        case UACompiledExpressionTypeConstant:
+            return self.constantValue;
+
+        case UACompiledExpressionTypeEvaluatedObject:
+            return object;
+
+        case UACompiledExpressionTypeKeyPath: {
+            id value = object;
+            for (UACompiledKey *key in self.keys) {
+                if (value == nil) {
+                    break;
+                }
+                value = [key valueOfObject:value];
+            }
+            return value;
+        }
+    }
+    return nil;
+}
+
+@end
+
+
+#pragma mark - Evaluator Tree
+
+@interface UAPredicateNode : NSObject
+
+// the predicate this node was compiled from, and the one we ask when we're not sure
+@property (nonatomic, strong) NSPredicate *predicate;
+
++ (UAPredicateNode *)nodeWithPredicate:(NSPredicate *)predicate;
+
+- (BOOL)evaluateWithObject:(nullable id)object;
+
+// whether this node does any of its own work, rather than just asking the predicate
+- (BOOL)isCompiled;
+
+@end
+
+@interface UACompoundPredicateNode : UAPredicateNode
+
+@property (nonatomic) NSCompoundPredicateType type;
+@property (nonatomic, strong) NSArray *subnodes;
+
+@end
+
+@interface UAComparisonPredicateNode : UAPredicateNode
+
+@property (nonatomic) NSPredicateOperatorType operatorType;
+@property (nonatomic) NSStringCompareOptions stringOptions;
+@property (nonatomic, strong) UACompiledExpression *leftExpression;
+@property (nonatomic, strong) UACompiledExpression *rightExpression;
+
+// a hashed copy of a constant IN collection
+@property (nonatomic, strong, nullable) NSSet *rightSet;
+
++ (nullable UAComparisonPredicateNode *)nodeWithComparisonPredicate:(NSComparisonPredicate *)predicate;
+
+@end
+
+@implementation UAPredicateNode
+
++ (UAPredicateNode *)nodeWithPredicate:(NSPredicate *)predicate {
+    UAPredicateNode *node = nil;
+
+    if ([predicate isKindOfClass:[NSCompoundPredicate class]]) {
+        NSCompoundPredicate *compound = (NSCompoundPredicate *)predicate;
+        NSMutableArray *subnodes = [[NSMutableArray alloc] initWithCapacity:compound.subpredicates.count];
+        for (NSPredicate *subpredicate in compound.subpredicates) {
+            [subnodes addObject:[UAPredicateNode nodeWithPredicate:subpredicate]];
+        }
+
+        // NOT only ever has the one
+        if (compound.compoundPredicateType != NSNotPredicateType || subnodes.count == 1) {
+            UACompoundPredicateNode *compoundNode = [[UACompoundPredicateNode alloc] init];
+            compoundNode.type = compound.compoundPredicateType;
+            compoundNode.subnodes = subnodes;
+            node = compoundNode;
+        }
+
+    } else if ([predicate isKindOfClass:[NSComparisonPredicate class]]) {
+        node = [UAComparisonPredicateNode nodeWithComparisonPredicate:(NSComparisonPredicate *)predicate];
+    }
+
+    // anything else (blocks, TRUEPREDICATE, subqueries and so on) is left to NSPredicate
+    if (node == nil) {
+        node = [[UAPredicateNode alloc] init];
+    }
+    node.predicate = predicate;
+    return node;
+}
+
+- (BOOL)evaluateWithObject:(nullable id)object {
+    return [self.predicate evaluateWithObject:object];
+}
+
+- (BOOL)isCompiled {
+    return NO;
+}
+
+@end
+
+@implementation UACompoundPredicateNode
+
+- (BOOL)evaluateWithObject:(nullable id)object {
+    switch (self.type) {
+        case NSNotPredicateType:
+            return ![(UAPredicateNode *)self.subnodes.firstObject evaluateWithObject:object];
+
+        case NSAndPredicateType:
+            for (UAPredicateNode *subnode in self.subnodes) {
+                if (![subnode evaluateWithObject:object]) {
+                    return NO;
+                }
+            }
+            return YES;
+
+        case NSOrPredicateType:
+            for (UAPredicateNode *subnode in self.subnodes) {
+                if ([subnode evaluateWithObject:object]) {
+                    return YES;
+                }
+            }
+            return NO;
+    }
+    return [super evaluateWithObject:object];
+}
+
+- (BOOL)isCompiled {
+    for (UAPredicateNode *subnode in self.subnodes) {
+        if ([subnode isCompiled]) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
+@end
+
+@implementation UAComparisonPredicateNode
+
++ (nullable UAComparisonPredicateNode *)nodeWithComparisonPredicate:(NSComparisonPredicate *)predicate {
+    if (predicate.comparisonPredicateModifier != NSDirectPredicateModifier) {
+        return nil;
+    }
+
+    NSComparisonPredicateOptions options = predicate.options;
+    if ((options & ~(NSCaseInsensitivePredicateOption | NSDiacriticInsensitivePredicateOption | NSNormalizedPredicateOption)) != 0) {
+        return nil;
+    }
+
+    NSPredicateOperatorType operatorType = predicate.predicateOperatorType;
+    switch (operatorType) {
+        case NSEqualToPredicateOperatorType:
+        case NSNotEqualToPredicateOperatorType:
+        case NSBeginsWithPredicateOperatorType:
+        case NSEndsWithPredicateOperatorType:
+        case NSContainsPredicateOperatorType:
+            break;
+
+        // the options only mean anything to the string operators
+        case NSLessThanPredicateOperatorType:
+        case NSLessThanOrEqualToPredicateOperatorType:
+        case NSGreaterThanPredicateOperatorType:
+        case NSGreaterThanOrEqualToPredicateOperatorType:
+        case NSInPredicateOperatorType:
+        case NSBetweenPredicateOperatorType:
+            if (options != 0) {
+                return nil;
+            }
+            break;
+
+        default:
+            return nil;
+    }
+
+    UACompiledExpression *leftExpression = [UACompiledExpression compiledExpressionWithExpression:predicate.leftExpression];
+    UACompiledExpression *rightExpression = [UACompiledExpression compiledExpressionWithExpression:predicate.rightExpression];
+    if (leftExpression == nil || rightExpression == nil) {
+        return nil;
+    }
+
+    UAComparisonPredicateNode *node = [[UAComparisonPredicateNode alloc] init];
+    node.operatorType = operatorType;
+    node.leftExpression = leftExpression;
+    node.rightExpression = rightExpression;
+
+    NSStringCompareOptions stringOptions = 0;
+    if ((options & NSCaseInsensitivePredicateOption) != 0) {
+        stringOptions |= NSCaseInsensitiveSearch;
+    }
+    if ((options & NSDiacriticInsensitivePredicateOption) != 0) {
+        stringOptions |= NSDiacriticInsensitiveSearch;
+    }
+    if ((options & NSNormalizedPredicateOption) != 0) {
+        stringOptions = NSLiteralSearch;
+    }
+    node.stringOptions = stringOptions;
+
+    // IN over a constant collection is a hash lookup
+    if (operatorType == NSInPredicateOperatorType && rightExpression.type == UACompiledExpressionTypeConstant) {
+        id collection = rightExpression.constantValue;
+        if ([collection isKindOfClass:[NSArray class]]) {
+            node.rightSet = [[NSSet alloc] initWithArray:collection];
+        } else if ([collection isKindOfClass:[NSSet class]]) {
+            node.rightSet = collection;
+        } else if ([collection isKindOfClass:[NSOrderedSet class]]) {
+            node.rightSet = [(NSOrderedSet *)collection set];
+        }
+    }
+
+    return node;
+}
+
+- (BOOL)isCompiled {
+    return YES;
+}
+
+- (BOOL)evaluateWithObject:(nullable id)object {
+    id left = [self.leftExpression valueForObject:object];
+    id right = [self.rightExpression valueForObject:object];
+
+    // NSPredicate has its own ideas about NSNull
+    if (left == [NSNull null] || right == [NSNull null]) {
+        return [super evaluateWithObject:object];
+    }
+
+    switch (self.operatorType) {
+        case NSEqualToPredicateOperatorType:
+        case NSNotEqualToPredicateOperatorType: {
+            BOOL isEqual = NO;
+            if (left == nil || right == nil) {
+                isEqual = (left == right);
+            } else if (self.stringOptions == 0) {
+                isEqual = [left isEqual:right];
+            } else if ([left isKindOfClass:[NSString class]] && [right isKindOfClass:[NSString class]]) {
+                isEqual = ([(NSString *)left compare:right options:self.stringOptions] == NSOrderedSame);
+            } else {
+                return [super evaluateWithObject:object];
+            }
+            return (self.operatorType == NSEqualToPredicateOperatorType ? isEqual : !isEqual);
+        }
+
+        case NSLessThanPredicateOperatorType:
+        case NSLessThanOrEqualToPredicateOperatorType:
+        case NSGreaterThanPredicateOperatorType:
+        case NSGreaterThanOrEqualToPredicateOperatorType: {
+            if (left == nil || right == nil || ![left respondsToSelector:@selector(compare:)]) {
+                return [super evaluateWithObject:object];
+            }
+            NSComparisonResult result = [left compare:right];
+            switch (self.operatorType) {
+                case NSLessThanPredicateOperatorType:               return (result == NSOrderedAscending);
+                case NSLessThanOrEqualToPredicateOperatorType:      return (result != NSOrderedDescending);
+                case NSGreaterThanPredicateOperatorType:            return (result == NSOrderedDescending);
+                default:                                            return (result != NSOrderedAscending);
+            }
+        }
+
+        case NSInPredicateOperatorType: {
+            if (self.rightSet != nil) {
+                return (left != nil && [self.rightSet containsObject:left]);
+            }
+            if (left != nil && ([right isKindOfClass:[NSArray class]] || [right isKindOfClass:[NSSet class]] || [right isKindOfClass:[NSOrderedSet class]])) {
+                return [right containsObject:left];
+            }
+            return [super evaluateWithObject:object];
+        }
+
+        case NSBetweenPredicateOperatorType: {
+            if (left == nil || ![left respondsToSelector:@selector(compare:)] || ![right isKindOfClass:[NSArray class]] || [right count] != 2) {
+                return [super evaluateWithObject:object];
+            }
+            return ([left compare:[right objectAtIndex:0]] != NSOrderedAscending && [left compare:[right objectAtIndex:1]] != NSOrderedDescending);
+        }
+
+        case NSBeginsWithPredicateOperatorType:
+        case NSEndsWithPredicateOperatorType:
+        case NSContainsPredicateOperatorType: {
+            // collections and empty strings are left to NSPredicate
+            if (![left isKindOfClass:[NSString class]] || ![right isKindOfClass:[NSString class]] || [right length] == 0) {
+                return [super evaluateWithObject:object];
+            }
+
+            NSStringCompareOptions searchOptions = self.stringOptions;
+            if (self.operatorType == NSBeginsWithPredicateOperatorType) {
+                searchOptions |= NSAnchoredSearch;
+            } else if (self.operatorType == NSEndsWithPredicateOperatorType) {
+                searchOptions |= (NSAnchoredSearch | NSBackwardsSearch);
+            }
+            return ([(NSString *)left rangeOfString:right options:searchOptions].location != NSNotFound);
+        }
+
+        default:
+            return [super evaluateWithObject:object];
+    }
+}
+
+@end
+
+
+#pragma mark - Implementation
+
+@interface UACompiledPredicate ()
+
+@property (nonatomic, strong, readwrite) NSPredicate *predicate;
+@property (nonatomic, readwrite, getter=isCompiled) BOOL compiled;
+@property (nonatomic, strong) UAPredicateNode *rootNode;
+
+@end
+
+@implementation UACompiledPredicate
+
++ (instancetype)compiledPredicateWithPredicate:(NSPredicate *)predicate {
+    UACompiledPredicate *compiledPredicate = [[self alloc] init];
+    compiledPredicate.predicate = predicate;
+    compiledPredicate.rootNode = [UAPredicateNode nodeWithPredicate:predicate];
+    compiledPredicate.compiled = [compiledPredicate.rootNode isCompiled];
+    return compiledPredicate;
+}
+
+- (BOOL)evaluateWithObject:(nullable id)object {
+    @try {
+        return [self.rootNode evaluateWithObject:object];
+
+    } @catch (NSException *exception) {
+        // mismatched types and the like, let NSPredicate decide (or throw) as it always would have
+        return [self.predicate evaluateWithObject:object];
+    }
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p; compiled = %@; predicate = %@>", NSStringFromClass([self class]), (void *)self, (self.compiled ? @"YES" : @"NO"), self.predicate];
+}
+
+@end
+NS_ASSUME_NONNULL_END
@@ -6,7 +6,7 @@
 //  Copyright (c) 2013 Desto. All rights reserved.
 //
 
-@import Foundation;
+#import <Foundation/Foundation.h>
 
 /**
  * A filter object that is applied to a result set inside the filterable results controller.
@@ -34,6 +34,21 @@
 **/
 @property (nonatomic, strong) NSPredicate *predicate;
 
+/**
+ * Whether the predicate should be compiled into a specialised evaluator the first time it is used. Defaults to NO.
+ *
+ * Compiled predicates skip the key path parsing and KVC of -[NSPredicate evaluateWithObject:] for the common comparison,
+ * string and compound predicates, which makes filtering large data sets much cheaper. See UACompiledPredicate for the details
+ * of what is compiled; anything else is still evaluated by the predicate itself.
+**/
+@property (nonatomic) BOOL compilesPredicate;
+
+/**
+ * The predicate the Filterable Results Controller actually evaluates. This is a predicate backed by the compiled form of
+ * -predicate when -compilesPredicate is YES, or -predicate itself otherwise.
+**/
+@property (nonatomic, strong, readonly) NSPredicate *evaluatedPredicate;
+
 /**
  * Creates a UAFilter object with the specified predicate.
  *
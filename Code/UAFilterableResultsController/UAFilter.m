@@ -7,6 +7,13 @@
 //
 
 #import "UAFilter.h"
+#import "UACompiledPredicate.h"
+
+@interface UAFilter ()
+
+@property (nonatomic, strong) NSPredicate *cachedEvaluatedPredicate;
+
+@end
 
 @implementation UAFilter
 
@@ -28,6 +35,42 @@
     return filter;
 }
 
+- (void)setPredicate:(NSPredicate *)predicate
+{
+    _predicatem = predicate;
+    self.cachedEvaluatedPredicate = nil;
+}
+
+- (void)setCompilesPredicate:(BOOL)compilesPredicate
+{
+    _compilesPredicate = compilesPredicate;
+    self.cachedEvaluatedPredicate = nil;
+}
+
+- (NSPredicate *)evaluatedPredicate
+{
+    NSPredicate *predicate = self.predicate;
+    if (!self.compilesPredicate || predicate == nil)
+        return predicate;
+
+    // we hang on to it so the same predicate object is handed out until something changes
+    if (self.cachedEvaluatedPredicate == nil)
+    {
+        UACompiledPredicate *compiledPredicate = [UACompiledPredicate compiledPredicateWithPredicate:predicate];
+        if (compiledPredicate.isCompiled)
+        {
+            self.cachedEvaluatedPredicate = [NSPredicate predicateWithBlock:^BOOL(id evaluatedObject, NSDictionary *bindings)
+            {
+                return [compiledPredicate evaluateWithObject:evaluatedObject];
+            }];
+        } else
+        {
+            self.cachedEvaluatedPredicate = predicate;
+        }
+    }
+    return self.cachedEvaluatedPredicate;
+}
+
 - (BOOL)isEqualToFilter:(UAFilter *)filter
 {
     return [self.title isEqualToString:filter.title] && [self.groupTitle isEqualToString:filter.groupTitle];
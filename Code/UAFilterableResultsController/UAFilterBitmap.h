@@ -0,0 +1,139 @@
+//
+//  UAFilterBitmap.h
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class UAFilteredSection;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * A fixed size bitmap recording which rows of the data match a predicate.
+ *
+ * Rows are numbered across all of the sections in order, so row r of section s is bit (rows in sections before s) + r.
+ * Bitmaps for different predicates over the same data can be combined a 64 bit word at a time, which is a tiny fraction of
+ * the cost of evaluating the predicates again.
+ *
+ * A bitmap can also be partial, when the predicate has only been evaluated against some of the rows, such as the ones that
+ * were visible when a filter was added. It has to be completed before it's combined with another or read from.
+**/
+@interface UAFilterBitmap : NSObject <NSCopying>
+
+/**
+ * The number of rows covered by the bitmap.
+**/
+@property (nonatomic, readonly) NSUInteger count;
+
+/**
+ * Whether the predicate has been evaluated against every row.
+**/
+@property (nonatomic, readonly, getter=isComplete) BOOL complete;
+
+/**
+ * The number of rows the predicate still has to be evaluated against.
+**/
+@property (nonatomic, readonly) NSUInteger numberOfUnevaluatedRows;
+
+/**
+ * Creates an empty bitmap covering the specified number of rows.
+ *
+ * @param   count                   The number of rows.
+ * @returns                         An initialised UAFilterBitmap with no bits set.
+**/
+- (instancetype)initWithCount:(NSUInteger)count;
+
+/**
+ * Creates a partial bitmap covering the specified number of rows, none of which have been evaluated yet.
+ *
+ * @param   count                   The number of rows.
+ * @returns                         An initialised UAFilterBitmap that is not complete.
+**/
+- (instancetype)initWithUnevaluatedCount:(NSUInteger)count;
+
+/**
+ * Creates a bitmap of the rows in the supplied sections that match a predicate.
+ *
+ * @param   predicate               The predicate to evaluate against each row.
+ * @param   sections                An array of sections, each of them an array of rows.
+ * @returns                         An initialised UAFilterBitmap.
+**/
+- (instancetype)initWithPredicate:(NSPredicate *)predicate evaluatedOverSections:(NSArray *)sections;
+
+/**
+ * Creates a bitmap of the rows in the supplied sections that match a predicate, optionally evaluating chunks of rows concurrently.
+ *
+ * Chunks are whole 64 bit words, so no two chunks ever write to the same part of the bitmap. A chunk can span sections and a
+ * large section is split across several chunks.
+ *
+ * @param   predicate               The predicate to evaluate against each row. It must be safe to evaluate from multiple threads.
+ * @param   sections                An array of sections, each of them an array of rows.
+ * @param   concurrently            Whether to evaluate the chunks concurrently using dispatch_apply.
+ * @returns                         An initialised UAFilterBitmap.
+**/
+- (instancetype)initWithPredicate:(NSPredicate *)predicate evaluatedOverSections:(NSArray *)sections concurrently:(BOOL)concurrently;
+
+/**
+ * Creates a bitmap of the rows in the supplied sections that match a predicate, giving up part way through if asked to.
+ *
+ * @param   predicate               The predicate to evaluate against each row. It must be safe to evaluate from multiple threads.
+ * @param   sections                An array of sections, each of them an array of rows.
+ * @param   concurrently            Whether to evaluate the chunks concurrently using dispatch_apply.
+ * @param   isCancelled             An optional block that is called every so often while evaluating. If it returns YES the evaluation stops.
+ * @returns                         An initialised UAFilterBitmap, or nil if the evaluation was cancelled.
+**/
+- (nullable instancetype)initWithPredicate:(NSPredicate *)predicate
+                     evaluatedOverSections:(NSArray *)sections
+                              concurrently:(BOOL)concurrently
+                              cancellation:(nullable BOOL (^)(void))isCancelled;
+
+- (BOOL)containsIndex:(NSUInteger)index;
+- (void)addIndex:(NSUInteger)index;
+
+/**
+ * Records whether a row matches the predicate, which also counts as evaluating it in a partial bitmap.
+**/
+- (void)setIndex:(NSUInteger)index matches:(BOOL)matches;
+
+/**
+ * Evaluates the predicate against every row that hasn't been evaluated yet, which leaves the bitmap complete.
+ *
+ * @param   predicate               The predicate the bitmap was made from.
+ * @param   sections                The sections of the data the bitmap covers, each of them an array of rows.
+**/
+- (void)completeWithPredicate:(NSPredicate *)predicate evaluatedOverSections:(NSArray *)sections;
+
+/**
+ * Makes room for rows inserted into the data, moving the bits at and after the start of the range along by its length.
+ *
+ * The bits of the inserted rows are clear, and in a partial bitmap they haven't been evaluated. This is a shift a word at a
+ * time, which is far cheaper than evaluating the predicate again.
+**/
+- (void)insertRowsInRange:(NSRange)range;
+
+/**
+ * Drops the bits of rows removed from the data, moving the bits after the range back by its length.
+**/
+- (void)removeRowsInRange:(NSRange)range;
+
+/**
+ * Clears every bit that is not also set in the supplied bitmap, which must cover the same number of rows. Both must be complete.
+**/
+- (void)intersectWithBitmap:(UAFilterBitmap *)bitmap;
+
+/**
+ * Returns the rows of an array whose bits are set, reading the bits from the specified offset. The bitmap must be complete.
+ *
+ * @param   array                   A section of the data the bitmap was built from.
+ * @param   offset                  The bit of the first row of the section.
+ * @returns                         A new filtered section mapping the matching rows of the array.
+**/
+- (UAFilteredSection *)filteredSectionOfArray:(NSArray *)array atOffset:(NSUInteger)offset;
+
+@end
+
+NS_ASSUME_NONNULL_END
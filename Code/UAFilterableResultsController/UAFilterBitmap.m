@@ -0,0 +1,414 @@
+//
+//  UAFilterBitmap.m
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import "UAFilterBitmap.h"
+#import "UAFilteredSection.h"
+
+#define UAFilterBitmapBitsPerWord 64
+#define UAFilterBitmapCancellationInterval 1024
+
+static inline NSUInteger UAFilterBitmapWordCount(NSUInteger count) {
+    return (count + UAFilterBitmapBitsPerWord - 1) / UAFilterBitmapBitsPerWord;
+}
+
+// a few chunks per core so a slow chunk doesn't hold everyone up, but never so small that dispatching them costs more than evaluating them
+static inline NSUInteger UAFilterBitmapChunkSize(NSUInteger count) {
+    NSUInteger chunks = [[NSProcessInfo processInfo] activeProcessorCount] * 4;
+    NSUInteger chunkSize = MAX((count + chunks - 1) / chunks, 1024);
+
+    // chunks are whole words so they never share one
+    return ((chunkSize + UAFilterBitmapBitsPerWord - 1) / UAFilterBitmapBitsPerWord) * UAFilterBitmapBitsPerWord;
+}
+
+// the word with the bits that fall outside of [start, end) cleared
+static inline uint64_t UAFilterBitmapWordInRange(const uint64_t *words, NSUInteger wordIndex, NSUInteger start, NSUInteger end) {
+    NSUInteger base = wordIndex * UAFilterBitmapBitsPerWord;
+    uint64_t word = words[wordIndex];
+    if (base < start) {
+        word &= (~0ULL << (start - base));
+    }
+    if (end - base < UAFilterBitmapBitsPerWord) {
+        word &= ((1ULL << (end - base)) - 1);
+    }
+    return word;
+}
+
+// the 64 bits starting at any bit, even one before the start, with anything outside of the words read as clear
+static inline uint64_t UAFilterBitmapWordAtBit(const uint64_t *words, NSUInteger wordCount, NSInteger bit) {
+    NSInteger wordIndex = (bit >= 0 ? bit / UAFilterBitmapBitsPerWord : -((-bit + UAFilterBitmapBitsPerWord - 1) / UAFilterBitmapBitsPerWord));
+    NSUInteger shift = (NSUInteger)(bit - wordIndex * UAFilterBitmapBitsPerWord);
+
+    uint64_t word = 0;
+    if (wordIndex >= 0 && (NSUInteger)wordIndex < wordCount) {
+        word = words[wordIndex] >> shift;
+    }
+    if (shift != 0 && wordIndex + 1 >= 0 && (NSUInteger)(wordIndex + 1) < wordCount) {
+        word |= words[wordIndex + 1] << (UAFilterBitmapBitsPerWord - shift);
+    }
+    return word;
+}
+
+// the bits of a word that are at or after a bit
+static inline uint64_t UAFilterBitmapMaskFromBit(NSUInteger wordIndex, NSUInteger bit) {
+    NSUInteger base = wordIndex * UAFilterBitmapBitsPerWord;
+    if (bit <= base) {
+        return ~0ULL;
+    }
+    if (bit - base >= UAFilterBitmapBitsPerWord) {
+        return 0;
+    }
+    return (~0ULL << (bit - base));
+}
+
+// moves the bits at and after the start of the range along by its length, leaving the range clear
+static void UAFilterBitmapInsertBits(uint64_t *words, NSUInteger wordCapacity, NSUInteger newWordCount, NSRange range) {
+    // from the top down, so every word is read before it's written over
+    NSUInteger start = range.location;
+    NSUInteger end = NSMaxRange(range);
+    for (NSUInteger wordIndex = newWordCount; wordIndex-- > start / UAFilterBitmapBitsPerWord; ) {
+        uint64_t moved = UAFilterBitmapWordAtBit(words, wordCapacity, (NSInteger)(wordIndex * UAFilterBitmapBitsPerWord) - (NSInteger)range.length);
+        words[wordIndex] = (moved & UAFilterBitmapMaskFromBit(wordIndex, end)) | (words[wordIndex] & ~UAFilterBitmapMaskFromBit(wordIndex, start));
+    }
+}
+
+// moves the bits after the range back by its length
+static void UAFilterBitmapRemoveBits(uint64_t *words, NSUInteger wordCount, NSRange range) {
+    // from the bottom up, so every word is read before it's written over, and the bits past the new end are read as clear
+    NSUInteger start = range.location;
+    for (NSUInteger wordIndex = start / UAFilterBitmapBitsPerWord; wordIndex < wordCount; wordIndex++) {
+        uint64_t moved = UAFilterBitmapWordAtBit(words, wordCount, (NSInteger)(wordIndex * UAFilterBitmapBitsPerWord + range.length));
+        words[wordIndex] = (moved & UAFilterBitmapMaskFromBit(wordIndex, start)) | (words[wordIndex] & ~UAFilterBitmapMaskFromBit(wordIndex, start));
+    }
+}
+
+static uint64_t *UAFilterBitmapGrowWords(uint64_t *words, NSUInteger wordCapacity, NSUInteger newCapacity, NSUInteger count) {
+    uint64_t *newWords = realloc(words, newCapacity * sizeof(uint64_t));
+    if (newWords == NULL) {
+        [NSException raise:NSMallocException format:@"Could not make room for a bitmap of %lu rows.", (unsigned long)count];
+    }
+    memset(newWords + wordCapacity, 0, (newCapacity - wordCapacity) * sizeof(uint64_t));
+    return newWords;
+}
+
+NS_ASSUME_NONNULL_BEGIN
+@interface UAFilterBitmap () {
+    // the words allocated, which can be more than the rows need after some have been removed. Any past the rows are clear.
+    NSUInteger _wordCapacity;
+}
+
+@property (nonatomic, readwrite) NSUInteger count;
+@property (nonatomic) uint64_t *words;
+
+// the rows the predicate has been evaluated against, or NULL once it has been evaluated against all of them
+@property (nonatomic, nullable) uint64_t *evaluatedWords;
+
+@end
+
+@implementation UAFilterBitmap
+
+- (instancetype)initWithCount:(NSUInteger)count {
+    self = [super init];
+    if (self) {
+        self.count = count;
+        _wordCapacity = MAX(UAFilterBitmapWordCount(count), 1);
+        self.words = calloc(_wordCapacity, sizeof(uint64_t));
+        if (self.words == NULL) {
+            [NSException raise:NSMallocException format:@"Could not make room for a bitmap of %lu rows.", (unsigned long)count];
+        }
+    }
+    return self;
+}
+
+- (instancetype)initWithUnevaluatedCount:(NSUInteger)count {
+    self = [self initWithCount:count];
+    if (self) {
+        self.evaluatedWords = calloc(_wordCapacity, sizeof(uint64_t));
+        if (self.evaluatedWords == NULL) {
+            [NSException raise:NSMallocException format:@"Could not make room for a bitmap of %lu rows.", (unsigned long)count];
+        }
+    }
+    return self;
+}
+
+- (instancetype)initWithPredicate:(NSPredicate *)predicate evaluatedOverSections:(NSArray *)sections {
+    return [self initWithPredicate:predicate evaluatedOverSections:sections concurrently:NO];
+}
+
+- (instancetype)initWithPredicate:(NSPredicate *)predicate evaluatedOverSections:(NSArray *)sections concurrently:(BOOL)concurrently {
+    return [self initWithPredicate:predicate evaluatedOverSections:sections concurrently:concurrently cancellation:nil];
+}
+
+- (nullable instancetype)initWithPredicate:(NSPredicate *)predicate
+                     evaluatedOverSections:(NSArray *)sections
+                              concurrently:(BOOL)concurrently
+                              cancellation:(nullable BOOL (^)(void))isCancelled {
+    // where each section starts, with the total on the end
+    NSUInteger sectionCount = sections.count;
+    NSUInteger *offsets = malloc((sectionCount + 1) * sizeof(NSUInteger));
+    if (offsets == NULL) {
+        [NSException raise:NSMallocException format:@"Could not make room for the offsets of %lu sections.", (unsigned long)sectionCount];
+    }
+    offsets[0] = 0;
+    for (NSUInteger sectionIndex = 0; sectionIndex < sectionCount; sectionIndex++) {
+        offsets[sectionIndex + 1] = offsets[sectionIndex] + [sections[sectionIndex] count];
+    }
+    NSUInteger count = offsets[sectionCount];
+
+    @try {
+        self = [self initWithCount:count];
+    } @catch (NSException *exception) {
+        free(offsets);
+        @throw exception;
+    }
+    if (self) {
+        NSUInteger chunkSize = (concurrently ? UAFilterBitmapChunkSize(count) : MAX(count, 1));
+        NSUInteger chunkCount = (count + chunkSize - 1) / chunkSize;
+        uint64_t *words = self.words;
+        __block NSException *chunkException = nil;
+        __block volatile BOOL wasCancelled = NO;
+
+        void (^evaluateChunk)(size_t) = ^(size_t chunk) {
+            NSUInteger index = chunk * chunkSize;
+            NSUInteger end = MIN(index + chunkSize, count);
+
+            // find the section the chunk starts in, the last one that starts at or before it
+            NSUInteger low = 0, high = sectionCount;
+            while (low < high) {
+                NSUInteger middle = low + (high - low) / 2;
+                if (offsets[middle + 1] <= index) {
+                    low = middle + 1;
+                } else {
+                    high = middle;
+                }
+            }
+
+            @autoreleasepool {
+                @try {
+                    for (NSUInteger sectionIndex = low; index < end && !wasCancelled; sectionIndex++) {
+                        NSArray *section = sections[sectionIndex];
+                        NSUInteger sectionEnd = MIN(offsets[sectionIndex + 1], end);
+                        for (; index < sectionEnd && !wasCancelled; index++) {
+                            // checking every so often keeps the cost of asking down
+                            if (isCancelled != nil && (index % UAFilterBitmapCancellationInterval) == 0 && isCancelled()) {
+                                wasCancelled = YES;
+                                break;
+                            }
+
+                            if ([predicate evaluateWithObject:[section objectAtIndex:index - offsets[sectionIndex]]]) {
+                                words[index / UAFilterBitmapBitsPerWord] |= (1ULL << (index % UAFilterBitmapBitsPerWord));
+                            }
+                        }
+                    }
+
+                // an exception can't cross threads, so we keep the first one and throw it once everyone is done
+                } @catch (NSException *exception) {
+                    @synchronized (predicate) {
+                        if (chunkException == nil) {
+                            chunkException = exception;
+                        }
+                    }
+                }
+            }
+        };
+
+        if (chunkCount > 1) {
+            dispatch_apply(chunkCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), evaluateChunk);
+        } else if (chunkCount == 1) {
+            evaluateChunk(0);
+        }
+
+        if (chunkException != nil) {
+            free(offsets);
+            @throw chunkException;
+        }
+        if (wasCancelled) {
+            free(offsets);
+            return nil;
+        }
+    }
+
+    free(offsets);
+    return self;
+}
+
+- (void)dealloc {
+    free(_words);
+    free(_evaluatedWords);
+}
+
+- (id)copyWithZone:(nullable NSZone *)zone {
+    UAFilterBitmap *copy = (self.isComplete ? [[UAFilterBitmap allocWithZone:zone] initWithCount:self.count]
+                                            : [[UAFilterBitmap allocWithZone:zone] initWithUnevaluatedCount:self.count]);
+    memcpy(copy.words, self.words, UAFilterBitmapWordCount(self.count) * sizeof(uint64_t));
+    if (!self.isComplete) {
+        memcpy(copy.evaluatedWords, self.evaluatedWords, UAFilterBitmapWordCount(self.count) * sizeof(uint64_t));
+    }
+    return copy;
+}
+
+#pragma mark - Evaluation
+
+- (BOOL)isComplete {
+    return (self.evaluatedWords == NULL);
+}
+
+- (NSUInteger)numberOfUnevaluatedRows {
+    const uint64_t *evaluatedWords = self.evaluatedWords;
+    if (evaluatedWords == NULL) {
+        return 0;
+    }
+
+    NSUInteger evaluated = 0;
+    NSUInteger wordCount = UAFilterBitmapWordCount(self.count);
+    for (NSUInteger wordIndex = 0; wordIndex < wordCount; wordIndex++) {
+        evaluated += (NSUInteger)__builtin_popcountll(evaluatedWords[wordIndex]);
+    }
+    return self.count - evaluated;
+}
+
+- (void)completeWithPredicate:(NSPredicate *)predicate evaluatedOverSections:(NSArray *)sections {
+    uint64_t *evaluatedWords = self.evaluatedWords;
+    if (evaluatedWords == NULL) {
+        return;
+    }
+
+    uint64_t *words = self.words;
+    NSUInteger offset = 0;
+    for (NSArray *section in sections) {
+        NSUInteger end = offset + section.count;
+        NSParameterAssert(end <= self.count);
+
+        // only the rows we haven't looked at yet, jumping straight from one to the next
+        NSUInteger endWord = (end + UAFilterBitmapBitsPerWord - 1) / UAFilterBitmapBitsPerWord;
+        for (NSUInteger wordIndex = offset / UAFilterBitmapBitsPerWord; wordIndex < endWord; wordIndex++) {
+            NSUInteger base = wordIndex * UAFilterBitmapBitsPerWord;
+            uint64_t word = ~evaluatedWords[wordIndex] & UAFilterBitmapMaskFromBit(wordIndex, offset) & ~UAFilterBitmapMaskFromBit(wordIndex, end);
+            while (word != 0) {
+                NSUInteger bit = (NSUInteger)__builtin_ctzll(word);
+                if ([predicate evaluateWithObject:[section objectAtIndex:base + bit - offset]]) {
+                    words[wordIndex] |= (1ULL << bit);
+                }
+                word &= (word - 1);
+            }
+        }
+        offset = end;
+    }
+    NSParameterAssert(offset == self.count);
+
+    free(evaluatedWords);
+    self.evaluatedWords = NULL;
+}
+
+#pragma mark - Bits
+
+- (BOOL)containsIndex:(NSUInteger)index {
+    NSParameterAssert(index < self.count);
+    return (self.words[index / UAFilterBitmapBitsPerWord] & (1ULL << (index % UAFilterBitmapBitsPerWord))) != 0;
+}
+
+- (void)addIndex:(NSUInteger)index {
+    NSParameterAssert(index < self.count);
+    self.words[index / UAFilterBitmapBitsPerWord] |= (1ULL << (index % UAFilterBitmapBitsPerWord));
+}
+
+- (void)setIndex:(NSUInteger)index matches:(BOOL)matches {
+    NSParameterAssert(index < self.count);
+    uint64_t bit = (1ULL << (index % UAFilterBitmapBitsPerWord));
+    if (matches) {
+        self.words[index / UAFilterBitmapBitsPerWord] |= bit;
+    } else {
+        self.words[index / UAFilterBitmapBitsPerWord] &= ~bit;
+    }
+    if (self.evaluatedWords != NULL) {
+        self.evaluatedWords[index / UAFilterBitmapBitsPerWord] |= bit;
+    }
+}
+
+- (void)insertRowsInRange:(NSRange)range {
+    NSParameterAssert(range.location <= self.count);
+    if (range.length == 0) {
+        return;
+    }
+
+    NSUInteger newCount = self.count + range.length;
+    NSUInteger newWordCount = UAFilterBitmapWordCount(newCount);
+    if (newWordCount > _wordCapacity) {
+        NSUInteger newCapacity = MAX(newWordCount, _wordCapacity * 2);
+        self.words = UAFilterBitmapGrowWords(self.words, _wordCapacity, newCapacity, newCount);
+        if (self.evaluatedWords != NULL) {
+            self.evaluatedWords = UAFilterBitmapGrowWords(self.evaluatedWords, _wordCapacity, newCapacity, newCount);
+        }
+        _wordCapacity = newCapacity;
+    }
+
+    UAFilterBitmapInsertBits(self.words, _wordCapacity, newWordCount, range);
+    if (self.evaluatedWords != NULL) {
+        UAFilterBitmapInsertBits(self.evaluatedWords, _wordCapacity, newWordCount, range);
+    }
+    self.count = newCount;
+}
+
+- (void)removeRowsInRange:(NSRange)range {
+    NSParameterAssert(NSMaxRange(range) <= self.count);
+    if (range.length == 0) {
+        return;
+    }
+
+    NSUInteger wordCount = UAFilterBitmapWordCount(self.count);
+    UAFilterBitmapRemoveBits(self.words, wordCount, range);
+    if (self.evaluatedWords != NULL) {
+        UAFilterBitmapRemoveBits(self.evaluatedWords, wordCount, range);
+    }
+    self.count = self.count - range.length;
+}
+
+- (void)intersectWithBitmap:(UAFilterBitmap *)bitmap {
+    NSParameterAssert(bitmap.count == self.count);
+    NSParameterAssert(self.isComplete && bitmap.isComplete);
+
+    // a plain loop over restrict pointers, which the compiler turns into vector instructions
+    uint64_t *__restrict words = self.words;
+    const uint64_t *__restrict otherWords = bitmap.words;
+    NSUInteger wordCount = UAFilterBitmapWordCount(self.count);
+    for (NSUInteger i = 0; i < wordCount; i++) {
+        words[i] &= otherWords[i];
+    }
+}
+
+- (UAFilteredSection *)filteredSectionOfArray:(NSArray *)array atOffset:(NSUInteger)offset {
+    NSParameterAssert(offset + array.count <= self.count);
+    NSParameterAssert(self.isComplete);
+
+    NSUInteger end = offset + array.count;
+    const uint64_t *words = self.words;
+    NSUInteger firstWord = offset / UAFilterBitmapBitsPerWord;
+    NSUInteger endWord = (end + UAFilterBitmapBitsPerWord - 1) / UAFilterBitmapBitsPerWord;
+
+    // count them first so the rows are allocated once
+    NSUInteger matches = 0;
+    for (NSUInteger wordIndex = firstWord; wordIndex < endWord; wordIndex++) {
+        matches += (NSUInteger)__builtin_popcountll(UAFilterBitmapWordInRange(words, wordIndex, offset, end));
+    }
+
+    UAFilteredSection *filteredSection = [[UAFilteredSection alloc] initWithSection:array capacity:matches];
+    for (NSUInteger wordIndex = firstWord; wordIndex < endWord; wordIndex++) {
+        NSUInteger base = wordIndex * UAFilterBitmapBitsPerWord;
+        uint64_t word = UAFilterBitmapWordInRange(words, wordIndex, offset, end);
+
+        // and jump straight from one set bit to the next
+        while (word != 0) {
+            NSUInteger bit = (NSUInteger)__builtin_ctzll(word);
+            [filteredSection addRow:base + bit - offset];
+            word &= (word - 1);
+        }
+    }
+    return filteredSection;
+}
+
+@end
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,74 @@
+//
+//  UAFilterableResultsChangeList.h
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "UAFilterableResultsChangeset.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+static inline UAFilterableResultsIndexPair UAFilterableResultsIndexPairMake(NSInteger fromSection, NSInteger fromRow, NSInteger toSection, NSInteger toRow) {
+    UAFilterableResultsIndexPair pair;
+    pair.fromSection = fromSection;
+    pair.fromRow = fromRow;
+    pair.toSection = toSection;
+    pair.toRow = toRow;
+    return pair;
+}
+
+/**
+ * A single change in a UAFilterableResultsChangeList. Section changes keep the index of the section in pair.fromSection.
+ *
+ * The object is not retained, the change list keeps the arrays it came from alive instead.
+**/
+typedef struct {
+    UAFilterableResultsChangeType type;
+    BOOL sectionChange;
+    UAFilterableResultsIndexPair pair;
+    __unsafe_unretained id object;
+} UAFilterableResultsChangeEntry;
+
+/**
+ * The changes needed to turn one data set into another, in the order they should be delivered.
+ *
+ * The changes are packed into a single C array, so working them out costs no allocation per row. Index paths are only
+ * created if they have to be handed to a delegate one row at a time.
+**/
+@interface UAFilterableResultsChangeList : NSObject
+
+/**
+ * Creates an empty list of changes.
+ *
+ * @param   fromArray               The data the changes start from. It is kept alive, along with every object in it, for as long as the list is.
+ * @param   toArray                 The data the changes end up at, which is kept alive in the same way.
+ * @returns                         An initialised UAFilterableResultsChangeList.
+**/
+- (instancetype)initWithFromArray:(NSArray *)fromArray toArray:(NSArray *)toArray;
+
+/**
+ * The number of changes in the list.
+**/
+@property (nonatomic, readonly) NSUInteger count;
+
+/**
+ * The changes, valid for as long as the list is and until the next one is added.
+**/
+- (const UAFilterableResultsChangeEntry *)entries NS_RETURNS_INNER_POINTER;
+
+/**
+ * Adds a change to an object, which must be in one of the arrays the list was created with.
+**/
+- (void)addChangeToObject:(id)object atIndexPair:(UAFilterableResultsIndexPair)pair forChangeType:(UAFilterableResultsChangeType)type;
+
+/**
+ * Adds a change to a whole section.
+**/
+- (void)addChangeForSectionAtIndex:(NSInteger)sectionIndex forChangeType:(UAFilterableResultsChangeType)type;
+
+@end
+
+NS_ASSUME_NONNULL_END
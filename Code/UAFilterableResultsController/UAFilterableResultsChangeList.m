@@ -0,0 +1,78 @@
+//
+//  UAFilterableResultsChangeList.m
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import "UAFilterableResultsChangeList.h"
+
+NS_ASSUME_NONNULL_BEGIN
+@interface UAFilterableResultsChangeList () {
+    UAFilterableResultsChangeEntry *_entries;
+    NSUInteger _capacity;
+}
+
+@property (nonatomic, readwrite) NSUInteger count;
+
+// what keeps the objects in the entries alive
+@property (nonatomic, strong) NSArray *fromArray;
+@property (nonatomic, strong) NSArray *toArray;
+
+@end
+
+@implementation UAFilterableResultsChangeList
+
+- (instancetype)initWithFromArray:(NSArray *)fromArray toArray:(NSArray *)toArray {
+    self = [super init];
+    if (self) {
+        self.fromArray = fromArray;
+        self.toArray = toArray;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_entries);
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p; count = %lu>", NSStringFromClass([self class]), (void *)self, (unsigned long)self.count];
+}
+
+- (const UAFilterableResultsChangeEntry *)entries {
+    return _entries;
+}
+
+- (UAFilterableResultsChangeEntry *)nextEntry {
+    if (self.count == _capacity) {
+        NSUInteger newCapacity = MAX(_capacity * 2, 16);
+        UAFilterableResultsChangeEntry *entries = realloc(_entries, newCapacity * sizeof(UAFilterableResultsChangeEntry));
+        if (entries == NULL) {
+            [NSException raise:NSMallocException format:@"Could not make room for %lu changes.", (unsigned long)newCapacity];
+        }
+        _entries = entries;
+        _capacity = newCapacity;
+    }
+    return &_entries[self.count++];
+}
+
+- (void)addChangeToObject:(id)object atIndexPair:(UAFilterableResultsIndexPair)pair forChangeType:(UAFilterableResultsChangeType)type {
+    UAFilterableResultsChangeEntry *entry = [self nextEntry];
+    entry->type = type;
+    entry->sectionChange = NO;
+    entry->pair = pair;
+    entry->object = object;
+}
+
+- (void)addChangeForSectionAtIndex:(NSInteger)sectionIndex forChangeType:(UAFilterableResultsChangeType)type {
+    UAFilterableResultsChangeEntry *entry = [self nextEntry];
+    entry->type = type;
+    entry->sectionChange = YES;
+    entry->pair = UAFilterableResultsIndexPairMake(sectionIndex, NSNotFound, NSNotFound, NSNotFound);
+    entry->object = nil;
+}
+
+@end
+NS_ASSUME_NONNULL_END
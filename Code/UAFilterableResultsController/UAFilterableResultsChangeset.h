@@ -0,0 +1,77 @@
+//
+//  UAFilterableResultsChangeset.h
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "UAFilterableResultsControllerDelegate.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Where a row or item was before and after a change. Deletions have no destination and insertions have no source, the
+ * missing half is set to NSNotFound. Updates use the source only.
+**/
+typedef struct {
+    NSInteger fromSection;
+    NSInteger fromRow;
+    NSInteger toSection;
+    NSInteger toRow;
+} UAFilterableResultsIndexPair;
+
+/**
+ * Every change made in a single outermost update batch, packed together.
+ *
+ * Changesets are only built for delegates that implement -filterableResultsController:didChangeContentWithChangeset:, and
+ * let you apply a whole batch with one call to -performBatchUpdates: without a delegate message and index path per row.
+ * The rows are kept in plain C arrays in the order they were reported. A changeset never changes once it has been delivered.
+**/
+@interface UAFilterableResultsChangeset : NSObject
+
+/**
+ * The sections that were inserted, deleted or reloaded.
+**/
+@property (nonatomic, strong, readonly) NSIndexSet *insertedSections;
+@property (nonatomic, strong, readonly) NSIndexSet *deletedSections;
+@property (nonatomic, strong, readonly) NSIndexSet *updatedSections;
+
+/**
+ * The number of rows deleted, inserted, moved and updated.
+**/
+@property (nonatomic, readonly) NSUInteger numberOfDeletions;
+@property (nonatomic, readonly) NSUInteger numberOfInsertions;
+@property (nonatomic, readonly) NSUInteger numberOfMoves;
+@property (nonatomic, readonly) NSUInteger numberOfUpdates;
+
+/**
+ * Whether nothing changed at all.
+**/
+@property (nonatomic, readonly, getter=isEmpty) BOOL empty;
+
+/**
+ * The packed rows for each type of change, valid for as long as the changeset is. Each has the matching number of entries.
+**/
+- (const UAFilterableResultsIndexPair *)deletions NS_RETURNS_INNER_POINTER;
+- (const UAFilterableResultsIndexPair *)insertions NS_RETURNS_INNER_POINTER;
+- (const UAFilterableResultsIndexPair *)moves NS_RETURNS_INNER_POINTER;
+- (const UAFilterableResultsIndexPair *)updates NS_RETURNS_INNER_POINTER;
+
+/**
+ * The rows for each type of change as index paths, ready to hand to UITableView or UICollectionView. These are only
+ * created when you ask for them.
+**/
+- (NSArray *)deletedIndexPaths;
+- (NSArray *)insertedIndexPaths;
+- (NSArray *)updatedIndexPaths;
+
+/**
+ * Calls the block with the source and destination of every move, in the order they were reported.
+**/
+- (void)enumerateMovesUsingBlock:(void (^)(NSIndexPath *indexPath, NSIndexPath *newIndexPath))block;
+
+@end
+
+NS_ASSUME_NONNULL_END
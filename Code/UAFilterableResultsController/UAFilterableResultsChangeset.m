@@ -0,0 +1,212 @@
+//
+//  UAFilterableResultsChangeset.m
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import "UAFilterableResultsChangeset.h"
+#import "UAFilterableResultsController+Private.h"
+
+typedef struct {
+    UAFilterableResultsIndexPair *pairs;
+    NSUInteger count;
+    NSUInteger capacity;
+} UAIndexPairBuffer;
+
+static void UAIndexPairBufferAppend(UAIndexPairBuffer *buffer, UAFilterableResultsIndexPair pair) {
+    if (buffer->count == buffer->capacity) {
+        NSUInteger newCapacity = MAX(buffer->capacity * 2, 16);
+        UAFilterableResultsIndexPair *pairs = realloc(buffer->pairs, newCapacity * sizeof(UAFilterableResultsIndexPair));
+        if (pairs == NULL) {
+            [NSException raise:NSMallocException format:@"Could not make room for %lu changes.", (unsigned long)newCapacity];
+        }
+        buffer->pairs = pairs;
+        buffer->capacity = newCapacity;
+    }
+    buffer->pairs[buffer->count++] = pair;
+}
+
+static NSArray *UAIndexPathsInBuffer(const UAIndexPairBuffer *buffer, BOOL destinations) {
+    NSMutableArray *indexPaths = [[NSMutableArray alloc] initWithCapacity:buffer->count];
+    for (NSUInteger i = 0; i < buffer->count; i++) {
+        UAFilterableResultsIndexPair pair = buffer->pairs[i];
+        [indexPaths addObject:(destinations ? [NSIndexPath indexPathForRow:pair.toRow inSection:pair.toSection] : [NSIndexPath indexPathForRow:pair.fromRow inSection:pair.fromSection])];
+    }
+    return indexPaths;
+}
+
+NS_ASSUME_NONNULL_BEGIN
+@interface UAFilterableResultsChangeset () {
+    UAIndexPairBuffer _deletions;
+    UAIndexPairBuffer _insertions;
+    UAIndexPairBuffer _moves;
+    UAIndexPairBuffer _updates;
+}
+
+@property (nonatomic, strong) NSMutableIndexSet *mutableInsertedSections;
+@property (nonatomic, strong) NSMutableIndexSet *mutableDeletedSections;
+@property (nonatomic, strong) NSMutableIndexSet *mutableUpdatedSections;
+
+@end
+
+@implementation UAFilterableResultsChangeset
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        self.mutableInsertedSections = [[NSMutableIndexSet alloc] init];
+        self.mutableDeletedSections = [[NSMutableIndexSet alloc] init];
+        self.mutableUpdatedSections = [[NSMutableIndexSet alloc] init];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_deletions.pairs);
+    free(_insertions.pairs);
+    free(_moves.pairs);
+    free(_updates.pairs);
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p; sections: +%lu -%lu ~%lu; rows: +%lu -%lu >%lu ~%lu>",
+            NSStringFromClass([self class]), (__bridge void *)self,
+            (unsigned long)self.insertedSections.count, (unsigned long)self.deletedSections.count, (unsigned long)self.updatedSections.count,
+            (unsigned long)self.numberOfInsertions, (unsigned long)self.numberOfDeletions, (unsigned long)self.numberOfMoves, (unsigned long)self.numberOfUpdates];
+}
+
+#pragma mark - Sections
+
+- (NSIndexSet *)insertedSections {
+    return self.mutableInsertedSections;
+}
+
+- (NSIndexSet *)deletedSections {
+    return self.mutableDeletedSections;
+}
+
+- (NSIndexSet *)updatedSections {
+    return self.mutableUpdatedSections;
+}
+
+#pragma mark - Rows
+
+- (NSUInteger)numberOfDeletions {
+    return _deletions.count;
+}
+
+- (NSUInteger)numberOfInsertions {
+    return _insertions.count;
+}
+
+- (NSUInteger)numberOfMoves {
+    return _moves.count;
+}
+
+- (NSUInteger)numberOfUpdates {
+    return _updates.count;
+}
+
+- (BOOL)isEmpty {
+    return (_deletions.count == 0 && _insertions.count == 0 && _moves.count == 0 && _updates.count == 0 &&
+            self.insertedSections.count == 0 && self.deletedSections.count == 0 && self.updatedSections.count == 0);
+}
+
+- (const UAFilterableResultsIndexPair *)deletions {
+    return _deletions.pairs;
+}
+
+- (const UAFilterableResultsIndexPair *)insertions {
+    return _insertions.pairs;
+}
+
+- (const UAFilterableResultsIndexPair *)moves {
+    return _moves.pairs;
+}
+
+- (const UAFilterableResultsIndexPair *)updates {
+    return _updates.pairs;
+}
+
+- (NSArray *)deletedIndexPaths {
+    return UAIndexPathsInBuffer(&_deletions, NO);
+}
+
+- (NSArray *)insertedIndexPaths {
+    return UAIndexPathsInBuffer(&_insertions, YES);
+}
+
+- (NSArray *)updatedIndexPaths {
+    return UAIndexPathsInBuffer(&_updates, NO);
+}
+
+- (void)enumerateMovesUsingBlock:(void (^)(NSIndexPath *indexPath, NSIndexPath *newIndexPath))block {
+    NSParameterAssert(block != nil);
+
+    for (NSUInteger i = 0; i < _moves.count; i++) {
+        UAFilterableResultsIndexPair move = _moves.pairs[i];
+        block([NSIndexPath indexPathForRow:move.fromRow inSection:move.fromSection], [NSIndexPath indexPathForRow:move.toRow inSection:move.toSection]);
+    }
+}
+
+@end
+
+#pragma mark - Recording
+
+@implementation UAFilterableResultsChangeset (Recording)
+
+- (void)recordChangeAtIndexPath:(nullable NSIndexPath *)indexPath forChangeType:(UAFilterableResultsChangeType)type newIndexPath:(nullable NSIndexPath *)newIndexPath {
+    UAFilterableResultsIndexPair pair;
+    pair.fromSection = (indexPath != nil ? indexPath.section : NSNotFound);
+    pair.fromRow = (indexPath != nil ? indexPath.row : NSNotFound);
+    pair.toSection = (newIndexPath != nil ? newIndexPath.section : NSNotFound);
+    pair.toRow = (newIndexPath != nil ? newIndexPath.row : NSNotFound);
+    [self recordChange:pair forChangeType:type];
+}
+
+- (void)recordChange:(UAFilterableResultsIndexPair)pair forChangeType:(UAFilterableResultsChangeType)type {
+    switch (type) {
+        case UAFilterableResultsChangeDelete:
+            UAIndexPairBufferAppend(&_deletions, pair);
+            break;
+
+        case UAFilterableResultsChangeInsert:
+            UAIndexPairBufferAppend(&_insertions, pair);
+            break;
+
+        case UAFilterableResultsChangeMove:
+            UAIndexPairBufferAppend(&_moves, pair);
+            break;
+
+        case UAFilterableResultsChangeUpdate:
+            // updates are reported at the old index path, same as UITableView wants them
+            pair.toSection = NSNotFound;
+            pair.toRow = NSNotFound;
+            UAIndexPairBufferAppend(&_updates, pair);
+            break;
+    }
+}
+
+- (void)recordChangeForSectionAtIndex:(NSInteger)sectionIndex forChangeType:(UAFilterableResultsChangeType)type {
+    switch (type) {
+        case UAFilterableResultsChangeInsert:
+            [self.mutableInsertedSections addIndex:(NSUInteger)sectionIndex];
+            break;
+
+        case UAFilterableResultsChangeDelete:
+            [self.mutableDeletedSections addIndex:(NSUInteger)sectionIndex];
+            break;
+
+        case UAFilterableResultsChangeUpdate:
+            [self.mutableUpdatedSections addIndex:(NSUInteger)sectionIndex];
+            break;
+
+        case UAFilterableResultsChangeMove:
+            break;
+    }
+}
+
+@end
+NS_ASSUME_NONNULL_END
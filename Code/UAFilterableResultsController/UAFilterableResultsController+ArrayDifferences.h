@@ -0,0 +1,66 @@
+//
+//  UAFilterableResultsController+ArrayDifferences.h
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import "UAFilterableResultsControllerClass.h"
+#import "UAFilterableResultsChangeList.h"
+
+NS_ASSUME_NONNULL_BEGIN
+@interface UAFilterableResultsController (ArrayDifferences)
+
+/**
+ * Notifies the delegate of the changes required to turn one data set into another, using the -primaryKeyPath if set.
+ *
+ * Objects are matched through a hash table keyed by their primary key (or by the objects themselves when there is no key path),
+ * and a longest increasing subsequence pass over the matched rows picks out the rows that keep their relative order. Those
+ * are reported as Updates and everything else that survived as a Move, so the delegate receives the smallest set of Insert,
+ * Delete and Move notifications. This is O(n log n) in the worst case and close to linear for typical updates.
+ *
+ * @param   fromArray               The one or two dimensional array as it was before the change.
+ * @param   toArray                 The one or two dimensional array as it is after the change.
+**/
+- (void)notifyForChangesFrom:(NSArray *)fromArray to:(NSArray *)toArray;
+
+/**
+ * Notifies the delegate of the changes required to turn one data set into another, matching objects with the supplied key path.
+ *
+ * @param   fromArray               The one or two dimensional array as it was before the change.
+ * @param   toArray                 The one or two dimensional array as it is after the change.
+ * @param   keyPath                 The key path used to match objects between the two arrays, or nil to use isEqual:.
+**/
+- (void)notifyForChangesFrom:(NSArray *)fromArray to:(NSArray *)toArray usingKeyPath:(nullable NSString *)keyPath;
+
+/**
+ * Notifies the delegate of the changes made to the rows of a single section when it is replaced.
+ *
+ * @param   sectionIndex            The index of the section that was replaced.
+ * @param   fromArray               The rows of the section before it was replaced.
+ * @param   toArray                 The rows of the replacement section.
+**/
+- (void)notifyForChangesForSectionAtIndex:(NSInteger)sectionIndex from:(NSArray *)fromArray to:(NSArray *)toArray;
+
+/**
+ * Works out the changes required to turn one data set into another without notifying anyone. This only looks at the
+ * arrays it is given, so it is safe to call on any thread as long as nobody is changing them.
+ *
+ * @param   fromArray               The one or two dimensional array as it was before the change.
+ * @param   toArray                 The one or two dimensional array as it is after the change.
+ * @param   keyPath                 The key path used to match objects between the two arrays, or nil to use isEqual:.
+ * @returns                         The changes, in the order they should be delivered.
+**/
++ (UAFilterableResultsChangeList *)changesFrom:(NSArray *)fromArray to:(NSArray *)toArray usingKeyPath:(nullable NSString *)keyPath;
+
+/**
+ * Notifies the delegate of each of the supplied changes, in order. A delegate that takes changesets has them recorded
+ * straight from the packed list.
+ *
+ * @param   changes                 The changes to deliver.
+**/
+- (void)notifyChanges:(UAFilterableResultsChangeList *)changes;
+
+@end
+NS_ASSUME_NONNULL_END
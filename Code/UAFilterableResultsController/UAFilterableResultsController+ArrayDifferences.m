@@ -0,0 +1,337 @@
+//
+//  UAFilterableResultsController+ArrayDifferences.m
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import "UAFilterableResultsController+ArrayDifferences.h"
+
+#pragma mark Private Methods
+
+#import "UAFilterableResultsController+Private.h"
+
+
+#pragma mark - Longest Increasing Subsequence
+
+// Marks the members of the longest strictly increasing subsequence of values in inSubsequence (patience sorting, O(n log n))
+static void UAMarkLongestIncreasingSubsequence(const NSUInteger *values, NSUInteger count, BOOL *inSubsequence) {
+    if (count == 0) {
+        return;
+    }
+
+    NSUInteger *tails = malloc(count * sizeof(NSUInteger));
+    NSUInteger *previous = malloc(count * sizeof(NSUInteger));
+    NSUInteger length = 0;
+
+    for (NSUInteger i = 0; i < count; i++) {
+        // find the first pile whose tail is not smaller than this value
+        NSUInteger low = 0, high = length;
+        while (low < high) {
+            NSUInteger middle = low + (high - low) / 2;
+            if (values[tails[middle]] < values[i]) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+
+        previous[i] = (low > 0 ? tails[low - 1] : NSNotFound);
+        tails[low] = i;
+        if (low == length) {
+            length++;
+        }
+    }
+
+    // walk back through the longest pile
+    for (NSUInteger i = tails[length - 1]; i != NSNotFound; i = previous[i]) {
+        inSubsequence[i] = YES;
+    }
+
+    free(tails);
+    free(previous);
+}
+
+
+#pragma mark - Implementation
+NS_ASSUME_NONNULL_BEGIN
+@implementation UAFilterableResultsController (ArrayDifferences)
+
+- (void)notifyForChangesFrom:(NSArray *)fromArray to:(NSArray *)toArray {
+    [self notifyForChangesFrom:fromArray to:toArray usingKeyPath:self.primaryKeyPath];
+}
+
+- (void)notifyForChangesFrom:(NSArray *)fromArray to:(NSArray *)toArray usingKeyPath:(nullable NSString *)keyPath {
+    if (![self areUpdatesEnabled]) {
+        return;
+    }
+
+    UAFilterableResultsMetrics *metrics = self.pendingMetrics;
+    if (metrics != nil) {
+        NSUInteger rows = [self numberOfRowsInArray:fromArray] + [self numberOfRowsInArray:toArray];
+        [metrics recordRowsCompared:rows];
+        if (keyPath != nil) {
+            [metrics recordKeyValueLookups:rows];
+        }
+    }
+
+    [self beginMetricsInterval:UAFilterableResultsMetricsIntervalDiff];
+    UAFilterableResultsChangeList *changes = [[self class] changesFrom:fromArray to:toArray usingKeyPath:keyPath];
+    [self endMetricsInterval:UAFilterableResultsMetricsIntervalDiff];
+
+    [self notifyChanges:changes];
+}
+
+- (void)notifyForChangesForSectionAtIndex:(NSInteger)sectionIndex from:(NSArray *)fromArray to:(NSArray *)toArray {
+    if (![self areUpdatesEnabled]) {
+        return;
+    }
+
+    [self.pendingMetrics recordRowsCompared:(fromArray.count + toArray.count)];
+    [self beginMetricsInterval:UAFilterableResultsMetricsIntervalDiff];
+    UAFilterableResultsChangeList *changes = [[UAFilterableResultsChangeList alloc] initWithFromArray:fromArray toArray:toArray];
+    [[self class] addChangesFromSections:@[ fromArray ]
+                              toSections:@[ toArray ]
+                            usingKeyPath:nil
+                        fromSectionIndex:[self originalSectionIndexForIndex:sectionIndex]
+                          toSectionIndex:sectionIndex
+                               toChanges:changes];
+    [self endMetricsInterval:UAFilterableResultsMetricsIntervalDiff];
+
+    [self notifyChanges:changes];
+}
+
+- (NSUInteger)numberOfRowsInArray:(NSArray *)array {
+    if (![self isArrayTwoDimensional:array]) {
+        return array.count;
+    }
+
+    NSUInteger count = 0;
+    for (NSArray *section in array) {
+        count += section.count;
+    }
+    return count;
+}
+
++ (UAFilterableResultsChangeList *)changesFrom:(NSArray *)fromArray to:(NSArray *)toArray usingKeyPath:(nullable NSString *)keyPath {
+    // we need to make sure they're both 2 dimensional
+    if (!(fromArray.count > 0 && [fromArray.firstObject isKindOfClass:[NSArray class]])) {
+        fromArray = @[ fromArray ];
+    }
+    if (!(toArray.count > 0 && [toArray.firstObject isKindOfClass:[NSArray class]])) {
+        toArray = @[ toArray ];
+    }
+
+    UAFilterableResultsChangeList *changes = [[UAFilterableResultsChangeList alloc] initWithFromArray:fromArray toArray:toArray];
+    [self addChangesFromSections:fromArray
+                      toSections:toArray
+                    usingKeyPath:keyPath
+                fromSectionIndex:0
+                  toSectionIndex:0
+                       toChanges:changes];
+    return changes;
+}
+
+- (void)notifyChanges:(UAFilterableResultsChangeList *)changes {
+    // a changeset takes the rows as they are, so they never need to become index paths
+    UAFilterableResultsChangeset *changeset = self.pendingChangeset;
+    BOOL shouldRecord = (changeset != nil && [self areUpdatesEnabled] && [self tableViewHasLoaded]);
+
+    const UAFilterableResultsChangeEntry *entries = changes.entries;
+    for (NSUInteger i = 0; i < changes.count; i++) {
+        UAFilterableResultsChangeEntry entry = entries[i];
+        if (entry.sectionChange) {
+            [self notifyChangedSectionAtIndex:entry.pair.fromSection forChangeType:entry.type];
+
+        } else if (shouldRecord) {
+            [self.pendingMetrics recordNotification];
+            [changeset recordChange:entry.pair forChangeType:entry.type];
+
+        } else {
+            UAFilterableResultsIndexPair pair = entry.pair;
+            [self notifyChangedObject:entry.object
+                          atIndexPath:(pair.fromRow != NSNotFound ? [NSIndexPath indexPathForRow:pair.fromRow inSection:pair.fromSection] : nil)
+                        forChangeType:entry.type
+                         newIndexPath:(pair.toRow != NSNotFound ? [NSIndexPath indexPathForRow:pair.toRow inSection:pair.toSection] : nil)];
+        }
+    }
+}
+
+#pragma mark - Diff Engine
+
++ (NSArray *)keysForSections:(NSArray *)sections count:(NSUInteger)count usingKeyPath:(NSString *)keyPath {
+    NSMutableArray *keys = [[NSMutableArray alloc] initWithCapacity:count];
+    for (NSUInteger sectionIndex = 0; sectionIndex < count; sectionIndex++) {
+        NSArray *section = sections[sectionIndex];
+        [keys addObject:[section valueForKeyPath:keyPath]];
+    }
+    return keys;
+}
+
++ (void)addChangesFromSections:(NSArray *)fromSections
+                    toSections:(NSArray *)toSections
+                  usingKeyPath:(nullable NSString *)keyPath
+              fromSectionIndex:(NSInteger)fromSectionBase
+                toSectionIndex:(NSInteger)toSectionBase
+                     toChanges:(UAFilterableResultsChangeList *)changes {
+
+    // rows are only matched between sections that exist on both sides, the rest are inserted or deleted as whole sections
+    NSUInteger commonSections = MIN(fromSections.count, toSections.count);
+
+    // refine it down to just the key paths, if an exception is thrown anywhere there we fall back to comparing the objects themselves
+    NSArray *fromKeys = fromSections;
+    NSArray *toKeys = toSections;
+    if (keyPath != nil) {
+        @try {
+            fromKeys = [self keysForSections:fromSections count:commonSections usingKeyPath:keyPath];
+            toKeys = [self keysForSections:toSections count:commonSections usingKeyPath:keyPath];
+
+        } @catch (NSException *exception) {
+            fromKeys = fromSections;
+            toKeys = toSections;
+        }
+    }
+
+    NSUInteger fromCount = 0, toCount = 0;
+    for (NSUInteger sectionIndex = 0; sectionIndex < commonSections; sectionIndex++) {
+        fromCount += [fromSections[sectionIndex] count];
+        toCount += [toSections[sectionIndex] count];
+    }
+
+    NSUInteger *fromSectionOfRow = malloc(MAX(fromCount, 1) * sizeof(NSUInteger));
+    NSUInteger *fromRowOfRow = malloc(MAX(fromCount, 1) * sizeof(NSUInteger));
+    NSUInteger *nextDuplicate = malloc(MAX(fromCount, 1) * sizeof(NSUInteger));
+    BOOL *matched = calloc(MAX(fromCount, 1), sizeof(BOOL));
+    NSUInteger *fromIndexOfRow = malloc(MAX(toCount, 1) * sizeof(NSUInteger));
+    BOOL *stable = calloc(MAX(toCount, 1), sizeof(BOOL));
+    NSUInteger *candidateRows = malloc(MAX(toCount, 1) * sizeof(NSUInteger));
+    NSUInteger *candidateIndexes = malloc(MAX(toCount, 1) * sizeof(NSUInteger));
+    BOOL *candidateStable = calloc(MAX(toCount, 1), sizeof(BOOL));
+
+    // hash every existing row by its key. We walk backwards so the table points at the first occurrence of each key
+    // and duplicates are chained in order through nextDuplicate.
+    NSMapTable *firstIndexForKey = [NSMapTable strongToStrongObjectsMapTable];
+    NSUInteger flatIndex = fromCount;
+    for (NSUInteger sectionIndex = commonSections; sectionIndex > 0; sectionIndex--) {
+        NSArray *sectionKeys = fromKeys[sectionIndex - 1];
+        for (NSUInteger rowIndex = sectionKeys.count; rowIndex > 0; rowIndex--) {
+            flatIndex--;
+            id key = sectionKeys[rowIndex - 1];
+            NSNumber *head = [firstIndexForKey objectForKey:key];
+            nextDuplicate[flatIndex] = (head != nil ? head.unsignedIntegerValue : NSNotFound);
+            fromSectionOfRow[flatIndex] = sectionIndex - 1;
+            fromRowOfRow[flatIndex] = rowIndex - 1;
+            [firstIndexForKey setObject:@(flatIndex) forKey:key];
+        }
+    }
+
+    // match every new row against the first unmatched existing row with the same key
+    flatIndex = 0;
+    for (NSUInteger sectionIndex = 0; sectionIndex < commonSections; sectionIndex++) {
+        for (id key in toKeys[sectionIndex]) {
+            NSNumber *head = [firstIndexForKey objectForKey:key];
+            if (head == nil) {
+                fromIndexOfRow[flatIndex++] = NSNotFound;
+                continue;
+            }
+
+            NSUInteger fromIndex = head.unsignedIntegerValue;
+            matched[fromIndex] = YES;
+            fromIndexOfRow[flatIndex++] = fromIndex;
+
+            if (nextDuplicate[fromIndex] == NSNotFound) {
+                [firstIndexForKey removeObjectForKey:key];
+            } else {
+                [firstIndexForKey setObject:@(nextDuplicate[fromIndex]) forKey:key];
+            }
+        }
+    }
+
+    // the rows that stayed in their section and keep their relative order don't need to move
+    flatIndex = 0;
+    for (NSUInteger sectionIndex = 0; sectionIndex < commonSections; sectionIndex++) {
+        NSUInteger sectionCount = [toSections[sectionIndex] count];
+        NSUInteger candidates = 0;
+        for (NSUInteger i = flatIndex; i < flatIndex + sectionCount; i++) {
+            NSUInteger fromIndex = fromIndexOfRow[i];
+            if (fromIndex != NSNotFound && fromSectionOfRow[fromIndex] == sectionIndex) {
+                candidateRows[candidates] = fromRowOfRow[fromIndex];
+                candidateIndexes[candidates] = i;
+                candidateStable[candidates] = NO;
+                candidates++;
+            }
+        }
+
+        UAMarkLongestIncreasingSubsequence(candidateRows, candidates, candidateStable);
+        for (NSUInteger i = 0; i < candidates; i++) {
+            stable[candidateIndexes[i]] = candidateStable[i];
+        }
+        flatIndex += sectionCount;
+    }
+
+    // notify about everything that has gone
+    for (NSUInteger fromIndex = 0; fromIndex < fromCount; fromIndex++) {
+        if (matched[fromIndex]) {
+            continue;
+        }
+        NSUInteger sectionIndex = fromSectionOfRow[fromIndex];
+        NSUInteger rowIndex = fromRowOfRow[fromIndex];
+        [changes addChangeToObject:[fromSections[sectionIndex] objectAtIndex:rowIndex]
+                       atIndexPair:UAFilterableResultsIndexPairMake((NSInteger)sectionIndex + fromSectionBase, (NSInteger)rowIndex, NSNotFound, NSNotFound)
+                     forChangeType:UAFilterableResultsChangeDelete];
+    }
+    for (NSUInteger sectionIndex = commonSections; sectionIndex < fromSections.count; sectionIndex++) {
+        [changes addChangeForSectionAtIndex:(NSInteger)sectionIndex + fromSectionBase forChangeType:UAFilterableResultsChangeDelete];
+    }
+
+    // now loop over the target array and note anything that isn't in the same place as last time
+    flatIndex = 0;
+    for (NSUInteger sectionIndex = 0; sectionIndex < toSections.count; sectionIndex++) {
+        // does this section exist in the source?
+        if (sectionIndex >= commonSections) {
+            // nope, lets just add the whole thing in
+            [changes addChangeForSectionAtIndex:(NSInteger)sectionIndex + toSectionBase forChangeType:UAFilterableResultsChangeInsert];
+            continue;
+        }
+
+        NSArray *section = toSections[sectionIndex];
+        for (NSUInteger rowIndex = 0; rowIndex < section.count; rowIndex++, flatIndex++) {
+            id obj = section[rowIndex];
+            NSInteger newSection = (NSInteger)sectionIndex + toSectionBase;
+
+            NSUInteger fromIndex = fromIndexOfRow[flatIndex];
+            if (fromIndex == NSNotFound) {
+                [changes addChangeToObject:obj
+                               atIndexPair:UAFilterableResultsIndexPairMake(NSNotFound, NSNotFound, newSection, (NSInteger)rowIndex)
+                             forChangeType:UAFilterableResultsChangeInsert];
+                continue;
+            }
+
+            NSInteger oldSection = (NSInteger)fromSectionOfRow[fromIndex] + fromSectionBase;
+            NSInteger oldRow = (NSInteger)fromRowOfRow[fromIndex];
+            if (stable[flatIndex]) {
+                [changes addChangeToObject:obj
+                               atIndexPair:UAFilterableResultsIndexPairMake(oldSection, oldRow, NSNotFound, NSNotFound)
+                             forChangeType:UAFilterableResultsChangeUpdate];
+            } else {
+                [changes addChangeToObject:obj
+                               atIndexPair:UAFilterableResultsIndexPairMake(oldSection, oldRow, newSection, (NSInteger)rowIndex)
+                             forChangeType:UAFilterableResultsChangeMove];
+            }
+        }
+    }
+
+    free(fromSectionOfRow);
+    free(fromRowOfRow);
+    free(nextDuplicate);
+    free(matched);
+    free(fromIndexOfRow);
+    free(stable);
+    free(candidateRows);
+    free(candidateIndexes);
+    free(candidateStable);
+}
+
+@end
+NS_ASSUME_NONNULL_END
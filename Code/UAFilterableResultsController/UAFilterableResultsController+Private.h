@@ -7,7 +7,38 @@
 //
 
 #import "UAFilterableResultsControllerClass.h"
+#import "UAFilterableResultsController+ArrayDifferences.h"
+#import "UAPrimaryKeyIndex.h"
+#import "UASectionOffsets.h"
+#import "UAFilterBitmap.h"
+#import "UAFilterableResultsChangeset.h"
+#import "UATextSearchFilter.h"
+#import "UATextSearchIndex.h"
+#import "UASectionBuckets.h"
+#import "UAFilterableResultsSnapshot.h"
 NS_ASSUME_NONNULL_BEGIN
+
+// which of the optional delegate methods the current delegate implements
+typedef struct {
+    unsigned int willChangeContent : 1;
+    unsigned int didChangeObject : 1;
+    unsigned int didChangeSection : 1;
+    unsigned int didChangeContent : 1;
+    unsigned int didChangeContentWithChangeset : 1;
+    unsigned int shouldReload : 1;
+    unsigned int titleForHeader : 1;
+    unsigned int titleForFooter : 1;
+    unsigned int viewForSupplementaryElement : 1;
+    unsigned int hasNoDataForLoadingTableView : 1;
+    unsigned int hasNoDataForLoadingCollectionView : 1;
+} UAFilterableResultsDelegateFlags;
+
+typedef struct {
+    unsigned int didFinishBatch : 1;
+    unsigned int willBeginInterval : 1;
+    unsigned int didEndInterval : 1;
+} UAFilterableResultsMetricsDelegateFlags;
+
 @interface UAFilterableResultsController ()
 
 @property (nonatomic, strong,nullable) NSMutableArray *UAData;
@@ -19,12 +50,77 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (nonatomic, strong,nullable ) NSMutableDictionary *indexPathNotificationMapping;
 
+@property (nonatomic, strong, nullable) UAPrimaryKeyIndex *primaryKeyIndex;
+@property (nonatomic, strong, nullable) UAPrimaryKeyIndex *filteredPrimaryKeyIndex;
+@property (nonatomic, strong, nullable) UASectionOffsets *sectionOffsets;
+@property (nonatomic, strong, nullable) UASectionOffsets *filteredSectionOffsets;
+@property (nonatomic, readonly, nullable) UAPrimaryKeyIndex *currentPrimaryKeyIndex;
+@property (nonatomic, readonly, nullable) UAPrimaryKeyIndex *currentFilteredPrimaryKeyIndex;
+
+// YES when the raw data has changed in a way that the filtered data hasn't caught up with
+@property (nonatomic) BOOL filteredDataIsStale;
+
+// YES when a change in the current batch was applied directly to the filtered data
+@property (nonatomic) BOOL changedFilteredDataIncrementally;
+
+// the predicates that produced the current filtered data, nil if we don't know
+@property (nonatomic, strong, nullable) NSArray *filteredDataPredicates;
+
+// a match bitmap over the current data for each applied predicate, emptied whenever the data changes
+@property (nonatomic, strong, nullable) NSMapTable *filterBitmaps;
+
+// what the one dimensional data is known to be in order by, a comparator or a UAKeyPathSorter, and the comparator for it.
+// Changes that leave the data in order keep it, anything else forgets it, so a sorted merge only checks the order once.
+@property (nonatomic, strong, nullable) id dataSortOrder;
+@property (nonatomic, copy, nullable) NSComparator dataSortOrderComparator;
+
+// bumped every time the raw data is changed, so work done against an earlier version can be recognised
+@property (nonatomic) NSUInteger dataGeneration;
+
+// the filters an asynchronous change is working towards, nil once they've been applied
+@property (nonatomic, copy, nullable) NSArray *pendingFilters;
+
+// the changes of the current outermost batch, when the delegate wants them all at once
+@property (nonatomic, strong, nullable) UAFilterableResultsChangeset *pendingChangeset;
+
+// the delegate messages of the thread safe change being made, delivered once it has let go of the write lock
+@property (nonatomic, strong, nullable) NSMutableArray *pendingDelegateMessages;
+
+// worked out once whenever the delegate is set, so we don't ask it on every change or data source call
+@property (nonatomic, readonly) UAFilterableResultsDelegateFlags delegateRespondsTo;
+@property (nonatomic, readonly) UAFilterableResultsMetricsDelegateFlags metricsDelegateRespondsTo;
+
+// what we've measured so far in the current batch, nil unless we're collecting metrics
+@property (nonatomic, strong, nullable) UAFilterableResultsMetrics *pendingMetrics;
+@property (nonatomic, strong, readwrite, nullable) UAFilterableResultsMetrics *lastMetrics;
+
+@property (nonatomic, strong, readwrite, nullable) id<UAFilterableResultsDataProvider> dataProvider;
+
+// a UATextSearchIndex for each set of key paths searched by a UATextSearchFilter, keyed by the key paths
+@property (nonatomic, strong, nullable) NSMutableDictionary *textSearchIndexes;
+
+// the value of each section when grouping by sectionKeyPath, built lazily and only trusted for the data it was built from
+@property (nonatomic, strong, nullable) UASectionBuckets *sectionBuckets;
+@property (nonatomic, readonly, nullable) UASectionBuckets *currentSectionBuckets;
+
+// the snapshots that may still share arrays with the data, told before any of those arrays is changed in place
+@property (nonatomic, strong, nullable) NSHashTable *snapshots;
+
+// the most recent snapshot and the version of the data it was taken of, so asking again before anything changes is free
+@property (nonatomic, weak, nullable) UAFilterableResultsSnapshot *latestSnapshot;
+@property (nonatomic) NSUInteger latestSnapshotGeneration;
+
+// YES until the paged data is changed through us, while the data provider's own primary key lookup can still be trusted
+@property (nonatomic) BOOL canAskDataProviderForPrimaryKeys;
+
 - (BOOL)isArrayTwoDimensional:(NSArray *)array;
 
 - (BOOL)isObject:(id)object equalToObject:(id)object usingKeyPath:(NSString *)keyPath;
 
 - (nullable NSIndexPath *)indexPathOfObject:(id)object inArray:(NSArray *)data;
 - (nullable NSIndexPath *)indexPathOfObjectWithPrimaryKey:(id)key inArray:(NSArray *)data;
+- (nullable UAPrimaryKeyIndex *)primaryKeyIndexForData:(nullable NSArray *)data;
+- (nullable UASectionOffsets *)sectionOffsetsForData:(nullable NSArray *)data;
 
 - (void)notifyBeginChanges;
 - (void)notifyChangedObject:(id)object atIndexPath:(nullable NSIndexPath *)indexPath forChangeType:(UAFilterableResultsChangeType)type newIndexPath:(nullable NSIndexPath *)newIndexPath;
@@ -32,12 +128,72 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)notifyReload;
 - (void)notifyEndChanges;
 - (void)notifyEndChangesButDontReapplyFilters;
-- (void)notifyForChangesFrom:(NSArray *)fromArray to:(NSArray *)toArray;
+- (NSInteger)originalSectionIndexForIndex:(NSInteger)sectionIndex;
 
 - (void)reapplyFilters;
+- (BOOL)objectPassesAppliedFilters:(id)object;
+- (NSUInteger)filteredRowForRow:(NSUInteger)row inSection:(NSUInteger)sectionIndex;
 - (void)applyFilters:(nullable NSArray *)array;
+- (void)invalidateFilterBitmaps;
+- (void)dataDidChange;
+- (NSArray *)predicatesOfFilters:(NSArray *)filters;
+
+- (void)beginMetricsInterval:(UAFilterableResultsMetricsInterval)interval;
+- (void)endMetricsInterval:(UAFilterableResultsMetricsInterval)interval;
+- (void)finishMetrics;
 
 @property (nonatomic,readonly) BOOL isFiltered;
 
 @end
+
+@interface UAFilterableResultsChangeset (Recording)
+
+- (void)recordChangeAtIndexPath:(nullable NSIndexPath *)indexPath forChangeType:(UAFilterableResultsChangeType)type newIndexPath:(nullable NSIndexPath *)newIndexPath;
+- (void)recordChange:(UAFilterableResultsIndexPair)pair forChangeType:(UAFilterableResultsChangeType)type;
+- (void)recordChangeForSectionAtIndex:(NSInteger)sectionIndex forChangeType:(UAFilterableResultsChangeType)type;
+
+@end
+
+@interface UAFilterableResultsSnapshot (Sharing)
+
+- (instancetype)initWithData:(NSArray *)data twoDimensional:(BOOL)twoDimensional;
+
+// called before the controller changes one of its sections, or its list of sections, in place
+- (void)preserveSection:(NSArray *)section;
+- (void)preserveSections;
+
+// called either side of the controller changing a single row in place, delta being 1 for an insertion, -1 for a removal and 0 for a replacement
+- (void)willChangeObjectAtRow:(NSUInteger)row ofSection:(NSArray *)section delta:(NSInteger)delta;
+- (void)didChangeObjectInSection:(NSArray *)section;
+
+@end
+
+@interface UATextSearchFilter (Searching)
+
+// whether the filter has looked up its query in the current state of the index
+- (BOOL)isPreparedWithIndex:(UATextSearchIndex *)index;
+- (void)prepareWithIndex:(UATextSearchIndex *)index;
+
+// preparing in two steps: attaching fixes the predicate and must be done on the delegate queue, the query can then be
+// looked up on any thread as the index is safe to read from anywhere
+- (void)attachToIndex:(UATextSearchIndex *)index;
+- (void)lookUpQueryInIndex:(UATextSearchIndex *)index;
+
+@end
+
+@interface UAFilterableResultsMetrics (Recording)
+
+- (void)beginInterval:(UAFilterableResultsMetricsInterval)interval;
+- (void)endInterval:(UAFilterableResultsMetricsInterval)interval;
+
+// closes off this batch and returns the metrics for the next, with any intervals that are still running carried across
+- (UAFilterableResultsMetrics *)metricsContinuingOpenIntervals;
+
+- (void)recordPredicateEvaluations:(NSUInteger)count;
+- (void)recordKeyValueLookups:(NSUInteger)count;
+- (void)recordNotification;
+- (void)recordRowsCompared:(NSUInteger)count;
+
+@end
+
 NS_ASSUME_NONNULL_END
\ No newline at end of file
@@ -32,7 +32,7 @@
     if (data.count == 0)
     {
         id<UAFilterableResultsControllerDelegate> delegate = self.delegate;
-        if (delegate != nil && [delegate respondsToSelector:@selector(filterableResultsController:hasNoDataForLoadingCollectionView:)]) {
+        if (delegate != nil && self.delegateRespondsTo.hasNoDataForLoadingCollectionView) {
             [delegate filterableResultsController:self hasNoDataForLoadingCollectionView:collectionView];
         }
     }
@@ -55,7 +55,7 @@
 {
     id<UAFilterableResultsControllerDelegate> delegate = self.delegate;
     NSAssert(delegate != nil, @"Filterable Results Controller delegate cannot be nil.");
-    NSAssert([delegate respondsToSelector:@selector(filterableResultsController:viewForSupplementaryElementOfKind:atIndexPath:)],
+    NSAssert(self.delegateRespondsTo.viewForSupplementaryElement,
              @"Your delegate must implement -filterableResultsController:viewForSupplementaryElementOfKind:atIndexPath: if you have a header, footer or other supplementary view with a size greater than CGSizeZero.");
     return [delegate filterableResultsController:self viewForSupplementaryElementOfKind:kind atIndexPath:indexPath];
 }
@@ -33,7 +33,7 @@
     // let the delegate know if we're about to display no rows
     if (data.count == 0) {
         id<UAFilterableResultsControllerDelegate> delegate = self.delegate;
-        if (delegate != nil && [delegate respondsToSelector:@selector(filterableResultsController:hasNoDataForLoadingTableView:)]) {
+        if (delegate != nil && self.delegateRespondsTo.hasNoDataForLoadingTableView) {
             [delegate filterableResultsController:self hasNoDataForLoadingTableView:tableView];
         }
     }
@@ -54,7 +54,7 @@
 
 - (NSString *)tableView:(UITableView *)tableView titleForHeaderInSection:(NSInteger)section {
     id<UAFilterableResultsControllerDelegate> delegate = self.delegate;
-    if (delegate != nil && [delegate respondsToSelector:@selector(filterableResultsController:titleForHeaderInSection:)]) {
+    if (delegate != nil && self.delegateRespondsTo.titleForHeader) {
         return [delegate filterableResultsController:self titleForHeaderInSection:section];
     }
     
@@ -63,7 +63,7 @@
 
 - (NSString *)tableView:(UITableView *)tableView titleForFooterInSection:(NSInteger)section {
     id<UAFilterableResultsControllerDelegate> delegate = self.delegate;
-    if (delegate != nil && [delegate respondsToSelector:@selector(filterableResultsController:titleForFooterInSection:)]) {
+    if (delegate != nil && self.delegateRespondsTo.titleForFooter) {
         return [delegate filterableResultsController:self titleForFooterInSection:section];
     }
     
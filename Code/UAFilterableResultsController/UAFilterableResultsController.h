@@ -7,6 +7,11 @@
 //
 
 #import "UAFilterableResultsControllerClass.h"
+#import "UAFilter.h"
+#import "UAFilterableResultsChangeset.h"
+#import "UATextSearchFilter.h"
+
+#if TARGET_OS_IPHONE
 #import "UAFilterableResultsController+UICollectionViewDataSource.h"
-#import "UAFilterableREsultsController+UITableViewDataSource.h"
-#import "UAFilter.h"
\ No newline at end of file
+#import "UAFilterableResultsController+UITableViewDataSource.h"
+#endif
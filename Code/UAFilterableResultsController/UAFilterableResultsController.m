@@ -7,7 +7,16 @@
 //
 
 #import "UAFilterableResultsControllerClass.h"
-#import "NSArray+UAArrayFlattening.h"
+#import "UAFlattenedArray.h"
+#import "UAFilterableResultsController+ArrayDifferences.h"
+#import "UAPrimaryKeyIndex.h"
+#import "UASectionOffsets.h"
+#import "UAKeyPathSorter.h"
+#import "UAPagedArray.h"
+#import "UAFilteredSection.h"
+#import <objc/runtime.h>
+#import <pthread.h>
+#import <stdatomic.h>
 
 #pragma mark Private Methods
 
@@ -16,9 +25,46 @@
 
 #pragma mark - Implementation
 NS_ASSUME_NONNULL_BEGIN
-@implementation UAFilterableResultsController
+// the controller whose lock the current thread holds, so the calls it makes to itself don't try to take it again
+static pthread_key_t UAFilterableResultsLockHolderKey;
+
+// set on a delegate queue other than the main queue, so we can tell when we're running on it
+static char UAFilterableResultsDelegateQueueKey;
+
+@implementation UAFilterableResultsController {
+    // whether each selector we've been asked about gets forwarded to the delegate, keyed by the SEL itself
+    CFMutableDictionaryRef _forwardedSelectors;
+
+    // guards _forwardedSelectors, UIKit asks us about selectors on whichever thread it likes once we're thread safe
+    pthread_mutex_t _forwardedSelectorsLock;
+
+    // held for writing while a change is made and for reading by lookups, when we're thread safe
+    pthread_rwlock_t _lock;
+
+    // bumped by every setData:completion:, so the background work of an earlier one can tell it has been superseded
+    atomic_ulong _dataRequestGeneration;
+
+    // bumped every time the filters are changed, anything working on an earlier generation gives up
+    atomic_ulong _filterGeneration;
+}
+
++ (void)initialize {
+    if (self == [UAFilterableResultsController class]) {
+        pthread_key_create(&UAFilterableResultsLockHolderKey, NULL);
+    }
+}
 
 // Initialisation
+- (id)init {
+    self = [super init];
+    if (self) {
+        pthread_rwlock_init(&_lock, NULL);
+        pthread_mutex_init(&_forwardedSelectorsLock, NULL);
+        _delegateQueue = dispatch_get_main_queue();
+    }
+    return self;
+}
+
 - (id)initWithPrimaryKeyPath:(nullable NSString *)primaryKeyPath delegate:(nullable id<UAFilterableResultsControllerDelegate>)delegate {
     self = [self init];
     if (self) {
@@ -28,6 +74,10 @@ NS_ASSUME_NONNULL_BEGIN
         self.changeBatches = 0;
         self.UAAppliedFilters = [[NSMutableArray alloc] initWithCapacity:0];
         self.updatesEnabled = YES;
+        self.filtersInParallel = NO;
+        self.parallelFilteringThreshold = 10000;
+        self.sortsInParallel = NO;
+        self.parallelSortingThreshold = 10000;
     }
     return self;
 }
@@ -40,6 +90,10 @@ NS_ASSUME_NONNULL_BEGIN
         self.changeBatches = 0;
         self.UAAppliedFilters = [[NSMutableArray alloc] initWithCapacity:0];
         self.updatesEnabled = YES;
+        self.filtersInParallel = NO;
+        self.parallelFilteringThreshold = 10000;
+        self.sortsInParallel = NO;
+        self.parallelSortingThreshold = 10000;
     }
     return self;
 }
@@ -47,12 +101,20 @@ NS_ASSUME_NONNULL_BEGIN
 #pragma mark - Object Manipulation
 
 - (void)setData:(nullable NSArray *)data {
+    if ([self performChange:^{ [self setData:data]; }]) {
+        return;
+    }
+
     BOOL hasExistingData = (self.UAData != nil);
     BOOL isFiltered = self.isFiltered;
+    self.dataProvider = nil;
+    self.canAskDataProviderForPrimaryKeys = NO;
     
     // nil'ing out the data?
     if (data == nil) {
         self.UAData = nil;
+        self.filteredDataPredicates = nil;
+        [self dataDidChange];
         [self setFilteredData:nil
                 notifications:NO];
 
@@ -64,12 +126,25 @@ NS_ASSUME_NONNULL_BEGIN
         return;
     }
     
+    // when sectioning by a key path the sections we're given are replaced by one for each value
+    if (self.sectionKeyPath != nil) {
+        data = [UASectionBuckets sectionsOfData:data keyPath:self.sectionKeyPath];
+    }
+
+    // in sorted mode everything that comes in is put in order first
+    if (self.sortComparator != nil) {
+        data = [[self class] data:data sortedUsingComparator:self.sortComparator];
+    }
+
     // if its 2D, make it mutable on both levels
     if ([self isArrayTwoDimensional:data]) {
+        [self beginMetricsInterval:UAFilterableResultsMetricsIntervalCopy];
         NSMutableArray *replacementData = [[NSMutableArray alloc] initWithCapacity:data.count];
         for (NSArray *section in data) {
             [replacementData addObject:[[NSMutableArray alloc] initWithArray:section]];
         }
+        [self endMetricsInterval:UAFilterableResultsMetricsIntervalCopy];
+
         if (hasExistingData) {
             [self notifyBeginChanges];
 
@@ -77,9 +152,12 @@ NS_ASSUME_NONNULL_BEGIN
                 [self notifyForChangesFrom:self.UAData to:replacementData];
             }
             self.UAData = replacementData;
+            [self dataDidChange];
+            self.filteredDataIsStale = YES;
             [self notifyEndChanges];
         } else {
             self.UAData = replacementData;
+            [self dataDidChange];
             [self reapplyFiltersWithoutNotifying];
             [self notifyReload];
         }
@@ -88,11 +166,17 @@ NS_ASSUME_NONNULL_BEGIN
 
     // straight array
     } else {
+        [self beginMetricsInterval:UAFilterableResultsMetricsIntervalCopy];
+        NSMutableArray *replacementData = data.mutableCopy;
+        [self endMetricsInterval:UAFilterableResultsMetricsIntervalCopy];
+
         if (hasExistingData) {
             [self notifyBeginChanges];
 
             NSMutableArray *existingData = self.UAData;
-            self.UAData = data.mutableCopy;
+            self.UAData = replacementData;
+            [self dataDidChange];
+            self.filteredDataIsStale = YES;
 
             if (!isFiltered) {
                 [self notifyForChangesFrom:existingData
@@ -100,7 +184,8 @@ NS_ASSUME_NONNULL_BEGIN
             }
             [self notifyEndChanges];
         } else {
-            self.UAData = data.mutableCopy;
+            self.UAData = replacementData;
+            [self dataDidChange];
             [self reapplyFiltersWithoutNotifying];
             [self notifyReload];
         }
@@ -120,20 +205,18 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)setData:(NSArray *)arrayOfObjects
     sortKeyPath:(NSString *)sortKeyPath
     sortOptions:(NSStringCompareOptions)options {
-    __block NSArray *keyPaths = [sortKeyPath componentsSeparatedByString:@","];
+    if (arrayOfObjects == nil) {
+        [self setData:nil];
+        return;
+    }
 
-    [self setData:arrayOfObjects sortComparator:^NSComparisonResult(id obj1, id obj2) {
-        for (NSString *path in keyPaths) {
-            id value1 = [obj1 valueForKeyPath:path];
-            id value2 = [obj2 valueForKeyPath:path];
-            
-            NSComparisonResult result = [value1 compare:value2 options:options];
-            if (result != NSOrderedSame)
-                return result;
-        }
-        
-        return NSOrderedSame;
-    }];
+    // read the sort keys once each rather than on every comparison
+    UAKeyPathSorter *sorter = [UAKeyPathSorter sorterWithSortKeyPath:sortKeyPath options:options];
+    [self setData:[sorter sortedArrayOfObjects:arrayOfObjects concurrently:[self shouldSortInParallel:arrayOfObjects.count]]];
+}
+
+- (BOOL)shouldSortInParallel:(NSUInteger)count {
+    return (self.sortsInParallel && count >= self.parallelSortingThreshold);
 }
 
 - (NSArray *)data {
@@ -187,16 +270,18 @@ NS_ASSUME_NONNULL_BEGIN
 }
 
 - (NSArray *)allObjects {
-    NSArray * retObjects = nil;
-    if ([self isArrayTwoDimensional:self.UAData]) {
-        retObjects = [self.UAData UAFlattenedArray];
-    } else {
-        retObjects = self.UAData;
+    NSArray *data = self.UAData;
+    if (![self isArrayTwoDimensional:data]) {
+        return data;
     }
-    return retObjects;
+    return [[UAFlattenedArray alloc] initWithSections:data offsets:[self sectionOffsetsForData:data]];
 }
 
 - (void)addObject:(id)object {
+    if ([self performChange:^{ [self addObject:object]; }]) {
+        return;
+    }
+
     NSAssert(self.UAData != nil, @"Cannot add object to nil data.");
     NSParameterAssert(object != nil);
     
@@ -204,37 +289,66 @@ NS_ASSUME_NONNULL_BEGIN
 }
 
 - (void)addObject:(id)object inSection:(NSInteger)sectionIndex {
+    if ([self performChange:^{ [self addObject:object inSection:sectionIndex]; }]) {
+        return;
+    }
+
     NSAssert(self.UAData != nil, @"Cannot add object to nil data.");
     NSParameterAssert(object != nil);
     
     [self notifyBeginChanges];
+
+    // when sectioning by a key path the object's value decides its section, and it gets a new one if nothing else has that value
+    UASectionBuckets *buckets = [self sectionBucketsForCurrentData];
+    if (buckets != nil) {
+        NSUInteger bucketIndex = [buckets indexOfSectionForObject:object];
+        if (bucketIndex == NSNotFound) {
+            [self insertSection:@[ object ] atIndex:[buckets insertionIndexOfSectionForObject:object]];
+            [self notifyEndChanges];
+            return;
+        }
+        sectionIndex = (NSInteger)bucketIndex;
+    }
     
-    // add it to the bottom of the last section if we're 2D
+    // add it to the bottom of the last section if we're 2D, or in its place if we're keeping things sorted
     if ([self isArrayTwoDimensional:self.UAData]) {
         NSMutableArray *section = sectionIndex == -1 ? [self.UAData lastObject] : [self.UAData objectAtIndex:(NSUInteger)sectionIndex];
-        [section addObject:object];
+        NSUInteger row = (self.sortComparator != nil ? [self sortedRowForObject:object inSection:section ignoringRow:NSNotFound] : section.count);
+        [self insertObject:object atRow:row ofSection:section];
+        [self trackInsertedObject:object
+                      atIndexPath:[NSIndexPath indexPathForRow:(NSInteger)row
+                                                     inSection:(sectionIndex == -1 ? (NSInteger)self.UAData.count-1 : sectionIndex)]];
+        [self dataDidChange];
 
         if (![self isFiltered]) {
-            NSInteger row = ((NSInteger)section.count-1);
             NSInteger section = (sectionIndex == -1 ? self.UAData.count-1 : sectionIndex);
             
-            NSIndexPath * newIndexP = [NSIndexPath indexPathForRow:row
+            NSIndexPath * newIndexP = [NSIndexPath indexPathForRow:(NSInteger)row
                                                          inSection:section];
             [self notifyChangedObject:object
                           atIndexPath:nil
                         forChangeType:UAFilterableResultsChangeInsert
                          newIndexPath:newIndexP];
+        } else {
+            [self updateFilteredDataForObjectInsertedAtRow:row
+                                                 inSection:(sectionIndex == -1 ? self.UAData.count-1 : (NSUInteger)sectionIndex)];
         }
         
     } else {
-        [self.UAData addObject:object];
+        NSUInteger row = (self.sortComparator != nil ? [self sortedRowForObject:object inSection:self.UAData ignoringRow:NSNotFound] : self.UAData.count);
+        [self insertObject:object atRow:row ofSection:self.UAData];
+        [self trackInsertedObject:object
+                      atIndexPath:[NSIndexPath indexPathForRow:(NSInteger)row inSection:0]];
+        [self dataDidChange];
         
         if (![self isFiltered]) {
-            NSIndexPath * newIndexP = [NSIndexPath indexPathForRow:((NSInteger)self.UAData.count-1)
+            NSIndexPath * newIndexP = [NSIndexPath indexPathForRow:(NSInteger)row
                                                          inSection:0];
             [self notifyChangedObject:object atIndexPath:nil
                         forChangeType:UAFilterableResultsChangeInsert
                          newIndexPath:newIndexP];
+        } else {
+            [self updateFilteredDataForObjectInsertedAtRow:row inSection:0];
         }
     }
     
@@ -243,6 +357,10 @@ NS_ASSUME_NONNULL_BEGIN
 }
 
 - (void)removeObject:(id)object {
+    if ([self performChange:^{ [self removeObject:object]; }]) {
+        return;
+    }
+
     NSAssert(self.UAData != nil, @"Cannot remove object from nil data.");
     NSParameterAssert(object != nil);
 
@@ -254,15 +372,32 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (void)removeObjectAtIndexPath:(NSIndexPath *)indexPath
 {
+    if ([self performChange:^{ [self removeObjectAtIndexPath:indexPath]; }]) {
+        return;
+    }
+
     NSAssert(self.UAData != nil, @"Cannot remove object from nil data.");
     NSParameterAssert(indexPath != nil);
     
     [self notifyBeginChanges];
     
     // find the section and remove the item at that index
-    NSMutableArray *section = ([self isArrayTwoDimensional:self.UAData] ? [self.UAData objectAtIndex:(NSUInteger)indexPath.section] : self.UAData);
+    BOOL isTwoDimensional = [self isArrayTwoDimensional:self.UAData];
+    NSUInteger sectionIndex = (isTwoDimensional ? (NSUInteger)indexPath.section : 0);
+    NSMutableArray *section = (isTwoDimensional ? [self.UAData objectAtIndex:sectionIndex] : self.UAData);
+
+    // a key path section goes with its last object, unless it's the only one left
+    if (section.count == 1 && self.UAData.count > 1 && [self sectionBucketsForCurrentData] != nil) {
+        [self removeSectionAtIndex:sectionIndex];
+        [self notifyEndChanges];
+        return;
+    }
+
     id oldObject = [section objectAtIndex:(NSUInteger)indexPath.row];
-    [section removeObjectAtIndex:(NSUInteger)indexPath.row];
+    NSUInteger oldFilteredRow = [self filteredRowOfObjectAtRow:(NSUInteger)indexPath.row inSection:sectionIndex];
+    [self removeObjectAtRow:(NSUInteger)indexPath.row ofSection:section];
+    [self trackRemovedObject:oldObject atIndexPath:indexPath];
+    [self dataDidChange];
     
     // notify
     if (![self isFiltered]) {
@@ -270,6 +405,12 @@ NS_ASSUME_NONNULL_BEGIN
                       atIndexPath:indexPath
                     forChangeType:UAFilterableResultsChangeDelete
                      newIndexPath:nil];
+    } else {
+        [self updateFilteredDataInSection:sectionIndex
+                             removeObject:oldObject
+                            atFilteredRow:oldFilteredRow
+                             insertObject:nil
+                            atFilteredRow:NSNotFound];
     }
 
     [self notifyEndChanges];
@@ -277,6 +418,10 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (void)removeObjectWithPrimaryKey:(NSString *)primaryKey
 {
+    if ([self performChange:^{ [self removeObjectWithPrimaryKey:primaryKey]; }]) {
+        return;
+    }
+
     NSAssert(self.UAData != nil, @"Cannot remove object from nil data.");
     NSParameterAssert(primaryKey != nil);
     
@@ -288,6 +433,10 @@ NS_ASSUME_NONNULL_BEGIN
 }
 
 - (void)replaceObject:(id)anObject {
+    if ([self performChange:^{ [self replaceObject:anObject]; }]) {
+        return;
+    }
+
     NSAssert(self.UAData != nil, @"Cannot replace object in nil data.");
     NSParameterAssert(anObject != nil);
     
@@ -299,6 +448,10 @@ NS_ASSUME_NONNULL_BEGIN
 }
 
 - (void)replaceObject:(id)oldObject withObject:(id)newObject {
+    if ([self performChange:^{ [self replaceObject:oldObject withObject:newObject]; }]) {
+        return;
+    }
+
     NSAssert(self.UAData != nil, @"Cannot replace object in nil data.");
     NSParameterAssert(oldObject != nil);
     NSParameterAssert(newObject != nil);
@@ -311,33 +464,78 @@ NS_ASSUME_NONNULL_BEGIN
 }
 
 - (void)replaceObjectAtIndexPath:(NSIndexPath *)indexPath withObject:(id)newObject {
+    if ([self performChange:^{ [self replaceObjectAtIndexPath:indexPath withObject:newObject]; }]) {
+        return;
+    }
+
     NSAssert(self.UAData != nil, @"Cannot replace object in nil data.");
     NSParameterAssert(indexPath != nil);
     NSParameterAssert(newObject != nil);
 
     [self notifyBeginChanges];
 
+    // a replacement with a different section value moves to its new section, or if either section comes or goes it's taken
+    // out of its old one and added to its new one
+    UASectionBuckets *buckets = [self sectionBucketsForCurrentData];
+    NSUInteger newSectionIndex = (buckets != nil ? [buckets indexOfSectionForObject:newObject] : (NSUInteger)indexPath.section);
+    if (newSectionIndex != (NSUInteger)indexPath.section) {
+        if (newSectionIndex != NSNotFound && [[self.UAData objectAtIndex:(NSUInteger)indexPath.section] count] > 1) {
+            [self moveObjectAtIndexPath:indexPath toSectionAtIndex:newSectionIndex replacingWithObject:newObject];
+        } else {
+            [self removeObjectAtIndexPath:indexPath];
+            [self addObject:newObject];
+        }
+        [self notifyEndChanges];
+        return;
+    }
+
+    // if we're keeping things sorted the replacement might belong somewhere else
+    if (self.sortComparator != nil && [self moveObjectAtIndexPath:indexPath toSortedRowOfObject:newObject]) {
+        [self notifyEndChanges];
+        return;
+    }
+
     // 2D Arrays
     NSMutableArray *data = self.UAData;
     if ([self isArrayTwoDimensional:data]) {
         NSMutableArray *section = [data objectAtIndex:(NSUInteger)indexPath.section];
-        [section replaceObjectAtIndex:(NSUInteger)indexPath.row withObject:newObject];
+        id oldObject = [section objectAtIndex:(NSUInteger)indexPath.row];
+        NSUInteger oldFilteredRow = [self filteredRowOfObjectAtRow:(NSUInteger)indexPath.row inSection:(NSUInteger)indexPath.section];
+        [self replaceObjectAtRow:(NSUInteger)indexPath.row ofSection:section withObject:newObject];
+        [self trackReplacedObject:oldObject withObject:newObject atIndexPath:indexPath];
+        [self dataDidChange];
         
         if (![self isFiltered]) {
             [self notifyChangedObject:newObject
                           atIndexPath:indexPath
                         forChangeType:UAFilterableResultsChangeUpdate
                          newIndexPath:indexPath];
+        } else {
+            [self updateFilteredDataInSection:(NSUInteger)indexPath.section
+                                 removeObject:oldObject
+                                atFilteredRow:oldFilteredRow
+                                 insertObject:newObject
+                                atFilteredRow:[self filteredRowForRow:(NSUInteger)indexPath.row inSection:(NSUInteger)indexPath.section]];
         }
 
     } else {
-        [data replaceObjectAtIndex:(NSUInteger)indexPath.row withObject:newObject];
+        id oldObject = [data objectAtIndex:(NSUInteger)indexPath.row];
+        NSUInteger oldFilteredRow = [self filteredRowOfObjectAtRow:(NSUInteger)indexPath.row inSection:0];
+        [self replaceObjectAtRow:(NSUInteger)indexPath.row ofSection:data withObject:newObject];
+        [self trackReplacedObject:oldObject withObject:newObject atIndexPath:indexPath];
+        [self dataDidChange];
 
         if (![self isFiltered]) {
             [self notifyChangedObject:newObject
                           atIndexPath:[NSIndexPath indexPathForRow:indexPath.row inSection:0]
                         forChangeType:UAFilterableResultsChangeUpdate
                          newIndexPath:[NSIndexPath indexPathForRow:indexPath.row inSection:0]];
+        } else {
+            [self updateFilteredDataInSection:0
+                                 removeObject:oldObject
+                                atFilteredRow:oldFilteredRow
+                                 insertObject:newObject
+                                atFilteredRow:[self filteredRowForRow:(NSUInteger)indexPath.row inSection:0]];
         }
     }
     
@@ -345,6 +543,10 @@ NS_ASSUME_NONNULL_BEGIN
 }
 
 - (void)replaceObjects:(NSArray *)arrayOfObjects {
+    if ([self performChange:^{ [self replaceObjects:arrayOfObjects]; }]) {
+        return;
+    }
+
     NSParameterAssert(arrayOfObjects != nil);
 
     [self notifyBeginChanges];
@@ -359,7 +561,27 @@ NS_ASSUME_NONNULL_BEGIN
 }
 
 - (void)mergeObjects:(NSArray *)arrayOfObjects sortComparator:(nullable NSComparator)comparator {
-    
+    [self mergeObjects:arrayOfObjects sortComparator:comparator sorter:nil];
+}
+
+- (void)mergeObjects:(NSArray *)arrayOfObjects sortComparator:(nullable NSComparator)comparator sorter:(nullable UAKeyPathSorter *)sorter {
+    if ([self performChange:^{ [self mergeObjects:arrayOfObjects sortComparator:comparator sorter:sorter]; }]) {
+        return;
+    }
+
+
+    // when sectioning by a key path each object has to find its own section
+    if (self.sectionKeyPath != nil && self.UAData != nil && self.dataProvider == nil) {
+        [self mergeObjectsOneAtATime:arrayOfObjects];
+        return;
+    }
+
+    // in sorted mode everything is merged in by our own comparator
+    if (self.sortComparator != nil) {
+        [self mergeObjectsKeepingSortOrder:arrayOfObjects];
+        return;
+    }
+
     if (comparator == nil) { // not sorting
 
         // if the existing data is nil just set it
@@ -367,24 +589,19 @@ NS_ASSUME_NONNULL_BEGIN
             [self setData:arrayOfObjects];
         } else {
             
-            [self notifyBeginChanges];
-
-            for (id object in arrayOfObjects) {
-                
-                if ([self indexPathOfObject:object] != nil) {
-                    [self replaceObject:object];
-                }
-                else {
-                    [self addObject:object];
-                }
-            }
-            [self notifyEndChanges];
+            [self mergeObjectsUsingHashJoin:arrayOfObjects];
         }
 
 
     
-    } else { // more complex if sorting (setData: will handle the notifications)
-        
+    } else { // more complex if sorting
+
+        // if what we have is already in order we can merge the new objects straight into it
+        if ([self mergeObjects:arrayOfObjects intoDataSortedUsingComparator:comparator sortOrder:(sorter ?: comparator)]) {
+            return;
+        }
+
+        // otherwise sort the lot (setData: will handle the notifications)
         NSMutableArray *data = self.UAData ? [self.UAData mutableCopy] : [NSMutableArray array];
         for (id object in arrayOfObjects) {
             NSIndexPath *indexPath = [self indexPathOfObject:object inArray:data];
@@ -395,131 +612,566 @@ NS_ASSUME_NONNULL_BEGIN
                 [data addObject:object];
             }
         }
-        [self setData:[data sortedArrayUsingComparator:comparator]];
+        if (sorter != nil) {
+            [self setData:[sorter sortedArrayOfObjects:data concurrently:[self shouldSortInParallel:data.count]]];
+        } else {
+            [self setData:[data sortedArrayUsingComparator:comparator]];
+        }
+        [self rememberDataSortOrder:(sorter ?: comparator) comparator:comparator];
     }
 }
 
-- (void)mergeObjects:(NSArray *)arrayOfObjects
-         sortKeyPath:(NSString *)sortKeyPath
-         sortOptions:(NSStringCompareOptions)options {
-    
-    __block NSArray *keyPaths = [sortKeyPath componentsSeparatedByString:@","];
+- (void)mergeObjectsUsingHashJoin:(NSArray *)arrayOfObjects {
+    NSMutableArray *data = self.UAData;
+    BOOL isTwoDimensional = [self isArrayTwoDimensional:data];
+    NSArray *sections = (isTwoDimensional ? data : @[ data ]);
+    NSString *keyPath = self.primaryKeyPath;
 
-    [self mergeObjects:arrayOfObjects sortComparator:^NSComparisonResult(id obj1, id obj2) {
-        for (NSString *path in keyPaths) {
-            id value1 = [obj1 valueForKeyPath:path];
-            id value2 = [obj2 valueForKeyPath:path];
-            
-            NSComparisonResult result = [value1 compare:value2 options:options];
-            if (result != NSOrderedSame) {
-                return result;
+    // The existing objects are found through the primary key index, which is kept up to date from one merge to the next, so
+    // only the incoming objects need their keys looked up. Without one we hash every existing object by its primary key (or
+    // itself), the first one wins like -indexPathOfObject:
+    UAPrimaryKeyIndex *index = [self primaryKeyIndexForData:data];
+    NSMapTable *indexPathsByKey = nil;
+    if (index == nil) {
+        indexPathsByKey = [NSMapTable strongToStrongObjectsMapTable];
+        @try {
+            for (NSUInteger sectionIndex = 0; sectionIndex < sections.count; sectionIndex++) {
+                NSArray *section = sections[sectionIndex];
+                for (NSUInteger row = 0; row < section.count; row++) {
+                    id key = (keyPath != nil ? [section[row] valueForKeyPath:keyPath] : section[row]);
+                    if (key != nil && [indexPathsByKey objectForKey:key] == nil) {
+                        [indexPathsByKey setObject:[NSIndexPath indexPathForRow:(NSInteger)row inSection:(NSInteger)sectionIndex] forKey:key];
+                    }
+                }
             }
-        }
-        
-        return NSOrderedSame;
-    }];
-}
 
-- (nullable id)objectAtIndexPath:(NSIndexPath *)indexPath {
-    if (self.UAData == nil) {
-        return nil;
+        } @catch (NSException *exception) {
+            // the objects don't all have the key path, do it the long way
+            [self mergeObjectsOneAtATime:arrayOfObjects];
+            return;
+        }
+        if (keyPath != nil) {
+            [self.pendingMetrics recordKeyValueLookups:self.numberOfObjects];
+        }
+    }
+    if (keyPath != nil) {
+        [self.pendingMetrics recordKeyValueLookups:arrayOfObjects.count];
     }
 
-    NSParameterAssert(indexPath != nil);
+    // split the incoming objects into replacements and insertions. Later objects with the same key replace earlier ones,
+    // whether they're already in the data or only just being added.
+    NSMutableArray *replacedIndexPaths = [[NSMutableArray alloc] init];
+    NSMapTable *replacementsByIndexPath = [NSMapTable strongToStrongObjectsMapTable];
+    NSMutableArray *insertions = [[NSMutableArray alloc] init];
+    NSMapTable *insertionIndexesByKey = [NSMapTable strongToStrongObjectsMapTable];
+    for (id object in arrayOfObjects) {
+        id key = nil;
+        @try {
+            key = (keyPath != nil ? [object valueForKeyPath:keyPath] : object);
+        } @catch (NSException *exception) {
+            key = nil;
+        }
 
-    // 2D Arrays
-    NSArray *data = self.UAData;
-    if ([self isArrayTwoDimensional:data])
-    {
-        NSArray *section = data[indexPath.section];
-        
-        if ((NSUInteger)indexPath.row >= section.count) {
-            return nil;
+        NSIndexPath *indexPath = nil;
+        if (key != nil) {
+            indexPath = (index != nil ? [index indexPathForKey:key] : [indexPathsByKey objectForKey:key]);
+        } else {
+            // nothing to hash on, but it could still be equal to something
+            indexPath = [self indexPathOfObject:object inArray:data usingKeyPath:nil];
         }
-        
-        return section[indexPath.row];
 
-    // Plain array
-    } else if ((NSUInteger)indexPath.row < data.count) {
-        return data[indexPath.row];
+        if (indexPath != nil) {
+            if ([replacementsByIndexPath objectForKey:indexPath] == nil) {
+                [replacedIndexPaths addObject:indexPath];
+            }
+            [replacementsByIndexPath setObject:object forKey:indexPath];
+            continue;
+        }
+
+        NSNumber *insertionIndex = (key != nil ? [insertionIndexesByKey objectForKey:key] : nil);
+        if (insertionIndex != nil) {
+            [insertions replaceObjectAtIndex:insertionIndex.unsignedIntegerValue withObject:object];
+        } else {
+            if (key != nil) {
+                [insertionIndexesByKey setObject:@(insertions.count) forKey:key];
+            }
+            [insertions addObject:object];
+        }
     }
-    
-    return nil;
-}
 
-- (nullable id)filteredObjectAtIndexPath:(NSIndexPath *)indexPath {
-    if (self.filteredData == nil)
-        return [self objectAtIndexPath:indexPath];
+    if (replacedIndexPaths.count == 0 && insertions.count == 0) {
+        return;
+    }
 
-    NSParameterAssert(indexPath != nil);
-    
-    // 2D Arrays
-    NSArray *data = self.filteredData;
-    if ([self isArrayTwoDimensional:data])
-    {
-        if (indexPath.section >= data.count) {
-            return nil;
+    [self notifyBeginChanges];
+
+    // replace everything in place
+    BOOL isFiltered = [self isFiltered];
+    for (NSIndexPath *indexPath in replacedIndexPaths) {
+        NSMutableArray *section = (isTwoDimensional ? data[(NSUInteger)indexPath.section] : data);
+        id oldObject = section[(NSUInteger)indexPath.row];
+        id newObject = [replacementsByIndexPath objectForKey:indexPath];
+        [self replaceObjectAtRow:(NSUInteger)indexPath.row ofSection:section withObject:newObject];
+        [self trackReplacedObject:oldObject withObject:newObject atIndexPath:indexPath];
+
+        if (!isFiltered) {
+            [self notifyChangedObject:newObject
+                          atIndexPath:indexPath
+                        forChangeType:UAFilterableResultsChangeUpdate
+                         newIndexPath:indexPath];
         }
-        NSArray *section = data[indexPath.section];
-        
-        if (indexPath.row >= section.count) {
-            return nil;
+    }
+
+    // and add the new ones to the end of the last section
+    NSMutableArray *lastSection = (isTwoDimensional ? data.lastObject : data);
+    NSInteger lastSectionIndex = (isTwoDimensional ? (NSInteger)data.count - 1 : 0);
+    for (id object in insertions) {
+        [self insertObject:object atRow:lastSection.count ofSection:lastSection];
+        NSIndexPath *indexPath = [NSIndexPath indexPathForRow:(NSInteger)lastSection.count - 1 inSection:lastSectionIndex];
+        [self trackInsertedObject:object atIndexPath:indexPath];
+
+        if (!isFiltered) {
+            [self notifyChangedObject:object
+                          atIndexPath:nil
+                        forChangeType:UAFilterableResultsChangeInsert
+                         newIndexPath:indexPath];
         }
+    }
+    [self dataDidChange];
 
-        return section[indexPath.row];
-        
-    // Plain array
-    } else {
-        return data[indexPath.row];
+    // filters are reapplied once for the lot when the batch ends, or right now if nobody is listening
+    if (isFiltered) {
+        self.filteredDataIsStale = YES;
+        if (![self areUpdatesEnabled] || ![self tableViewHasLoaded]) {
+            [self reapplyFiltersWithoutNotifying];
+        }
     }
+
+    [self notifyEndChanges];
 }
 
-- (nullable id)objectWithPrimaryKey:(id)primaryKey {
-    NSAssert(self.UAData != nil, @"Cannot find object in nil data.");
-    NSAssert(self.primaryKeyPath != nil, @"Cannot find object using nil primary key path.");
-    NSParameterAssert(primaryKey != nil);
-    
-    // 2D Arrays
-    NSArray *data = self.UAData;
-    if ([self isArrayTwoDimensional:data])
-    {
-        for (NSUInteger sectionCounter = 0; sectionCounter < data.count; sectionCounter++) {
-            NSArray *section = data[sectionCounter];
-            for (NSUInteger rowCounter = 0; rowCounter < section.count; rowCounter++) {
-                
-                id obj = section[rowCounter];
-                id value = [obj valueForKeyPath:self.primaryKeyPath];
-                
-                if (value != nil && [primaryKey isEqual:value]) {
-                    return obj;
-                }
+// The sort order is what the comparator came from, the comparator itself or a UAKeyPathSorter, so we can tell if the data
+// is already known to be in that order.
+- (BOOL)mergeObjects:(NSArray *)arrayOfObjects intoDataSortedUsingComparator:(NSComparator)comparator sortOrder:(id)sortOrder {
+    NSMutableArray *data = self.UAData;
+    NSUInteger count = data.count;
+    if (count == 0 || [self isArrayTwoDimensional:data]) {
+        return NO;
+    }
+
+    // a key path sorter reads the keys of each object once, rather than twice for every comparison it's in
+    UAKeyPathSorter *sorter = ([sortOrder isKindOfClass:[UAKeyPathSorter class]] ? sortOrder : nil);
+    UAKeyPathSortKeys *sortKeys = [sorter sortKeysOfObjects:data];
+
+    // one pass to make sure the existing data really is in order, unless nothing has put it out of order since we last did
+    if (![self isDataSortedBySortOrder:sortOrder]) {
+        for (NSUInteger row = 1; row < count; row++) {
+            NSComparisonResult result = (sortKeys != nil ? [sortKeys compareRow:row - 1 toRow:row ofKeys:sortKeys] : comparator(data[row - 1], data[row]));
+            if (result == NSOrderedDescending) {
+                return NO;
             }
         }
-        
-        // Plain array
-    } else {
-        
-        for (NSUInteger rowCounter = 0; rowCounter < data.count; rowCounter++) {
-            id obj = data[rowCounter];
-            id value = [obj valueForKeyPath:self.primaryKeyPath];
-            if (value != nil && [primaryKey isEqual:value]) {
-                return obj;
+    }
+
+    // the primary key index already knows where every key is, otherwise hash the existing rows by primary key (or themselves),
+    // the first one wins like -indexPathOfObject:
+    NSString *keyPath = self.primaryKeyPath;
+    UAPrimaryKeyIndex *index = [self primaryKeyIndexForData:data];
+    NSMapTable *rowsByKey = nil;
+    if (index == nil) {
+        rowsByKey = [NSMapTable strongToStrongObjectsMapTable];
+        @try {
+            for (NSUInteger row = 0; row < count; row++) {
+                id key = (keyPath != nil ? [data[row] valueForKeyPath:keyPath] : data[row]);
+                if (key != nil && [rowsByKey objectForKey:key] == nil) {
+                    [rowsByKey setObject:@(row) forKey:key];
+                }
             }
+
+        } @catch (NSException *exception) {
+            return NO;
+        }
+        if (keyPath != nil) {
+            [self.pendingMetrics recordKeyValueLookups:count];
         }
     }
-    
-    // not found
-    return nil;
-}
+    if (keyPath != nil) {
+        [self.pendingMetrics recordKeyValueLookups:arrayOfObjects.count];
+    }
 
-- (nullable NSIndexPath *)indexPathOfObject:(id)object {
-    return [self indexPathOfObject:object inArray:self.UAData];
-}
+    // split the incoming objects into replacements and insertions, later objects with the same key win
+    NSMutableArray *incoming = [[NSMutableArray alloc] init];
+    NSMutableArray *incomingKeys = [[NSMutableArray alloc] init];
+    NSMutableArray *incomingRows = [[NSMutableArray alloc] init];
+    NSMapTable *incomingIndexesByKey = [NSMapTable strongToStrongObjectsMapTable];
+    NSMutableDictionary *incomingIndexesByRow = [[NSMutableDictionary alloc] init];
+    for (id object in arrayOfObjects) {
+        id key = nil;
+        @try {
+            key = (keyPath != nil ? [object valueForKeyPath:keyPath] : object);
+        } @catch (NSException *exception) {
+            key = nil;
+        }
+
+        NSNumber *row = nil;
+        if (key != nil && index != nil) {
+            NSIndexPath *indexPath = [index indexPathForKey:key];
+            row = (indexPath != nil ? @(indexPath.row) : nil);
+        } else if (key != nil) {
+            row = [rowsByKey objectForKey:key];
+        } else {
+            // nothing to hash on, but it could still be equal to something
+            NSIndexPath *indexPath = [self indexPathOfObject:object inArray:data usingKeyPath:nil];
+            row = (indexPath != nil ? @(indexPath.row) : nil);
+        }
+
+        NSNumber *incomingIndex = (row != nil ? incomingIndexesByRow[row] : (key != nil ? [incomingIndexesByKey objectForKey:key] : nil));
+        if (incomingIndex != nil) {
+            [incoming replaceObjectAtIndex:incomingIndex.unsignedIntegerValue withObject:object];
+            continue;
+        }
+
+        incomingIndex = @(incoming.count);
+        if (row != nil) {
+            incomingIndexesByRow[row] = incomingIndex;
+        } else if (key != nil) {
+            [incomingIndexesByKey setObject:incomingIndex forKey:key];
+        }
+        [incoming addObject:object];
+        [incomingKeys addObject:(key ?: [NSNull null])];
+        [incomingRows addObject:(row ?: [NSNull null])];
+    }
+
+    NSUInteger incomingCount = incoming.count;
+    if (incomingCount == 0) {
+        return YES;
+    }
+
+    // where everything came from: replacements keep their old row, insertions go after everything in the order they arrived,
+    // which makes the merge below come out exactly like a stable sort of the replaced data with the insertions on the end
+    NSUInteger *origins = malloc(incomingCount * sizeof(NSUInteger));
+    BOOL *replaced = calloc(count, sizeof(BOOL));
+    for (NSUInteger i = 0; i < incomingCount; i++) {
+        id row = incomingRows[i];
+        if (row != [NSNull null]) {
+            origins[i] = [row unsignedIntegerValue];
+            replaced[origins[i]] = YES;
+        } else {
+            origins[i] = count + i;
+        }
+    }
+
+    // only the new batch needs sorting
+    UAKeyPathSortKeys *incomingSortKeys = [sorter sortKeysOfObjects:incoming];
+    NSMutableArray *order = [[NSMutableArray alloc] initWithCapacity:incomingCount];
+    for (NSUInteger i = 0; i < incomingCount; i++) {
+        [order addObject:@(i)];
+    }
+    [order sortUsingComparator:^NSComparisonResult(NSNumber *index1, NSNumber *index2) {
+        NSUInteger i1 = index1.unsignedIntegerValue, i2 = index2.unsignedIntegerValue;
+        NSComparisonResult result = (incomingSortKeys != nil ? [incomingSortKeys compareRow:i1 toRow:i2 ofKeys:incomingSortKeys] : comparator(incoming[i1], incoming[i2]));
+        if (result != NSOrderedSame) {
+            return result;
+        }
+        return (origins[i1] < origins[i2] ? NSOrderedAscending : NSOrderedDescending);
+    }];
+
+    // the number of rows that stay put before each replaced row
+    NSUInteger *survivorsBefore = malloc(count * sizeof(NSUInteger));
+    NSUInteger survivors = 0;
+    for (NSUInteger row = 0; row < count; row++) {
+        survivorsBefore[row] = survivors;
+        if (!replaced[row]) {
+            survivors++;
+        }
+    }
+
+    // and now a two way merge of the rows that stay put with the sorted batch
+    NSMutableArray *merged = [[NSMutableArray alloc] initWithCapacity:count + incomingCount];
+    NSMutableArray *mergedKeys = (index != nil ? [[NSMutableArray alloc] initWithCapacity:count + incomingCount] : nil);
+    UAFilterableResultsChangeList *changes = [[UAFilterableResultsChangeList alloc] initWithFromArray:data toArray:merged];
+    NSUInteger row = 0, next = 0, survivorsMerged = 0, lastStableRow = NSNotFound;
+    while (row < count || next < incomingCount) {
+        if (row < count && replaced[row]) {
+            row++;
+            continue;
+        }
+
+        NSUInteger i = (next < incomingCount ? [order[next] unsignedIntegerValue] : NSNotFound);
+        BOOL takeExisting = NO;
+        if (row < count && i == NSNotFound) {
+            takeExisting = YES;
+        } else if (row < count) {
+            NSComparisonResult result = (sortKeys != nil ? [sortKeys compareRow:row toRow:i ofKeys:incomingSortKeys] : comparator(data[row], incoming[i]));
+            takeExisting = (result == NSOrderedAscending || (result == NSOrderedSame && row < origins[i]));
+        }
+
+        if (takeExisting) {
+            [merged addObject:data[row]];
+            [mergedKeys addObject:([index indexedKeyAtRow:row inSection:0] ?: [NSNull null])];
+            row++;
+            survivorsMerged++;
+            lastStableRow = NSNotFound;
+            continue;
+        }
+
+        id object = incoming[i];
+        NSInteger newRow = (NSInteger)merged.count;
+        [merged addObject:object];
+        [mergedKeys addObject:incomingKeys[i]];
+        next++;
+
+        if (origins[i] >= count) {
+            [changes addChangeToObject:object
+                           atIndexPair:UAFilterableResultsIndexPairMake(NSNotFound, NSNotFound, 0, newRow)
+                         forChangeType:UAFilterableResultsChangeInsert];
+            continue;
+        }
+
+        // a replacement that still sits between the same neighbours, in the same order as any others there, is just an update
+        NSUInteger oldRow = origins[i];
+        if (survivorsBefore[oldRow] == survivorsMerged && (lastStableRow == NSNotFound || oldRow > lastStableRow)) {
+            lastStableRow = oldRow;
+            [changes addChangeToObject:object
+                           atIndexPair:UAFilterableResultsIndexPairMake(0, (NSInteger)oldRow, 0, (NSInteger)oldRow)
+                         forChangeType:UAFilterableResultsChangeUpdate];
+        } else {
+            [changes addChangeToObject:object
+                           atIndexPair:UAFilterableResultsIndexPairMake(0, (NSInteger)oldRow, 0, newRow)
+                         forChangeType:UAFilterableResultsChangeMove];
+        }
+    }
+
+    free(origins);
+    free(replaced);
+    free(survivorsBefore);
+
+    [self notifyBeginChanges];
+
+    BOOL isFiltered = [self isFiltered];
+    self.UAData = merged;
+    [self rememberDataSortOrder:sortOrder comparator:comparator];
+
+    // every key was already known, so the merged data can be indexed without asking the objects again
+    if (index != nil) {
+        self.primaryKeyIndex = [[UAPrimaryKeyIndex alloc] initWithData:merged keys:mergedKeys keyPath:keyPath];
+    }
+    [self dataDidChange];
+
+    if (!isFiltered) {
+        [self notifyChanges:changes];
+
+    // filters are reapplied once for the lot when the batch ends, or right now if nobody is listening
+    } else {
+        self.filteredDataIsStale = YES;
+        if (![self areUpdatesEnabled] || ![self tableViewHasLoaded]) {
+            [self reapplyFiltersWithoutNotifying];
+        }
+    }
+
+    [self notifyEndChanges];
+    return YES;
+}
+
+- (BOOL)isDataSortedBySortOrder:(id)sortOrder {
+    return self.dataSortOrder != nil && [self.dataSortOrder isEqual:sortOrder];
+}
+
+- (void)rememberDataSortOrder:(id)sortOrder comparator:(NSComparator)comparator {
+    self.dataSortOrder = sortOrder;
+    self.dataSortOrderComparator = comparator;
+}
+
+// An inserted or replaced row only has to be checked against its neighbours to know the data is still in order.
+- (void)updateDataSortOrderAroundIndexPath:(NSIndexPath *)indexPath {
+    if (self.dataSortOrder == nil) {
+        return;
+    }
+
+    NSArray *data = self.UAData;
+    NSUInteger row = (NSUInteger)indexPath.row;
+    NSComparator comparator = self.dataSortOrderComparator;
+    if ([self isArrayTwoDimensional:data] ||
+        (row > 0 && comparator(data[row - 1], data[row]) == NSOrderedDescending) ||
+        (row + 1 < data.count && comparator(data[row], data[row + 1]) == NSOrderedDescending)) {
+        self.dataSortOrder = nil;
+    }
+}
+
+- (void)mergeObjectsOneAtATime:(NSArray *)arrayOfObjects {
+    [self notifyBeginChanges];
+
+    for (id object in arrayOfObjects) {
+        
+        if ([self indexPathOfObject:object] != nil) {
+            [self replaceObject:object];
+        }
+        else {
+            [self addObject:object];
+        }
+    }
+    [self notifyEndChanges];
+}
+
+- (void)mergeObjects:(NSArray *)arrayOfObjects
+         sortKeyPath:(NSString *)sortKeyPath
+         sortOptions:(NSStringCompareOptions)options {
+    UAKeyPathSorter *sorter = [UAKeyPathSorter sorterWithSortKeyPath:sortKeyPath options:options];
+    [self mergeObjects:arrayOfObjects sortComparator:sorter.comparator sorter:sorter];
+}
+
+- (nullable id)objectAtIndexPath:(NSIndexPath *)indexPath {
+    __block id object = nil;
+    if ([self performLookup:^{ object = [self objectAtIndexPath:indexPath]; } exclusively:NO]) {
+        return object;
+    }
+
+    if (self.UAData == nil) {
+        return nil;
+    }
+
+    NSParameterAssert(indexPath != nil);
+
+    // 2D Arrays
+    NSArray *data = self.UAData;
+    if ([self isArrayTwoDimensional:data])
+    {
+        NSArray *section = data[indexPath.section];
+        
+        if ((NSUInteger)indexPath.row >= section.count) {
+            return nil;
+        }
+        
+        return section[indexPath.row];
+
+    // Plain array
+    } else if ((NSUInteger)indexPath.row < data.count) {
+        return data[indexPath.row];
+    }
+    
+    return nil;
+}
+
+- (nullable id)filteredObjectAtIndexPath:(NSIndexPath *)indexPath {
+    __block id object = nil;
+    if ([self performLookup:^{ object = [self filteredObjectAtIndexPath:indexPath]; } exclusively:NO]) {
+        return object;
+    }
+
+    if (self.filteredData == nil)
+        return [self objectAtIndexPath:indexPath];
+
+    NSParameterAssert(indexPath != nil);
+    
+    // 2D Arrays
+    NSArray *data = self.filteredData;
+    if ([self isArrayTwoDimensional:data])
+    {
+        if (indexPath.section >= data.count) {
+            return nil;
+        }
+        NSArray *section = data[indexPath.section];
+        
+        if (indexPath.row >= section.count) {
+            return nil;
+        }
+
+        return section[indexPath.row];
+        
+    // Plain array
+    } else {
+        return data[indexPath.row];
+    }
+}
+
+- (nullable id)objectWithPrimaryKey:(id)primaryKey {
+    __block id object = nil;
+    if ([self performLookup:^{ object = [self objectWithPrimaryKey:primaryKey]; } exclusively:NO]) {
+        return object;
+    }
+
+    NSAssert(self.UAData != nil, @"Cannot find object in nil data.");
+    NSAssert(self.primaryKeyPath != nil, @"Cannot find object using nil primary key path.");
+    NSParameterAssert(primaryKey != nil);
+    
+    // use the index if we can
+    UAPrimaryKeyIndex *index = [self primaryKeyIndexForData:self.UAData];
+    if (index != nil) {
+        NSIndexPath *indexPath = [index indexPathForKey:primaryKey];
+        return indexPath != nil ? [self objectAtIndexPath:indexPath] : nil;
+    }
+
+    // or the data provider, rather than going through every page
+    if (self.canAskDataProviderForPrimaryKeys) {
+        NSIndexPath *indexPath = [self.dataProvider indexPathOfObjectWithPrimaryKey:primaryKey];
+        return indexPath != nil ? [self objectAtIndexPath:indexPath] : nil;
+    }
+
+    // 2D Arrays
+    NSArray *data = self.UAData;
+    if ([self isArrayTwoDimensional:data])
+    {
+        for (NSUInteger sectionCounter = 0; sectionCounter < data.count; sectionCounter++) {
+            NSArray *section = data[sectionCounter];
+            for (NSUInteger rowCounter = 0; rowCounter < section.count; rowCounter++) {
+                
+                id obj = section[rowCounter];
+                id value = [obj valueForKeyPath:self.primaryKeyPath];
+                
+                if (value != nil && [primaryKey isEqual:value]) {
+                    return obj;
+                }
+            }
+        }
+        
+        // Plain array
+    } else {
+        
+        for (NSUInteger rowCounter = 0; rowCounter < data.count; rowCounter++) {
+            id obj = data[rowCounter];
+            id value = [obj valueForKeyPath:self.primaryKeyPath];
+            if (value != nil && [primaryKey isEqual:value]) {
+                return obj;
+            }
+        }
+    }
+    
+    // not found
+    return nil;
+}
+
+- (nullable NSIndexPath *)indexPathOfObject:(id)object {
+    __block NSIndexPath *indexPath = nil;
+    if ([self performLookup:^{ indexPath = [self indexPathOfObject:object]; } exclusively:NO]) {
+        return indexPath;
+    }
+
+    return [self indexPathOfObject:object inArray:self.UAData];
+}
 
 - (nullable NSIndexPath *)filteredIndexPathOfObject:(id)object {
+    __block NSIndexPath *indexPath = nil;
+    if ([self performLookup:^{ indexPath = [self filteredIndexPathOfObject:object]; } exclusively:YES]) {
+        return indexPath;
+    }
+
+    if ([self canFindFilteredObjectsInData]) {
+        NSIndexPath *indexPath = [self indexPathOfObject:object];
+        return (indexPath != nil ? [self filteredIndexPathForIndexPath:indexPath] : nil);
+    }
     return [self indexPathOfObject:object inArray:(self.filteredData ?: self.UAData)];
 }
 
+// When the filtered data maps the raw data and we have a primary key index over it, the index finds the object and its row
+// is mapped across, so the filtered data never needs an index of its own.
+- (BOOL)canFindFilteredObjectsInData {
+    if (![self isFiltered] || [self primaryKeyIndexForData:self.UAData] == nil) {
+        return NO;
+    }
+    NSArray *filteredData = self.filteredData;
+    return ([filteredData isKindOfClass:[UAFilteredSection class]] || ([self isArrayTwoDimensional:self.UAData] && filteredData.count == self.UAData.count));
+}
+
 - (nullable NSIndexPath *)indexPathOfObject:(id)object inArray:(NSArray *)data {
     return [self indexPathOfObject:object inArray:data usingKeyPath:self.primaryKeyPath];
 }
@@ -532,6 +1184,22 @@ NS_ASSUME_NONNULL_BEGIN
     NSAssert(data != nil, @"Cannot find index path of object in nil data.");
     NSParameterAssert(object != nil);
 
+    // matching by primary key? the index can find it for us
+    UAPrimaryKeyIndex *index = (keyPath != nil && [keyPath isEqualToString:self.primaryKeyPath] ? [self primaryKeyIndexForData:data] : nil);
+    if (index != nil) {
+        id key = [index keyForObject:object];
+        if (key != nil && index.isUsable) {
+            NSIndexPath *indexPath = [index indexPathForKey:key];
+            if (indexPath == nil) {
+                return nil;
+            }
+            NSArray *section = ([self isArrayTwoDimensional:data] ? data[(NSUInteger)indexPath.section] : data);
+            if ([self isObject:section[(NSUInteger)indexPath.row] equalToObject:object usingKeyPath:keyPath]) {
+                return indexPath;
+            }
+        }
+    }
+
     // 2D Arrays
     if ([self isArrayTwoDimensional:data]) {
         for (NSUInteger sectionCounter = 0; sectionCounter < data.count; sectionCounter++) {
@@ -560,21 +1228,25 @@ NS_ASSUME_NONNULL_BEGIN
     return nil;
 }
 
-- (NSUInteger)indexOfObject:(id)object inArray:(NSArray *)data usingKeyPath:(nullable NSString *)keyPath {
-    for (NSUInteger rowCounter = 0; rowCounter < data.count; rowCounter++) {
-        id obj = data[rowCounter];
-        if ([self isObject:obj equalToObject:object usingKeyPath:keyPath]) {
-            return rowCounter;
-        }
+- (nullable NSIndexPath *)indexPathOfObjectWithPrimaryKey:(id)key {
+    __block NSIndexPath *indexPath = nil;
+    if ([self performLookup:^{ indexPath = [self indexPathOfObjectWithPrimaryKey:key]; } exclusively:NO]) {
+        return indexPath;
     }
-    return NSNotFound;
-}
 
-- (nullable NSIndexPath *)indexPathOfObjectWithPrimaryKey:(id)key {
     return [self indexPathOfObjectWithPrimaryKey:key inArray:self.UAData];
 }
 
 - (nullable NSIndexPath *)filteredIndexPathOfObjectWithPrimaryKey:(id)key {
+    __block NSIndexPath *indexPath = nil;
+    if ([self performLookup:^{ indexPath = [self filteredIndexPathOfObjectWithPrimaryKey:key]; } exclusively:YES]) {
+        return indexPath;
+    }
+
+    if ([self canFindFilteredObjectsInData]) {
+        NSIndexPath *indexPath = [self indexPathOfObjectWithPrimaryKey:key];
+        return (indexPath != nil ? [self filteredIndexPathForIndexPath:indexPath] : nil);
+    }
     return [self indexPathOfObjectWithPrimaryKey:key inArray:(self.filteredData ?: self.UAData)];
 }
 
@@ -594,6 +1266,15 @@ NS_ASSUME_NONNULL_BEGIN
     
     NSAssert(self.primaryKeyPath != nil, @"Cannot find object using nil primary key path.");
     NSParameterAssert(key != nil);
+
+    // use the index if we can
+    UAPrimaryKeyIndex *index = [self primaryKeyIndexForData:data];
+    if (index != nil) {
+        return [index indexPathForKey:key];
+    }
+    if (data == self.UAData && self.canAskDataProviderForPrimaryKeys) {
+        return [self.dataProvider indexPathOfObjectWithPrimaryKey:key];
+    }
     
     @try {
     
@@ -630,291 +1311,2182 @@ NS_ASSUME_NONNULL_BEGIN
 }
 
 - (NSUInteger)numberOfObjects {
-    NSArray *data = self.UAData;
-    if (data == nil || data.count == 0) {
-        return 0;
+    __block NSUInteger count = 0;
+    if ([self performLookup:^{ count = [self numberOfObjects]; } exclusively:NO]) {
+        return count;
     }
 
-    // not 2D?
-    if (![self isArrayTwoDimensional:data]) {
-        return data.count;
+    return [self sectionOffsetsForData:self.UAData].count;
+}
+
+- (NSUInteger)numberOfFilteredObjects {
+    __block NSUInteger count = 0;
+    if ([self performLookup:^{ count = [self numberOfFilteredObjects]; } exclusively:YES]) {
+        return count;
     }
 
-    // definitely 2D. Add them up.
-    NSUInteger count = 0;
-    for (NSArray *section in data) {
-        count += section.count;
+    if (self.filteredData == nil) {
+        return [self numberOfObjects];
     }
-    
-    return count;
+    return [self sectionOffsetsForData:self.filteredData].count;
 }
 
-#pragma mark - Object Comparison
-
-- (BOOL)isObject:(id)anObject equalToObject:(id)anotherObject usingKeyPath:(NSString *)keyPath {
-    // hack for ids and hashes
-    if ([anObject isEqual:anotherObject]) {
-        return YES;
+- (nullable NSIndexPath *)indexPathOfObjectAtOffset:(NSUInteger)offset {
+    __block NSIndexPath *indexPath = nil;
+    if ([self performLookup:^{ indexPath = [self indexPathOfObjectAtOffset:offset]; } exclusively:NO]) {
+        return indexPath;
     }
 
-    // are they the same class?
-    if (![anObject isKindOfClass:[anotherObject class]]) {
-        return NO;
-    }
+    return [[self sectionOffsetsForData:self.UAData] indexPathForOffset:offset];
+}
 
-    // no key path supplied? Can't continue further checking.
-    if (keyPath == nil) {
-        // check directly (we already know they're the same class)
-        if ([anObject isKindOfClass:[NSString class]]) {
-            return [((NSString *)anObject) isEqualToString:anotherObject];
-        }
-        return NO;
+- (nullable NSIndexPath *)filteredIndexPathOfObjectAtOffset:(NSUInteger)offset {
+    __block NSIndexPath *indexPath = nil;
+    if ([self performLookup:^{ indexPath = [self filteredIndexPathOfObjectAtOffset:offset]; } exclusively:YES]) {
+        return indexPath;
     }
-    
-    // otherwise, get the values at the specified keypath for both and compare those
-    @try {
-        id aValue = [anObject valueForKeyPath:keyPath];
-        id anotherValue = [anotherObject valueForKeyPath:keyPath];
-        if ([aValue isEqual:anotherValue]) {
-            return YES;
-        }
-        
-        // otherwise no
-        return NO;
-    } @catch (NSException *) {
-        // the keypath wasnt found on at least one of the objects, so definitely not.
-        return NO;
+
+    if (self.filteredData == nil) {
+        return [self indexPathOfObjectAtOffset:offset];
     }
+    return [[self sectionOffsetsForData:self.filteredData] indexPathForOffset:offset];
 }
 
-- (BOOL)isArrayTwoDimensional:(NSArray *)array {
-    if (array == nil || array.count == 0) {
-        return NO;
+- (NSUInteger)offsetOfObjectAtIndexPath:(NSIndexPath *)indexPath {
+    __block NSUInteger offset = NSNotFound;
+    if ([self performLookup:^{ offset = [self offsetOfObjectAtIndexPath:indexPath]; } exclusively:NO]) {
+        return offset;
     }
-    
+
+    NSParameterAssert(indexPath != nil);
+
+    UASectionOffsets *offsets = [self sectionOffsetsForData:self.UAData];
+    return (offsets != nil ? [offsets offsetOfIndexPath:indexPath] : NSNotFound);
+}
+
+- (NSUInteger)filteredOffsetOfObjectAtIndexPath:(NSIndexPath *)indexPath {
+    __block NSUInteger offset = NSNotFound;
+    if ([self performLookup:^{ offset = [self filteredOffsetOfObjectAtIndexPath:indexPath]; } exclusively:YES]) {
+        return offset;
+    }
+
+    NSParameterAssert(indexPath != nil);
+
+    if (self.filteredData == nil) {
+        return [self offsetOfObjectAtIndexPath:indexPath];
+    }
+    UASectionOffsets *offsets = [self sectionOffsetsForData:self.filteredData];
+    return (offsets != nil ? [offsets offsetOfIndexPath:indexPath] : NSNotFound);
+}
+
+#pragma mark - Asynchronous Data
+
+- (void)setData:(nullable NSArray *)data completion:(nullable void (^)(BOOL finished))completion {
+    NSAssert([self isOnDelegateQueue], @"setData:completion: must be called on the delegate queue.");
+
+    // anything still in flight is now out of date
+    unsigned long request = atomic_fetch_add(&_dataRequestGeneration, 1) + 1;
+
+    // nil'ing out the data is cheap enough to do here
+    if (data == nil) {
+        [self setData:nil];
+        if (completion != nil) {
+            completion(YES);
+        }
+        return;
+    }
+
+    // Take everything the background work needs. The existing data is an O(1) snapshot, and what's on screen is worked out
+    // from it in the background rather than copied here. Filtered data that is already out of date can't be worked out that
+    // way, so we don't diff against it.
+    BOOL hadData = (self.UAData != nil);
+    BOOL shouldFilter = (self.UAAppliedFilters.count > 0);
+    BOOL canDiff = (hadData && !(self.isFiltered && self.filteredDataIsStale));
+    UAFilterableResultsSnapshot *oldSnapshot = (canDiff ? [self snapshot] : nil);
+    BOOL wasFiltered = self.isFiltered;
+    NSArray *newData = [self snapshotOfData:data];
+    NSUInteger dataGeneration = self.dataGeneration;
+    NSArray *predicates = [self predicatesOfFilters:self.UAAppliedFilters];
+    NSString *keyPath = self.primaryKeyPath;
+    NSUInteger parallelThreshold = (self.filtersInParallel ? self.parallelFilteringThreshold : NSUIntegerMax);
+    NSComparator sortComparator = self.sortComparator;
+    NSString *sectionKeyPath = self.sectionKeyPath;
+    atomic_ulong *requestGeneration = &_dataRequestGeneration;
+
+    void (^finish)(BOOL) = ^(BOOL finished) {
+        if (completion != nil) {
+            completion(finished);
+        }
+    };
+
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        NSMutableArray *replacementData = nil;
+        NSMutableArray *filteredData = nil;
+        NSMapTable *filterBitmaps = [NSMapTable mapTableWithKeyOptions:(NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality)
+                                                          valueOptions:NSPointerFunctionsStrongMemory];
+        UAFilterableResultsChangeList *changes = nil;
+
+        // we check in between each step in case we've been superseded
+        if (atomic_load(requestGeneration) == request) {
+            NSArray *sections = (sectionKeyPath != nil ? [UASectionBuckets sectionsOfData:newData keyPath:sectionKeyPath] : newData);
+            replacementData = [self mutableDataWithData:(sortComparator != nil ? [UAFilterableResultsController data:sections sortedUsingComparator:sortComparator] : sections)];
+        }
+        if (atomic_load(requestGeneration) == request && shouldFilter) {
+            filteredData = [UAFilterableResultsController filteredDataOfData:replacementData
+                                                          matchingPredicates:predicates
+                                                                     bitmaps:filterBitmaps
+                                                           parallelThreshold:parallelThreshold];
+        }
+        if (atomic_load(requestGeneration) == request && oldSnapshot != nil) {
+            NSArray *oldData = oldSnapshot.data;
+            if (wasFiltered) {
+                NSMapTable *oldFilterBitmaps = [NSMapTable mapTableWithKeyOptions:(NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality)
+                                                                     valueOptions:NSPointerFunctionsStrongMemory];
+                oldData = [UAFilterableResultsController filteredDataOfData:oldData
+                                                         matchingPredicates:predicates
+                                                                    bitmaps:oldFilterBitmaps
+                                                          parallelThreshold:parallelThreshold];
+            }
+            changes = [UAFilterableResultsController changesFrom:oldData to:(filteredData ?: replacementData) usingKeyPath:keyPath];
+        }
+
+        dispatch_async(self.delegateQueue, ^{
+            if (atomic_load(requestGeneration) != request) {
+                finish(NO);
+                return;
+            }
+
+            // if the data or filters were changed while we were busy the changes won't line up any more, so we do it the long way
+            BOOL isStillFiltered = (self.UAAppliedFilters.count > 0);
+            if (self.dataGeneration != dataGeneration || (self.UAData != nil) != hadData || isStillFiltered != shouldFilter || (hadData && changes == nil) ||
+                (self.sectionKeyPath != sectionKeyPath && ![self.sectionKeyPath isEqualToString:sectionKeyPath]) ||
+                ![self predicates:[self predicatesOfFilters:self.UAAppliedFilters] areIdenticalToPredicates:predicates]) {
+                [self setData:replacementData];
+                finish(YES);
+                return;
+            }
+
+            [self applyData:replacementData filteredData:filteredData filterBitmaps:filterBitmaps changes:changes];
+            finish(YES);
+        });
+    });
+}
+
+- (NSArray *)snapshotOfData:(nullable NSArray *)data {
+    if (data == nil) {
+        return @[];
+    }
+    if (![self isArrayTwoDimensional:data]) {
+        return [data copy];
+    }
+
+    // copying an immutable array costs nothing, so this is only real work for the mutable ones
+    NSMutableArray *sections = [[NSMutableArray alloc] initWithCapacity:data.count];
+    for (NSArray *section in data) {
+        [sections addObject:[section copy]];
+    }
+    return sections;
+}
+
+- (NSMutableArray *)mutableDataWithData:(NSArray *)data {
+    if (![self isArrayTwoDimensional:data]) {
+        return [[NSMutableArray alloc] initWithArray:data];
+    }
+
+    // mutable on both levels
+    NSMutableArray *sections = [[NSMutableArray alloc] initWithCapacity:data.count];
+    for (NSArray *section in data) {
+        [sections addObject:[[NSMutableArray alloc] initWithArray:section]];
+    }
+    return sections;
+}
+
+- (void)applyData:(NSMutableArray *)data filteredData:(nullable NSMutableArray *)filteredData filterBitmaps:(NSMapTable *)filterBitmaps changes:(nullable UAFilterableResultsChangeList *)changes {
+    if ([self performChange:^{ [self applyData:data filteredData:filteredData filterBitmaps:filterBitmaps changes:changes]; }]) {
+        return;
+    }
+
+    BOOL hasExistingData = (self.UAData != nil);
+    self.dataProvider = nil;
+    self.canAskDataProviderForPrimaryKeys = NO;
+
+    if (hasExistingData) {
+        [self notifyBeginChanges];
+    }
+
+    self.UAData = data;
+    [self dataDidChange];
+
+    if (filteredData != nil) {
+        self.filterBitmaps = filterBitmaps;
+        self.filteredDataPredicates = [self predicatesOfFilters:self.UAAppliedFilters];
+    }
+    self.filteredDataIsStale = NO;
+    [self setFilteredData:filteredData notifications:NO];
+
+    if (hasExistingData) {
+        if ([self areUpdatesEnabled] && changes != nil) {
+            [self notifyChanges:changes];
+        }
+        [self notifyEndChangesButDontReapplyFilters];
+    } else {
+        [self notifyReload];
+    }
+}
+
+#pragma mark - Paged Data
+
+- (void)setDataProvider:(nullable id<UAFilterableResultsDataProvider>)dataProvider pageSize:(NSUInteger)pageSize maximumResidentPages:(NSUInteger)maximumResidentPages {
+    if ([self performChange:^{ [self setDataProvider:dataProvider pageSize:pageSize maximumResidentPages:maximumResidentPages]; }]) {
+        return;
+    }
+
+    if (dataProvider == nil) {
+        [self setData:nil];
+        return;
+    }
+    NSParameterAssert(pageSize > 0);
+
+    // working out the differences would mean reading every page, so we always reload
+    self.UAData = [UAPagedArray dataWithProvider:dataProvider pageSize:pageSize maximumResidentPages:maximumResidentPages];
+    self.dataProvider = dataProvider;
+    self.canAskDataProviderForPrimaryKeys = [dataProvider respondsToSelector:@selector(indexPathOfObjectWithPrimaryKey:)];
+    self.filteredDataPredicates = nil;
+    [self dataDidChange];
+    [self reapplyFiltersWithoutNotifying];
+    [self notifyReload];
+}
+
+#pragma mark - Sorted Data
+
+- (void)setSortComparator:(nullable NSComparator)sortComparator {
+    if ([self performChange:^{ [self setSortComparator:sortComparator]; }]) {
+        return;
+    }
+
+    _sortComparator = [sortComparator copy];
+    _sortDescriptors = nil;
+
+    // put what we already have in order, setData: will work out the moves. Paged data is left alone as sorting it would read every page.
+    if (sortComparator != nil && self.UAData != nil && self.dataProvider == nil) {
+        [self setData:self.UAData];
+    }
+}
+
+- (void)setSortDescriptors:(nullable NSArray *)sortDescriptors {
+    if ([self performChange:^{ [self setSortDescriptors:sortDescriptors]; }]) {
+        return;
+    }
+
+    if (sortDescriptors.count == 0) {
+        self.sortComparator = nil;
+        return;
+    }
+
+    NSArray *descriptors = [sortDescriptors copy];
+    self.sortComparator = ^NSComparisonResult(id obj1, id obj2) {
+        for (NSSortDescriptor *descriptor in descriptors) {
+            NSComparisonResult result = [descriptor compareObject:obj1 toObject:obj2];
+            if (result != NSOrderedSame) {
+                return result;
+            }
+        }
+        return NSOrderedSame;
+    };
+    _sortDescriptors = descriptors;
+}
+
++ (NSArray *)data:(NSArray *)data sortedUsingComparator:(NSComparator)comparator {
+    // this only touches what it is given, so it's safe to use off the main thread
+    if (!(data.count > 0 && [data.firstObject isKindOfClass:[NSArray class]])) {
+        return [data sortedArrayWithOptions:NSSortStable usingComparator:comparator];
+    }
+
+    NSMutableArray *sections = [[NSMutableArray alloc] initWithCapacity:data.count];
+    for (NSArray *section in data) {
+        [sections addObject:[section sortedArrayWithOptions:NSSortStable usingComparator:comparator]];
+    }
+    return sections;
+}
+
+// the row an object belongs at in a sorted section, after anything it compares the same as so the order is stable.
+// The row being replaced, if there is one, is left out of the search and the result counts the rows without it.
+- (NSUInteger)sortedRowForObject:(id)object inSection:(NSArray *)section ignoringRow:(NSUInteger)ignoredRow {
+    NSComparator comparator = self.sortComparator;
+    NSUInteger low = 0;
+    NSUInteger high = section.count - (ignoredRow < section.count ? 1 : 0);
+    while (low < high) {
+        NSUInteger middle = low + (high - low) / 2;
+        NSUInteger row = (middle >= ignoredRow ? middle + 1 : middle);
+        if (comparator(section[row], object) == NSOrderedDescending) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return low;
+}
+
+// Replaces the object at the index path with one that belongs at a different row, as a single move.
+// Returns NO, having done nothing, if it belongs at the same row.
+- (BOOL)moveObjectAtIndexPath:(NSIndexPath *)indexPath toSortedRowOfObject:(id)newObject {
+    BOOL isTwoDimensional = [self isArrayTwoDimensional:self.UAData];
+    NSUInteger sectionIndex = (isTwoDimensional ? (NSUInteger)indexPath.section : 0);
+    NSMutableArray *section = (isTwoDimensional ? [self.UAData objectAtIndex:sectionIndex] : self.UAData);
+    NSUInteger oldRow = (NSUInteger)indexPath.row;
+    NSUInteger newRow = [self sortedRowForObject:newObject inSection:section ignoringRow:oldRow];
+    if (newRow == oldRow) {
+        return NO;
+    }
+
+    // both filtered rows are worked out before anything moves, so the insertion point is counted with the old row still in place
+    id oldObject = [section objectAtIndex:oldRow];
+    NSUInteger oldFilteredRow = [self filteredRowOfObjectAtRow:oldRow inSection:sectionIndex];
+    NSUInteger newFilteredRow = [self filteredRowForRow:(newRow > oldRow ? newRow + 1 : newRow) inSection:sectionIndex];
+
+    NSIndexPath *oldIndexPath = [NSIndexPath indexPathForRow:(NSInteger)oldRow inSection:(NSInteger)sectionIndex];
+    NSIndexPath *newIndexPath = [NSIndexPath indexPathForRow:(NSInteger)newRow inSection:(NSInteger)sectionIndex];
+    [self removeObjectAtRow:oldRow ofSection:section];
+    [self trackRemovedObject:oldObject atIndexPath:oldIndexPath];
+    [self insertObject:newObject atRow:newRow ofSection:section];
+    [self trackInsertedObject:newObject atIndexPath:newIndexPath];
+    [self dataDidChange];
+
+    if (![self isFiltered]) {
+        [self notifyChangedObject:newObject
+                      atIndexPath:oldIndexPath
+                    forChangeType:UAFilterableResultsChangeMove
+                     newIndexPath:newIndexPath];
+    } else {
+        [self updateFilteredDataInSection:sectionIndex
+                             removeObject:oldObject
+                            atFilteredRow:oldFilteredRow
+                             insertObject:newObject
+                            atFilteredRow:newFilteredRow];
+    }
+    return YES;
+}
+
+// Replaces the object at the index path with one that belongs in another section, as a single move. Both sections must stay.
+- (void)moveObjectAtIndexPath:(NSIndexPath *)indexPath toSectionAtIndex:(NSUInteger)newSectionIndex replacingWithObject:(id)newObject {
+    NSMutableArray *oldSection = [self.UAData objectAtIndex:(NSUInteger)indexPath.section];
+    NSMutableArray *newSection = [self.UAData objectAtIndex:newSectionIndex];
+    id oldObject = [oldSection objectAtIndex:(NSUInteger)indexPath.row];
+    NSUInteger newRow = (self.sortComparator != nil ? [self sortedRowForObject:newObject inSection:newSection ignoringRow:NSNotFound] : newSection.count);
+    NSIndexPath *newIndexPath = [NSIndexPath indexPathForRow:(NSInteger)newRow inSection:(NSInteger)newSectionIndex];
+
+    [self removeObjectAtRow:(NSUInteger)indexPath.row ofSection:oldSection];
+    [self trackRemovedObject:oldObject atIndexPath:indexPath];
+    [self insertObject:newObject atRow:newRow ofSection:newSection];
+    [self trackInsertedObject:newObject atIndexPath:newIndexPath];
+    [self dataDidChange];
+
+    if (![self isFiltered]) {
+        [self notifyChangedObject:newObject
+                      atIndexPath:indexPath
+                    forChangeType:UAFilterableResultsChangeMove
+                     newIndexPath:newIndexPath];
+
+    // both filtered sections change at once, so they're worked out again when the batch ends, or right now if nobody is listening
+    } else {
+        self.filteredDataIsStale = YES;
+        if (![self areUpdatesEnabled] || ![self tableViewHasLoaded]) {
+            [self reapplyFiltersWithoutNotifying];
+        }
+    }
+}
+
+- (void)mergeObjectsKeepingSortOrder:(NSArray *)arrayOfObjects {
+    if (self.UAData == nil) {
+        [self setData:arrayOfObjects];
+        return;
+    }
+
+    // a binary search for each object is cheaper than a pass over everything until the batch gets big
+    NSUInteger count = self.numberOfObjects;
+    NSUInteger comparisonsPerObject = 1;
+    for (NSUInteger remaining = count; remaining > 1; remaining >>= 1) {
+        comparisonsPerObject++;
+    }
+    if ([self isArrayTwoDimensional:self.UAData] || arrayOfObjects.count * comparisonsPerObject < count ||
+        ![self mergeObjects:arrayOfObjects intoDataSortedUsingComparator:self.sortComparator sortOrder:self.sortComparator]) {
+        [self mergeObjectsOneAtATime:arrayOfObjects];
+    }
+}
+
+#pragma mark - Sectioned Data
+
+- (void)setSectionKeyPath:(nullable NSString *)sectionKeyPath {
+    if ([self performChange:^{ [self setSectionKeyPath:sectionKeyPath]; }]) {
+        return;
+    }
+
+    _sectionKeyPath = [sectionKeyPath copy];
+    self.sectionBuckets = nil;
+
+    // regroup what we already have, setData: will work out the section changes. Paged data is left alone as grouping it would read every page.
+    if (sectionKeyPath != nil && self.UAData != nil && self.dataProvider == nil) {
+        [self setData:self.UAData];
+    }
+}
+
+- (nullable id)sectionValueAtIndex:(NSUInteger)sectionIndex {
+    id value = [[self sectionBucketsForCurrentData] valueOfSectionAtIndex:sectionIndex];
+    return (value == [NSNull null] ? nil : value);
+}
+
+// built the first time it's needed for each version of the data, nil unless we're sectioning by a key path
+- (nullable UASectionBuckets *)sectionBucketsForCurrentData {
+    NSArray *data = self.UAData;
+    if (self.sectionKeyPath == nil || data == nil || self.dataProvider != nil || ![self isArrayTwoDimensional:data]) {
+        return nil;
+    }
+
+    UASectionBuckets *buckets = self.currentSectionBuckets;
+    if (buckets == nil || ![buckets.keyPath isEqualToString:self.sectionKeyPath]) {
+        buckets = [[UASectionBuckets alloc] initWithSections:data keyPath:self.sectionKeyPath];
+        self.sectionBuckets = buckets;
+    }
+    return buckets;
+}
+
+- (nullable UASectionBuckets *)currentSectionBuckets {
+    UASectionBuckets *buckets = self.sectionBuckets;
+    return (buckets != nil && buckets.data == self.UAData) ? buckets : nil;
+}
+
+#pragma mark - Snapshots
+
+- (nullable UAFilterableResultsSnapshot *)snapshot {
+    __block UAFilterableResultsSnapshot *snapshot = nil;
+    if ([self performLookup:^{ snapshot = [self snapshot]; } exclusively:YES]) {
+        return snapshot;
+    }
+
+    NSArray *data = self.UAData;
+    if (data == nil) {
+        return nil;
+    }
+
+    UAFilterableResultsSnapshot *snapshot = self.latestSnapshot;
+    if (snapshot != nil && self.latestSnapshotGeneration == self.dataGeneration) {
+        return snapshot;
+    }
+
+    snapshot = [[UAFilterableResultsSnapshot alloc] initWithData:data twoDimensional:[self isArrayTwoDimensional:data]];
+    if (self.snapshots == nil) {
+        self.snapshots = [NSHashTable weakObjectsHashTable];
+    }
+    [self.snapshots addObject:snapshot];
+    self.latestSnapshot = snapshot;
+    self.latestSnapshotGeneration = self.dataGeneration;
+    return snapshot;
+}
+
+- (void)setUAData:(nullable NSMutableArray *)UAData {
+    // the snapshots share the arrays being replaced, and nothing will change those in place again. The text search indexes
+    // and filter bitmaps were built from them too, and are built again from the new data the next time they're needed.
+    // Whoever sets the new data tells us if it is in order.
+    if (UAData != _UAData) {
+        [self.snapshots removeAllObjects];
+        self.textSearchIndexes = nil;
+        [self invalidateFilterBitmaps];
+        self.dataSortOrder = nil;
+    }
+    _UAData = UAData;
+}
+
+// A single row of a section (or of the data itself, when it's one dimensional) changed in place. One dimensional snapshots
+// only copy the chunk of rows the change is in, and read the rest from the section, so they're kept out while it changes.
+- (void)changeObjectAtRow:(NSUInteger)row ofSection:(NSMutableArray *)section delta:(NSInteger)delta usingBlock:(dispatch_block_t)change {
+    if (self.snapshots.count == 0) {
+        change();
+        return;
+    }
+
+    NSArray *snapshots = self.snapshots.allObjects;
+    for (UAFilterableResultsSnapshot *snapshot in snapshots) {
+        [snapshot willChangeObjectAtRow:row ofSection:section delta:delta];
+    }
+    @try {
+        change();
+    } @finally {
+        for (UAFilterableResultsSnapshot *snapshot in snapshots) {
+            [snapshot didChangeObjectInSection:section];
+        }
+    }
+}
+
+- (void)insertObject:(id)object atRow:(NSUInteger)row ofSection:(NSMutableArray *)section {
+    [self changeObjectAtRow:row ofSection:section delta:1 usingBlock:^{
+        [section insertObject:object atIndex:row];
+    }];
+}
+
+- (void)removeObjectAtRow:(NSUInteger)row ofSection:(NSMutableArray *)section {
+    [self changeObjectAtRow:row ofSection:section delta:-1 usingBlock:^{
+        [section removeObjectAtIndex:row];
+    }];
+}
+
+- (void)replaceObjectAtRow:(NSUInteger)row ofSection:(NSMutableArray *)section withObject:(id)object {
+    [self changeObjectAtRow:row ofSection:section delta:0 usingBlock:^{
+        [section replaceObjectAtIndex:row withObject:object];
+    }];
+}
+
+// called before sections are added, removed or replaced
+- (void)willChangeSections {
+    if (self.snapshots.count == 0) {
+        return;
+    }
+    for (UAFilterableResultsSnapshot *snapshot in self.snapshots.allObjects) {
+        [snapshot preserveSections];
+    }
+}
+
+#pragma mark - Thread Safety
+
+- (void)setThreadSafe:(BOOL)threadSafe {
+    _threadSafe = threadSafe;
+}
+
+- (void)setDelegateQueue:(nullable dispatch_queue_t)delegateQueue {
+    dispatch_queue_t queue = (delegateQueue ?: dispatch_get_main_queue());
+    if (queue != dispatch_get_main_queue()) {
+        dispatch_queue_set_specific(queue, &UAFilterableResultsDelegateQueueKey, (__bridge void *)queue, NULL);
+    }
+    _delegateQueue = queue;
+}
+
+- (BOOL)isOnDelegateQueue {
+    dispatch_queue_t queue = self.delegateQueue;
+    if (queue == dispatch_get_main_queue()) {
+        return [NSThread isMainThread];
+    }
+    return (dispatch_get_specific(&UAFilterableResultsDelegateQueueKey) == (__bridge void *)queue);
+}
+
+- (BOOL)isHoldingLock {
+    return (pthread_getspecific(UAFilterableResultsLockHolderKey) == (__bridge void *)self);
+}
+
+// Makes a change on the delegate queue while holding the write lock, sending it there if we're somewhere else, and tells the
+// delegate about it once the lock has been let go of. Returns NO when the caller should just go ahead and make the change
+// itself, because we're not thread safe or we're already inside one.
+- (BOOL)performChange:(dispatch_block_t)change {
+    if (!self.threadSafe || [self isHoldingLock]) {
+        return NO;
+    }
+    if (![self isOnDelegateQueue]) {
+        dispatch_async(self.delegateQueue, change);
+        return YES;
+    }
+    [self performLockedChange:change];
+    return YES;
+}
+
+- (void)performLockedChange:(dispatch_block_t)change {
+    if (!self.threadSafe || [self isHoldingLock]) {
+        change();
+        return;
+    }
+
+    // the delegate messages are held back until the lock has been let go of, so a delegate can wait on a lookup made from
+    // another thread while it handles them
+    NSArray *messages = nil;
+    self.pendingDelegateMessages = [[NSMutableArray alloc] init];
+    @try {
+        [self performLocked:change];
+    } @finally {
+        messages = self.pendingDelegateMessages;
+        self.pendingDelegateMessages = nil;
+    }
+
+    for (dispatch_block_t message in messages) {
+        message();
+    }
+}
+
+// Runs the block holding the write lock, unless we're not thread safe or already hold it.
+- (void)performLocked:(dispatch_block_t)block {
+    if (!self.threadSafe || [self isHoldingLock]) {
+        block();
+        return;
+    }
+
+    pthread_rwlock_wrlock(&_lock);
+    void *previousHolder = pthread_getspecific(UAFilterableResultsLockHolderKey);
+    pthread_setspecific(UAFilterableResultsLockHolderKey, (__bridge void *)self);
+    @try {
+        block();
+    } @finally {
+        pthread_setspecific(UAFilterableResultsLockHolderKey, previousHolder);
+        pthread_rwlock_unlock(&_lock);
+    }
+}
+
+// Sends a message to the delegate, timed as part of the batch when collecting metrics. During a thread safe change it waits
+// until the change has let go of the lock. Lookups from other threads count their metrics holding the lock, so the metrics
+// are only touched holding it too.
+- (void)deliverDelegateMessage:(dispatch_block_t)message {
+    if (self.pendingDelegateMessages == nil) {
+        [self beginMetricsInterval:UAFilterableResultsMetricsIntervalNotify];
+        message();
+        [self endMetricsInterval:UAFilterableResultsMetricsIntervalNotify];
+        return;
+    }
+
+    [self.pendingDelegateMessages addObject:[^{
+        [self performLockedIfCollectingMetrics:^{ [self beginMetricsInterval:UAFilterableResultsMetricsIntervalNotify]; }];
+        message();
+        [self performLockedIfCollectingMetrics:^{ [self endMetricsInterval:UAFilterableResultsMetricsIntervalNotify]; }];
+    } copy]];
+}
+
+- (void)performLockedIfCollectingMetrics:(dispatch_block_t)block {
+    if (self.pendingMetrics != nil) {
+        [self performLocked:block];
+    }
+}
+
+// Runs a lookup holding the read lock, or the write lock if it could change something on the way. Returns NO when the caller
+// should just go ahead and look it up itself, because we're not thread safe or we already hold the lock.
+- (BOOL)performLookup:(dispatch_block_t)lookup exclusively:(BOOL)exclusively {
+    if (!self.threadSafe || [self isHoldingLock]) {
+        return NO;
+    }
+
+    // paged data fetches pages as it's read, metrics are counted as we go, and the first lookup after a change brings the
+    // indexes up to date, so they need the lock to themselves too
+    pthread_rwlock_rdlock(&_lock);
+    if (exclusively || self.dataProvider != nil || self.pendingMetrics != nil || ![self isReadyForConcurrentLookups]) {
+        pthread_rwlock_unlock(&_lock);
+        pthread_rwlock_wrlock(&_lock);
+    }
+
+    void *previousHolder = pthread_getspecific(UAFilterableResultsLockHolderKey);
+    pthread_setspecific(UAFilterableResultsLockHolderKey, (__bridge void *)self);
+    @try {
+        if (![self isReadyForConcurrentLookups]) {
+            [self prepareForConcurrentLookups];
+        }
+        lookup();
+    } @finally {
+        pthread_setspecific(UAFilterableResultsLockHolderKey, previousHolder);
+        pthread_rwlock_unlock(&_lock);
+    }
+    return YES;
+}
+
+// whether a lookup on the raw data would only read, rather than build or bring something up to date on the way
+- (BOOL)isReadyForConcurrentLookups {
+    NSArray *data = self.UAData;
+    if (data == nil || self.dataProvider != nil) {
+        return YES;
+    }
+    if (self.currentSectionOffsets == nil) {
+        return NO;
+    }
+
+    NSString *keyPath = self.primaryKeyPath;
+    UAPrimaryKeyIndex *index = self.currentPrimaryKeyIndex;
+    return (keyPath == nil || (index != nil && !index.needsRebuild && !index.hasStaleSections && [index.keyPath isEqualToString:keyPath]));
+}
+
+// Builds or brings up to date everything a lookup on the raw data would otherwise do on the way, so the lookups after it only
+// read. This is left to the first lookup after a change, so a run of changes with no lookups in between doesn't pay for it.
+- (void)prepareForConcurrentLookups {
+    NSArray *data = self.UAData;
+    if (data == nil || self.dataProvider != nil) {
+        return;
+    }
+
+    [self sectionOffsetsForData:data];
+    UAPrimaryKeyIndex *index = [self primaryKeyIndexForData:data];
+    [index refreshStaleSections];
+    if (index.needsRebuild) {
+        [self primaryKeyIndexForData:data];
+    }
+}
+
+#pragma mark - Incremental Filtering
+
+- (nullable UAFilteredSection *)maintainableFilteredSectionAtIndex:(NSUInteger)sectionIndex {
+    // we can only keep the filtered data up to date if it was current to begin with
+    if (![self isFiltered] || self.filteredDataIsStale) {
+        return nil;
+    }
+
+    NSMutableArray *filteredData = self.filteredData;
+    id filteredSection = nil;
+    NSArray *section = nil;
+    if (![self isArrayTwoDimensional:self.UAData]) {
+        if ([self isArrayTwoDimensional:filteredData]) {
+            return nil;
+        }
+        filteredSection = filteredData;
+        section = self.UAData;
+
+    } else {
+        // the filtered sections must line up with the raw ones
+        if (filteredData.count != self.UAData.count || sectionIndex >= filteredData.count) {
+            return nil;
+        }
+        filteredSection = filteredData[sectionIndex];
+        section = self.UAData[sectionIndex];
+    }
+
+    // we find our way around by the rows it maps, so anything else is reapplied at the end of the batch instead
+    if (![filteredSection isKindOfClass:[UAFilteredSection class]] || ((UAFilteredSection *)filteredSection).section != section) {
+        return nil;
+    }
+    return filteredSection;
+}
+
+- (BOOL)objectPassesAppliedFilters:(id)object {
+    UAFilterableResultsMetrics *metrics = self.pendingMetrics;
+    for (UAFilter *filter in self.UAAppliedFilters) {
+        NSPredicate *predicate = filter.evaluatedPredicate;
+        if (predicate == nil) {
+            continue;
+        }
+
+        [metrics recordPredicateEvaluations:1];
+        if (![predicate evaluateWithObject:object]) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+- (NSUInteger)filteredRowForRow:(NSUInteger)row inSection:(NSUInteger)sectionIndex {
+    UAFilteredSection *filteredSection = [self maintainableFilteredSectionAtIndex:sectionIndex];
+    return (filteredSection != nil ? [filteredSection numberOfIndexesBeforeRow:row] : NSNotFound);
+}
+
+- (NSUInteger)filteredRowOfObjectAtRow:(NSUInteger)row inSection:(NSUInteger)sectionIndex {
+    UAFilteredSection *filteredSection = [self maintainableFilteredSectionAtIndex:sectionIndex];
+
+    // found by row rather than by object, so the same instance showing up twice can't be mistaken for this one
+    return (filteredSection != nil ? [filteredSection indexOfRow:row] : NSNotFound);
+}
+
+- (void)updateFilteredDataForObjectInsertedAtRow:(NSUInteger)row inSection:(NSUInteger)sectionIndex {
+    NSArray *section = ([self isArrayTwoDimensional:self.UAData] ? self.UAData[sectionIndex] : self.UAData);
+    [self updateFilteredDataInSection:sectionIndex
+                         removeObject:nil
+                        atFilteredRow:NSNotFound
+                         insertObject:section[row]
+                        atFilteredRow:[self filteredRowForRow:row inSection:sectionIndex]];
+}
+
+- (void)updateFilteredDataInSection:(NSUInteger)sectionIndex
+                       removeObject:(nullable id)oldObject
+                      atFilteredRow:(NSUInteger)oldFilteredRow
+                       insertObject:(nullable id)newObject
+                      atFilteredRow:(NSUInteger)newFilteredRow {
+
+    UAFilteredSection *filteredSection = [self maintainableFilteredSectionAtIndex:sectionIndex];
+    if (filteredSection == nil || (newObject != nil && newFilteredRow == NSNotFound)) {
+        // we couldn't keep up, so it will all be reapplied at the end of the batch
+        self.filteredDataIsStale = YES;
+        return;
+    }
+    self.changedFilteredDataIncrementally = YES;
+
+    // only the changed object needs to be evaluated
+    BOOL wasVisible = (oldObject != nil && oldFilteredRow != NSNotFound);
+    BOOL isVisible = (newObject != nil && [self objectPassesAppliedFilters:newObject]);
+
+    NSInteger filteredSectionIndex = ([self isArrayTwoDimensional:self.filteredData] ? (NSInteger)sectionIndex : 0);
+    UAPrimaryKeyIndex *filteredIndex = self.currentFilteredPrimaryKeyIndex;
+    UASectionOffsets *filteredOffsets = self.currentFilteredSectionOffsets;
+
+    if (wasVisible && isVisible && oldFilteredRow == newFilteredRow) {
+        NSIndexPath *indexPath = [NSIndexPath indexPathForRow:(NSInteger)oldFilteredRow inSection:filteredSectionIndex];
+        [filteredSection replaceObjectAtIndex:oldFilteredRow withObject:newObject];
+        [filteredIndex didReplaceObject:oldObject withObject:newObject atIndexPath:indexPath];
+        [self notifyChangedObject:newObject
+                      atIndexPath:indexPath
+                    forChangeType:UAFilterableResultsChangeUpdate
+                     newIndexPath:indexPath];
+
+    } else if (wasVisible && isVisible) {
+        NSIndexPath *oldIndexPath = [NSIndexPath indexPathForRow:(NSInteger)oldFilteredRow inSection:filteredSectionIndex];
+        [filteredSection removeObjectAtIndex:oldFilteredRow];
+        [filteredIndex didRemoveObject:oldObject atIndexPath:oldIndexPath];
+        [filteredOffsets didRemoveObjectAtIndexPath:oldIndexPath];
+
+        // the insertion point was counted with the old row still in place
+        NSUInteger insertionRow = (newFilteredRow > oldFilteredRow ? newFilteredRow - 1 : newFilteredRow);
+        NSIndexPath *newIndexPath = [NSIndexPath indexPathForRow:(NSInteger)insertionRow inSection:filteredSectionIndex];
+        [filteredSection insertObject:newObject atIndex:insertionRow];
+        [filteredIndex didInsertObject:newObject atIndexPath:newIndexPath];
+        [filteredOffsets didInsertObjectAtIndexPath:newIndexPath];
+        [self notifyChangedObject:newObject
+                      atIndexPath:oldIndexPath
+                    forChangeType:UAFilterableResultsChangeMove
+                     newIndexPath:newIndexPath];
+
+    } else if (wasVisible) {
+        NSIndexPath *indexPath = [NSIndexPath indexPathForRow:(NSInteger)oldFilteredRow inSection:filteredSectionIndex];
+        [filteredSection removeObjectAtIndex:oldFilteredRow];
+        [filteredIndex didRemoveObject:oldObject atIndexPath:indexPath];
+        [filteredOffsets didRemoveObjectAtIndexPath:indexPath];
+        [self notifyChangedObject:oldObject
+                      atIndexPath:indexPath
+                    forChangeType:UAFilterableResultsChangeDelete
+                     newIndexPath:nil];
+
+    } else if (isVisible) {
+        NSIndexPath *indexPath = [NSIndexPath indexPathForRow:(NSInteger)newFilteredRow inSection:filteredSectionIndex];
+        [filteredSection insertObject:newObject atIndex:newFilteredRow];
+        [filteredIndex didInsertObject:newObject atIndexPath:indexPath];
+        [filteredOffsets didInsertObjectAtIndexPath:indexPath];
+        [self notifyChangedObject:newObject
+                      atIndexPath:nil
+                    forChangeType:UAFilterableResultsChangeInsert
+                     newIndexPath:indexPath];
+    }
+}
+
+- (nullable UAPrimaryKeyIndex *)currentFilteredPrimaryKeyIndex {
+    UAPrimaryKeyIndex *index = self.filteredPrimaryKeyIndex;
+    return (index != nil && index.data == self.filteredData) ? index : nil;
+}
+
+- (nullable UASectionOffsets *)currentFilteredSectionOffsets {
+    UASectionOffsets *offsets = self.filteredSectionOffsets;
+    return (offsets != nil && offsets.data == self.filteredData) ? offsets : nil;
+}
+
+#pragma mark - Filtered Index Paths
+
+- (nullable UAFilteredSection *)filteredSectionOverSection:(NSArray *)section atIndex:(NSUInteger)sectionIndex {
+    NSArray *filteredData = self.filteredData;
+    if (filteredData == nil) {
+        return nil;
+    }
+
+    // the filtered sections usually line up with the raw ones
+    id candidate = filteredData;
+    if ([self isArrayTwoDimensional:self.UAData]) {
+        candidate = (sectionIndex < filteredData.count ? filteredData[sectionIndex] : nil);
+    }
+    if ([candidate isKindOfClass:[UAFilteredSection class]] && ((UAFilteredSection *)candidate).section == section) {
+        return candidate;
+    }
+
+    // but sections may have come and gone since they were filtered
+    if ([self isArrayTwoDimensional:self.UAData] && ![filteredData isKindOfClass:[UAFilteredSection class]]) {
+        for (id filteredSection in filteredData) {
+            if ([filteredSection isKindOfClass:[UAFilteredSection class]] && ((UAFilteredSection *)filteredSection).section == section) {
+                return filteredSection;
+            }
+        }
+    }
+    return nil;
+}
+
+// the filtered section at the index, if it maps exactly the raw section at the same index
+- (nullable UAFilteredSection *)filteredSectionMappingSectionAtIndex:(NSUInteger)sectionIndex {
+    NSArray *data = self.UAData;
+    NSArray *filteredData = self.filteredData;
+    if (data == nil || filteredData == nil) {
+        return nil;
+    }
+
+    UAFilteredSection *filteredSection = nil;
+    NSArray *section = nil;
+    if ([filteredData isKindOfClass:[UAFilteredSection class]]) {
+        if (sectionIndex != 0 || [self isArrayTwoDimensional:data]) {
+            return nil;
+        }
+        filteredSection = (UAFilteredSection *)filteredData;
+        section = data;
+    } else {
+        if (sectionIndex >= filteredData.count || sectionIndex >= data.count || filteredData.count != data.count) {
+            return nil;
+        }
+        filteredSection = filteredData[sectionIndex];
+        section = data[sectionIndex];
+    }
+
+    if (![filteredSection isKindOfClass:[UAFilteredSection class]] || filteredSection.section != section || !filteredSection.isMapped) {
+        return nil;
+    }
+    return filteredSection;
+}
+
+- (nullable NSIndexPath *)filteredIndexPathForIndexPath:(NSIndexPath *)indexPath {
+    NSParameterAssert(indexPath != nil);
+    if (![self isFiltered]) {
+        return indexPath;
+    }
+
+    NSUInteger sectionIndex = (NSUInteger)indexPath.section;
+    UAFilteredSection *filteredSection = [self filteredSectionMappingSectionAtIndex:sectionIndex];
+    if (filteredSection != nil) {
+        NSUInteger filteredRow = [filteredSection indexOfRow:(NSUInteger)indexPath.row];
+        return (filteredRow != NSNotFound ? [NSIndexPath indexPathForRow:(NSInteger)filteredRow inSection:indexPath.section] : nil);
+    }
+
+    // otherwise we have to look for it
+    id object = [self objectAtIndexPath:indexPath];
+    return (object != nil ? [self indexPathOfObjectIdenticalTo:object inArray:self.filteredData] : nil);
+}
+
+- (nullable NSIndexPath *)indexPathForFilteredIndexPath:(NSIndexPath *)filteredIndexPath {
+    NSParameterAssert(filteredIndexPath != nil);
+    if (![self isFiltered]) {
+        return filteredIndexPath;
+    }
+
+    UAFilteredSection *filteredSection = [self filteredSectionMappingSectionAtIndex:(NSUInteger)filteredIndexPath.section];
+    if (filteredSection != nil) {
+        if ((NSUInteger)filteredIndexPath.row >= filteredSection.count) {
+            return nil;
+        }
+        return [NSIndexPath indexPathForRow:(NSInteger)[filteredSection rowAtIndex:(NSUInteger)filteredIndexPath.row] inSection:filteredIndexPath.section];
+    }
+
+    // otherwise we have to look for it
+    id object = [self filteredObjectAtIndexPath:filteredIndexPath];
+    return (object != nil ? [self indexPathOfObjectIdenticalTo:object inArray:self.UAData] : nil);
+}
+
+- (nullable NSIndexPath *)indexPathOfObjectIdenticalTo:(id)object inArray:(NSArray *)data {
+    NSArray *sections = ([self isArrayTwoDimensional:data] ? data : @[ data ]);
+    for (NSUInteger sectionIndex = 0; sectionIndex < sections.count; sectionIndex++) {
+        NSUInteger row = [sections[sectionIndex] indexOfObjectIdenticalTo:object];
+        if (row != NSNotFound) {
+            return [NSIndexPath indexPathForRow:(NSInteger)row inSection:(NSInteger)sectionIndex];
+        }
+    }
+    return nil;
+}
+
+#pragma mark - Primary Key Index
+
+- (nullable UAPrimaryKeyIndex *)primaryKeyIndexForData:(nullable NSArray *)data {
+    NSString *keyPath = self.primaryKeyPath;
+    if (keyPath == nil || data == nil) {
+        return nil;
+    }
+
+    // we only index our own arrays, and not paged data as it would mean reading every page
+    BOOL isFilteredData = (data == self.filteredData);
+    if (!isFilteredData && (data != self.UAData || self.dataProvider != nil)) {
+        return nil;
+    }
+
+    // (re)build it lazily if the data has been replaced since we last looked
+    UAPrimaryKeyIndex *index = (isFilteredData ? self.filteredPrimaryKeyIndex : self.primaryKeyIndex);
+    if (index == nil || index.data != data || index.needsRebuild || ![index.keyPath isEqualToString:keyPath]) {
+        index = [[UAPrimaryKeyIndex alloc] initWithData:data twoDimensional:[self isArrayTwoDimensional:data] keyPath:keyPath];
+        if (isFilteredData) {
+            self.filteredPrimaryKeyIndex = index;
+        } else {
+            self.primaryKeyIndex = index;
+        }
+    }
+
+    return index.isUsable ? index : nil;
+}
+
+- (nullable UAPrimaryKeyIndex *)currentPrimaryKeyIndex {
+    UAPrimaryKeyIndex *index = self.primaryKeyIndex;
+    return (index != nil && index.data == self.UAData) ? index : nil;
+}
+
+#pragma mark - Section Offsets
+
+- (nullable UASectionOffsets *)sectionOffsetsForData:(nullable NSArray *)data {
+    if (data == nil) {
+        return nil;
+    }
+
+    // we only keep totals for our own arrays
+    BOOL isFilteredData = (data == self.filteredData);
+    if (!isFilteredData && data != self.UAData) {
+        return [[UASectionOffsets alloc] initWithData:data twoDimensional:[self isArrayTwoDimensional:data]];
+    }
+
+    // (re)build them lazily if the data has been replaced since we last looked
+    UASectionOffsets *offsets = (isFilteredData ? self.filteredSectionOffsets : self.sectionOffsets);
+    if (offsets == nil || offsets.data != data) {
+        offsets = [[UASectionOffsets alloc] initWithData:data twoDimensional:[self isArrayTwoDimensional:data]];
+        if (isFilteredData) {
+            self.filteredSectionOffsets = offsets;
+        } else {
+            self.sectionOffsets = offsets;
+        }
+    }
+    return offsets;
+}
+
+- (nullable UASectionOffsets *)currentSectionOffsets {
+    UASectionOffsets *offsets = self.sectionOffsets;
+    return (offsets != nil && offsets.data == self.UAData) ? offsets : nil;
+}
+
+#pragma mark - Tracking Changes
+
+// Every change made to the raw data in place is reported here, so the indexes over it can keep up without walking it again
+
+// the filtered section that maps rows of the section at the index path, whether or not it's current
+- (nullable UAFilteredSection *)filteredSectionOverSectionAtIndexPath:(NSIndexPath *)indexPath {
+    if (self.filteredData == nil) {
+        return nil;
+    }
+    BOOL isTwoDimensional = [self isArrayTwoDimensional:self.UAData];
+    NSUInteger sectionIndex = (isTwoDimensional ? (NSUInteger)indexPath.section : 0);
+    NSArray *section = (isTwoDimensional ? self.UAData[sectionIndex] : self.UAData);
+    return [self filteredSectionOverSection:section atIndex:sectionIndex];
+}
+
+- (void)trackInsertedObject:(id)object atIndexPath:(NSIndexPath *)indexPath {
+    self.canAskDataProviderForPrimaryKeys = NO;
+    [[self filteredSectionOverSectionAtIndexPath:indexPath] didInsertRowAtIndex:(NSUInteger)indexPath.row];
+    [[self currentTextSearchIndexes] makeObjectsPerformSelector:@selector(addObject:) withObject:object];
+    [self.currentPrimaryKeyIndex didInsertObject:object atIndexPath:indexPath];
+    [self.currentSectionOffsets didInsertObjectAtIndexPath:indexPath];
+    [self.currentSectionBuckets didInsertObject:object atIndexPath:indexPath];
+    [self updateDataSortOrderAroundIndexPath:indexPath];
+    [self updateFilterBitmapsAtIndexPath:indexPath removingCount:0 insertingObjects:@[ object ]];
+}
+
+- (void)trackRemovedObject:(id)object atIndexPath:(NSIndexPath *)indexPath {
+    self.canAskDataProviderForPrimaryKeys = NO;
+    [[self filteredSectionOverSectionAtIndexPath:indexPath] didRemoveObject:object atRow:(NSUInteger)indexPath.row];
+    [[self currentTextSearchIndexes] makeObjectsPerformSelector:@selector(removeObject:) withObject:object];
+    [self.currentPrimaryKeyIndex didRemoveObject:object atIndexPath:indexPath];
+    [self.currentSectionOffsets didRemoveObjectAtIndexPath:indexPath];
+    [self.currentSectionBuckets didRemoveObject:object atIndexPath:indexPath];
+    [self updateFilterBitmapsAtIndexPath:indexPath removingCount:1 insertingObjects:@[]];
+}
+
+- (void)trackReplacedObject:(id)oldObject withObject:(id)newObject atIndexPath:(NSIndexPath *)indexPath {
+    self.canAskDataProviderForPrimaryKeys = NO;
+    [[self filteredSectionOverSectionAtIndexPath:indexPath] didReplaceObject:oldObject atRow:(NSUInteger)indexPath.row];
+    for (UATextSearchIndex *index in [self currentTextSearchIndexes]) {
+        [index removeObject:oldObject];
+        [index addObject:newObject];
+    }
+    [self.currentPrimaryKeyIndex didReplaceObject:oldObject withObject:newObject atIndexPath:indexPath];
+    [self.currentSectionBuckets didReplaceObject:oldObject withObject:newObject atIndexPath:indexPath];
+    [self updateDataSortOrderAroundIndexPath:indexPath];
+    [self updateFilterBitmapsAtIndexPath:indexPath removingCount:1 insertingObjects:@[ newObject ]];
+}
+
+- (void)trackInsertedSection:(NSArray *)section atIndex:(NSUInteger)sectionIndex {
+    self.canAskDataProviderForPrimaryKeys = NO;
+    [self.currentPrimaryKeyIndex didInsertSection:section atIndex:sectionIndex];
+    [self.currentSectionOffsets didInsertSection:section atIndex:sectionIndex];
+    [self.currentSectionBuckets didInsertSection:section atIndex:sectionIndex];
+    self.dataSortOrder = nil;
+    for (UATextSearchIndex *index in [self currentTextSearchIndexes]) {
+        for (id object in section) {
+            [index addObject:object];
+        }
+    }
+    [self updateFilterBitmapsAtIndexPath:[NSIndexPath indexPathForRow:0 inSection:(NSInteger)sectionIndex] removingCount:0 insertingObjects:section];
+}
+
+- (void)trackRemovedSection:(NSArray *)section atIndex:(NSUInteger)sectionIndex {
+    self.canAskDataProviderForPrimaryKeys = NO;
+    [self.currentPrimaryKeyIndex didRemoveSection:section atIndex:sectionIndex];
+    [self.currentSectionOffsets didRemoveSection:section atIndex:sectionIndex];
+    [self.currentSectionBuckets didRemoveSection:section atIndex:sectionIndex];
+    self.dataSortOrder = nil;
+    for (UATextSearchIndex *index in [self currentTextSearchIndexes]) {
+        for (id object in section) {
+            [index removeObject:object];
+        }
+    }
+    [self updateFilterBitmapsAtIndexPath:[NSIndexPath indexPathForRow:0 inSection:(NSInteger)sectionIndex] removingCount:section.count insertingObjects:@[]];
+}
+
+- (void)trackReplacedSection:(NSArray *)oldSection withSection:(NSArray *)newSection atIndex:(NSUInteger)sectionIndex {
+    self.canAskDataProviderForPrimaryKeys = NO;
+    [self.currentPrimaryKeyIndex didReplaceSection:oldSection withSection:newSection atIndex:sectionIndex];
+    [self.currentSectionOffsets didReplaceSection:oldSection withSection:newSection atIndex:sectionIndex];
+    [self.currentSectionBuckets didReplaceSection:oldSection withSection:newSection atIndex:sectionIndex];
+    self.dataSortOrder = nil;
+    for (UATextSearchIndex *index in [self currentTextSearchIndexes]) {
+        for (id object in oldSection) {
+            [index removeObject:object];
+        }
+        for (id object in newSection) {
+            [index addObject:object];
+        }
+    }
+    [self updateFilterBitmapsAtIndexPath:[NSIndexPath indexPathForRow:0 inSection:(NSInteger)sectionIndex] removingCount:oldSection.count insertingObjects:newSection];
+}
+
+// The bitmaps number the rows across every section, so the rows after a change only need their bits moved along, and only
+// the new rows are evaluated. This runs last, once the section offsets already include the change.
+- (void)updateFilterBitmapsAtIndexPath:(NSIndexPath *)indexPath removingCount:(NSUInteger)removedCount insertingObjects:(NSArray *)objects {
+    NSMapTable *filterBitmaps = self.filterBitmaps;
+    if (filterBitmaps.count == 0) {
+        return;
+    }
+
+    UASectionOffsets *offsets = [self sectionOffsetsForData:self.UAData];
+    NSUInteger offset = [offsets offsetOfIndexPath:indexPath];
+    NSUInteger insertedCount = objects.count;
+    UAFilterableResultsMetrics *metrics = self.pendingMetrics;
+
+    for (NSPredicate *predicate in [[filterBitmaps keyEnumerator] allObjects]) {
+        UAFilterBitmap *bitmap = [filterBitmaps objectForKey:predicate];
+
+        // one that had already fallen behind is worked out again the next time it's needed
+        if (bitmap.count + insertedCount != offsets.count + removedCount) {
+            [filterBitmaps removeObjectForKey:predicate];
+            continue;
+        }
+
+        if (removedCount > insertedCount) {
+            [bitmap removeRowsInRange:NSMakeRange(offset + insertedCount, removedCount - insertedCount)];
+        } else if (insertedCount > removedCount) {
+            [bitmap insertRowsInRange:NSMakeRange(offset + removedCount, insertedCount - removedCount)];
+        }
+
+        NSUInteger row = offset;
+        for (id object in objects) {
+            [metrics recordPredicateEvaluations:1];
+            [bitmap setIndex:row matches:[predicate evaluateWithObject:object]];
+            row++;
+        }
+    }
+}
+
+#pragma mark - Object Comparison
+
+- (BOOL)isObject:(id)anObject equalToObject:(id)anotherObject usingKeyPath:(NSString *)keyPath {
+    // hack for ids and hashes
+    if ([anObject isEqual:anotherObject]) {
+        return YES;
+    }
+
+    // are they the same class?
+    if (![anObject isKindOfClass:[anotherObject class]]) {
+        return NO;
+    }
+
+    // no key path supplied? Can't continue further checking.
+    if (keyPath == nil) {
+        // check directly (we already know they're the same class)
+        if ([anObject isKindOfClass:[NSString class]]) {
+            return [((NSString *)anObject) isEqualToString:anotherObject];
+        }
+        return NO;
+    }
+    
+    // otherwise, get the values at the specified keypath for both and compare those
+    [self.pendingMetrics recordKeyValueLookups:2];
+    @try {
+        id aValue = [anObject valueForKeyPath:keyPath];
+        id anotherValue = [anotherObject valueForKeyPath:keyPath];
+        if ([aValue isEqual:anotherValue]) {
+            return YES;
+        }
+        
+        // otherwise no
+        return NO;
+    } @catch (NSException *) {
+        // the keypath wasnt found on at least one of the objects, so definitely not.
+        return NO;
+    }
+}
+
+- (BOOL)isArrayTwoDimensional:(NSArray *)array {
+    if (array == nil || array.count == 0) {
+        return NO;
+    }
+
+    // a paged section is never two dimensional, and looking at its first object would fetch a page
+    if ([array isKindOfClass:[UAPagedArray class]]) {
+        return NO;
+    }
+    
     return [[array firstObject] isKindOfClass:[NSArray class]];
 }
 
-#pragma mark - Section Manipulation
+#pragma mark - Section Manipulation
+
+- (void)addSection:(NSArray *)section {
+    if ([self performChange:^{ [self addSection:section]; }]) {
+        return;
+    }
+
+    NSAssert(self.UAData != nil, @"Cannot add section to nil data.");
+    NSAssert([self isArrayTwoDimensional:self.UAData], @"Cannot add section to 1D array.");
+    NSParameterAssert(section != nil);
+    
+    [self notifyBeginChanges];
+    [self willChangeSections];
+    [self.UAData addObject:[section mutableCopy]];
+    [self trackInsertedSection:section atIndex:self.UAData.count-1];
+    [self dataDidChange];
+    self.filteredDataIsStale = YES;
+    [self notifyChangedSectionAtIndex:((NSInteger)self.UAData.count-1) forChangeType:UAFilterableResultsChangeInsert];
+    [self notifyEndChanges];
+}
+
+- (void)insertSection:(NSArray *)section atIndex:(NSUInteger)index {
+    if ([self performChange:^{ [self insertSection:section atIndex:index]; }]) {
+        return;
+    }
+
+    NSAssert(self.UAData != nil, @"Cannot insert section to nil data.");
+    NSAssert([self isArrayTwoDimensional:self.UAData], @"Cannot imsert section to 1D array.");
+    NSParameterAssert(section != nil);
+    
+    [self notifyBeginChanges];
+    [self willChangeSections];
+    [self.UAData insertObject:[section mutableCopy] atIndex:index];
+    [self trackInsertedSection:section atIndex:index];
+    [self dataDidChange];
+    self.filteredDataIsStale = YES;
+    [self notifyChangedSectionAtIndex:(NSInteger)index forChangeType:UAFilterableResultsChangeInsert];
+    [self notifyEndChanges];
+}
+
+- (void)removeSection:(NSArray *)section {
+    if ([self performChange:^{ [self removeSection:section]; }]) {
+        return;
+    }
+
+    NSAssert(self.UAData != nil, @"Cannot remove section from nil data.");
+    NSAssert([self isArrayTwoDimensional:self.UAData], @"Cannot remove section from 1D array.");
+    NSParameterAssert(section != nil);
+    
+    NSUInteger indexOfSection = [self.UAData indexOfObject:section];
+    [self removeSectionAtIndex:indexOfSection];
+}
+
+- (void)removeSectionAtIndex:(NSUInteger)sectionIndex {
+    if ([self performChange:^{ [self removeSectionAtIndex:sectionIndex]; }]) {
+        return;
+    }
+
+    NSAssert(self.UAData != nil, @"Cannot remove section from nil data.");
+    NSAssert([self isArrayTwoDimensional:self.UAData], @"Cannot remove section from 1D array.");
+
+    if (sectionIndex != NSNotFound)
+    {
+        [self notifyBeginChanges];
+        NSArray *section = [self.UAData objectAtIndex:sectionIndex];
+        [self willChangeSections];
+        [self.UAData removeObjectAtIndex:sectionIndex];
+        [self trackRemovedSection:section atIndex:sectionIndex];
+        [self dataDidChange];
+        self.filteredDataIsStale = YES;
+        [self notifyChangedSectionAtIndex:(NSInteger)sectionIndex forChangeType:UAFilterableResultsChangeDelete];
+        [self notifyEndChanges];
+    }
+}
+
+- (void)replaceSection:(NSArray *)oldSection withSection:(NSArray *)newSection {
+    if ([self performChange:^{ [self replaceSection:oldSection withSection:newSection]; }]) {
+        return;
+    }
+
+    NSAssert(self.UAData != nil, @"Cannot replace section in nil data.");
+    NSAssert([self isArrayTwoDimensional:self.UAData], @"Cannot replace section in 1D array.");
+    NSParameterAssert(oldSection != nil);
+    NSParameterAssert(newSection != nil);
+    
+    NSUInteger indexOfSection = [self.UAData indexOfObject:oldSection];
+    if (indexOfSection != NSNotFound) {
+        [self replaceSectionAtIndex:(NSInteger)indexOfSection withSection:newSection];
+    }
+}
+
+- (void)replaceSectionAtIndex:(NSInteger)sectionIndex withSection:(NSArray *)newSection {
+    if ([self performChange:^{ [self replaceSectionAtIndex:sectionIndex withSection:newSection]; }]) {
+        return;
+    }
+
+    NSAssert(self.UAData != nil, @"Cannot replace section in nil data.");
+    NSAssert([self isArrayTwoDimensional:self.UAData], @"Cannot replace section in 1D array.");
+    NSParameterAssert(sectionIndex != NSNotFound);
+    NSParameterAssert(newSection != nil);
+    
+    [self notifyBeginChanges];
+
+    NSArray *existing = [self.UAData objectAtIndex:(NSUInteger)sectionIndex];
+    [self willChangeSections];
+    [self.UAData replaceObjectAtIndex:(NSUInteger)sectionIndex withObject:newSection];
+    [self trackReplacedSection:existing withSection:newSection atIndex:(NSUInteger)sectionIndex];
+    [self dataDidChange];
+    self.filteredDataIsStale = YES;
+
+    if (existing != nil) {
+        [self notifyForChangesForSectionAtIndex:sectionIndex from:existing to:newSection];
+    } else {
+        [self notifyChangedSectionAtIndex:sectionIndex forChangeType:UAFilterableResultsChangeUpdate];
+    }
+
+    [self notifyEndChanges];
+}
+
+
+#pragma mark - Filters
+
+- (void)addFilter:(UAFilter *)filter {
+    [self addFilters:@[ filter ]];
+}
+
+- (void)addFilters:(NSArray *)filters {
+    if ([self performChange:^{ [self addFilters:filters]; }]) {
+        return;
+    }
+
+    [self cancelPendingFilters];
+    [self addFilters:filters toFilters:self.UAAppliedFilters];
+
+    // reload the filters
+    [self applyFilters:self.UAAppliedFilters];
+}
+
+- (void)addFilters:(NSArray *)filters toFilters:(NSMutableArray *)appliedFilters {
+    for (UAFilter *filter in filters) {
+        // are there any existing filters in this group?
+        BOOL didReplaceFilter = NO;
+        for (NSUInteger i = 0; i < appliedFilters.count; i++) {
+            UAFilter *existingFilter = [appliedFilters objectAtIndex:i];
+            if (existingFilter.groupTitle != nil && filter.groupTitle != nil && [existingFilter.groupTitle isEqualToString:filter.groupTitle]) {
+                [appliedFilters replaceObjectAtIndex:i withObject:filter];
+                didReplaceFilter = YES;
+                break;
+            }
+        }
+        
+        // if we did not replace an existing filter we add it in
+        if (!didReplaceFilter) {
+            [appliedFilters addObject:filter];
+        }
+    }
+}
+
+- (void)removeFilter:(UAFilter *)filter {
+    if ([self performChange:^{ [self removeFilter:filter]; }]) {
+        return;
+    }
+
+    BOOL didTakePendingFilters = [self cancelPendingFilters];
+    NSMutableArray *appliedFilters = self.UAAppliedFilters;
+    if (appliedFilters.count == 0 && !didTakePendingFilters) {
+        return;
+    }
+    
+    [appliedFilters removeObject:filter];
+    [self applyFilters:appliedFilters];
+}
+
+- (void)replaceFilters:(NSArray *)filters {
+    if ([self performChange:^{ [self replaceFilters:filters]; }]) {
+        return;
+    }
+
+    [self cancelPendingFilters];
+    NSMutableArray *appliedFilters = self.UAAppliedFilters;
+    [appliedFilters replaceObjectsInRange:NSMakeRange(0, self.UAAppliedFilters.count) withObjectsFromArray:filters];
+    [self applyFilters:appliedFilters];
+}
+
+- (void)clearFilters {
+    if ([self performChange:^{ [self clearFilters]; }]) {
+        return;
+    }
+
+    [self cancelPendingFilters];
+    [self.UAAppliedFilters removeAllObjects];
+    [self applyFilters:nil];
+}
+
+#pragma mark - Asynchronous Filters
+
+- (void)addFilter:(UAFilter *)filter completion:(nullable void (^)(BOOL finished))completion {
+    NSMutableArray *filters = [[self latestFilters] mutableCopy];
+    [self addFilters:@[ filter ] toFilters:filters];
+    [self applyFiltersAsynchronously:filters completion:completion];
+}
+
+- (void)replaceFilters:(NSArray *)filters completion:(nullable void (^)(BOOL finished))completion {
+    [self applyFiltersAsynchronously:filters completion:completion];
+}
+
+- (void)clearFiltersWithCompletion:(nullable void (^)(BOOL finished))completion {
+    [self applyFiltersAsynchronously:@[] completion:completion];
+}
+
+// the filters most recently asked for, which might not have been applied yet
+- (NSArray *)latestFilters {
+    return (self.pendingFilters ?: self.UAAppliedFilters);
+}
 
-- (void)addSection:(NSArray *)section {
-    NSAssert(self.UAData != nil, @"Cannot add section to nil data.");
-    NSAssert([self isArrayTwoDimensional:self.UAData], @"Cannot add section to 1D array.");
-    NSParameterAssert(section != nil);
-    
-    [self notifyBeginChanges];
-    [self.UAData addObject:[section mutableCopy]];
-    [self notifyChangedSectionAtIndex:((NSInteger)self.UAData.count-1) forChangeType:UAFilterableResultsChangeInsert];
-    [self notifyEndChanges];
+// anything still in flight is superseded, but the filters it was going to apply are kept so the caller can build on them.
+// Returns YES if there were any, in which case the filtered data no longer matches the applied filters.
+- (BOOL)cancelPendingFilters {
+    atomic_fetch_add(&_filterGeneration, 1);
+    if (self.pendingFilters == nil) {
+        return NO;
+    }
+
+    [self.UAAppliedFilters setArray:self.pendingFilters];
+    self.pendingFilters = nil;
+    return YES;
 }
 
-- (void)insertSection:(NSArray *)section atIndex:(NSUInteger)index {
-    NSAssert(self.UAData != nil, @"Cannot insert section to nil data.");
-    NSAssert([self isArrayTwoDimensional:self.UAData], @"Cannot imsert section to 1D array.");
-    NSParameterAssert(section != nil);
-    
+- (void)applyFiltersAsynchronously:(NSArray *)filters completion:(nullable void (^)(BOOL finished))completion {
+    NSAssert([self isOnDelegateQueue], @"Filters must be changed asynchronously from the delegate queue.");
+
+    // every change gets the next generation, and anything working on an earlier one gives up as soon as it notices
+    unsigned long generation = atomic_fetch_add(&_filterGeneration, 1) + 1;
+    filters = [filters copy];
+    self.pendingFilters = filters;
+
+    void (^finish)(BOOL) = ^(BOOL finished) {
+        if (completion != nil) {
+            completion(finished);
+        }
+    };
+
+    // with nothing to filter the filters are simply stored for later
+    if (self.UAData == nil) {
+        self.pendingFilters = nil;
+        [self.UAAppliedFilters setArray:filters];
+        [self applyFilters:(filters.count > 0 ? self.UAAppliedFilters : nil)];
+        finish(YES);
+        return;
+    }
+
+    // Take everything the background work needs, the same way setData:completion: does. Text search queries are only
+    // looked up in the background, and what's on screen now is worked out there from the snapshot.
+    UAFilterableResultsSnapshot *snapshot = [self snapshot];
+    NSUInteger dataGeneration = self.dataGeneration;
+    BOOL shouldFilter = (filters.count > 0);
+    BOOL wasFiltered = self.isFiltered;
+    NSMapTable *textSearchQueries = [NSMapTable mapTableWithKeyOptions:(NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality)
+                                                          valueOptions:NSPointerFunctionsStrongMemory];
+    NSArray *predicates = [self predicatesOfFilters:filters textSearchQueries:textSearchQueries];
+    NSArray *displayedPredicates = (wasFiltered ? [self predicatesOfFilters:self.UAAppliedFilters textSearchQueries:textSearchQueries] : nil);
+
+    // we can only work out what's on screen if we know exactly which predicates produced it
+    BOOL canDiff = (!wasFiltered || (!self.filteredDataIsStale && self.filteredDataPredicates != nil &&
+                                     [self predicates:displayedPredicates areIdenticalToPredicates:self.filteredDataPredicates]));
+    NSString *keyPath = self.primaryKeyPath;
+    NSUInteger parallelThreshold = (self.filtersInParallel ? self.parallelFilteringThreshold : NSUIntegerMax);
+
+    // The bitmaps we already have are good for the predicates that are staying, unless it's the same filters again. They're
+    // kept up to date in place as the data changes, so the background gets its own copies.
+    NSMapTable *filterBitmaps = [NSMapTable mapTableWithKeyOptions:(NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality)
+                                                      valueOptions:NSPointerFunctionsStrongMemory];
+    if (self.filterBitmaps != nil && !(self.filteredDataPredicates != nil && [self predicates:predicates areIdenticalToPredicates:self.filteredDataPredicates])) {
+        for (NSPredicate *predicate in predicates) {
+            UAFilterBitmap *bitmap = [self.filterBitmaps objectForKey:predicate];
+            if (bitmap != nil) {
+                [filterBitmaps setObject:[bitmap copy] forKey:predicate];
+            }
+        }
+    }
+
+    BOOL (^isCancelled)(void) = ^BOOL {
+        return (atomic_load(&self->_filterGeneration) != generation);
+    };
+
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        NSArray *data = snapshot.data;
+        NSMutableArray *filteredData = nil;
+        UAFilterableResultsChangeList *changes = nil;
+
+        for (UATextSearchFilter *filter in textSearchQueries.keyEnumerator) {
+            if (!isCancelled()) {
+                [filter lookUpQueryInIndex:[textSearchQueries objectForKey:filter]];
+            }
+        }
+
+        // we check in between each step, and the evaluation checks as it goes, in case we've been superseded
+        if (!isCancelled() && shouldFilter) {
+            filteredData = [UAFilterableResultsController filteredDataOfData:data
+                                                          matchingPredicates:predicates
+                                                                     bitmaps:filterBitmaps
+                                                           parallelThreshold:parallelThreshold
+                                                                cancellation:isCancelled];
+        }
+        NSArray *displayedData = data;
+        if (!isCancelled() && canDiff && wasFiltered) {
+            NSMapTable *displayedBitmaps = [NSMapTable mapTableWithKeyOptions:(NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality)
+                                                                 valueOptions:NSPointerFunctionsStrongMemory];
+            displayedData = [UAFilterableResultsController filteredDataOfData:data
+                                                           matchingPredicates:displayedPredicates
+                                                                      bitmaps:displayedBitmaps
+                                                            parallelThreshold:parallelThreshold
+                                                                 cancellation:isCancelled];
+        }
+        if (!isCancelled() && canDiff && displayedData != nil && (filteredData != nil || !shouldFilter)) {
+            changes = [UAFilterableResultsController changesFrom:displayedData to:(filteredData ?: data) usingKeyPath:keyPath];
+        }
+
+        dispatch_async(self.delegateQueue, ^{
+            [self performLockedChange:^{
+                if (isCancelled()) {
+                    finish(NO);
+                    return;
+                }
+                self.pendingFilters = nil;
+                [self.UAAppliedFilters setArray:filters];
+
+                // If the data was changed while we were busy the changes won't line up any more, so we do it the long way. The
+                // queries were looked up in the background, so getting the predicates again doesn't repeat them.
+                if (changes == nil || self.dataGeneration != dataGeneration || ![self predicates:[self predicatesOfFilters:filters] areIdenticalToPredicates:predicates]) {
+                    [self applyFilters:(shouldFilter ? self.UAAppliedFilters : nil)];
+                    finish(YES);
+                    return;
+                }
+
+                [self applyFilteredData:filteredData bitmaps:(shouldFilter ? filterBitmaps : nil) predicates:predicates changes:changes];
+                finish(YES);
+            }];
+        });
+    });
+}
+
+- (void)applyFilteredData:(nullable NSMutableArray *)filteredData bitmaps:(nullable NSMapTable *)filterBitmaps predicates:(NSArray *)predicates changes:(UAFilterableResultsChangeList *)changes {
+    // nothing has changed since the snapshot was taken, so the filtered rows line up with our own sections as they are
+    if (filteredData != nil) {
+        NSArray *data = self.UAData;
+        BOOL isTwoDimensional = [self isArrayTwoDimensional:data];
+        NSArray *sections = (isTwoDimensional ? data : @[ data ]);
+        NSArray *filteredSections = (isTwoDimensional ? filteredData : @[ filteredData ]);
+        [filteredSections enumerateObjectsUsingBlock:^(UAFilteredSection *filteredSection, NSUInteger sectionIndex, BOOL *stop) {
+            [filteredSection moveToSection:sections[sectionIndex]];
+        }];
+    }
+
     [self notifyBeginChanges];
-    [self.UAData insertObject:[section mutableCopy] atIndex:index];
-    [self notifyChangedSectionAtIndex:(NSInteger)index forChangeType:UAFilterableResultsChangeInsert];
-    [self notifyEndChanges];
+    [self removeTextSearchIndexesNotUsedByFilters:self.UAAppliedFilters];
+    self.filterBitmaps = filterBitmaps;
+    self.filteredDataPredicates = (filterBitmaps != nil ? predicates : @[]);
+    self.filteredDataIsStale = NO;
+    [self setFilteredData:filteredData notifications:NO];
+
+    if ([self areUpdatesEnabled]) {
+        [self notifyChanges:changes];
+    }
+    [self notifyEndChangesButDontReapplyFilters];
 }
 
-- (void)removeSection:(NSArray *)section {
-    NSAssert(self.UAData != nil, @"Cannot remove section from nil data.");
-    NSAssert([self isArrayTwoDimensional:self.UAData], @"Cannot remove section from 1D array.");
-    NSParameterAssert(section != nil);
+#pragma mark - Applying Filters
+
+- (void)reapplyFiltersWithoutNotifying {
+    if (self.UAAppliedFilters != nil && self.UAAppliedFilters.count > 0) {
+        [self applyFilters:self.UAAppliedFilters notifications:NO];
+    }
+}
+
+- (void)reapplyFilters {
+    if (self.UAAppliedFilters != nil && self.UAAppliedFilters.count > 0) {
+        [self applyFilters:self.UAAppliedFilters];
+    }
+}
+
+- (void)applyFilters:(nullable NSArray *)filters {
+    [self applyFilters:filters notifications:YES];
+}
+
+- (void)applyFilters:(NSArray *)filters notifications:(BOOL)notifications {
+    if (filters == nil) {
+        // with no filters everything is visible
+        self.filteredDataPredicates = @[];
+        self.filterBitmaps = nil;
+        [self removeTextSearchIndexesNotUsedByFilters:@[]];
+        [self setFilteredData:nil notifications:notifications];
+        return;
+    }
     
-    NSUInteger indexOfSection = [self.UAData indexOfObject:section];
-    [self removeSectionAtIndex:indexOfSection];
+    // nothing to apply to?
+    if (self.UAData == nil) {
+        return;
+    }
+
+    [self beginMetricsInterval:UAFilterableResultsMetricsIntervalFilter];
+
+    // The same filters again means the objects themselves have changed, so nothing we worked out before can be trusted. That
+    // includes the text we indexed, so the queries aren't looked up until we know whether the indexes need building again.
+    NSMapTable *textSearchQueries = [NSMapTable mapTableWithKeyOptions:(NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality)
+                                                          valueOptions:NSPointerFunctionsStrongMemory];
+    NSArray *predicates = [self predicatesOfFilters:filters textSearchQueries:textSearchQueries];
+    if (self.filteredDataPredicates != nil && [self predicates:predicates areIdenticalToPredicates:self.filteredDataPredicates]) {
+        [self invalidateFilterBitmaps];
+        [self rebuildTextSearchIndexes];
+        predicates = [self predicatesOfFilters:filters];
+    } else {
+        for (UATextSearchFilter *filter in textSearchQueries.keyEnumerator) {
+            [filter lookUpQueryInIndex:[textSearchQueries objectForKey:filter]];
+        }
+    }
+    [self removeTextSearchIndexesNotUsedByFilters:filters];
+
+    // Adding filters only ever hides rows, so the new ones only have to be evaluated against the rows that are visible now.
+    // Otherwise if we have bitmaps for the filters that are staying we only have to evaluate the new ones, and failing that
+    // we can at least start from the rows we already know about (which is a serial walk, so not when we're going wide).
+    NSMutableArray *filteredData = nil;
+    if ([self isNarrowingToPredicates:predicates] || (![self shouldFilterInParallel] && ![self hasFilterBitmapsForKeptPredicates:predicates])) {
+        filteredData = [self filteredDataByChangingToFilters:filters];
+    }
+    if (filteredData == nil) {
+        filteredData = [self filteredDataByApplyingFilters:filters];
+    }
+
+    // whatever we come up with will be current
+    self.filteredDataIsStale = NO;
+    self.filteredDataPredicates = predicates;
+    [self removeFilterBitmapsNotInPredicates:predicates];
+    [self endMetricsInterval:UAFilterableResultsMetricsIntervalFilter];
+
+    [self setFilteredData:filteredData notifications:notifications];
 }
 
-- (void)removeSectionAtIndex:(NSUInteger)sectionIndex {
-    NSAssert(self.UAData != nil, @"Cannot remove section from nil data.");
-    NSAssert([self isArrayTwoDimensional:self.UAData], @"Cannot remove section from 1D array.");
+- (NSMutableArray *)filteredDataByApplyingFilters:(NSArray *)filters {
+    NSMapTable *filterBitmaps = self.filterBitmaps;
+    if (filterBitmaps == nil) {
+        filterBitmaps = [NSMapTable mapTableWithKeyOptions:(NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality)
+                                              valueOptions:NSPointerFunctionsStrongMemory];
+        self.filterBitmaps = filterBitmaps;
+    }
 
-    if (sectionIndex != NSNotFound)
-    {
-        [self notifyBeginChanges];
-        [self.UAData removeObjectAtIndex:sectionIndex];
-        [self notifyChangedSectionAtIndex:(NSInteger)sectionIndex forChangeType:UAFilterableResultsChangeDelete];
-        [self notifyEndChanges];
+    // every predicate we don't have a bitmap for yet gets evaluated against every object
+    UAFilterableResultsMetrics *metrics = self.pendingMetrics;
+    if (metrics != nil) {
+        NSUInteger count = self.numberOfObjects;
+        for (NSPredicate *predicate in [self predicatesOfFilters:filters]) {
+            UAFilterBitmap *bitmap = [filterBitmaps objectForKey:predicate];
+            if (bitmap == nil || bitmap.count != count) {
+                [metrics recordPredicateEvaluations:count];
+            } else {
+                [metrics recordPredicateEvaluations:bitmap.numberOfUnevaluatedRows];
+            }
+        }
     }
+
+    return [[self class] filteredDataOfData:self.UAData
+                          matchingPredicates:[self predicatesOfFilters:filters]
+                                     bitmaps:filterBitmaps
+                           parallelThreshold:(self.filtersInParallel ? self.parallelFilteringThreshold : NSUIntegerMax)];
 }
 
-- (void)replaceSection:(NSArray *)oldSection withSection:(NSArray *)newSection {
-    NSAssert(self.UAData != nil, @"Cannot replace section in nil data.");
-    NSAssert([self isArrayTwoDimensional:self.UAData], @"Cannot replace section in 1D array.");
-    NSParameterAssert(oldSection != nil);
-    NSParameterAssert(newSection != nil);
-    
-    NSUInteger indexOfSection = [self.UAData indexOfObject:oldSection];
-    if (indexOfSection != NSNotFound) {
-        [self replaceSectionAtIndex:(NSInteger)indexOfSection withSection:newSection];
++ (NSMutableArray *)filteredDataOfData:(NSArray *)data
+                    matchingPredicates:(NSArray *)predicates
+                               bitmaps:(NSMapTable *)filterBitmaps
+                     parallelThreshold:(NSUInteger)parallelThreshold {
+
+    return [self filteredDataOfData:data matchingPredicates:predicates bitmaps:filterBitmaps parallelThreshold:parallelThreshold cancellation:nil];
+}
+
++ (nullable NSMutableArray *)filteredDataOfData:(NSArray *)data
+                             matchingPredicates:(NSArray *)predicates
+                                        bitmaps:(NSMapTable *)filterBitmaps
+                              parallelThreshold:(NSUInteger)parallelThreshold
+                                   cancellation:(nullable BOOL (^)(void))isCancelled {
+
+    // this only touches what it is given, so it's safe to use off the main thread
+    BOOL isTwoDimensional = (data.count > 0 && [data.firstObject isKindOfClass:[NSArray class]]);
+    NSArray *sections = (isTwoDimensional ? data : @[ data ]);
+
+    NSUInteger count = 0;
+    for (NSArray *section in sections) {
+        count += section.count;
+    }
+
+    // combine the bitmaps of every filter, working out any we don't have yet
+    UAFilterBitmap *matches = nil;
+    for (NSPredicate *predicate in predicates) {
+        UAFilterBitmap *bitmap = [filterBitmaps objectForKey:predicate];
+        if (bitmap == nil || bitmap.count != count) {
+            bitmap = [[UAFilterBitmap alloc] initWithPredicate:predicate
+                                         evaluatedOverSections:sections
+                                                  concurrently:(count >= parallelThreshold)
+                                                  cancellation:isCancelled];
+            if (bitmap == nil) {
+                return nil;
+            }
+            [filterBitmaps setObject:bitmap forKey:predicate];
+
+        // one made while narrowing only has the rows that were visible at the time
+        } else if (!bitmap.isComplete) {
+            [bitmap completeWithPredicate:predicate evaluatedOverSections:sections];
+        }
+
+        if (matches == nil) {
+            matches = [bitmap copy];
+        } else {
+            [matches intersectWithBitmap:bitmap];
+        }
+    }
+
+    // and pick out the rows that are left
+    NSMutableArray *filteredSections = [[NSMutableArray alloc] initWithCapacity:sections.count];
+    NSUInteger offset = 0;
+    for (NSArray *section in sections) {
+        if (matches == nil) {
+            [filteredSections addObject:[[UAFilteredSection alloc] initWithAllRowsOfSection:section]];
+        } else {
+            [filteredSections addObject:[matches filteredSectionOfArray:section atOffset:offset]];
+        }
+        offset += section.count;
     }
+
+    return (isTwoDimensional ? filteredSections : filteredSections.firstObject);
 }
 
-- (void)replaceSectionAtIndex:(NSInteger)sectionIndex withSection:(NSArray *)newSection {
-    NSAssert(self.UAData != nil, @"Cannot replace section in nil data.");
-    NSAssert([self isArrayTwoDimensional:self.UAData], @"Cannot replace section in 1D array.");
-    NSParameterAssert(sectionIndex != NSNotFound);
-    NSParameterAssert(newSection != nil);
-    
-    [self notifyBeginChanges];
+- (BOOL)shouldFilterInParallel {
+    if (!self.filtersInParallel) {
+        return NO;
+    }
 
-    NSArray *existing = [self.UAData objectAtIndex:(NSUInteger)sectionIndex];
-    [self.UAData replaceObjectAtIndex:(NSUInteger)sectionIndex withObject:newSection];
+    NSUInteger count = 0;
+    for (NSArray *section in ([self isArrayTwoDimensional:self.UAData] ? self.UAData : @[ self.UAData ])) {
+        count += section.count;
+        if (count >= self.parallelFilteringThreshold) {
+            return YES;
+        }
+    }
+    return NO;
+}
+
+- (BOOL)predicates:(NSArray *)predicates areIdenticalToPredicates:(NSArray *)otherPredicates {
+    if (predicates.count != otherPredicates.count) {
+        return NO;
+    }
+    for (NSPredicate *predicate in predicates) {
+        if ([otherPredicates indexOfObjectIdenticalTo:predicate] == NSNotFound) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+- (BOOL)hasFilterBitmapsForKeptPredicates:(NSArray *)predicates {
+    NSArray *oldPredicates = self.filteredDataPredicates;
+    if (oldPredicates == nil || self.filteredDataIsStale) {
+        return NO;
+    }
+
+    for (NSPredicate *predicate in predicates) {
+        if ([oldPredicates indexOfObjectIdenticalTo:predicate] != NSNotFound && [self.filterBitmaps objectForKey:predicate] == nil) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+// every predicate that produced the current filtered data is staying, and there are new ones
+- (BOOL)isNarrowingToPredicates:(NSArray *)predicates {
+    NSArray *oldPredicates = self.filteredDataPredicates;
+    if (oldPredicates == nil || self.filteredDataIsStale || predicates.count <= oldPredicates.count) {
+        return NO;
+    }
+
+    for (NSPredicate *predicate in oldPredicates) {
+        if ([predicates indexOfObjectIdenticalTo:predicate] == NSNotFound) {
+            return NO;
+        }
+    }
+    return YES;
+}
+
+- (void)removeFilterBitmapsNotInPredicates:(NSArray *)predicates {
+    NSMapTable *filterBitmaps = self.filterBitmaps;
+    for (NSPredicate *predicate in [[filterBitmaps keyEnumerator] allObjects]) {
+        if ([predicates indexOfObjectIdenticalTo:predicate] == NSNotFound) {
+            [filterBitmaps removeObjectForKey:predicate];
+        }
+    }
+}
+
+- (void)invalidateFilterBitmaps {
+    [self.filterBitmaps removeAllObjects];
+}
+
+// the filter bitmaps are kept up to date by the tracking hooks, and dropped when the data is replaced
+- (void)dataDidChange {
+    self.dataGeneration = (self.dataGeneration + 1);
+}
+
+- (NSArray *)predicatesOfFilters:(NSArray *)filters {
+    return [self predicatesOfFilters:filters textSearchQueries:nil];
+}
+
+// Text search filters look up their query in the index as they're prepared, unless there's somewhere to put the queries,
+// in which case each filter that still needs to is added along with the index to look it up in.
+- (NSArray *)predicatesOfFilters:(NSArray *)filters textSearchQueries:(nullable NSMapTable *)textSearchQueries {
+    NSMutableArray *predicates = [[NSMutableArray alloc] initWithCapacity:filters.count];
+    for (UAFilter *filter in filters) {
+        if ([filter isKindOfClass:[UATextSearchFilter class]]) {
+            UATextSearchIndex *index = [self prepareTextSearchFilter:(UATextSearchFilter *)filter lookingUpQuery:(textSearchQueries == nil)];
+            if (index != nil && textSearchQueries != nil && ![(UATextSearchFilter *)filter isPreparedWithIndex:index]) {
+                [textSearchQueries setObject:index forKey:filter];
+            }
+        }
+
+        NSPredicate *predicate = filter.evaluatedPredicate;
+        if (predicate != nil && [predicates indexOfObjectIdenticalTo:predicate] == NSNotFound) {
+            [predicates addObject:predicate];
+        }
+    }
+    return predicates;
+}
+
+#pragma mark - Text Search
+
+- (nullable UATextSearchIndex *)prepareTextSearchFilter:(UATextSearchFilter *)filter lookingUpQuery:(BOOL)shouldLookUpQuery {
+    NSArray *data = self.UAData;
+    if (data == nil || filter.query.length == 0) {
+        return nil;
+    }
+
+    // one index for each set of key paths, built the first time it's searched and kept up to date after that
+    if (self.textSearchIndexes == nil) {
+        self.textSearchIndexes = [[NSMutableDictionary alloc] init];
+    }
+    UATextSearchIndex *index = self.textSearchIndexes[filter.keyPaths];
+    if (index == nil) {
+        index = [[UATextSearchIndex alloc] initWithKeyPaths:filter.keyPaths];
+        self.textSearchIndexes[filter.keyPaths] = index;
+    }
+    if (index.data != data) {
+        [index rebuildWithData:data twoDimensional:[self isArrayTwoDimensional:data]];
+    }
+
+    if (!shouldLookUpQuery) {
+        [filter attachToIndex:index];
+    } else if (![filter isPreparedWithIndex:index]) {
+        [filter prepareWithIndex:index];
+    }
+    return index;
+}
+
+// rebuilt in place, so the filters using them keep their predicates and just look their queries up again
+- (void)rebuildTextSearchIndexes {
+    NSArray *data = self.UAData;
+    for (UATextSearchIndex *index in [self currentTextSearchIndexes]) {
+        [index rebuildWithData:data twoDimensional:[self isArrayTwoDimensional:data]];
+    }
+}
+
+// an index is only worth keeping up to date while a filter is searching it
+- (void)removeTextSearchIndexesNotUsedByFilters:(NSArray *)filters {
+    if (self.textSearchIndexes.count == 0) {
+        return;
+    }
+
+    NSMutableSet *usedKeyPaths = [[NSMutableSet alloc] init];
+    for (UAFilter *filter in filters) {
+        if ([filter isKindOfClass:[UATextSearchFilter class]]) {
+            [usedKeyPaths addObject:((UATextSearchFilter *)filter).keyPaths];
+        }
+    }
+    for (NSArray *keyPaths in self.textSearchIndexes.allKeys) {
+        if (![usedKeyPaths containsObject:keyPaths]) {
+            [self.textSearchIndexes removeObjectForKey:keyPaths];
+        }
+    }
+}
+
+// the indexes that are following the current data
+- (NSArray *)currentTextSearchIndexes {
+    if (self.textSearchIndexes.count == 0) {
+        return @[];
+    }
+
+    NSMutableArray *indexes = [[NSMutableArray alloc] initWithCapacity:self.textSearchIndexes.count];
+    for (UATextSearchIndex *index in self.textSearchIndexes.objectEnumerator) {
+        if (index.data == self.UAData) {
+            [indexes addObject:index];
+        }
+    }
+    return indexes;
+}
+
+- (nullable NSMutableArray *)filteredDataByChangingToFilters:(NSArray *)filters {
+    // we need to know exactly which predicates produced the current filtered data
+    NSArray *oldPredicates = self.filteredDataPredicates;
+    if (oldPredicates == nil || self.filteredDataIsStale) {
+        return nil;
+    }
+
+    // work out which predicates are new and whether any have gone
+    NSArray *predicates = [self predicatesOfFilters:filters];
+    NSMutableArray *addedPredicates = [[NSMutableArray alloc] initWithCapacity:predicates.count];
+    NSUInteger keptCount = 0;
+    for (NSPredicate *predicate in predicates) {
+        if ([oldPredicates indexOfObjectIdenticalTo:predicate] == NSNotFound) {
+            [addedPredicates addObject:predicate];
+        } else {
+            keptCount++;
+        }
+    }
+    BOOL isWidening = (keptCount < oldPredicates.count);
+
+    // the same filters again means the objects themselves have changed, they all need to be looked at
+    if (addedPredicates.count == 0 && !isWidening) {
+        return nil;
+    }
+
+    NSArray *data = self.UAData;
+    NSArray *oldFilteredData = (self.filteredData ?: data);
+    BOOL isTwoDimensional = [self isArrayTwoDimensional:data];
+    NSArray *sections = (isTwoDimensional ? data : @[ data ]);
+    NSArray *oldFilteredSections = (isTwoDimensional ? oldFilteredData : @[ oldFilteredData ]);
+    if (oldFilteredSections.count != sections.count || (!isTwoDimensional && [self isArrayTwoDimensional:oldFilteredData])) {
+        return nil;
+    }
+
+    // When narrowing, what the new predicates make of each visible row goes into a bitmap for each of them, to be finished
+    // off if it's ever needed for the hidden rows as well
+    NSArray *addedBitmaps = (isWidening ? nil : [self partialFilterBitmapsForPredicates:addedPredicates overSections:sections]);
+
+    NSMutableArray *filteredSections = [[NSMutableArray alloc] initWithCapacity:sections.count];
+    NSUInteger offset = 0;
+    for (NSUInteger sectionIndex = 0; sectionIndex < sections.count; sectionIndex++) {
+        NSArray *section = sections[sectionIndex];
+        NSArray *oldFilteredSection = oldFilteredSections[sectionIndex];
+        UAFilteredSection *filteredSection = [[UAFilteredSection alloc] initWithSection:section capacity:oldFilteredSection.count];
+
+        // narrowing only has to look at the visible rows, which a mapped filtered section can tell us directly
+        if (!isWidening && (oldFilteredSection == section || ([oldFilteredSection isKindOfClass:[UAFilteredSection class]] &&
+                                                               ((UAFilteredSection *)oldFilteredSection).section == section &&
+                                                               ((UAFilteredSection *)oldFilteredSection).isMapped))) {
+            BOOL isEveryRow = (oldFilteredSection == section);
+            NSUInteger visibleCount = oldFilteredSection.count;
+            for (NSUInteger index = 0; index < visibleCount; index++) {
+                NSUInteger row = (isEveryRow ? index : [(UAFilteredSection *)oldFilteredSection rowAtIndex:index]);
+                if ([self object:section[row] passesPredicates:addedPredicates recordingInBitmaps:addedBitmaps atIndex:offset + row]) {
+                    [filteredSection addRow:row];
+                }
+            }
+            [filteredSections addObject:filteredSection];
+            offset += section.count;
+            continue;
+        }
+
+        // otherwise the old filtered section is an ordered subset of the section, so we can walk them together
+        NSUInteger oldFilteredRow = 0;
+        NSUInteger row = 0;
+        for (id object in section) {
+            BOOL wasVisible = (oldFilteredRow < oldFilteredSection.count && oldFilteredSection[oldFilteredRow] == object);
+            if (wasVisible) {
+                oldFilteredRow++;
+            }
+
+            // Narrowing: visible rows already pass the kept predicates so only the new ones need checking,
+            // and hidden rows fail one of the kept predicates so they stay hidden.
+            // Widening: hidden rows might have failed a removed predicate, so they're checked against everything.
+            BOOL isVisible = NO;
+            if (wasVisible) {
+                isVisible = [self object:object passesPredicates:addedPredicates recordingInBitmaps:addedBitmaps atIndex:offset + row];
+            } else if (isWidening) {
+                isVisible = [self object:object passesPredicates:predicates];
+            }
+
+            if (isVisible) {
+                [filteredSection addRow:row];
+            }
+            row++;
+        }
+
+        // if the old filtered data didn't line up with the section we can't trust any of it
+        if (oldFilteredRow != oldFilteredSection.count) {
+            return nil;
+        }
+        [filteredSections addObject:filteredSection];
+        offset += section.count;
+    }
 
-    if (existing != nil) {
-        [self notifyForChangesForSectionAtIndex:sectionIndex from:existing to:newSection];
-    } else {
-        [self notifyChangedSectionAtIndex:sectionIndex forChangeType:UAFilterableResultsChangeUpdate];
+    // the bitmaps are only kept once we know the rows they were worked out from lined up
+    for (NSUInteger index = 0; index < addedBitmaps.count; index++) {
+        if (addedBitmaps[index] != [NSNull null]) {
+            [self.filterBitmaps setObject:addedBitmaps[index] forKey:addedPredicates[index]];
+        }
     }
 
-    [self notifyEndChanges];
+    return (isTwoDimensional ? filteredSections : filteredSections.firstObject);
 }
 
+// an empty partial bitmap for each predicate, or NSNull where there's already one to keep
+- (NSArray *)partialFilterBitmapsForPredicates:(NSArray *)predicates overSections:(NSArray *)sections {
+    if (self.filterBitmaps == nil) {
+        self.filterBitmaps = [NSMapTable mapTableWithKeyOptions:(NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality)
+                                                   valueOptions:NSPointerFunctionsStrongMemory];
+    }
 
-#pragma mark - Filters
-
-- (void)addFilter:(UAFilter *)filter {
-    NSMutableArray *appliedFilters = self.UAAppliedFilters;
-
-    // are there any existing filters in this group?
-    BOOL didReplaceFilter = NO;
-    for (NSUInteger i = 0; i < appliedFilters.count; i++) {
-        UAFilter *existingFilter = [appliedFilters objectAtIndex:i];
-        if (existingFilter.groupTitle != nil && filter.groupTitle != nil && [existingFilter.groupTitle isEqualToString:filter.groupTitle]) {
-            [appliedFilters replaceObjectAtIndex:i withObject:filter];
-            didReplaceFilter = YES;
-            break;
-        }
+    NSUInteger count = 0;
+    for (NSArray *section in sections) {
+        count += section.count;
     }
-    
-    // if we did not replace an existing filter we add it in
-    if (!didReplaceFilter) {
-        [appliedFilters addObject:filter];
+
+    NSMutableArray *bitmaps = [[NSMutableArray alloc] initWithCapacity:predicates.count];
+    for (NSPredicate *predicate in predicates) {
+        UAFilterBitmap *bitmap = [self.filterBitmaps objectForKey:predicate];
+        [bitmaps addObject:(bitmap != nil && bitmap.count == count ? [NSNull null] : [[UAFilterBitmap alloc] initWithUnevaluatedCount:count])];
     }
-    
-    // reload the filters
-    [self applyFilters:appliedFilters];
+    return bitmaps;
 }
 
-- (void)addFilters:(NSArray *)filters {
-    NSMutableArray *appliedFilters = self.UAAppliedFilters;
-    
-    for (UAFilter *filter in filters) {
-        // are there any existing filters in this group?
-        BOOL didReplaceFilter = NO;
-        for (NSUInteger i = 0; i < appliedFilters.count; i++) {
-            UAFilter *existingFilter = [appliedFilters objectAtIndex:i];
-            if (existingFilter.groupTitle != nil && filter.groupTitle != nil && [existingFilter.groupTitle isEqualToString:filter.groupTitle]) {
-                [appliedFilters replaceObjectAtIndex:i withObject:filter];
-                didReplaceFilter = YES;
-                break;
-            }
+// Stops at the first predicate the object fails, so the predicates after that aren't recorded as evaluated for it
+- (BOOL)object:(id)object passesPredicates:(NSArray *)predicates recordingInBitmaps:(nullable NSArray *)bitmaps atIndex:(NSUInteger)index {
+    UAFilterableResultsMetrics *metrics = self.pendingMetrics;
+    for (NSUInteger predicateIndex = 0; predicateIndex < predicates.count; predicateIndex++) {
+        [metrics recordPredicateEvaluations:1];
+        BOOL matches = [predicates[predicateIndex] evaluateWithObject:object];
+
+        UAFilterBitmap *bitmap = bitmaps[predicateIndex];
+        if (bitmap != (id)[NSNull null]) {
+            [bitmap setIndex:index matches:matches];
         }
-        
-        // if we did not replace an existing filter we add it in
-        if (!didReplaceFilter) {
-            [appliedFilters addObject:filter];
+        if (!matches) {
+            return NO;
         }
     }
-    
-    // reload the filters
-    [self applyFilters:appliedFilters];
+    return YES;
 }
 
-- (void)removeFilter:(UAFilter *)filter {
-    NSMutableArray *appliedFilters = self.UAAppliedFilters;
-    if (appliedFilters.count == 0) {
-        return;
+- (BOOL)object:(id)object passesPredicates:(NSArray *)predicates {
+    UAFilterableResultsMetrics *metrics = self.pendingMetrics;
+    for (NSPredicate *predicate in predicates) {
+        [metrics recordPredicateEvaluations:1];
+        if (![predicate evaluateWithObject:object]) {
+            return NO;
+        }
     }
-    
-    [appliedFilters removeObject:filter];
-    [self applyFilters:appliedFilters];
+    return YES;
 }
 
-- (void)replaceFilters:(NSArray *)filters {
-    NSMutableArray *appliedFilters = self.UAAppliedFilters;
-    [appliedFilters replaceObjectsInRange:NSMakeRange(0, self.UAAppliedFilters.count) withObjectsFromArray:filters];
-    [self applyFilters:appliedFilters];
+- (NSArray *)appliedFilters {
+    return self.UAAppliedFilters;
 }
 
-- (void)clearFilters {
-    [self.UAAppliedFilters removeAllObjects];
-    [self applyFilters:nil];
+- (void)dealloc {
+    if (_forwardedSelectors != NULL) {
+        CFRelease(_forwardedSelectors);
+    }
+    pthread_mutex_destroy(&_forwardedSelectorsLock);
+    pthread_rwlock_destroy(&_lock);
 }
 
-- (void)reapplyFiltersWithoutNotifying {
-    if (self.UAAppliedFilters != nil && self.UAAppliedFilters.count > 0) {
-        [self applyFilters:self.UAAppliedFilters notifications:NO];
+#pragma mark - Metrics
+
+- (void)setCollectsMetrics:(BOOL)collectsMetrics {
+    _collectsMetrics = collectsMetrics;
+    if (!collectsMetrics) {
+        self.pendingMetrics = nil;
+        self.lastMetrics = nil;
+    } else if (self.pendingMetrics == nil) {
+        self.pendingMetrics = [[UAFilterableResultsMetrics alloc] init];
     }
 }
 
-- (void)reapplyFilters {
-    if (self.UAAppliedFilters != nil && self.UAAppliedFilters.count > 0) {
-        [self applyFilters:self.UAAppliedFilters];
-    }
+- (void)setMetricsDelegate:(nullable id<UAFilterableResultsControllerMetricsDelegate>)metricsDelegate {
+    _metricsDelegate = metricsDelegate;
+
+    UAFilterableResultsMetricsDelegateFlags flags;
+    flags.didFinishBatch = [metricsDelegate respondsToSelector:@selector(filterableResultsController:didFinishBatchWithMetrics:)];
+    flags.willBeginInterval = [metricsDelegate respondsToSelector:@selector(filterableResultsController:willBeginInterval:)];
+    flags.didEndInterval = [metricsDelegate respondsToSelector:@selector(filterableResultsController:didEndInterval:)];
+    _metricsDelegateRespondsTo = flags;
 }
 
-- (void)applyFilters:(nullable NSArray *)filters {
-    [self applyFilters:filters notifications:YES];
+- (void)beginMetricsInterval:(UAFilterableResultsMetricsInterval)interval {
+    UAFilterableResultsMetrics *metrics = self.pendingMetrics;
+    if (metrics == nil) {
+        return;
+    }
+
+    id<UAFilterableResultsControllerMetricsDelegate> metricsDelegate = self.metricsDelegate;
+    if (metricsDelegate != nil && self.metricsDelegateRespondsTo.willBeginInterval) {
+        [metricsDelegate filterableResultsController:self willBeginInterval:interval];
+    }
+
+    // start the clock after the hook so it isn't timing itself
+    [metrics beginInterval:interval];
 }
 
-- (void)applyFilters:(NSArray *)filters notifications:(BOOL)notifications {
-    if (filters == nil) {
-        [self setFilteredData:nil notifications:notifications];
+- (void)endMetricsInterval:(UAFilterableResultsMetricsInterval)interval {
+    UAFilterableResultsMetrics *metrics = self.pendingMetrics;
+    if (metrics == nil) {
         return;
     }
-    
-    // nothing to apply to?
-    if (self.UAData == nil) {
+
+    [metrics endInterval:interval];
+
+    id<UAFilterableResultsControllerMetricsDelegate> metricsDelegate = self.metricsDelegate;
+    if (metricsDelegate != nil && self.metricsDelegateRespondsTo.didEndInterval) {
+        [metricsDelegate filterableResultsController:self didEndInterval:interval];
+    }
+}
+
+- (void)finishMetrics {
+    UAFilterableResultsMetrics *metrics = self.pendingMetrics;
+    if (metrics == nil) {
         return;
     }
 
-    // 2D Arrays
-    NSMutableArray *data = self.UAData;
-    if ([self isArrayTwoDimensional:data]) {
-        NSMutableArray *filteredData = [[NSMutableArray alloc] initWithCapacity:data.count];
-        for (NSMutableArray *section in data) {
-            NSMutableArray *filteredSection = [[NSMutableArray alloc] initWithArray:section];
-
-            // apply all of the filters to that section now
-            for (UAFilter *filter in filters) {
-                if (filter.predicate != nil) {
-                    [filteredSection filterUsingPredicate:filter.predicate];
-                }
-            }
+    // the batch isn't over until the delegate has heard about it
+    if (self.pendingDelegateMessages != nil) {
+        [self.pendingDelegateMessages addObject:[^{
+            [self performLockedIfCollectingMetrics:^{ [self finishMetrics]; }];
+        } copy]];
+        return;
+    }
 
-            // and add it to the filtered data
-            [filteredData addObject:filteredSection];
-        }
-        
-        [self setFilteredData:filteredData notifications:notifications];
+    self.pendingMetrics = [metrics metricsContinuingOpenIntervals];
+    self.lastMetrics = metrics;
 
-    // 1D Array
-    } else {
-        NSMutableArray *filteredData = [[NSMutableArray alloc] initWithArray:data];
-        
-        // apply all of the filters to that section now
-        for (UAFilter *filter in filters)
-        {
-            if (filter.predicate != nil) {
-                [filteredData filterUsingPredicate:filter.predicate];
-            }
-        }
-        
-        [self setFilteredData:filteredData notifications:notifications];
+    id<UAFilterableResultsControllerMetricsDelegate> metricsDelegate = self.metricsDelegate;
+    if (metricsDelegate != nil && self.metricsDelegateRespondsTo.didFinishBatch) {
+        [metricsDelegate filterableResultsController:self didFinishBatchWithMetrics:metrics];
     }
 }
 
-- (NSArray *)appliedFilters {
-    return self.UAAppliedFilters;
+#pragma mark - Delegate
+
+- (void)setDelegate:(nullable id<UAFilterableResultsControllerDelegate>)delegate {
+    _delegate = delegate;
+
+    UAFilterableResultsDelegateFlags flags;
+    flags.willChangeContent = [delegate respondsToSelector:@selector(filterableResultsControllerWillChangeContent:)];
+    flags.didChangeObject = [delegate respondsToSelector:@selector(filterableResultsController:didChangeObject:atIndexPath:forChangeType:newIndexPath:)];
+    flags.didChangeSection = [delegate respondsToSelector:@selector(filterableResultsController:didChangeSectionAtIndex:forChangeType:)];
+    flags.didChangeContent = [delegate respondsToSelector:@selector(filterableResultsControllerDidChangeContent:)];
+    flags.didChangeContentWithChangeset = [delegate respondsToSelector:@selector(filterableResultsController:didChangeContentWithChangeset:)];
+    flags.shouldReload = [delegate respondsToSelector:@selector(filterableResultsControllerShouldReload:)];
+    flags.titleForHeader = [delegate respondsToSelector:@selector(filterableResultsController:titleForHeaderInSection:)];
+    flags.titleForFooter = [delegate respondsToSelector:@selector(filterableResultsController:titleForFooterInSection:)];
+    flags.viewForSupplementaryElement = [delegate respondsToSelector:@selector(filterableResultsController:viewForSupplementaryElementOfKind:atIndexPath:)];
+    flags.hasNoDataForLoadingTableView = [delegate respondsToSelector:@selector(filterableResultsController:hasNoDataForLoadingTableView:)];
+    flags.hasNoDataForLoadingCollectionView = [delegate respondsToSelector:@selector(filterableResultsController:hasNoDataForLoadingCollectionView:)];
+    _delegateRespondsTo = flags;
+
+    // anything we worked out about forwarding was for the old delegate
+    pthread_mutex_lock(&_forwardedSelectorsLock);
+    if (_forwardedSelectors != NULL) {
+        CFDictionaryRemoveAllValues(_forwardedSelectors);
+    }
+    pthread_mutex_unlock(&_forwardedSelectorsLock);
 }
 
 #pragma mark - Delegate Notifications
 
 - (void)beginUpdates {
+    if ([self performChange:^{ [self beginUpdates]; }]) {
+        return;
+    }
+
     [self notifyBeginChanges];
 }
 
@@ -932,11 +3504,20 @@ NS_ASSUME_NONNULL_BEGIN
     if (self.changeBatches == 0) {
         // Notify the delegate of the impending change
         id<UAFilterableResultsControllerDelegate> delegate = self.delegate;
-        if (delegate != nil && [delegate respondsToSelector:@selector(filterableResultsControllerWillChangeContent:)]) {
-            [delegate filterableResultsControllerWillChangeContent:self];
+        if (delegate != nil && self.delegateRespondsTo.willChangeContent) {
+            [self.pendingMetrics recordNotification];
+            [self deliverDelegateMessage:^{
+                [delegate filterableResultsControllerWillChangeContent:self];
+            }];
         }
         
         self.indexPathNotificationMapping = [NSMutableDictionary dictionary];
+        self.changedFilteredDataIncrementally = NO;
+
+        // delegates that take the whole batch at once get a changeset instead of a message per row
+        if (delegate != nil && self.delegateRespondsTo.didChangeContentWithChangeset) {
+            self.pendingChangeset = [[UAFilterableResultsChangeset alloc] init];
+        }
     }
     self.changeBatches = (self.changeBatches + 1);
 //    NSLog(@"Change batches: %li", (long)self.changeBatches);
@@ -956,13 +3537,23 @@ NS_ASSUME_NONNULL_BEGIN
         return;
     }
     
+    UAFilterableResultsChangeset *changeset = self.pendingChangeset;
+    if (changeset != nil) {
+        [self.pendingMetrics recordNotification];
+        [changeset recordChangeAtIndexPath:indexPath forChangeType:type newIndexPath:newIndexPath];
+        return;
+    }
+
     id<UAFilterableResultsControllerDelegate> delegate = self.delegate;
-    if (delegate != nil && [delegate respondsToSelector:@selector(filterableResultsController:didChangeObject:atIndexPath:forChangeType:newIndexPath:)]) {
-        [delegate filterableResultsController:self
-                              didChangeObject:object
-                                  atIndexPath:indexPath
-                                forChangeType:type
-                                 newIndexPath:newIndexPath];
+    if (delegate != nil && self.delegateRespondsTo.didChangeObject) {
+        [self.pendingMetrics recordNotification];
+        [self deliverDelegateMessage:^{
+            [delegate filterableResultsController:self
+                                  didChangeObject:object
+                                      atIndexPath:indexPath
+                                    forChangeType:type
+                                     newIndexPath:newIndexPath];
+        }];
     }
 }
 
@@ -1003,73 +3594,21 @@ NS_ASSUME_NONNULL_BEGIN
         }
     }
     
-    id<UAFilterableResultsControllerDelegate> delegate = self.delegate;
-    if (delegate != nil && [delegate respondsToSelector:@selector(filterableResultsController:didChangeSectionAtIndex:forChangeType:)]) {
-        [delegate filterableResultsController:self
-                      didChangeSectionAtIndex:sectionIndex
-                                forChangeType:type];
-    }
-}
-
-- (void)notifyForChangesForSectionAtIndex:(NSInteger)sectionIndex from:(NSArray *)fromArray to:(NSArray *)toArray {
-    if (![self areUpdatesEnabled]) {
+    UAFilterableResultsChangeset *changeset = self.pendingChangeset;
+    if (changeset != nil) {
+        [self.pendingMetrics recordNotification];
+        [changeset recordChangeForSectionAtIndex:sectionIndex forChangeType:type];
         return;
     }
-    
-    // move everything that exists in both arrays into a mutable array, notify for all the others
-    NSMutableArray *fromMutable = [[NSMutableArray alloc] initWithCapacity:0];
-    for (NSUInteger rowIndex = 0; rowIndex < fromArray.count; rowIndex++) {
-        id obj = fromArray[rowIndex];
-        
-        // if it exists in the target we add it
-        if ([self indexPathOfObject:obj inArray:toArray usingKeyPath:nil] != nil) {
-            [fromMutable addObject:obj];
-        }
-        
-        // otherwise, we notify about it
-        else {
-            NSIndexPath * indexP = [NSIndexPath indexPathForRow:(NSInteger)rowIndex
-                                                      inSection:[self originalSectionIndexForIndex:(NSInteger)sectionIndex]];
-            [self notifyChangedObject:obj
-                          atIndexPath:indexP
-                        forChangeType:UAFilterableResultsChangeDelete
-                         newIndexPath:nil];
-        }
-    }
-    
-    // now that thats over, we need to loop over the target array and note anything that isn't in the same place as last time
-    for (NSUInteger rowIndex = 0; rowIndex < toArray.count; rowIndex++) {
-        id obj = toArray[rowIndex];
-        
-        // alrighty, does this object exist in the old one?
-        NSUInteger indexInExisting = [self indexOfObject:obj inArray:fromArray usingKeyPath:nil];
-        if (indexInExisting == NSNotFound) {
-            // nope, lets notify about it
-            NSIndexPath *newIP = [NSIndexPath indexPathForRow:(NSInteger)rowIndex inSection:[self originalSectionIndexForIndex:(NSInteger)sectionIndex]];
-            [self notifyChangedObject:obj
-                          atIndexPath:nil
-                        forChangeType:UAFilterableResultsChangeInsert
-                         newIndexPath:newIP];
-            
-        // is it the same as where we are now?
-        } else if (indexInExisting == (NSInteger)rowIndex) {
-            
-            NSIndexPath * ip = [NSIndexPath indexPathForRow:(NSInteger)rowIndex inSection:[self originalSectionIndexForIndex:(NSInteger)sectionIndex]];
-            [self notifyChangedObject:obj
-                          atIndexPath:ip
-                        forChangeType:UAFilterableResultsChangeUpdate
-                         newIndexPath:nil];
-        }
-        
-        // nope, tell them where it is now
-        else {
-            NSIndexPath * ipInExisting = [NSIndexPath indexPathForRow:(NSInteger)indexInExisting inSection:[self originalSectionIndexForIndex:(NSInteger)sectionIndex]];
-            NSIndexPath * newIP = [NSIndexPath indexPathForRow:(NSInteger)rowIndex inSection:(NSInteger)sectionIndex];
-            [self notifyChangedObject:obj
-                          atIndexPath:ipInExisting
-                        forChangeType:UAFilterableResultsChangeMove
-                         newIndexPath:newIP];
-        }
+
+    id<UAFilterableResultsControllerDelegate> delegate = self.delegate;
+    if (delegate != nil && self.delegateRespondsTo.didChangeSection) {
+        [self.pendingMetrics recordNotification];
+        [self deliverDelegateMessage:^{
+            [delegate filterableResultsController:self
+                          didChangeSectionAtIndex:sectionIndex
+                                    forChangeType:type];
+        }];
     }
 }
 
@@ -1088,18 +3627,28 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (void)notifyReload {
     
-    if (![self areUpdatesEnabled]) {
-        return;
+    if ([self areUpdatesEnabled]) {
+        // the only one we can send without being fully loaded
+        id<UAFilterableResultsControllerDelegate> delegate = self.delegate;
+        if (delegate != nil && self.delegateRespondsTo.shouldReload) {
+            [self.pendingMetrics recordNotification];
+            [self deliverDelegateMessage:^{
+                [delegate filterableResultsControllerShouldReload:self];
+            }];
+        }
     }
-    
-    // the only one we can send without being fully loaded
-    id<UAFilterableResultsControllerDelegate> delegate = self.delegate;
-    if (delegate != nil && [delegate respondsToSelector:@selector(filterableResultsControllerShouldReload:)]) {
-        [delegate filterableResultsControllerShouldReload:self];
+
+    // a reload outside of a batch is the end of one as far as the metrics are concerned
+    if (self.changeBatches == 0) {
+        [self finishMetrics];
     }
 }
 
 - (void)endUpdates {
+    if ([self performChange:^{ [self endUpdates]; }]) {
+        return;
+    }
+
     
     [self notifyEndChanges];
 }
@@ -1123,7 +3672,8 @@ NS_ASSUME_NONNULL_BEGIN
     // we only notify for the outer one, not the inner ones
     if (self.changeBatches == 0) {
         
-        if (self.appliedFilters != nil && self.appliedFilters.count > 0) {
+        // reapply the filters unless every change in the batch was already applied to the filtered data
+        if (self.appliedFilters != nil && self.appliedFilters.count > 0 && (self.filteredDataIsStale || !self.changedFilteredDataIncrementally)) {
             
             // increment it again lest the count is out
             self.changeBatches = 1;
@@ -1137,11 +3687,33 @@ NS_ASSUME_NONNULL_BEGIN
         
         self.indexPathNotificationMapping = nil;
 
+        [self notifyChangeset];
+
         // Notify the delegate of the impending change
         id delegate = self.delegate;
-        if (delegate != nil && [delegate respondsToSelector:@selector(filterableResultsControllerDidChangeContent:)]) {
-            [delegate filterableResultsControllerDidChangeContent:self];
+        if (delegate != nil && self.delegateRespondsTo.didChangeContent) {
+            [self.pendingMetrics recordNotification];
+            [self deliverDelegateMessage:^{
+                [delegate filterableResultsControllerDidChangeContent:self];
+            }];
         }
+
+        [self finishMetrics];
+    }
+}
+
+- (void)notifyChangeset {
+    UAFilterableResultsChangeset *changeset = self.pendingChangeset;
+    if (changeset == nil) {
+        return;
+    }
+    self.pendingChangeset = nil;
+
+    id delegate = self.delegate;
+    if (delegate != nil && self.delegateRespondsTo.didChangeContentWithChangeset) {
+        [self deliverDelegateMessage:^{
+            [(id<UAFilterableResultsControllerChangesetDelegate>)delegate filterableResultsController:self didChangeContentWithChangeset:changeset];
+        }];
     }
 }
 
@@ -1161,214 +3733,18 @@ NS_ASSUME_NONNULL_BEGIN
     
     // we only notify for the outer one, not the inner ones
     if (self.changeBatches == 0) {
+        [self notifyChangeset];
+
         // Notify the delegate of the impending change
         id delegate = self.delegate;
-        if (delegate != nil && [delegate respondsToSelector:@selector(filterableResultsControllerDidChangeContent:)]) {
-            [delegate filterableResultsControllerDidChangeContent:self];
-        }
-    }
-}
-
-- (void)notifyForChangesFrom:(NSArray *)fromArray to:(NSArray *)toArray {
-    if (![self areUpdatesEnabled]) {
-        return;
-    }
-    
-    // do we have a primary key? we use an optimised version of this approach if so.
-    if (self.primaryKeyPath != nil) {
-        [self notifyForChangesFrom:fromArray to:toArray usingKeyPath:self.primaryKeyPath];
-        return;
-    }
-
-    // we need to make sure they're both 2 dimensional
-    if (![self isArrayTwoDimensional:fromArray]) {
-        fromArray = @[ fromArray ];
-    }
-    if (![self isArrayTwoDimensional:toArray]) {
-        toArray = @[ toArray ];
-    }
-    
-    // move everything that exists in both arrays into a mutable array, notify for all the others
-    NSMutableArray *fromMutable = [[NSMutableArray alloc] initWithCapacity:fromArray.count];
-    for (NSUInteger sectionIndex = 0; sectionIndex < fromArray.count; sectionIndex++) {
-        
-        NSArray *section = fromArray[sectionIndex];
-        NSMutableArray *newSection = [[NSMutableArray alloc] initWithCapacity:0];
-        for (NSUInteger rowIndex = 0; rowIndex < section.count; rowIndex++) {
-            
-            id obj = section[rowIndex];
-
-            // if it exists in the target we add it
-            if ([self indexPathOfObject:obj inArray:toArray usingKeyPath:nil] != nil) {
-                [newSection addObject:obj];
-            }
-            
-            // otherwise, we notify about it
-            else {
-                [self notifyChangedObject:obj
-                              atIndexPath:[NSIndexPath indexPathForRow:(NSInteger)rowIndex inSection:(NSInteger)sectionIndex]
-                            forChangeType:UAFilterableResultsChangeDelete newIndexPath:nil];
-            }
-        }
-        
-        [fromMutable addObject:newSection];
-        newSection = nil;
-    }
-
-    // now that thats over, we need to loop over the target array and note anything that isn't in the same place as last time
-    for (NSUInteger sectionIndex = 0; sectionIndex < toArray.count; sectionIndex++) {
-        // now loop over the section
-        NSArray *section = toArray[sectionIndex];
-        for (NSUInteger rowIndex = 0; rowIndex < section.count; rowIndex++) {
-            
-            id obj = section[rowIndex];
-            
-            // alrighty, does this object exist in the old one?
-            NSIndexPath *pathInExisting = [self indexPathOfObject:obj inArray:fromArray usingKeyPath:nil];
-            if (pathInExisting == nil) {
-                // nope, lets notify about it
-                [self notifyChangedObject:obj
-                              atIndexPath:nil
-                            forChangeType:UAFilterableResultsChangeInsert
-                             newIndexPath:[NSIndexPath indexPathForRow:(NSInteger)rowIndex inSection:(NSInteger)sectionIndex]];
-                
-                // does this section exist?
-                if (sectionIndex+1 > fromMutable.count) {
-                    [fromMutable addObject:[[NSMutableArray alloc] initWithCapacity:0]];
-                }
-                
-                NSMutableArray *fromSection = [fromMutable objectAtIndex:sectionIndex];
-                [fromSection insertObject:obj atIndex:rowIndex];
-
-                // is it the same as where we are now?
-            } else if (pathInExisting.section == (NSInteger)sectionIndex && pathInExisting.row == (NSInteger)rowIndex) {
-                
-                [self notifyChangedObject:obj
-                              atIndexPath:[self indexPathOfObject:obj inArray:fromArray usingKeyPath:nil]
-                            forChangeType:UAFilterableResultsChangeUpdate
-                             newIndexPath:nil];
-                
-            } else { // nope, tell them where it is now
-                [self notifyChangedObject:obj
-                              atIndexPath:pathInExisting
-                            forChangeType:UAFilterableResultsChangeMove
-                             newIndexPath:[NSIndexPath indexPathForRow:(NSInteger)rowIndex inSection:(NSInteger)sectionIndex]];
-            }
+        if (delegate != nil && self.delegateRespondsTo.didChangeContent) {
+            [self.pendingMetrics recordNotification];
+            [self deliverDelegateMessage:^{
+                [delegate filterableResultsControllerDidChangeContent:self];
+            }];
         }
-    }
-}
-
-- (void)notifyForChangesFrom:(NSArray *)fromArray to:(NSArray *)toArray usingKeyPath:(NSString *)keyPath {
-    if (![self areUpdatesEnabled]) {
-        return;
-    }
-    
-    // we need to make sure they're both 2 dimensional
-    if (![self isArrayTwoDimensional:fromArray]) {
-        fromArray = @[ fromArray ];
-    }
-    if (![self isArrayTwoDimensional:toArray]) {
-        toArray = @[ toArray ];
-    }
-    
-    // refine it down to just the key paths, if an exception is thrown anywhere there we fall back to the non-optimised method
-    NSArray *originalFromArray = [fromArray copy];
-    NSArray *originalToArray = [toArray copy];
-    @try {
-        fromArray = [fromArray valueForKeyPath:keyPath];
-        toArray = [toArray valueForKeyPath:keyPath];
-        keyPath = nil;
 
-    } @catch (NSException *exception) {
-        // go back to the originals
-        fromArray = originalFromArray;
-        toArray = originalToArray;
-    }
-
-    // copy the primary keys from everything that exists in both arrays into a mutable array, notify for all the others
-    NSMutableArray *fromMutable = [[NSMutableArray alloc] initWithCapacity:fromArray.count];
-    for (NSUInteger sectionIndex = 0; sectionIndex < fromArray.count; sectionIndex++) {
-        
-        // does this section exist in the target?
-        if (sectionIndex >= toArray.count) {
-            // nope, deleted
-            [self notifyChangedSectionAtIndex:sectionIndex forChangeType:UAFilterableResultsChangeDelete];
-            continue;
-        }
-        
-        NSArray *section = fromArray[sectionIndex];
-        NSArray *originalSection = originalFromArray[sectionIndex];
-        NSMutableArray *newSection = [[NSMutableArray alloc] initWithCapacity:0];
-        for (NSUInteger rowIndex = 0; rowIndex < section.count; rowIndex++) {
-            id obj = section[rowIndex];
-            
-            // if it exists in the target we add it
-            if ([self indexPathOfObject:obj inArray:toArray usingKeyPath:keyPath] != nil) {
-                [newSection addObject:obj];
-            }
-            
-            // otherwise, we notify about it
-            else {
-                [self notifyChangedObject:[originalSection objectAtIndex:rowIndex]
-                              atIndexPath:[NSIndexPath indexPathForRow:(NSInteger)rowIndex inSection:(NSInteger)sectionIndex]
-                            forChangeType:UAFilterableResultsChangeDelete
-                             newIndexPath:nil];
-            }
-        }
-        
-        [fromMutable addObject:newSection];
-        newSection = nil;
-    }
-    
-    // now that thats over, we need to loop over the target array and note anything that isn't in the same place as last time
-    for (NSUInteger sectionIndex = 0; sectionIndex < toArray.count; sectionIndex++) {
-        // does this section exist in the source?
-        if (sectionIndex >= fromArray.count) {
-            // nope, lets just add the whole thing in
-            [self notifyChangedSectionAtIndex:sectionIndex forChangeType:UAFilterableResultsChangeInsert];
-            continue;
-        }
-        
-        // now loop over the section
-        NSArray *section = toArray[sectionIndex];
-        NSArray *originalSection = originalToArray[sectionIndex];
-        for (NSUInteger rowIndex = 0; rowIndex < section.count; rowIndex++) {
-            
-            id obj = section[rowIndex];
-            
-            // alrighty, does this object exist in the old one?
-            NSIndexPath *pathInExisting = [self indexPathOfObject:obj inArray:fromMutable usingKeyPath:keyPath];
-            if (pathInExisting == nil) {
-                
-                // nope, lets notify about it
-                [self notifyChangedObject:originalSection[rowIndex]
-                              atIndexPath:nil
-                            forChangeType:UAFilterableResultsChangeInsert
-                             newIndexPath:[NSIndexPath indexPathForRow:(NSInteger)rowIndex inSection:(NSInteger)sectionIndex]];
-                
-                // does this section exist?
-                if (sectionIndex+1 > fromMutable.count) {
-                    [fromMutable addObject:[[NSMutableArray alloc] initWithCapacity:0]];
-                }
-                
-                NSMutableArray *fromSection = fromMutable[sectionIndex];
-                [fromSection insertObject:obj atIndex:rowIndex];
-                
-            // is it the same as where we are now?
-            } else if (pathInExisting.section == (NSInteger)sectionIndex && pathInExisting.row == (NSInteger)rowIndex) {
-                [self notifyChangedObject:originalSection[rowIndex]
-                              atIndexPath:[self indexPathOfObject:obj inArray:fromArray usingKeyPath:keyPath]
-                            forChangeType:UAFilterableResultsChangeUpdate
-                             newIndexPath:nil];
-            }
-            
-            // nope, tell them where it is now
-            else {
-                [self notifyChangedObject:originalSection[rowIndex]
-                              atIndexPath:pathInExisting forChangeType:UAFilterableResultsChangeMove
-                             newIndexPath:[NSIndexPath indexPathForRow:(NSInteger)rowIndex inSection:(NSInteger)sectionIndex]];
-            }
-        }
+        [self finishMetrics];
     }
 }
 
@@ -1380,46 +3756,40 @@ NS_ASSUME_NONNULL_BEGIN
     }
     
     // if we don't support it but it is an obvious UICollectionViewDataSource or UITableViewDataSource method we should try forwarding it
-    id delegate = self.delegate;
-    
-    // nothing to forward to
-    if (delegate == nil) {
-        return NO;
-    }
-    
-    NSString *selectorName = NSStringFromSelector(aSelector);
-    if ([selectorName rangeOfString:@"tableView:"].location == 0 || [selectorName rangeOfString:@"collectionView:"].location == 0) {
-        
-        // it is for a collection view or table view method, see if we can pass it
-        if ([delegate respondsToSelector:aSelector]) {
-            return YES;
-        }
-    }
-    
-    // nothing supported
-    return NO;
+    return [self forwardingTargetForSelector:aSelector] != nil;
 }
 
-- (id)forwardingTargetForSelector:(SEL)aSelector {
-    // if we don't support it but it is an obvious UICollectionViewDataSource or UITableViewDataSource method we should try forwarding it
+- (nullable id)forwardingTargetForSelector:(SEL)aSelector {
     id delegate = self.delegate;
     
     // nothing to forward to
     if (delegate == nil) {
         return nil;
     }
-    
-    NSString *selectorName = NSStringFromSelector(aSelector);
-    if ([selectorName rangeOfString:@"tableView:"].location == 0 || [selectorName rangeOfString:@"collectionView:"].location == 0)
-    {
-        // it is for a collection view or table view method, see if we can pass it
-        if ([delegate respondsToSelector:aSelector]) {
-            return delegate;
+
+    // UITableView and UICollectionView ask about the same handful of selectors over and over, so we only work each one out once per delegate
+    pthread_mutex_lock(&_forwardedSelectorsLock);
+    if (_forwardedSelectors == NULL) {
+        _forwardedSelectors = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, NULL, NULL);
+    }
+    CFBooleanRef forwards = (CFBooleanRef)CFDictionaryGetValue(_forwardedSelectors, (const void *)aSelector);
+    pthread_mutex_unlock(&_forwardedSelectorsLock);
+
+    if (forwards == NULL) {
+        // it has to be for a collection view or table view method, and the delegate has to implement it. We ask without the lock
+        // held, in case the delegate asks us something in turn.
+        const char *selectorName = sel_getName(aSelector);
+        BOOL isDataSourceMethod = (strncmp(selectorName, "tableView:", 10) == 0 || strncmp(selectorName, "collectionView:", 15) == 0);
+        forwards = (isDataSourceMethod && [delegate respondsToSelector:aSelector]) ? kCFBooleanTrue : kCFBooleanFalse;
+
+        pthread_mutex_lock(&_forwardedSelectorsLock);
+        if (delegate == self.delegate) {
+            CFDictionarySetValue(_forwardedSelectors, (const void *)aSelector, forwards);
         }
+        pthread_mutex_unlock(&_forwardedSelectorsLock);
     }
     
-    // nothing supported
-    return nil;
+    return (forwards == kCFBooleanTrue) ? delegate : nil;
 }
 
 @end
@@ -6,9 +6,12 @@
 //  Copyright (c) 2013 Desto. All rights reserved.
 //
 
-@import Foundation;
+#import <Foundation/Foundation.h>
 #import "UAFilterableResultsControllerDelegate.h"
 #import "UAFilter.h"
+#import "UAFilterableResultsMetrics.h"
+#import "UAFilterableResultsSnapshot.h"
+#import "UAFilterableResultsDataProvider.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -113,6 +116,24 @@ NS_ASSUME_NONNULL_BEGIN
 **/
 - (void)setData:(nullable NSArray * )data;
 
+/**
+ * Replaces the entire data array with the supplied data, doing the expensive work away from the main thread.
+ *
+ * The data is copied, filtered and compared with the existing data on a background queue. The changes are then applied on
+ * the main queue and your delegate notified of them in a single batch, exactly as they would be by -setData:.
+ *
+ * If this is called again before an earlier call has finished, the earlier call is abandoned and its completion block is
+ * called with NO. If the data or filters are changed on the main thread while the work is in progress, the new data is
+ * applied with -setData: instead so the changes are always correct.
+ *
+ * This must be called on the main thread, or the -delegateQueue if you have changed it, which is also where the results are
+ * applied. Your objects (and any filter predicates) must be safe to read from a background thread.
+ *
+ * @param   data                    A one or two dimensional array of data objects.
+ * @param   completion              An optional block called on the main queue once the data has been applied (finished is YES) or abandoned (finished is NO).
+**/
+- (void)setData:(nullable NSArray *)data completion:(nullable void (^)(BOOL finished))completion;
+
 /**
  * Replaces existing objects in the array with the supplied objects.
  *
@@ -133,18 +154,34 @@ NS_ASSUME_NONNULL_BEGIN
  * The delegate will be notified of the changes to the objects, allowing you to animate the changes to your table or collection view.
  *
  * @param   arrayOfObjects          An NSArray of objects.
- * @param   sortKeyPath             A key path to sort the objects by. compare: will be called on the values at this keypath.
+ * @param   sortKeyPath             A key path (or comma separated key paths) to sort the objects by. compare: will be called on the values at this keypath.
  * @param   options                 A mask of NSStringCompareOptions to use during the sort.
 **/
 - (void)setData:(NSArray *)arrayOfObjects sortKeyPath:(NSString *)sortKeyPath sortOptions:(NSStringCompareOptions)options;
 
 /**
  * Returns the data arrays as are they currently used without any applied filters.
+ *
+ * These are the arrays the controller changes in place, so use -snapshot if you need to read them from another thread.
 **/
 - (NSArray *)data;
 
+/**
+ * Returns an immutable view of the data as it is right now, without any applied filters.
+ *
+ * This is O(1): the snapshot shares the controller's arrays, and each one is only copied if the controller is about to change
+ * it while the snapshot is still around. Asking again before the data changes returns the same snapshot. The snapshot is safe
+ * to read from any thread. Paged data carries on being fetched a page at a time as the snapshot is read.
+ *
+ * @returns                         A snapshot of the data, or nil if there is no data.
+**/
+- (nullable UAFilterableResultsSnapshot *)snapshot;
+
 /**
  * Returns all of the objects in the data arrays as a flattened one dimensional array.
+ *
+ * For two dimensional data this is a read-only view over the sections rather than a copy of them, so it is cheap to
+ * create and enumerate. It reflects later changes to the data, so -copy it if you need a snapshot.
 **/
 - (NSArray *)allObjects;
 
@@ -301,9 +338,16 @@ NS_ASSUME_NONNULL_BEGIN
 
 /**
  * Returns the total number of objects currently within the results controller.
+ *
+ * The section sizes are totalled as the data changes, so this does not need to count every section.
 **/
 - (NSUInteger)numberOfObjects;
 
+/**
+ * Returns the total number of objects that pass the applied filters, or -numberOfObjects if there are no filters.
+**/
+- (NSUInteger)numberOfFilteredObjects;
+
 /**
  * Merges the existing matching objects in the array with the supplied objects.
  *
@@ -319,11 +363,80 @@ NS_ASSUME_NONNULL_BEGIN
  * The delegate will be notified of the changes to the objects, allowing you to animate the changes to your table or collection view.
  *
  * @param   arrayOfObjects          An NSArray of objects.
- * @param   sortKeyPath             A key path to sort the objects by. compare: will be called on the values at this keypath.
+ * @param   sortKeyPath             A key path (or comma separated key paths) to sort the objects by. compare: will be called on the values at this keypath.
  * @param   options                 A mask of NSStringCompareOptions to use during the sort.
 **/
 - (void)mergeObjects:(NSArray *)arrayOfObjects sortKeyPath:(NSString *)sortKeyPath sortOptions:(NSStringCompareOptions)options;
 
+/**
+ * Whether -setData:sortKeyPath:sortOptions: and -mergeObjects:sortKeyPath:sortOptions: sort on all available cores.
+ *
+ * The values at the sort key paths are always read once per object up front. When YES and there are at least
+ * -parallelSortingThreshold objects, chunks of them are then sorted at the same time and merged back together. The values
+ * must be safe to compare from multiple threads. This is set to NO by default.
+**/
+@property (nonatomic) BOOL sortsInParallel;
+
+/**
+ * The number of objects below which sorting is always done serially, even when -sortsInParallel is YES. This is set to 10,000 by default.
+**/
+@property (nonatomic) NSUInteger parallelSortingThreshold;
+
+/** @name Sorted Data **/
+
+/**
+ * A comparator that the data is kept sorted by. This is nil (and the data is kept in the order you supply it) by default.
+ *
+ * When it is set the existing data is sorted straight away, and from then on:
+ *  - -setData: and -setData:completion: sort each section of the new data before it is used;
+ *  - -addObject: and -addObject:inSection: find the object's place in the section with a binary search and insert it there;
+ *  - replacing an object that no longer belongs where it was moves it to its new place, as a single Move rather than a reload;
+ *  - -mergeObjects: (and the other merge methods, whatever comparator they are given) merge by this comparator, placing each
+ *    object by binary search when the batch is small compared with the data, or merging the lot in one pass when it isn't.
+ *
+ * Each change to a single object costs O(log n) comparisons to place. Objects that compare the same keep the order they were
+ * added in. Sections added with the section methods are used as they are, and paged data is never sorted.
+ *
+ * The comparator must be safe to call from a background thread if you use -setData:completion:.
+**/
+@property (nonatomic, copy, nullable) NSComparator sortComparator;
+
+/**
+ * An array of NSSortDescriptor objects that the data is kept sorted by, in order of precedence. Setting this sets the
+ * -sortComparator to one that compares by each of the descriptors in turn, and setting the -sortComparator clears it.
+**/
+@property (nonatomic, copy, nullable) NSArray *sortDescriptors;
+
+/** @name Sectioning Data **/
+
+/**
+ * A key path that the data is grouped into sections by, like the sectionNameKeyPath of an NSFetchedResultsController. This is nil
+ * (and the data keeps the sections you supply) by default.
+ *
+ * When it is set the existing data is regrouped straight away, and from then on:
+ *  - -setData: and -setData:completion: flatten the new data and group it into one section for each value at the key path,
+ *    in ascending order of the values (compared using compare:, with nil first);
+ *  - -addObject: finds the section for the object's value, or inserts a new section in its place if there isn't one yet;
+ *  - removing the last object in a section removes the section;
+ *  - replacing an object with one that has a different value moves it to the section for that value, as a Delete and an Insert.
+ *
+ * Sections that are created or removed are notified through -filterableResultsController:didChangeSectionAtIndex:forChangeType:.
+ * Finding an object's section is O(1), and placing a new section is O(log sections). Within each section the objects keep the
+ * order you give them, or the -sortComparator order if there is one. Sections added with the section methods are used as they
+ * are, and paged data is never sectioned.
+ *
+ * The key path is read from a background thread if you use -setData:completion:.
+**/
+@property (nonatomic, copy, nullable) NSString *sectionKeyPath;
+
+/**
+ * Returns the value at the -sectionKeyPath shared by the objects in a section.
+ *
+ * @param   sectionIndex            The index of the section in the unfiltered data.
+ * @returns                         The section's value, or nil if the objects have no value, the section is empty or there is no -sectionKeyPath.
+**/
+- (nullable id)sectionValueAtIndex:(NSUInteger)sectionIndex;
+
 /** @name Batching Updates **/
 
 /**
@@ -442,6 +555,62 @@ NS_ASSUME_NONNULL_BEGIN
 **/
 - (nullable NSIndexPath *)filteredIndexPathOfObjectWithPrimaryKey:(id)key;
 
+/**
+ * Returns the index path of the object at the specified position in the raw data, counting across every section in order.
+ *
+ * This is useful for mapping a position in a flattened list of the objects back to a section and row, and takes time
+ * proportional to the logarithm of the number of sections.
+ *
+ * @param   offset                  The position of the object, where zero is the first row of the first section.
+ * @returns                         An NSIndexPath to the object, or nil if the offset is beyond the last object.
+**/
+- (nullable NSIndexPath *)indexPathOfObjectAtOffset:(NSUInteger)offset;
+
+/**
+ * Returns the index path of the object at the specified position in the filtered data, counting across every section in order.
+ *
+ * @param   offset                  The position of the object, where zero is the first row of the first filtered section.
+ * @returns                         An NSIndexPath to the object, or nil if the offset is beyond the last filtered object.
+**/
+- (nullable NSIndexPath *)filteredIndexPathOfObjectAtOffset:(NSUInteger)offset;
+
+/**
+ * Returns the position of the object at the specified index path of the raw data, counting across every section in order.
+ *
+ * @param   indexPath               The NSIndexPath of the object.
+ * @returns                         The position of the object, or NSNotFound if the index path is not valid.
+**/
+- (NSUInteger)offsetOfObjectAtIndexPath:(NSIndexPath *)indexPath;
+
+/**
+ * Returns the position of the object at the specified index path of the filtered data, counting across every section in order.
+ *
+ * @param   indexPath               The NSIndexPath of the object, as supplied to your table or collection views.
+ * @returns                         The position of the object, or NSNotFound if the index path is not valid.
+**/
+- (NSUInteger)filteredOffsetOfObjectAtIndexPath:(NSIndexPath *)indexPath;
+
+/**
+ * Returns where the object at the specified index path of the raw data appears in the filtered data.
+ *
+ * The filtered data is kept as the rows of each raw section that pass the filters, so this is a binary search within the
+ * section rather than a search for the object. If no filters are applied the index path is returned unchanged.
+ *
+ * @param   indexPath               The NSIndexPath of the object in the raw data.
+ * @returns                         The NSIndexPath of the object in the filtered data, or nil if it is filtered out.
+**/
+- (nullable NSIndexPath *)filteredIndexPathForIndexPath:(NSIndexPath *)indexPath;
+
+/**
+ * Returns where the object at the specified index path of the filtered data is in the raw data.
+ *
+ * This is a single lookup of the row the filtered object came from. If no filters are applied the index path is returned unchanged.
+ *
+ * @param   filteredIndexPath       The NSIndexPath of the object, as supplied to your table or collection views.
+ * @returns                         The NSIndexPath of the object in the raw data, or nil if the filtered index path is not valid.
+**/
+- (nullable NSIndexPath *)indexPathForFilteredIndexPath:(NSIndexPath *)filteredIndexPath;
+
 /** @name Manipulating Sections **/
 
 /**
@@ -574,6 +743,133 @@ NS_ASSUME_NONNULL_BEGIN
 **/
 - (NSArray *)appliedFilters;
 
+/**
+ * Adds a filter, doing the evaluation and comparison away from the main thread.
+ *
+ * Each change to the filters gets a new generation. The filters are evaluated and the new filtered data compared with what
+ * is displayed on a background queue, and the result is applied on the main queue and your delegate notified of the changes
+ * in a single batch, exactly as -addFilter: would.
+ *
+ * When another change to the filters arrives (from any of the filtering methods) the earlier work notices part way through
+ * and gives up, and its completion block is called with NO. Only the latest filters ever reach your delegate, so this is
+ * the one to use for search-as-you-type. Filters added this way are built on by later calls, even before they are applied,
+ * but -appliedFilters doesn't return them until they have been.
+ *
+ * If the data is changed while the work is in progress, they are applied on the main thread instead so the changes
+ * are always correct.
+ *
+ * This must be called on the main thread, or the -delegateQueue if you have changed it, which is also where the results are
+ * applied. Your objects and filter predicates must be safe to read from a background thread.
+ *
+ * @param   filter                  The UAFilter to add. If there is an existing filter with the same group it will be replaced.
+ * @param   completion              An optional block called on the main queue once the filters have been applied (finished is YES) or superseded (finished is NO).
+**/
+- (void)addFilter:(UAFilter *)filter completion:(nullable void (^)(BOOL finished))completion;
+
+/**
+ * Replaces the existing filters, doing the evaluation and comparison away from the main thread. See -addFilter:completion:.
+ *
+ * @param   filters                 An NSArray of UAFilter objects.
+ * @param   completion              An optional block called on the main queue once the filters have been applied (finished is YES) or superseded (finished is NO).
+**/
+- (void)replaceFilters:(NSArray *)filters completion:(nullable void (^)(BOOL finished))completion;
+
+/**
+ * Removes all of the existing filters, comparing the data away from the main thread. See -addFilter:completion:.
+ *
+ * @param   completion              An optional block called on the main queue once the filters have been removed (finished is YES) or superseded (finished is NO).
+**/
+- (void)clearFiltersWithCompletion:(nullable void (^)(BOOL finished))completion;
+
+/**
+ * Whether filters are evaluated concurrently on all available cores.
+ *
+ * When YES and the data has at least -parallelFilteringThreshold objects, the data is split into chunks (across sections, and
+ * within large sections) that are evaluated against each predicate at the same time, and the results are stitched back
+ * together in their original order. Your predicates, and any properties they read from your objects, must be safe to use from
+ * multiple threads. This is set to NO by default.
+**/
+@property (nonatomic) BOOL filtersInParallel;
+
+/**
+ * The number of objects below which filters are always evaluated serially, even when -filtersInParallel is YES, because the
+ * overhead of splitting the work up outweighs the gain. This is set to 10,000 by default.
+**/
+@property (nonatomic) NSUInteger parallelFilteringThreshold;
+
+/** @name Metrics **/
+
+/**
+ * Whether the controller measures how long it spends copying, diffing, filtering and notifying, and counts the work it does.
+ *
+ * Collecting metrics costs a few clock reads for every change, so it is set to NO by default. See UAFilterableResultsMetrics
+ * for what is measured and when each batch ends.
+**/
+@property (nonatomic) BOOL collectsMetrics;
+
+/**
+ * An object that is told about the metrics of each batch as it ends. Only used when -collectsMetrics is YES.
+**/
+@property (nonatomic, weak, nullable) id<UAFilterableResultsControllerMetricsDelegate> metricsDelegate;
+
+/**
+ * The metrics of the most recent batch to end, or nil if none have ended since -collectsMetrics was turned on.
+**/
+@property (nonatomic, strong, readonly, nullable) UAFilterableResultsMetrics *lastMetrics;
+
+/** @name Paged Data **/
+
+/**
+ * Sets the controller's data from a data provider, which is asked for it a page at a time as rows are read.
+ *
+ * Use this instead of -setData: when there is too much data to hold in memory at once. Only the counts are read up front,
+ * so the table or collection view can load straight away, and no more than maximumResidentPages pages are kept at any time.
+ *
+ * Replacing paged data always reloads rather than working out the differences, as that would mean reading every page.
+ * Filters still work, though they read every page once each time they're applied.
+ * Changing a section through the controller fetches that whole section and keeps it from then on.
+ *
+ * @param   dataProvider            The provider to read the data from, or nil to clear the data.
+ * @param   pageSize                The number of rows to fetch at a time.
+ * @param   maximumResidentPages    The most pages to keep in memory at once, across all sections.
+**/
+- (void)setDataProvider:(nullable id<UAFilterableResultsDataProvider>)dataProvider pageSize:(NSUInteger)pageSize maximumResidentPages:(NSUInteger)maximumResidentPages;
+
+/**
+ * The data provider the current data came from, or nil if it was set some other way.
+**/
+@property (nonatomic, strong, readonly, nullable) id<UAFilterableResultsDataProvider> dataProvider;
+
+/** @name Thread Safety **/
+
+/**
+ * Whether the controller can be used from more than one thread at once. This is NO by default.
+ *
+ * When it is YES:
+ *  - changes asked for on any queue other than the -delegateQueue are sent there with dispatch_async and made in the order
+ *    they were asked for, so a lookup made straight after a change from another thread may not see it yet;
+ *  - each change holds a write lock while it is made and lookups take a read lock, so any number of threads can look things
+ *    up at once without waiting for the main thread. Your delegate is told about the change once the lock has been let go of,
+ *    so it can wait on a lookup from another thread while it handles it;
+ *  - the first lookup on the raw data after a change takes the write lock and brings the primary key index and offsets up to
+ *    date, so the ones after it never have to change anything. Those on the filtered data (other than
+ *    -filteredObjectAtIndexPath:), on paged data and while collecting metrics can, so they always take the write lock;
+ *  - setting the -sortComparator, -sortDescriptors or -sectionKeyPath is a change like any other.
+ *
+ * The lookups are the methods under Finding Objects, along with -objectAtIndexPath: and -filteredObjectAtIndexPath:. The arrays
+ * returned by -data and -filteredData are still changed in place, use -snapshot to read the data as a whole from another thread.
+ *
+ * Set this, and the -delegateQueue, before you use the controller from another thread.
+**/
+@property (nonatomic, getter=isThreadSafe) BOOL threadSafe;
+
+/**
+ * The serial queue that changes are made and your delegate is notified on when the controller is -threadSafe. This is the main
+ * queue by default, which is what UIKit expects. -setData:completion: and the asynchronous filter methods must be called on this
+ * queue, and finish on it.
+**/
+@property (nonatomic, strong, null_resettable) dispatch_queue_t delegateQueue;
+
 NS_ASSUME_NONNULL_END
 
 @end
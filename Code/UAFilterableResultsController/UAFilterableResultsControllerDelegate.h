@@ -6,7 +6,8 @@
 //  Copyright (c) 2013 Desto. All rights reserved.
 //
 
-@import UIKit;
+#import <Foundation/Foundation.h>
+#import "NSIndexPath+UAIndexPathAdditions.h"
 
 typedef NS_ENUM(NSUInteger, UAFilterableResultsChangeType)
 {
@@ -23,7 +24,10 @@ typedef NS_ENUM(NSUInteger, UAFilterableResultsChangeType)
     UAFilterableResultsChangeUpdate = 4
 };
 
-@class UAFilter, UAFilterableResultsController;
+@class UAFilter, UAFilterableResultsController, UAFilterableResultsChangeset;
+
+// the core doesn't need UIKit, these only appear as pointers in the delegate methods that the data source categories call
+@class UITableView, UICollectionView, UICollectionReusableView;
 
 @protocol UAFilterableResultsControllerDelegate <NSObject>
 
@@ -144,3 +148,26 @@ typedef NS_ENUM(NSUInteger, UAFilterableResultsChangeType)
 - (void)filterableResultsControllerShouldReload:(UAFilterableResultsController *)controller;
 
 @end
+
+
+/**
+ * A delegate that takes the changes of each batch all at once, rather than one row or section at a time.
+ *
+ * If your delegate adopts this protocol the controller packs the changes of each outermost batch into a single
+ * UAFilterableResultsChangeset, and doesn't call -filterableResultsController:didChangeObject:atIndexPath:forChangeType:newIndexPath:
+ * or -filterableResultsController:didChangeSectionAtIndex:forChangeType: at all.
+**/
+@protocol UAFilterableResultsControllerChangesetDelegate <UAFilterableResultsControllerDelegate>
+
+/**
+ * Delivers every change made since -filterableResultsControllerWillChangeContent:.
+ *
+ * This is called just before -filterableResultsControllerDidChangeContent:, so you can apply the whole batch in one
+ * -performBatchUpdates: (or between -beginUpdates and -endUpdates) on your table or collection view.
+ *
+ * @param   controller              The UAFilterableResultsController that made the changes.
+ * @param   changeset               The changes, which won't change again.
+**/
+- (void)filterableResultsController:(UAFilterableResultsController *)controller didChangeContentWithChangeset:(UAFilterableResultsChangeset *)changeset;
+
+@end
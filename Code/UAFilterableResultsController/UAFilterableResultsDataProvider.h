@@ -0,0 +1,60 @@
+//
+//  UAFilterableResultsDataProvider.h
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Supplies data to a UAFilterableResultsController a page at a time, so that it doesn't all have to be in memory at once.
+ *
+ * The counts are asked for once, up front, when the provider is handed to -setDataProvider:pageSize:maximumResidentPages:.
+ * Pages are then asked for as rows are touched, and may be asked for again after they've been let go. Return the same objects
+ * (or at least equal ones, in the same order) every time. If filters are evaluated in parallel, pages can be asked for
+ * from more than one thread, but never more than one at a time.
+**/
+@protocol UAFilterableResultsDataProvider <NSObject>
+
+/**
+ * Returns the number of objects in the specified section.
+ *
+ * @param   section                 The index of the section, always 0 for one dimensional data.
+ * @returns                         How many objects are in the section.
+**/
+- (NSUInteger)numberOfObjectsInSection:(NSUInteger)section;
+
+/**
+ * Returns the objects in a range of the specified section.
+ *
+ * @param   section                 The index of the section, always 0 for one dimensional data.
+ * @param   range                   The rows to return, which are always inside the section.
+ * @returns                         An array of exactly range.length objects.
+**/
+- (NSArray *)objectsInSection:(NSUInteger)section range:(NSRange)range;
+
+@optional
+
+/**
+ * Returns the number of sections. If you don't implement this the data is one dimensional, like passing a flat
+ * array to -setData:.
+**/
+- (NSUInteger)numberOfSections;
+
+/**
+ * Finds the object with the specified primary key without the controller having to go through every page.
+ *
+ * This is only used until the data is changed through the controller, after that the controller searches the pages itself.
+ *
+ * @param   key                     The primary key to look for, as found at the controller's primaryKeyPath.
+ * @returns                         The index path of the object, or nil if there isn't one.
+**/
+- (nullable NSIndexPath *)indexPathOfObjectWithPrimaryKey:(id)key;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,114 @@
+//
+//  UAFilterableResultsMetrics.h
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class UAFilterableResultsController;
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSUInteger, UAFilterableResultsMetricsInterval)
+{
+    // Making mutable copies of data passed to -setData:.
+    UAFilterableResultsMetricsIntervalCopy = 0,
+
+    // Working out the differences between the old and new data.
+    UAFilterableResultsMetricsIntervalDiff = 1,
+
+    // Evaluating filters over the data.
+    UAFilterableResultsMetricsIntervalFilter = 2,
+
+    // Calling your delegate, including however long it takes to do its thing.
+    UAFilterableResultsMetricsIntervalNotify = 3
+};
+
+/**
+ * Where the time went during a single batch of changes, and how much work was done.
+ *
+ * A batch ends when the outermost change batch ends (the point that -filterableResultsControllerDidChangeContent: is sent)
+ * or when the controller asks the delegate to reload. Work done while there is nothing to notify, like changes made before
+ * the table has loaded, is counted towards the next batch that does end.
+ *
+ * The durations don't overlap: if filtering leads to a diff, and the diff to your delegate being notified, each gets
+ * only its own share of the time. That means the notify duration is time spent in your code, and the rest is ours.
+**/
+@interface UAFilterableResultsMetrics : NSObject
+
+/**
+ * How long was spent in each interval, in seconds.
+**/
+@property (nonatomic, readonly) NSTimeInterval copyingDuration;
+@property (nonatomic, readonly) NSTimeInterval diffingDuration;
+@property (nonatomic, readonly) NSTimeInterval filteringDuration;
+@property (nonatomic, readonly) NSTimeInterval notifyingDuration;
+
+/**
+ * Returns how long was spent in the specified interval, in seconds.
+**/
+- (NSTimeInterval)durationOfInterval:(UAFilterableResultsMetricsInterval)interval;
+
+/**
+ * The number of times a filter's predicate was evaluated against an object.
+**/
+@property (nonatomic, readonly) NSUInteger numberOfPredicateEvaluations;
+
+/**
+ * The number of primary key values read with -valueForKeyPath: while diffing, merging and comparing objects.
+**/
+@property (nonatomic, readonly) NSUInteger numberOfKeyValueLookups;
+
+/**
+ * The number of messages sent to the delegate, or changes recorded for it when it takes changesets.
+**/
+@property (nonatomic, readonly) NSUInteger numberOfNotifications;
+
+/**
+ * The number of rows on both sides of every diff.
+**/
+@property (nonatomic, readonly) NSUInteger numberOfRowsCompared;
+
+@end
+
+
+/**
+ * Receives the metrics of each batch as it ends, and optionally the start and end of each interval as it happens.
+ *
+ * The interval methods are there so you can bracket them with signposts or your own tracing, they're called a lot
+ * (once or twice for every change that is notified) so keep them quick.
+**/
+@protocol UAFilterableResultsControllerMetricsDelegate <NSObject>
+
+@optional
+
+/**
+ * Informs the delegate that a batch has ended.
+ *
+ * @param   controller              The UAFilterableResultsController that made the changes.
+ * @param   metrics                 What was measured during the batch, which won't change again.
+**/
+- (void)filterableResultsController:(UAFilterableResultsController *)controller didFinishBatchWithMetrics:(UAFilterableResultsMetrics *)metrics;
+
+/**
+ * Informs the delegate that the controller is starting work in the specified interval.
+ *
+ * @param   controller              The UAFilterableResultsController doing the work.
+ * @param   interval                The kind of work it is starting.
+**/
+- (void)filterableResultsController:(UAFilterableResultsController *)controller willBeginInterval:(UAFilterableResultsMetricsInterval)interval;
+
+/**
+ * Informs the delegate that the controller has finished the work it started with -filterableResultsController:willBeginInterval:.
+ *
+ * @param   controller              The UAFilterableResultsController doing the work.
+ * @param   interval                The kind of work it has finished.
+**/
+- (void)filterableResultsController:(UAFilterableResultsController *)controller didEndInterval:(UAFilterableResultsMetricsInterval)interval;
+
+@end
+
+NS_ASSUME_NONNULL_END
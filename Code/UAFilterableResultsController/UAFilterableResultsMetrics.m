@@ -0,0 +1,151 @@
+//
+//  UAFilterableResultsMetrics.m
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import "UAFilterableResultsMetrics.h"
+#import "UAFilterableResultsController+Private.h"
+#import <time.h>
+#if defined(__APPLE__)
+#import <mach/mach_time.h>
+#endif
+
+#define UAFilterableResultsMetricsIntervalCount 4
+#define UAFilterableResultsMetricsMaximumDepth 16
+
+// a monotonic clock in seconds
+static double UAFilterableResultsMetricsNow(void) {
+#if defined(__APPLE__)
+    static double secondsPerTick = 0;
+    if (secondsPerTick == 0) {
+        mach_timebase_info_data_t timebase;
+        mach_timebase_info(&timebase);
+        secondsPerTick = (double)timebase.numer / (double)timebase.denom / 1e9;
+    }
+    return (double)mach_absolute_time() * secondsPerTick;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+#endif
+}
+
+NS_ASSUME_NONNULL_BEGIN
+@interface UAFilterableResultsMetrics () {
+    NSTimeInterval _durations[UAFilterableResultsMetricsIntervalCount];
+
+    // the intervals that are running, innermost last. Only the innermost one is accumulating time.
+    UAFilterableResultsMetricsInterval _openIntervals[UAFilterableResultsMetricsMaximumDepth];
+    NSUInteger _depth;
+    double _resumedAt;
+}
+
+@property (nonatomic) NSUInteger numberOfPredicateEvaluations;
+@property (nonatomic) NSUInteger numberOfKeyValueLookups;
+@property (nonatomic) NSUInteger numberOfNotifications;
+@property (nonatomic) NSUInteger numberOfRowsCompared;
+
+@end
+
+@implementation UAFilterableResultsMetrics
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p; copy: %.3fms; diff: %.3fms; filter: %.3fms; notify: %.3fms; predicates: %lu; key lookups: %lu; notifications: %lu; rows compared: %lu>",
+            NSStringFromClass([self class]), (__bridge void *)self,
+            self.copyingDuration * 1000, self.diffingDuration * 1000, self.filteringDuration * 1000, self.notifyingDuration * 1000,
+            (unsigned long)self.numberOfPredicateEvaluations, (unsigned long)self.numberOfKeyValueLookups,
+            (unsigned long)self.numberOfNotifications, (unsigned long)self.numberOfRowsCompared];
+}
+
+#pragma mark - Durations
+
+- (NSTimeInterval)durationOfInterval:(UAFilterableResultsMetricsInterval)interval {
+    NSParameterAssert(interval < UAFilterableResultsMetricsIntervalCount);
+    return (interval < UAFilterableResultsMetricsIntervalCount ? _durations[interval] : 0);
+}
+
+- (NSTimeInterval)copyingDuration {
+    return _durations[UAFilterableResultsMetricsIntervalCopy];
+}
+
+- (NSTimeInterval)diffingDuration {
+    return _durations[UAFilterableResultsMetricsIntervalDiff];
+}
+
+- (NSTimeInterval)filteringDuration {
+    return _durations[UAFilterableResultsMetricsIntervalFilter];
+}
+
+- (NSTimeInterval)notifyingDuration {
+    return _durations[UAFilterableResultsMetricsIntervalNotify];
+}
+
+@end
+
+#pragma mark - Recording
+
+@implementation UAFilterableResultsMetrics (Recording)
+
+- (void)accumulateInnermostIntervalUntil:(double)now {
+    if (_depth > 0 && _depth <= UAFilterableResultsMetricsMaximumDepth) {
+        _durations[_openIntervals[_depth - 1]] += (now - _resumedAt);
+    }
+    _resumedAt = now;
+}
+
+- (void)beginInterval:(UAFilterableResultsMetricsInterval)interval {
+    NSParameterAssert(interval < UAFilterableResultsMetricsIntervalCount);
+
+    // the interval we're inside of stops accumulating until this one ends
+    [self accumulateInnermostIntervalUntil:UAFilterableResultsMetricsNow()];
+    if (_depth < UAFilterableResultsMetricsMaximumDepth) {
+        _openIntervals[_depth] = interval;
+    }
+    _depth++;
+}
+
+- (void)endInterval:(UAFilterableResultsMetricsInterval)interval {
+    // nothing open means metrics were turned on partway through this interval
+    if (_depth == 0) {
+        return;
+    }
+    NSAssert(_depth > UAFilterableResultsMetricsMaximumDepth || _openIntervals[_depth - 1] == interval, @"Metrics intervals must be ended in the reverse order they were begun.");
+
+    [self accumulateInnermostIntervalUntil:UAFilterableResultsMetricsNow()];
+    _depth--;
+}
+
+- (UAFilterableResultsMetrics *)metricsContinuingOpenIntervals {
+    double now = UAFilterableResultsMetricsNow();
+    [self accumulateInnermostIntervalUntil:now];
+
+    // whatever is still running carries on in the next batch
+    UAFilterableResultsMetrics *next = [[UAFilterableResultsMetrics alloc] init];
+    memcpy(next->_openIntervals, _openIntervals, sizeof(_openIntervals));
+    next->_depth = _depth;
+    next->_resumedAt = now;
+    _depth = 0;
+    return next;
+}
+
+- (void)recordPredicateEvaluations:(NSUInteger)count {
+    self.numberOfPredicateEvaluations += count;
+}
+
+- (void)recordKeyValueLookups:(NSUInteger)count {
+    self.numberOfKeyValueLookups += count;
+}
+
+- (void)recordNotification {
+    self.numberOfNotifications += 1;
+}
+
+- (void)recordRowsCompared:(NSUInteger)count {
+    self.numberOfRowsCompared += count;
+}
+
+@end
+NS_ASSUME_NONNULL_END
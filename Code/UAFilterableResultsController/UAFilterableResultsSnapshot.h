@@ -0,0 +1,60 @@
+//
+//  UAFilterableResultsSnapshot.h
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * A read-only view of the controller's data as it was when the snapshot was taken.
+ *
+ * Taking a snapshot copies nothing, it shares the controller's arrays. When the controller next changes one of those arrays it
+ * first hands the snapshot a copy of that one section (or, for changes to the list of sections, a copy of the list) so the
+ * snapshot never sees the change. Only the parts that are touched after the snapshot was taken are ever copied, and a snapshot
+ * that is never outlived by a change costs nothing at all. One dimensional data is shared in chunks of 1024 rows instead, and
+ * a change to a single row only copies the chunk it is in.
+ *
+ * Snapshots never change and are safe to read from any thread, while the controller carries on changing its data on its own.
+**/
+@interface UAFilterableResultsSnapshot : NSObject
+
+/**
+ * Whether the data was two dimensional when the snapshot was taken.
+**/
+@property (nonatomic, readonly, getter=isTwoDimensional) BOOL twoDimensional;
+
+/**
+ * The number of sections, one for one dimensional data.
+**/
+@property (nonatomic, readonly) NSUInteger numberOfSections;
+
+/**
+ * Returns the number of objects in the section at the specified index.
+**/
+- (NSUInteger)numberOfObjectsInSection:(NSUInteger)sectionIndex;
+
+/**
+ * Returns the object at the specified index path, or nil if there isn't one.
+**/
+- (nullable id)objectAtIndexPath:(NSIndexPath *)indexPath;
+
+/**
+ * Calls the block with every object in order, stopping early if the block sets stop to YES.
+**/
+- (void)enumerateObjectsUsingBlock:(void (^)(id object, NSIndexPath *indexPath, BOOL *stop))block;
+
+/**
+ * The data in the same shape as the controller's -data, as immutable arrays.
+ *
+ * This is built the first time you ask, in O(n), and the snapshot no longer shares anything with the controller after that.
+**/
+@property (nonatomic, readonly) NSArray *data;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,305 @@
+//
+//  UAFilterableResultsSnapshot.m
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import "UAFilterableResultsSnapshot.h"
+#import <pthread.h>
+
+// the number of rows of one dimensional data that are copied together
+static const NSUInteger UAFilterableResultsSnapshotChunkSize = 1024;
+
+NS_ASSUME_NONNULL_BEGIN
+@interface UAFilterableResultsSnapshot () {
+    pthread_rwlock_t _lock;
+
+    // One dimensional data is shared in chunks of rows. For each chunk, the row of the controller's array it starts at
+    // now, or NSNotFound once it has been copied into _chunkCopies.
+    NSUInteger *_chunkStarts;
+    NSUInteger _chunkCount;
+    NSUInteger _sharedChunkCount;
+    NSUInteger _count;
+}
+
+@property (nonatomic, readwrite, getter=isTwoDimensional) BOOL twoDimensional;
+
+// the controller's own array of sections (or objects, when one dimensional) until the list is changed, then our copy of it
+@property (nonatomic, strong) NSArray *sections;
+@property (nonatomic) BOOL ownsSections;
+
+// once we own the list, the sections in it that are still the controller's, by identity
+@property (nonatomic, strong, nullable) NSHashTable *sharedSections;
+
+// the controller's section to the copy we took before it was changed, by identity
+@property (nonatomic, strong) NSMapTable *preservedSections;
+
+@property (nonatomic, strong, nullable) NSArray *materialisedData;
+
+// the chunks of one dimensional data we've copied, and NSNull for the ones still shared
+@property (nonatomic, strong, nullable) NSMutableArray *chunkCopies;
+
+@end
+
+@implementation UAFilterableResultsSnapshot
+
+- (instancetype)initWithData:(NSArray *)data twoDimensional:(BOOL)twoDimensional {
+    self = [super init];
+    if (self) {
+        pthread_rwlock_init(&_lock, NULL);
+        self.twoDimensional = twoDimensional;
+        self.sections = data;
+        self.preservedSections = [NSMapTable mapTableWithKeyOptions:(NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality)
+                                                       valueOptions:NSPointerFunctionsStrongMemory];
+
+        if (!twoDimensional) {
+            _count = data.count;
+            _chunkCount = (_count + UAFilterableResultsSnapshotChunkSize - 1) / UAFilterableResultsSnapshotChunkSize;
+            _sharedChunkCount = _chunkCount;
+            _chunkStarts = malloc(MAX(_chunkCount, 1) * sizeof(NSUInteger));
+            if (_chunkStarts == NULL) {
+                pthread_rwlock_destroy(&_lock);
+                [NSException raise:NSMallocException format:@"Could not make room for a snapshot of %lu rows.", (unsigned long)_count];
+            }
+
+            self.chunkCopies = [[NSMutableArray alloc] initWithCapacity:_chunkCount];
+            for (NSUInteger chunk = 0; chunk < _chunkCount; chunk++) {
+                _chunkStarts[chunk] = chunk * UAFilterableResultsSnapshotChunkSize;
+                [self.chunkCopies addObject:[NSNull null]];
+            }
+        }
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_chunkStarts);
+    pthread_rwlock_destroy(&_lock);
+}
+
+#pragma mark - Reading
+
+// must be called with the lock held
+- (nullable NSArray *)sectionAtIndex:(NSUInteger)sectionIndex {
+    NSAssert(self.twoDimensional, @"One dimensional data is read a chunk at a time.");
+    if (sectionIndex >= self.sections.count) {
+        return nil;
+    }
+    NSArray *section = self.sections[sectionIndex];
+    return ([self.preservedSections objectForKey:section] ?: section);
+}
+
+- (NSUInteger)numberOfSections {
+    if (!self.twoDimensional) {
+        return 1;
+    }
+    pthread_rwlock_rdlock(&_lock);
+    NSUInteger count = self.sections.count;
+    pthread_rwlock_unlock(&_lock);
+    return count;
+}
+
+// must be called with the lock held
+- (NSUInteger)lengthOfChunk:(NSUInteger)chunk {
+    return MIN(UAFilterableResultsSnapshotChunkSize, _count - chunk * UAFilterableResultsSnapshotChunkSize);
+}
+
+// must be called with the lock held
+- (id)objectAtRow:(NSUInteger)row {
+    if (self.materialisedData != nil) {
+        return self.materialisedData[row];
+    }
+
+    NSUInteger chunk = row / UAFilterableResultsSnapshotChunkSize;
+    NSUInteger start = _chunkStarts[chunk];
+    if (start == NSNotFound) {
+        return self.chunkCopies[chunk][row % UAFilterableResultsSnapshotChunkSize];
+    }
+    return self.sections[start + row % UAFilterableResultsSnapshotChunkSize];
+}
+
+- (NSUInteger)numberOfObjectsInSection:(NSUInteger)sectionIndex {
+    if (!self.twoDimensional) {
+        return (sectionIndex == 0 ? _count : 0);
+    }
+
+    pthread_rwlock_rdlock(&_lock);
+    NSUInteger count = [self sectionAtIndex:sectionIndex].count;
+    pthread_rwlock_unlock(&_lock);
+    return count;
+}
+
+- (nullable id)objectAtIndexPath:(NSIndexPath *)indexPath {
+    if (indexPath.section < 0 || indexPath.row < 0) {
+        return nil;
+    }
+
+    id object = nil;
+    pthread_rwlock_rdlock(&_lock);
+    if (!self.twoDimensional) {
+        if (indexPath.section == 0 && (NSUInteger)indexPath.row < _count) {
+            object = [self objectAtRow:(NSUInteger)indexPath.row];
+        }
+    } else {
+        NSArray *section = [self sectionAtIndex:(NSUInteger)indexPath.section];
+        object = ((NSUInteger)indexPath.row < section.count ? section[(NSUInteger)indexPath.row] : nil);
+    }
+    pthread_rwlock_unlock(&_lock);
+    return object;
+}
+
+- (void)enumerateObjectsUsingBlock:(void (^)(id object, NSIndexPath *indexPath, BOOL *stop))block {
+    NSParameterAssert(block != nil);
+
+    // we enumerate our own copy so the controller isn't kept waiting on the block
+    NSArray *data = self.data;
+    NSArray *sections = (self.twoDimensional ? data : @[ data ]);
+    BOOL stop = NO;
+    for (NSUInteger sectionIndex = 0; sectionIndex < sections.count && !stop; sectionIndex++) {
+        NSArray *section = sections[sectionIndex];
+        for (NSUInteger row = 0; row < section.count && !stop; row++) {
+            block(section[row], [NSIndexPath indexPathForRow:(NSInteger)row inSection:(NSInteger)sectionIndex], &stop);
+        }
+    }
+}
+
+- (NSArray *)data {
+    pthread_rwlock_rdlock(&_lock);
+    NSArray *data = self.materialisedData;
+    if (data == nil) {
+        if (self.twoDimensional) {
+            NSMutableArray *sections = [[NSMutableArray alloc] initWithCapacity:self.sections.count];
+            for (NSUInteger sectionIndex = 0; sectionIndex < self.sections.count; sectionIndex++) {
+                [sections addObject:[[self sectionAtIndex:sectionIndex] copy]];
+            }
+            data = [sections copy];
+        } else {
+            NSMutableArray *objects = [[NSMutableArray alloc] initWithCapacity:_count];
+            for (NSUInteger chunk = 0; chunk < _chunkCount; chunk++) {
+                NSUInteger start = _chunkStarts[chunk];
+                if (start == NSNotFound) {
+                    [objects addObjectsFromArray:self.chunkCopies[chunk]];
+                } else {
+                    [objects addObjectsFromArray:[self.sections subarrayWithRange:NSMakeRange(start, [self lengthOfChunk:chunk])]];
+                }
+            }
+            data = [objects copy];
+        }
+    }
+    pthread_rwlock_unlock(&_lock);
+
+    // from now on we read our own copy, and the controller has nothing left to tell us
+    pthread_rwlock_wrlock(&_lock);
+    if (self.materialisedData == nil) {
+        self.materialisedData = data;
+        self.sections = data;
+        self.ownsSections = YES;
+        self.sharedSections = nil;
+        [self.preservedSections removeAllObjects];
+        self.chunkCopies = nil;
+        _sharedChunkCount = 0;
+    }
+    data = self.materialisedData;
+    pthread_rwlock_unlock(&_lock);
+    return data;
+}
+
+#pragma mark - Sharing
+
+// must be called with the lock held
+- (void)preserveChunk:(NSUInteger)chunk {
+    NSUInteger start = _chunkStarts[chunk];
+    if (start == NSNotFound) {
+        return;
+    }
+    self.chunkCopies[chunk] = [self.sections subarrayWithRange:NSMakeRange(start, [self lengthOfChunk:chunk])];
+    _chunkStarts[chunk] = NSNotFound;
+    _sharedChunkCount--;
+}
+
+- (void)preserveSections {
+    pthread_rwlock_wrlock(&_lock);
+    if (!self.twoDimensional) {
+        // we don't know what's about to change, so every chunk we still share is copied
+        if (self.materialisedData == nil && _sharedChunkCount > 0) {
+            for (NSUInteger chunk = 0; chunk < _chunkCount; chunk++) {
+                [self preserveChunk:chunk];
+            }
+        }
+
+    } else if (!self.ownsSections) {
+        self.sections = [self.sections copy];
+        self.ownsSections = YES;
+
+        // from here on the controller can change sections we don't have, so we keep track of the ones we do
+        if (self.twoDimensional) {
+            NSHashTable *sharedSections = [[NSHashTable alloc] initWithOptions:(NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality)
+                                                                      capacity:self.sections.count];
+            for (NSArray *section in self.sections) {
+                if ([self.preservedSections objectForKey:section] == nil) {
+                    [sharedSections addObject:section];
+                }
+            }
+            self.sharedSections = sharedSections;
+        }
+    }
+    pthread_rwlock_unlock(&_lock);
+}
+
+- (void)preserveSection:(NSArray *)section {
+    if (!self.twoDimensional) {
+        [self preserveSections];
+        return;
+    }
+
+    pthread_rwlock_wrlock(&_lock);
+    BOOL isShared = (self.ownsSections ? [self.sharedSections containsObject:section] : [self.preservedSections objectForKey:section] == nil);
+    if (isShared) {
+        [self.preservedSections setObject:[section copy] forKey:section];
+        [self.sharedSections removeObject:section];
+    }
+    pthread_rwlock_unlock(&_lock);
+}
+
+- (void)willChangeObjectAtRow:(NSUInteger)row ofSection:(NSArray *)section delta:(NSInteger)delta {
+    if (self.twoDimensional) {
+        [self preserveSection:section];
+        return;
+    }
+
+    // held until the change has been made, as the chunks we still share are read straight from the array being changed
+    pthread_rwlock_wrlock(&_lock);
+    if (self.materialisedData != nil || _sharedChunkCount == 0) {
+        return;
+    }
+
+    // Only the chunk the row is in has to be copied. The shared chunks after it just start one row further along (or back).
+    // An insertion at the very start of a chunk pushes the whole chunk along rather than changing it.
+    for (NSUInteger chunk = 0; chunk < _chunkCount; chunk++) {
+        NSUInteger start = _chunkStarts[chunk];
+        if (start == NSNotFound) {
+            continue;
+        }
+
+        NSUInteger end = start + [self lengthOfChunk:chunk];
+        BOOL containsRow = (delta > 0 ? (start < row && row < end) : (start <= row && row < end));
+        if (containsRow) {
+            [self preserveChunk:chunk];
+        } else if (delta > 0 && start >= row) {
+            _chunkStarts[chunk] = start + 1;
+        } else if (delta < 0 && start > row) {
+            _chunkStarts[chunk] = start - 1;
+        }
+    }
+}
+
+- (void)didChangeObjectInSection:(NSArray *)section {
+    if (!self.twoDimensional) {
+        pthread_rwlock_unlock(&_lock);
+    }
+}
+
+@end
+NS_ASSUME_NONNULL_END
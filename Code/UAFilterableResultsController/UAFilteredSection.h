@@ -0,0 +1,88 @@
+//
+//  UAFilteredSection.h
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * The filtered rows of one section of the data, stored as a sorted vector of 32 bit row numbers into that section rather
+ * than a second copy of the objects.
+ *
+ * It is read like any other array, each object coming straight from the section it maps. Going from a filtered index to
+ * its row is a single lookup and going back is a binary search.
+ *
+ * The section is changed in place, so the filtered section must be told about every change made to it. Rows after an
+ * insertion or removal are renumbered. A row that is removed or replaced while it is visible is held on to as a detached
+ * object, so the filtered section still reads the way it did when it was built until it is changed itself. Objects it is
+ * given that can't be found in the section are detached the same way, so it never stops behaving like an array.
+**/
+@interface UAFilteredSection : NSMutableArray
+
+/**
+ * The section the rows refer to.
+**/
+@property (nonatomic, strong, readonly) NSArray *section;
+
+/**
+ * Whether every index maps to a row of the section, with no detached objects.
+**/
+@property (nonatomic, readonly, getter=isMapped) BOOL mapped;
+
+/**
+ * Creates an empty filtered section.
+ *
+ * @param   section                 The section the rows will refer to, which must have no more than UINT32_MAX rows.
+ * @param   capacity                The number of rows to make room for.
+ * @returns                         An initialised UAFilteredSection with no rows.
+**/
+- (instancetype)initWithSection:(NSArray *)section capacity:(NSUInteger)capacity;
+
+/**
+ * Creates a filtered section in which every row of the section is visible.
+ *
+ * @param   section                 The section the rows will refer to, which must have no more than UINT32_MAX rows.
+ * @returns                         An initialised UAFilteredSection mapping every row.
+**/
+- (instancetype)initWithAllRowsOfSection:(NSArray *)section;
+
+/**
+ * Points the filtered section at another section holding the same objects in the same rows, such as the array a copy was
+ * taken from. Nothing is copied.
+**/
+- (void)moveToSection:(NSArray *)section;
+
+/**
+ * Appends a row. Rows must be added in ascending order.
+**/
+- (void)addRow:(NSUInteger)row;
+
+/**
+ * Returns the row of the section at the specified filtered index, or NSNotFound if the object there is detached.
+**/
+- (NSUInteger)rowAtIndex:(NSUInteger)index;
+
+/**
+ * Returns the filtered index of the specified row of the section, or NSNotFound if it isn't visible.
+**/
+- (NSUInteger)indexOfRow:(NSUInteger)row;
+
+/**
+ * Returns how many filtered indexes come before the specified row of the section, which is where it would be inserted.
+**/
+- (NSUInteger)numberOfIndexesBeforeRow:(NSUInteger)row;
+
+/** @name Tracking Changes **/
+
+- (void)didInsertRowAtIndex:(NSUInteger)row;
+- (void)didRemoveObject:(id)object atRow:(NSUInteger)row;
+- (void)didReplaceObject:(id)oldObject atRow:(NSUInteger)row;
+
+@end
+
+NS_ASSUME_NONNULL_END
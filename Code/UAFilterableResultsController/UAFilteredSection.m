@@ -0,0 +1,275 @@
+//
+//  UAFilteredSection.m
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import "UAFilteredSection.h"
+
+NS_ASSUME_NONNULL_BEGIN
+@implementation UAFilteredSection {
+    // the row of each filtered index, ascending. A detached object keeps the row it had so the order still holds.
+    uint32_t *_rows;
+    NSUInteger _count;
+    NSUInteger _capacity;
+
+    // the objects that no longer match their row, keyed by filtered index. There are rarely more than one or two.
+    NSMutableDictionary *_detachedObjects;
+}
+
+- (instancetype)init {
+    return [self initWithSection:@[] capacity:0];
+}
+
+- (instancetype)initWithSection:(NSArray *)section capacity:(NSUInteger)capacity {
+    NSParameterAssert(section.count <= UINT32_MAX);
+
+    self = [super init];
+    if (self) {
+        _section = section;
+        _detachedObjects = [[NSMutableDictionary alloc] init];
+        [self ensureCapacity:capacity];
+    }
+    return self;
+}
+
+- (instancetype)initWithAllRowsOfSection:(NSArray *)section {
+    self = [self initWithSection:section capacity:section.count];
+    if (self) {
+        for (NSUInteger row = 0; row < section.count; row++) {
+            _rows[row] = (uint32_t)row;
+        }
+        _count = section.count;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_rows);
+}
+
+- (BOOL)isMapped {
+    return (_detachedObjects.count == 0);
+}
+
+- (void)moveToSection:(NSArray *)section {
+    NSParameterAssert(section.count == _section.count);
+    _section = section;
+}
+
+#pragma mark - Rows
+
+- (void)ensureCapacity:(NSUInteger)capacity {
+    if (capacity <= _capacity) {
+        return;
+    }
+    NSUInteger newCapacity = MAX(capacity, MAX(_capacity * 2, (NSUInteger)16));
+    uint32_t *rows = realloc(_rows, newCapacity * sizeof(uint32_t));
+    if (rows == NULL) {
+        [NSException raise:NSMallocException format:@"Could not make room for %lu filtered rows.", (unsigned long)newCapacity];
+    }
+    _rows = rows;
+    _capacity = newCapacity;
+}
+
+- (void)addRow:(NSUInteger)row {
+    NSParameterAssert(row < self.section.count);
+    NSAssert(_count == 0 || _rows[_count - 1] < row, @"Rows must be added to a filtered section in ascending order.");
+
+    [self ensureCapacity:_count + 1];
+    _rows[_count++] = (uint32_t)row;
+}
+
+- (NSUInteger)rowAtIndex:(NSUInteger)index {
+    if (index >= _count) {
+        [NSException raise:NSRangeException format:@"*** -[UAFilteredSection rowAtIndex:]: index %lu beyond bounds [0 .. %ld]", (unsigned long)index, (long)_count - 1];
+    }
+    return ([self isDetachedAtIndex:index] ? NSNotFound : _rows[index]);
+}
+
+- (NSUInteger)numberOfIndexesBeforeRow:(NSUInteger)row {
+    // the first index whose row isn't before this one
+    NSUInteger low = 0;
+    NSUInteger high = _count;
+    while (low < high) {
+        NSUInteger middle = low + (high - low) / 2;
+        if (_rows[middle] < row) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+- (NSUInteger)indexOfRow:(NSUInteger)row {
+    // a detached object can share its row with the one that replaced it, so step past any of those
+    for (NSUInteger index = [self numberOfIndexesBeforeRow:row]; index < _count && _rows[index] == row; index++) {
+        if (![self isDetachedAtIndex:index]) {
+            return index;
+        }
+    }
+    return NSNotFound;
+}
+
+#pragma mark - Detached Objects
+
+- (BOOL)isDetachedAtIndex:(NSUInteger)index {
+    return (_detachedObjects.count > 0 && _detachedObjects[@(index)] != nil);
+}
+
+- (void)detachObject:(id)object atIndex:(NSUInteger)index {
+    _detachedObjects[@(index)] = object;
+}
+
+- (void)shiftDetachedObjectsFromIndex:(NSUInteger)index by:(NSInteger)delta {
+    if (_detachedObjects.count == 0) {
+        return;
+    }
+
+    NSMutableDictionary *shifted = [[NSMutableDictionary alloc] initWithCapacity:_detachedObjects.count];
+    [_detachedObjects enumerateKeysAndObjectsUsingBlock:^(NSNumber *key, id object, BOOL *stop) {
+        NSUInteger detachedIndex = key.unsignedIntegerValue;
+        shifted[@(detachedIndex >= index ? (NSUInteger)((NSInteger)detachedIndex + delta) : detachedIndex)] = object;
+    }];
+    _detachedObjects = shifted;
+}
+
+// the row of the section an object being inserted at the index came from, or NSNotFound
+- (NSUInteger)rowOfObject:(id)object insertedAtIndex:(NSUInteger)index {
+    NSArray *section = self.section;
+
+    // it can only be between its neighbours' rows, or on them if they're detached
+    NSUInteger start = 0;
+    if (index > 0) {
+        start = _rows[index - 1] + ([self isDetachedAtIndex:index - 1] ? 0 : 1);
+    }
+    NSUInteger end = section.count;
+    if (index < _count) {
+        end = MIN(end, (NSUInteger)_rows[index] + ([self isDetachedAtIndex:index] ? 1 : 0));
+    }
+
+    for (NSUInteger row = start; row < end; row++) {
+        if (section[row] == object && [self indexOfRow:row] == NSNotFound) {
+            return row;
+        }
+    }
+    return NSNotFound;
+}
+
+#pragma mark - NSArray
+
+- (NSUInteger)count {
+    return _count;
+}
+
+- (id)objectAtIndex:(NSUInteger)index {
+    if (index >= _count) {
+        [NSException raise:NSRangeException format:@"*** -[UAFilteredSection objectAtIndex:]: index %lu beyond bounds [0 .. %ld]", (unsigned long)index, (long)_count - 1];
+    }
+
+    if (_detachedObjects.count > 0) {
+        id object = _detachedObjects[@(index)];
+        if (object != nil) {
+            return object;
+        }
+    }
+    return [self.section objectAtIndex:_rows[index]];
+}
+
+#pragma mark - NSMutableArray
+
+- (void)insertObject:(id)anObject atIndex:(NSUInteger)index {
+    NSParameterAssert(anObject != nil);
+    if (index > _count) {
+        [NSException raise:NSRangeException format:@"*** -[UAFilteredSection insertObject:atIndex:]: index %lu beyond bounds [0 .. %lu]", (unsigned long)index, (unsigned long)_count];
+    }
+
+    // objects that aren't in the section are kept in order with their neighbours
+    NSUInteger row = [self rowOfObject:anObject insertedAtIndex:index];
+    BOOL isDetached = (row == NSNotFound);
+    if (isDetached) {
+        row = (index > 0 ? _rows[index - 1] : 0);
+    }
+
+    [self ensureCapacity:_count + 1];
+    memmove(_rows + index + 1, _rows + index, (_count - index) * sizeof(uint32_t));
+    _rows[index] = (uint32_t)row;
+    _count++;
+
+    [self shiftDetachedObjectsFromIndex:index by:1];
+    if (isDetached) {
+        [self detachObject:anObject atIndex:index];
+    }
+}
+
+- (void)removeObjectAtIndex:(NSUInteger)index {
+    if (index >= _count) {
+        [NSException raise:NSRangeException format:@"*** -[UAFilteredSection removeObjectAtIndex:]: index %lu beyond bounds [0 .. %ld]", (unsigned long)index, (long)_count - 1];
+    }
+
+    memmove(_rows + index, _rows + index + 1, (_count - index - 1) * sizeof(uint32_t));
+    _count--;
+
+    if (_detachedObjects.count > 0) {
+        [_detachedObjects removeObjectForKey:@(index)];
+        [self shiftDetachedObjectsFromIndex:index + 1 by:-1];
+    }
+}
+
+- (void)addObject:(id)anObject {
+    [self insertObject:anObject atIndex:_count];
+}
+
+- (void)removeLastObject {
+    if (_count > 0) {
+        [self removeObjectAtIndex:_count - 1];
+    }
+}
+
+- (void)replaceObjectAtIndex:(NSUInteger)index withObject:(id)anObject {
+    NSParameterAssert(anObject != nil);
+    if (index >= _count) {
+        [NSException raise:NSRangeException format:@"*** -[UAFilteredSection replaceObjectAtIndex:withObject:]: index %lu beyond bounds [0 .. %ld]", (unsigned long)index, (long)_count - 1];
+    }
+
+    // usually the section has already been changed at this row, so it's mapped again
+    NSUInteger row = _rows[index];
+    BOOL isInSection = (row < self.section.count && self.section[row] == anObject);
+    if (isInSection && [self isDetachedAtIndex:index] && [self indexOfRow:row] == NSNotFound) {
+        [_detachedObjects removeObjectForKey:@(index)];
+    } else if (!isInSection || [self isDetachedAtIndex:index]) {
+        [self detachObject:anObject atIndex:index];
+    }
+}
+
+#pragma mark - Tracking Changes
+
+- (void)didInsertRowAtIndex:(NSUInteger)row {
+    NSAssert(self.section.count <= UINT32_MAX, @"A filtered section can't map more than UINT32_MAX rows.");
+    for (NSUInteger index = [self numberOfIndexesBeforeRow:row]; index < _count; index++) {
+        _rows[index]++;
+    }
+}
+
+- (void)didRemoveObject:(id)object atRow:(NSUInteger)row {
+    NSUInteger index = [self indexOfRow:row];
+    if (index != NSNotFound) {
+        [self detachObject:object atIndex:index];
+    }
+    for (index = [self numberOfIndexesBeforeRow:row + 1]; index < _count; index++) {
+        _rows[index]--;
+    }
+}
+
+- (void)didReplaceObject:(id)oldObject atRow:(NSUInteger)row {
+    NSUInteger index = [self indexOfRow:row];
+    if (index != NSNotFound) {
+        [self detachObject:oldObject atIndex:index];
+    }
+}
+
+@end
+NS_ASSUME_NONNULL_END
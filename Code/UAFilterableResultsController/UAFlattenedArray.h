@@ -0,0 +1,35 @@
+//
+//  UAFlattenedArray.h
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+@class UASectionOffsets;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * A read-only, one dimensional view of a two dimensional array of sections.
+ *
+ * Nothing is copied: -objectAtIndex: finds the section using the supplied UASectionOffsets and reads straight out of it,
+ * and fast enumeration hands out the contents of each section in turn. Because the view reads the live sections it reflects
+ * any changes made to them afterwards, as long as the offsets are kept up to date, so copy it if you need a snapshot.
+**/
+@interface UAFlattenedArray : NSArray
+
+/**
+ * Creates a view of the supplied sections.
+ *
+ * @param   sections                An array of sections, each of them an array of objects.
+ * @param   offsets                 The section offsets for the same array, kept up to date as it changes.
+ * @returns                         An initialised UAFlattenedArray.
+**/
+- (instancetype)initWithSections:(NSArray *)sections offsets:(UASectionOffsets *)offsets;
+
+@end
+
+NS_ASSUME_NONNULL_END
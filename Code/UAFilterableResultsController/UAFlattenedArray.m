@@ -0,0 +1,88 @@
+//
+//  UAFlattenedArray.m
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import "UAFlattenedArray.h"
+#import "UASectionOffsets.h"
+
+NS_ASSUME_NONNULL_BEGIN
+@interface UAFlattenedArray ()
+
+@property (nonatomic, strong) NSArray *sections;
+@property (nonatomic, strong) UASectionOffsets *offsets;
+
+@end
+
+@implementation UAFlattenedArray
+
+- (instancetype)initWithSections:(NSArray *)sections offsets:(UASectionOffsets *)offsets {
+    NSParameterAssert(offsets.data == sections);
+
+    self = [super init];
+    if (self) {
+        self.sections = sections;
+        self.offsets = offsets;
+    }
+    return self;
+}
+
+#pragma mark - NSArray
+
+- (NSUInteger)count {
+    return self.offsets.count;
+}
+
+- (id)objectAtIndex:(NSUInteger)index {
+    NSIndexPath *indexPath = [self.offsets indexPathForOffset:index];
+    if (indexPath == nil) {
+        [NSException raise:NSRangeException format:@"*** -[UAFlattenedArray objectAtIndex:]: index %lu beyond bounds [0 .. %ld]", (unsigned long)index, (long)self.count - 1];
+    }
+    return [self.sections[(NSUInteger)indexPath.section] objectAtIndex:(NSUInteger)indexPath.row];
+}
+
+- (id)copyWithZone:(nullable NSZone *)zone {
+    // a copy is a snapshot, not another view
+    return [[NSArray allocWithZone:zone] initWithArray:self];
+}
+
+#pragma mark - Fast Enumeration
+
+- (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state objects:(id __unsafe_unretained [])buffer count:(NSUInteger)len {
+    // extra[0] is the section we're up to and extra[1] the row within it
+    if (state->state == 0) {
+        state->state = 1;
+        state->extra[0] = 0;
+        state->extra[1] = 0;
+    }
+
+    // the caller compares this with the value it saw first, so we refresh it on each call to catch changes to the sections
+    state->extra[4] = self.offsets.mutations;
+    state->mutationsPtr = &state->extra[4];
+
+    NSArray *sections = self.sections;
+    NSUInteger sectionCount = sections.count;
+    while (state->extra[0] < sectionCount) {
+        NSArray *section = sections[state->extra[0]];
+        NSUInteger row = state->extra[1];
+        if (row >= section.count) {
+            state->extra[0]++;
+            state->extra[1] = 0;
+            continue;
+        }
+
+        // pass on as much of the section as fits in the caller's buffer, no objects are retained or allocated
+        NSUInteger length = MIN(len, section.count - row);
+        [section getObjects:buffer range:NSMakeRange(row, length)];
+        state->extra[1] = row + length;
+        state->itemsPtr = buffer;
+        return length;
+    }
+    return 0;
+}
+
+@end
+NS_ASSUME_NONNULL_END
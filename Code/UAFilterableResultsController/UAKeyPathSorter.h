@@ -0,0 +1,92 @@
+//
+//  UAKeyPathSorter.h
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class UAKeyPathSortKeys;
+
+/**
+ * Sorts objects by the values at one or more key paths, reading each value only once.
+ *
+ * Rather than calling valueForKeyPath: twice per key path on every comparison, the sorter pulls out every object's sort keys
+ * up front (decorate), sorts the row numbers by those keys (sort) and then picks the objects out in that order (undecorate).
+ * String keys are folded once for the case, diacritic and width insensitive options, so the comparisons only have to deal
+ * with what is left over.
+ *
+ * Strings are compared using compare:options:, anything else using compare:. Objects with no value at a key path sort first.
+ * The sort is stable. Two sorters are equal when they sort by the same key paths with the same options.
+**/
+@interface UAKeyPathSorter : NSObject
+
+/**
+ * The key paths to sort by, in order of precedence.
+**/
+@property (nonatomic, strong, readonly) NSArray *keyPaths;
+
+/**
+ * The NSStringCompareOptions used to compare string values.
+**/
+@property (nonatomic, readonly) NSStringCompareOptions options;
+
+/**
+ * Creates a sorter for a comma separated list of key paths.
+ *
+ * @param   sortKeyPath             One or more key paths separated by commas.
+ * @param   options                 A mask of NSStringCompareOptions to use when comparing strings.
+ * @returns                         An initialised UAKeyPathSorter.
+**/
++ (instancetype)sorterWithSortKeyPath:(NSString *)sortKeyPath options:(NSStringCompareOptions)options;
+
+/**
+ * A comparator that orders two objects exactly the way -sortedArrayOfObjects:concurrently: would.
+ *
+ * It has to read the keys of both objects every time it is called, so use it for the odd comparison and not for a full sort.
+**/
+- (NSComparator)comparator;
+
+/**
+ * Returns the supplied objects sorted by the key paths.
+ *
+ * @param   objects                 An NSArray of objects.
+ * @param   concurrently            Whether to sort chunks of the objects concurrently and merge them together afterwards.
+ *                                  The keys are still read serially, but your values must be safe to compare from multiple threads.
+ * @returns                         A new sorted array.
+**/
+- (NSMutableArray *)sortedArrayOfObjects:(NSArray *)objects concurrently:(BOOL)concurrently;
+
+/**
+ * Returns the sort keys of the supplied objects, for comparing them by row as often as needed without reading them again.
+ *
+ * @param   objects                 An NSArray of objects.
+ * @returns                         A UAKeyPathSortKeys that reads the keys of each object the first time it is compared.
+**/
+- (UAKeyPathSortKeys *)sortKeysOfObjects:(NSArray *)objects;
+
+@end
+
+/**
+ * The sort keys of an array of objects, read the first time each object is compared and kept from then on.
+**/
+@interface UAKeyPathSortKeys : NSObject
+
+/**
+ * The objects the keys belong to.
+**/
+@property (nonatomic, strong, readonly) NSArray *objects;
+
+/**
+ * Compares the object in one row with the object in a row of another set of keys from the same sorter, which can be this one,
+ * exactly the way -[UAKeyPathSorter comparator] would.
+**/
+- (NSComparisonResult)compareRow:(NSUInteger)row toRow:(NSUInteger)otherRow ofKeys:(UAKeyPathSortKeys *)otherKeys;
+
+@end
+
+NS_ASSUME_NONNULL_END
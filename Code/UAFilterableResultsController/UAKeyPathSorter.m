@@ -0,0 +1,318 @@
+//
+//  UAKeyPathSorter.m
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import "UAKeyPathSorter.h"
+
+// runs this short are insertion sorted before merging starts
+#define UAKeyPathSorterRunLength 16
+
+// the options we can apply to a string once up front instead of on every comparison
+static const NSStringCompareOptions UAKeyPathSorterFoldingOptions = (NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch | NSWidthInsensitiveSearch);
+
+typedef struct {
+    __unsafe_unretained id *values;
+    NSUInteger keyCount;
+    NSStringCompareOptions options;
+} UAKeyPathSorterContext;
+
+static inline NSComparisonResult UACompareSortValues(__unsafe_unretained id value1, __unsafe_unretained id value2, NSStringCompareOptions options) {
+    if (value1 == value2) {
+        return NSOrderedSame;
+    }
+
+    // missing values go first
+    id null = [NSNull null];
+    if (value1 == null) {
+        return NSOrderedAscending;
+    }
+    if (value2 == null) {
+        return NSOrderedDescending;
+    }
+
+    if ([value1 isKindOfClass:[NSString class]] && [value2 isKindOfClass:[NSString class]]) {
+        return [(NSString *)value1 compare:value2 options:options];
+    }
+    return [(NSNumber *)value1 compare:value2];
+}
+
+static inline NSComparisonResult UACompareSortRows(const UAKeyPathSorterContext *context, NSUInteger row1, NSUInteger row2) {
+    __unsafe_unretained id *keys1 = context->values + (row1 * context->keyCount);
+    __unsafe_unretained id *keys2 = context->values + (row2 * context->keyCount);
+    for (NSUInteger i = 0; i < context->keyCount; i++) {
+        NSComparisonResult result = UACompareSortValues(keys1[i], keys2[i], context->options);
+        if (result != NSOrderedSame) {
+            return result;
+        }
+    }
+    return NSOrderedSame;
+}
+
+static void UAInsertionSortRows(const UAKeyPathSorterContext *context, NSUInteger *rows, NSUInteger count) {
+    for (NSUInteger i = 1; i < count; i++) {
+        NSUInteger row = rows[i];
+        NSUInteger j = i;
+        for (; j > 0 && UACompareSortRows(context, rows[j - 1], row) == NSOrderedDescending; j--) {
+            rows[j] = rows[j - 1];
+        }
+        rows[j] = row;
+    }
+}
+
+// Merges neighbouring sorted runs of the specified width, doubling it until there is only one run left. The rows ping-pong
+// between the two buffers, so this returns whichever one they ended up in.
+static NSUInteger *UAMergeSortedRuns(const UAKeyPathSorterContext *context, NSUInteger *rows, NSUInteger *scratch, NSUInteger count, NSUInteger width, BOOL concurrently) {
+    NSUInteger *source = rows;
+    NSUInteger *destination = scratch;
+
+    for (; width < count; width *= 2) {
+        NSUInteger pairs = (count + (2 * width) - 1) / (2 * width);
+        NSUInteger *from = source, *to = destination;
+
+        void (^mergePair)(size_t) = ^(size_t pair) {
+            NSUInteger start = pair * 2 * width;
+            NSUInteger middle = MIN(start + width, count);
+            NSUInteger end = MIN(start + (2 * width), count);
+            NSUInteger left = start, right = middle, index = start;
+
+            // ties go to the left so the sort stays stable
+            while (left < middle && right < end) {
+                if (UACompareSortRows(context, from[right], from[left]) == NSOrderedAscending) {
+                    to[index++] = from[right++];
+                } else {
+                    to[index++] = from[left++];
+                }
+            }
+            memcpy(to + index, from + left, (middle - left) * sizeof(NSUInteger));
+            index += (middle - left);
+            memcpy(to + index, from + right, (end - right) * sizeof(NSUInteger));
+        };
+
+        if (concurrently && pairs > 1) {
+            dispatch_apply(pairs, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), mergePair);
+        } else {
+            for (NSUInteger pair = 0; pair < pairs; pair++) {
+                mergePair(pair);
+            }
+        }
+
+        source = to;
+        destination = from;
+    }
+    return source;
+}
+
+// a plain bottom up merge sort that leaves the sorted rows in rows
+static void UASortRows(const UAKeyPathSorterContext *context, NSUInteger *rows, NSUInteger *scratch, NSUInteger count) {
+    for (NSUInteger start = 0; start < count; start += UAKeyPathSorterRunLength) {
+        UAInsertionSortRows(context, rows + start, MIN(UAKeyPathSorterRunLength, count - start));
+    }
+
+    NSUInteger *sorted = UAMergeSortedRuns(context, rows, scratch, count, UAKeyPathSorterRunLength, NO);
+    if (sorted != rows) {
+        memcpy(rows, sorted, count * sizeof(NSUInteger));
+    }
+}
+
+NS_ASSUME_NONNULL_BEGIN
+@interface UAKeyPathSortKeys ()
+
+@property (nonatomic, strong) UAKeyPathSorter *sorter;
+@property (nonatomic, strong, readwrite) NSArray *objects;
+
+// every key of every row laid out row by row, NULL until the row has been read
+@property (nonatomic, strong) NSPointerArray *values;
+
+- (instancetype)initWithSorter:(UAKeyPathSorter *)sorter objects:(NSArray *)objects;
+
+@end
+
+@interface UAKeyPathSorter ()
+
+@property (nonatomic, strong, readwrite) NSArray *keyPaths;
+@property (nonatomic, readwrite) NSStringCompareOptions options;
+
+- (void)addKeysForObject:(id)object toArray:(NSMutableArray *)keys;
+
+@end
+
+@implementation UAKeyPathSorter
+
++ (instancetype)sorterWithSortKeyPath:(NSString *)sortKeyPath options:(NSStringCompareOptions)options {
+    NSParameterAssert(sortKeyPath != nil);
+
+    UAKeyPathSorter *sorter = [[self alloc] init];
+    sorter.keyPaths = [sortKeyPath componentsSeparatedByString:@","];
+    sorter.options = options;
+    return sorter;
+}
+
+#pragma mark - Equality
+
+- (BOOL)isEqual:(id)object {
+    if (object == self) {
+        return YES;
+    }
+    if (![object isKindOfClass:[UAKeyPathSorter class]]) {
+        return NO;
+    }
+
+    UAKeyPathSorter *sorter = object;
+    return sorter.options == self.options && [sorter.keyPaths isEqualToArray:self.keyPaths];
+}
+
+- (NSUInteger)hash {
+    return self.keyPaths.hash ^ self.options;
+}
+
+#pragma mark - Keys
+
+- (void)addKeysForObject:(id)object toArray:(NSMutableArray *)keys {
+    NSStringCompareOptions foldingOptions = (self.options & UAKeyPathSorterFoldingOptions);
+    for (NSString *keyPath in self.keyPaths) {
+        id value = [object valueForKeyPath:keyPath];
+        if (value == nil) {
+            value = [NSNull null];
+        } else if (foldingOptions != 0 && [value isKindOfClass:[NSString class]]) {
+            value = [value stringByFoldingWithOptions:foldingOptions locale:nil];
+        }
+        [keys addObject:value];
+    }
+}
+
+- (UAKeyPathSorterContext)contextForKeys:(NSArray *)keys buffer:(__unsafe_unretained id *)buffer {
+    [keys getObjects:buffer range:NSMakeRange(0, keys.count)];
+
+    UAKeyPathSorterContext context;
+    context.values = buffer;
+    context.keyCount = self.keyPaths.count;
+    context.options = (self.options & ~UAKeyPathSorterFoldingOptions);
+    return context;
+}
+
+#pragma mark - Sorting
+
+- (NSComparator)comparator {
+    return ^NSComparisonResult(id obj1, id obj2) {
+        NS_VALID_UNTIL_END_OF_SCOPE NSMutableArray *keys = [[NSMutableArray alloc] initWithCapacity:self.keyPaths.count * 2];
+        [self addKeysForObject:obj1 toArray:keys];
+        [self addKeysForObject:obj2 toArray:keys];
+
+        __unsafe_unretained id *buffer = (__unsafe_unretained id *)malloc(keys.count * sizeof(id));
+        UAKeyPathSorterContext context = [self contextForKeys:keys buffer:buffer];
+        NSComparisonResult result = UACompareSortRows(&context, 0, 1);
+        free(buffer);
+        return result;
+    };
+}
+
+- (NSMutableArray *)sortedArrayOfObjects:(NSArray *)objects concurrently:(BOOL)concurrently {
+    NSUInteger count = objects.count;
+    if (count < 2) {
+        return [objects mutableCopy];
+    }
+
+    // decorate: every key of every object, read once and laid out row by row
+    NS_VALID_UNTIL_END_OF_SCOPE NSMutableArray *keys = [[NSMutableArray alloc] initWithCapacity:count * self.keyPaths.count];
+    for (id object in objects) {
+        [self addKeysForObject:object toArray:keys];
+    }
+
+    __unsafe_unretained id *buffer = (__unsafe_unretained id *)malloc(keys.count * sizeof(id));
+    UAKeyPathSorterContext context = [self contextForKeys:keys buffer:buffer];
+    NSUInteger *rows = malloc(count * sizeof(NSUInteger));
+    NSUInteger *scratch = malloc(count * sizeof(NSUInteger));
+    for (NSUInteger row = 0; row < count; row++) {
+        rows[row] = row;
+    }
+
+    // sort: the row numbers only, comparing the keys we already have
+    if (concurrently) {
+        NSUInteger chunks = [[NSProcessInfo processInfo] activeProcessorCount] * 4;
+        NSUInteger chunkSize = MAX((count + chunks - 1) / chunks, 1024);
+        NSUInteger chunkCount = (count + chunkSize - 1) / chunkSize;
+        UAKeyPathSorterContext *sharedContext = &context;
+
+        dispatch_apply(chunkCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t chunk) {
+            NSUInteger start = chunk * chunkSize;
+            UASortRows(sharedContext, rows + start, scratch + start, MIN(chunkSize, count - start));
+        });
+
+        NSUInteger *sorted = UAMergeSortedRuns(&context, rows, scratch, count, chunkSize, YES);
+        if (sorted != rows) {
+            memcpy(rows, sorted, count * sizeof(NSUInteger));
+        }
+    } else {
+        UASortRows(&context, rows, scratch, count);
+    }
+
+    // undecorate: pick the objects out in their new order
+    NSMutableArray *sortedObjects = [[NSMutableArray alloc] initWithCapacity:count];
+    for (NSUInteger i = 0; i < count; i++) {
+        [sortedObjects addObject:[objects objectAtIndex:rows[i]]];
+    }
+
+    free(buffer);
+    free(rows);
+    free(scratch);
+    return sortedObjects;
+}
+
+- (UAKeyPathSortKeys *)sortKeysOfObjects:(NSArray *)objects {
+    return [[UAKeyPathSortKeys alloc] initWithSorter:self objects:objects];
+}
+
+@end
+
+@implementation UAKeyPathSortKeys
+
+- (instancetype)initWithSorter:(UAKeyPathSorter *)sorter objects:(NSArray *)objects {
+    self = [super init];
+    if (self) {
+        self.sorter = sorter;
+        self.objects = objects;
+        self.values = [NSPointerArray strongObjectsPointerArray];
+        self.values.count = objects.count * sorter.keyPaths.count;
+    }
+    return self;
+}
+
+- (void)readRow:(NSUInteger)row {
+    NSUInteger keyCount = self.sorter.keyPaths.count;
+    if ([self.values pointerAtIndex:row * keyCount] != NULL) {
+        return;
+    }
+
+    // a missing value is kept as NSNull, so a row that has been read never has a NULL key
+    NSMutableArray *keys = [[NSMutableArray alloc] initWithCapacity:keyCount];
+    [self.sorter addKeysForObject:self.objects[row] toArray:keys];
+    for (NSUInteger i = 0; i < keyCount; i++) {
+        [self.values replacePointerAtIndex:(row * keyCount) + i withPointer:(__bridge void *)keys[i]];
+    }
+}
+
+- (NSComparisonResult)compareRow:(NSUInteger)row toRow:(NSUInteger)otherRow ofKeys:(UAKeyPathSortKeys *)otherKeys {
+    NSParameterAssert([otherKeys.sorter isEqual:self.sorter]);
+
+    [self readRow:row];
+    [otherKeys readRow:otherRow];
+
+    NSUInteger keyCount = self.sorter.keyPaths.count;
+    NSStringCompareOptions options = (self.sorter.options & ~UAKeyPathSorterFoldingOptions);
+    for (NSUInteger i = 0; i < keyCount; i++) {
+        NSComparisonResult result = UACompareSortValues((__bridge id)[self.values pointerAtIndex:(row * keyCount) + i],
+                                                        (__bridge id)[otherKeys.values pointerAtIndex:(otherRow * keyCount) + i],
+                                                        options);
+        if (result != NSOrderedSame) {
+            return result;
+        }
+    }
+    return NSOrderedSame;
+}
+
+@end
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,45 @@
+//
+//  UAPagedArray.h
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "UAFilterableResultsDataProvider.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * A mutable array of one section of a UAFilterableResultsDataProvider's data, fetched a page at a time as it is read.
+ *
+ * The count is known up front. Reading a row fetches the page it is on, unless that page is already resident. All of the
+ * sections created together share one least recently used list of pages, so no more than maximumResidentPages are kept
+ * in memory across all of them. Reads are thread safe, and the data provider is never asked for a page while holding the
+ * lock on the others.
+ *
+ * Making any change to the array fetches every page of it and keeps them for good, after which it is an ordinary mutable
+ * array. So edits to paged data are best kept to sections that are small or already loaded. A copy made before then shares
+ * the pages rather than fetching them, and carries on paging them in after the original has been changed.
+**/
+@interface UAPagedArray : NSMutableArray
+
+/**
+ * Creates paged arrays for all of the provider's data.
+ *
+ * @param   provider                The data provider to fetch pages from.
+ * @param   pageSize                The number of rows in each page.
+ * @param   maximumResidentPages    The most pages to keep in memory across all sections, at least one.
+ * @returns                         A UAPagedArray if the provider's data is one dimensional, otherwise a mutable array with a UAPagedArray for each section.
+**/
++ (NSMutableArray *)dataWithProvider:(id<UAFilterableResultsDataProvider>)provider pageSize:(NSUInteger)pageSize maximumResidentPages:(NSUInteger)maximumResidentPages;
+
+/**
+ * Whether the array has been changed, and so holds all of its objects rather than fetching them.
+**/
+@property (nonatomic, readonly, getter=isMaterialized) BOOL materialized;
+
+@end
+
+NS_ASSUME_NONNULL_END
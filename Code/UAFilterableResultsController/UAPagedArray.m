@@ -0,0 +1,397 @@
+//
+//  UAPagedArray.m
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import "UAPagedArray.h"
+#import <pthread.h>
+
+@class UAPagedArrayPages;
+
+#pragma mark Pages
+
+// a resident page, and when it was last read
+@interface UAPagedArrayPage : NSObject
+
+@property (nonatomic, unsafe_unretained) UAPagedArrayPages *pages;
+@property (nonatomic) NSUInteger index;
+@property (nonatomic, strong) NSArray *objects;
+@property (nonatomic) unsigned long long lastUsed;
+
+@end
+
+@implementation UAPagedArrayPage
+@end
+
+#pragma mark - Page Cache
+
+// the pages of every section created together, and the lock that guards them
+@interface UAPagedArrayCache : NSObject {
+    @public
+    pthread_mutex_t _lock;
+    unsigned long long _clock;
+}
+
+@property (nonatomic, strong) id<UAFilterableResultsDataProvider> provider;
+@property (nonatomic) NSUInteger pageSize;
+@property (nonatomic) NSUInteger maximumResidentPages;
+@property (nonatomic, strong) NSMutableArray *residentPages;
+
+@end
+
+// the pages of one section, shared by a paged array and any copies of it
+@interface UAPagedArrayPages : NSObject
+
+@property (nonatomic, strong, readonly) UAPagedArrayCache *cache;
+@property (nonatomic, readonly) NSUInteger section;
+@property (nonatomic, readonly) NSUInteger count;
+
+- (instancetype)initWithCache:(UAPagedArrayCache *)cache section:(NSUInteger)section;
+
+- (NSArray *)objectsOfPageAtIndex:(NSUInteger)pageIndex keepingResident:(BOOL)keepResident;
+- (void)unloadPageAtIndex:(NSUInteger)pageIndex;
+
+@end
+
+@implementation UAPagedArrayCache
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        pthread_mutex_init(&_lock, NULL);
+        self.residentPages = [[NSMutableArray alloc] init];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    pthread_mutex_destroy(&_lock);
+}
+
+// must be called with the lock held
+- (void)didLoadPage:(UAPagedArrayPage *)page {
+    [self.residentPages addObject:page];
+
+    // let go of the least recently used pages until we're back under the limit. The list is short so a scan is fine.
+    NSMutableArray *residentPages = self.residentPages;
+    while (residentPages.count > self.maximumResidentPages) {
+        NSUInteger oldestIndex = 0;
+        unsigned long long oldest = ULLONG_MAX;
+        for (NSUInteger i = 0; i < residentPages.count; i++) {
+            UAPagedArrayPage *candidate = residentPages[i];
+            if (candidate.lastUsed < oldest) {
+                oldest = candidate.lastUsed;
+                oldestIndex = i;
+            }
+        }
+
+        UAPagedArrayPage *evicted = residentPages[oldestIndex];
+        [residentPages removeObjectAtIndex:oldestIndex];
+        [evicted.pages unloadPageAtIndex:evicted.index];
+    }
+}
+
+// must be called with the lock held
+- (void)forgetPagesOfSection:(UAPagedArrayPages *)pages {
+    NSMutableIndexSet *indexes = [[NSMutableIndexSet alloc] init];
+    [self.residentPages enumerateObjectsUsingBlock:^(UAPagedArrayPage *page, NSUInteger index, BOOL *stop) {
+        if (page.pages == pages) {
+            [indexes addIndex:index];
+        }
+    }];
+    [self.residentPages removeObjectsAtIndexes:indexes];
+}
+
+@end
+
+@implementation UAPagedArrayPages {
+    // a UAPagedArrayPage for each resident page and NSNull for the rest, guarded by the cache's lock
+    NSMutableArray *_pages;
+}
+
+- (instancetype)initWithCache:(UAPagedArrayCache *)cache section:(NSUInteger)section {
+    self = [super init];
+    if (self) {
+        _cache = cache;
+        _section = section;
+        _count = [cache.provider numberOfObjectsInSection:section];
+
+        NSUInteger pageCount = (_count + cache.pageSize - 1) / cache.pageSize;
+        _pages = [[NSMutableArray alloc] initWithCapacity:pageCount];
+        for (NSUInteger i = 0; i < pageCount; i++) {
+            [_pages addObject:[NSNull null]];
+        }
+    }
+    return self;
+}
+
+- (void)dealloc {
+    pthread_mutex_lock(&_cache->_lock);
+    [_cache forgetPagesOfSection:self];
+    pthread_mutex_unlock(&_cache->_lock);
+}
+
+// must be called with the lock held, returns nil if the page isn't resident
+- (nullable NSArray *)residentObjectsOfPageAtIndex:(NSUInteger)pageIndex {
+    UAPagedArrayPage *page = _pages[pageIndex];
+    if ((id)page == [NSNull null]) {
+        return nil;
+    }
+    page.lastUsed = ++_cache->_clock;
+    return page.objects;
+}
+
+- (NSArray *)objectsOfPageAtIndex:(NSUInteger)pageIndex keepingResident:(BOOL)keepResident {
+    UAPagedArrayCache *cache = self.cache;
+    pthread_mutex_lock(&cache->_lock);
+    NSArray *objects = [self residentObjectsOfPageAtIndex:pageIndex];
+    pthread_mutex_unlock(&cache->_lock);
+    if (objects != nil) {
+        return objects;
+    }
+
+    // the provider can take its time, so it's asked without the lock and the other sections can carry on being read meanwhile
+    NSUInteger pageSize = cache.pageSize;
+    NSRange range = NSMakeRange(pageIndex * pageSize, MIN(pageSize, _count - pageIndex * pageSize));
+    objects = [cache.provider objectsInSection:_section range:range];
+    if (objects.count != range.length) {
+        [NSException raise:NSInternalInconsistencyException format:@"The data provider returned %lu objects for rows %lu to %lu of section %lu.",
+         (unsigned long)objects.count, (unsigned long)range.location, (unsigned long)NSMaxRange(range) - 1, (unsigned long)_section];
+    }
+    if (!keepResident) {
+        return objects;
+    }
+
+    // another thread may have fetched it while we were, in which case we use theirs
+    pthread_mutex_lock(&cache->_lock);
+    NSArray *residentObjects = [self residentObjectsOfPageAtIndex:pageIndex];
+    if (residentObjects != nil) {
+        objects = residentObjects;
+    } else {
+        UAPagedArrayPage *page = [[UAPagedArrayPage alloc] init];
+        page.pages = self;
+        page.index = pageIndex;
+        page.objects = objects;
+        page.lastUsed = ++cache->_clock;
+        _pages[pageIndex] = page;
+        [cache didLoadPage:page];
+    }
+    pthread_mutex_unlock(&cache->_lock);
+    return objects;
+}
+
+// called by the cache with the lock held
+- (void)unloadPageAtIndex:(NSUInteger)pageIndex {
+    _pages[pageIndex] = [NSNull null];
+}
+
+@end
+
+#pragma mark - Pinning
+
+// The objects handed out in bulk are only retained by the page they're on, so each thread pins the pages it was last handed by each
+// array until it next reads from that array in bulk. Keeping them per thread means concurrent readers can't unpin each other.
+static pthread_key_t UAPagedArrayPinsKey;
+
+static void UAPagedArrayReleasePins(void *pins) {
+    CFRelease(pins);
+}
+
+static NSMapTable *UAPagedArrayPinsOfCurrentThread(void) {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        pthread_key_create(&UAPagedArrayPinsKey, UAPagedArrayReleasePins);
+    });
+
+    NSMapTable *pins = (__bridge NSMapTable *)pthread_getspecific(UAPagedArrayPinsKey);
+    if (pins == nil) {
+        pins = [NSMapTable weakToStrongObjectsMapTable];
+        pthread_setspecific(UAPagedArrayPinsKey, CFBridgingRetain(pins));
+    }
+    return pins;
+}
+
+#pragma mark - Implementation
+
+NS_ASSUME_NONNULL_BEGIN
+@implementation UAPagedArray {
+    // the section's pages, nil once materialised
+    UAPagedArrayPages *_pages;
+
+    // every object, once we've been changed
+    NSMutableArray *_materialized;
+}
+
++ (NSMutableArray *)dataWithProvider:(id<UAFilterableResultsDataProvider>)provider pageSize:(NSUInteger)pageSize maximumResidentPages:(NSUInteger)maximumResidentPages {
+    NSParameterAssert(provider != nil);
+    NSParameterAssert(pageSize > 0);
+
+    UAPagedArrayCache *cache = [[UAPagedArrayCache alloc] init];
+    cache.provider = provider;
+    cache.pageSize = MAX(pageSize, 1);
+    cache.maximumResidentPages = MAX(maximumResidentPages, 1);
+
+    if (![provider respondsToSelector:@selector(numberOfSections)]) {
+        return [[self alloc] initWithPages:[[UAPagedArrayPages alloc] initWithCache:cache section:0]];
+    }
+
+    NSUInteger numberOfSections = [provider numberOfSections];
+    NSMutableArray *sections = [[NSMutableArray alloc] initWithCapacity:numberOfSections];
+    for (NSUInteger section = 0; section < numberOfSections; section++) {
+        [sections addObject:[[self alloc] initWithPages:[[UAPagedArrayPages alloc] initWithCache:cache section:section]]];
+    }
+    return sections;
+}
+
+- (instancetype)initWithPages:(UAPagedArrayPages *)pages {
+    self = [super init];
+    if (self) {
+        _pages = pages;
+    }
+    return self;
+}
+
+- (BOOL)isMaterialized {
+    return (_materialized != nil);
+}
+
+- (void)materialize {
+    if (_materialized != nil) {
+        return;
+    }
+
+    // take what's resident, and fetch the rest without pushing anything else out. Any copies of us keep the pages.
+    UAPagedArrayPages *pages = _pages;
+    NSUInteger count = pages.count;
+    NSUInteger pageSize = pages.cache.pageSize;
+    NSMutableArray *objects = [[NSMutableArray alloc] initWithCapacity:count];
+    for (NSUInteger pageIndex = 0; pageIndex * pageSize < count; pageIndex++) {
+        [objects addObjectsFromArray:[pages objectsOfPageAtIndex:pageIndex keepingResident:NO]];
+    }
+
+    NSAssert(objects.count == count, @"The data provider returned the wrong number of objects for section %lu.", (unsigned long)pages.section);
+    _materialized = objects;
+    _pages = nil;
+}
+
+#pragma mark - NSCopying
+
+- (id)copyWithZone:(nullable NSZone *)zone {
+    if (_materialized != nil) {
+        return [_materialized copy];
+    }
+
+    // a copy shares our pages rather than reading them all, and keeps them when we're changed
+    return [[UAPagedArray alloc] initWithPages:_pages];
+}
+
+#pragma mark - NSArray
+
+- (NSUInteger)count {
+    return (_materialized != nil ? _materialized.count : _pages.count);
+}
+
+- (id)objectAtIndex:(NSUInteger)index {
+    if (_materialized != nil) {
+        return [_materialized objectAtIndex:index];
+    }
+    if (index >= _pages.count) {
+        [NSException raise:NSRangeException format:@"*** -[UAPagedArray objectAtIndex:]: index %lu beyond bounds [0 .. %ld]", (unsigned long)index, (long)_pages.count - 1];
+    }
+
+    NSUInteger pageSize = _pages.cache.pageSize;
+    return [[_pages objectsOfPageAtIndex:index / pageSize keepingResident:YES] objectAtIndex:index % pageSize];
+}
+
+- (void)getObjects:(id __unsafe_unretained [])objects range:(NSRange)range {
+    if (_materialized != nil) {
+        [_materialized getObjects:objects range:range];
+        return;
+    }
+    if (NSMaxRange(range) > _pages.count) {
+        [NSException raise:NSRangeException format:@"*** -[UAPagedArray getObjects:range:]: range %@ beyond bounds [0 .. %ld]", NSStringFromRange(range), (long)_pages.count - 1];
+    }
+
+    // a page at a time. Loading a later page can push out an earlier one, so every page we've copied from is pinned.
+    NSUInteger pageSize = _pages.cache.pageSize;
+    NSUInteger copied = 0;
+    NSArray *firstPage = nil;
+    NSMutableArray *touchedPages = nil;
+    while (copied < range.length) {
+        NSUInteger index = range.location + copied;
+        NSUInteger row = index % pageSize;
+        NSUInteger length = MIN(pageSize - row, range.length - copied);
+
+        NSArray *page = [_pages objectsOfPageAtIndex:index / pageSize keepingResident:YES];
+        [page getObjects:objects + copied range:NSMakeRange(row, length)];
+        if (firstPage == nil) {
+            firstPage = page;
+        } else {
+            if (touchedPages == nil) {
+                touchedPages = [[NSMutableArray alloc] initWithObjects:firstPage, nil];
+            }
+            [touchedPages addObject:page];
+        }
+        copied += length;
+    }
+
+    if (firstPage != nil) {
+        [UAPagedArrayPinsOfCurrentThread() setObject:(touchedPages ?: firstPage) forKey:self];
+    }
+}
+
+- (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state objects:(id __unsafe_unretained [])buffer count:(NSUInteger)len {
+    if (_materialized != nil) {
+        return [_materialized countByEnumeratingWithState:state objects:buffer count:len];
+    }
+
+    // state->state is the next row. We never hand out more than one page at a time, so that page stays pinned while the caller goes through it.
+    if (state->state == 0) {
+        state->mutationsPtr = &state->extra[0];
+    }
+    NSUInteger index = (NSUInteger)state->state;
+    NSUInteger count = _pages.count;
+    if (index >= count) {
+        return 0;
+    }
+
+    NSUInteger pageSize = _pages.cache.pageSize;
+    NSUInteger length = MIN(MIN(len, pageSize - index % pageSize), count - index);
+    [self getObjects:buffer range:NSMakeRange(index, length)];
+    state->state = index + length;
+    state->itemsPtr = buffer;
+    return length;
+}
+
+#pragma mark - NSMutableArray
+
+- (void)insertObject:(id)anObject atIndex:(NSUInteger)index {
+    [self materialize];
+    [_materialized insertObject:anObject atIndex:index];
+}
+
+- (void)removeObjectAtIndex:(NSUInteger)index {
+    [self materialize];
+    [_materialized removeObjectAtIndex:index];
+}
+
+- (void)addObject:(id)anObject {
+    [self materialize];
+    [_materialized addObject:anObject];
+}
+
+- (void)removeLastObject {
+    [self materialize];
+    [_materialized removeLastObject];
+}
+
+- (void)replaceObjectAtIndex:(NSUInteger)index withObject:(id)anObject {
+    [self materialize];
+    [_materialized replaceObjectAtIndex:index withObject:anObject];
+}
+
+@end
+NS_ASSUME_NONNULL_END
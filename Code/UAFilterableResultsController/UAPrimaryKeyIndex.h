@@ -0,0 +1,105 @@
+//
+//  UAPrimaryKeyIndex.h
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "NSIndexPath+UAIndexPathAdditions.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * A hash index from primary key to index path over a one or two dimensional data array.
+ *
+ * The index keeps a reference to the data array it was built from and is told about every change made to it, so it can
+ * be kept up to date without walking the data again. Rows that shift after an insertion or removal are not renumbered
+ * straight away; the section remembers the first row that may be out of date and that tail is renumbered the next time
+ * a key inside it is looked up. Each section keeps its entries in row order, so renumbering never looks at the objects.
+ *
+ * A key shared by more than one object belongs to the first of them in the data, and passes to the next when it goes.
+**/
+@interface UAPrimaryKeyIndex : NSObject
+
+/**
+ * The data array the index was built from.
+**/
+@property (nonatomic, strong, readonly) NSArray *data;
+
+/**
+ * The key path used to determine the primary key of each object.
+**/
+@property (nonatomic, copy, readonly) NSString *keyPath;
+
+/**
+ * Whether the index can be used. This is NO when the key path could not be applied to the objects in the data.
+**/
+@property (nonatomic, readonly, getter=isUsable) BOOL usable;
+
+/**
+ * Whether the index has lost track of the data, such as being told about a row that isn't there, and must be rebuilt
+ * before it is used again.
+**/
+@property (nonatomic, readonly) BOOL needsRebuild;
+
+/**
+ * Whether rows shifted by an earlier change may still need renumbering, which the next lookup to land on them would do.
+**/
+@property (nonatomic, readonly) BOOL hasStaleSections;
+
+/**
+ * Builds an index of the objects in the supplied data.
+ *
+ * @param   data                    A one or two dimensional array of data objects.
+ * @param   twoDimensional          Whether the data should be treated as an array of sections.
+ * @param   keyPath                 The key path applied to each object to determine its primary key.
+ * @returns                         An initialised UAPrimaryKeyIndex.
+**/
+- (instancetype)initWithData:(NSArray *)data twoDimensional:(BOOL)twoDimensional keyPath:(NSString *)keyPath;
+
+/**
+ * Builds an index of one dimensional data whose primary keys are already known, without asking the objects for them again.
+ *
+ * @param   data                    A one dimensional array of data objects.
+ * @param   keys                    The primary key of each object in the data, in the same order, or NSNull for an object without one.
+ * @param   keyPath                 The key path the keys were read from.
+ * @returns                         An initialised UAPrimaryKeyIndex.
+**/
+- (instancetype)initWithData:(NSArray *)data keys:(NSArray *)keys keyPath:(NSString *)keyPath;
+
+/**
+ * Returns the index path of the first object with the supplied primary key, or nil if there is none.
+**/
+- (nullable NSIndexPath *)indexPathForKey:(id)key;
+
+/**
+ * Returns the primary key of the supplied object, or nil if it does not have one.
+**/
+- (nullable id)keyForObject:(id)object;
+
+/**
+ * Returns the primary key the object in the supplied row was indexed under, or nil if it has none. The object isn't asked again.
+**/
+- (nullable id)indexedKeyAtRow:(NSUInteger)row inSection:(NSUInteger)sectionIndex;
+
+/**
+ * Renumbers every row that was shifted by an earlier change now, rather than on the next lookup that lands on it.
+ *
+ * Lookups don't change anything afterwards, until the next change, so they can be made from several threads at once.
+**/
+- (void)refreshStaleSections;
+
+/** @name Tracking Changes **/
+
+- (void)didInsertObject:(id)object atIndexPath:(NSIndexPath *)indexPath;
+- (void)didRemoveObject:(id)object atIndexPath:(NSIndexPath *)indexPath;
+- (void)didReplaceObject:(id)oldObject withObject:(id)newObject atIndexPath:(NSIndexPath *)indexPath;
+- (void)didInsertSection:(NSArray *)section atIndex:(NSUInteger)sectionIndex;
+- (void)didRemoveSection:(NSArray *)section atIndex:(NSUInteger)sectionIndex;
+- (void)didReplaceSection:(NSArray *)oldSection withSection:(NSArray *)newSection atIndex:(NSUInteger)sectionIndex;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,405 @@
+//
+//  UAPrimaryKeyIndex.m
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import "UAPrimaryKeyIndex.h"
+
+#pragma mark Index Records
+
+@class UAPrimaryKeyIndexEntry;
+
+@interface UAPrimaryKeyIndexSection : NSObject
+
+// the current index of the section within the data
+@property (nonatomic) NSUInteger index;
+
+// the first row whose entry may be out of date, NSNotFound if the whole section is current
+@property (nonatomic) NSUInteger staleFromRow;
+
+// the entry for each row in order, or NSNull for a row with no key, so rows are renumbered by position without looking at the objects
+@property (nonatomic, strong) NSMutableArray *rows;
+
+@end
+
+@implementation UAPrimaryKeyIndexSection
+@end
+
+@interface UAPrimaryKeyIndexEntry : NSObject
+
+@property (nonatomic, weak) UAPrimaryKeyIndexSection *section;
+@property (nonatomic) NSUInteger row;
+
+// what the object's key was when it was indexed, so the entry can be found again without asking the object
+@property (nonatomic, strong) id key;
+
+@end
+
+@implementation UAPrimaryKeyIndexEntry
+@end
+
+
+#pragma mark - Implementation
+
+NS_ASSUME_NONNULL_BEGIN
+@interface UAPrimaryKeyIndex ()
+
+@property (nonatomic, strong, readwrite) NSArray *data;
+@property (nonatomic, copy, readwrite) NSString *keyPath;
+@property (nonatomic, readwrite, getter=isUsable) BOOL usable;
+@property (nonatomic, readwrite) BOOL needsRebuild;
+@property (nonatomic, readwrite) BOOL hasStaleSections;
+
+@property (nonatomic) BOOL twoDimensional;
+@property (nonatomic, strong) NSMutableArray *sections;
+
+// each key maps to its entry, or to an array of entries when more than one row has it
+@property (nonatomic, strong) NSMapTable *entries;
+
+@end
+
+@implementation UAPrimaryKeyIndex
+
+- (instancetype)initWithData:(NSArray *)data twoDimensional:(BOOL)twoDimensional keyPath:(NSString *)keyPath {
+    self = [super init];
+    if (self) {
+        self.data = data;
+        self.keyPath = keyPath;
+        self.twoDimensional = twoDimensional;
+        self.usable = YES;
+        self.needsRebuild = NO;
+
+        NSUInteger sectionCount = twoDimensional ? data.count : 1;
+        self.sections = [[NSMutableArray alloc] initWithCapacity:sectionCount];
+        self.entries = [NSMapTable strongToStrongObjectsMapTable];
+
+        for (NSUInteger sectionIndex = 0; sectionIndex < sectionCount && self.usable; sectionIndex++) {
+            [self.sections addObject:[self indexedSectionOfRows:[self arrayForSectionAtIndex:sectionIndex] atIndex:sectionIndex]];
+        }
+    }
+    return self;
+}
+
+- (instancetype)initWithData:(NSArray *)data keys:(NSArray *)keys keyPath:(NSString *)keyPath {
+    NSParameterAssert(data.count == keys.count);
+
+    self = [super init];
+    if (self) {
+        self.data = data;
+        self.keyPath = keyPath;
+        self.twoDimensional = NO;
+        self.usable = YES;
+        self.needsRebuild = NO;
+        self.entries = [NSMapTable strongToStrongObjectsMapTable];
+
+        UAPrimaryKeyIndexSection *section = [self emptySectionAtIndex:0 capacity:keys.count];
+        for (NSUInteger rowIndex = 0; rowIndex < keys.count; rowIndex++) {
+            id key = keys[rowIndex];
+            [section.rows addObject:[self entryForKey:(key != [NSNull null] ? key : nil) inSection:section atRow:rowIndex]];
+        }
+        self.sections = [[NSMutableArray alloc] initWithObjects:section, nil];
+    }
+    return self;
+}
+
+- (NSArray *)arrayForSectionAtIndex:(NSUInteger)sectionIndex {
+    return self.twoDimensional ? self.data[sectionIndex] : self.data;
+}
+
+- (nullable id)keyForObject:(id)object {
+    @try {
+        return [object valueForKeyPath:self.keyPath];
+
+    } @catch (NSException *exception) {
+        return nil;
+    }
+}
+
+- (nullable id)indexedKeyForObject:(id)object {
+    @try {
+        return [object valueForKeyPath:self.keyPath];
+
+    } @catch (NSException *exception) {
+        // the objects in the data don't have the key path, the index is no use to anyone
+        self.usable = NO;
+        return nil;
+    }
+}
+
+- (nullable id)indexedKeyAtRow:(NSUInteger)row inSection:(NSUInteger)sectionIndex {
+    if (!self.usable || self.needsRebuild || sectionIndex >= self.sections.count) {
+        return nil;
+    }
+
+    // the rows are kept in order even when their numbers are stale
+    NSArray *rows = ((UAPrimaryKeyIndexSection *)self.sections[sectionIndex]).rows;
+    id entry = (row < rows.count ? rows[row] : nil);
+    return (entry != nil && entry != [NSNull null]) ? ((UAPrimaryKeyIndexEntry *)entry).key : nil;
+}
+
+#pragma mark - Lookup
+
+- (nullable NSIndexPath *)indexPathForKey:(id)key {
+    if (!self.usable || self.needsRebuild) {
+        return nil;
+    }
+
+    id value = [self.entries objectForKey:key];
+    if (value == nil) {
+        return nil;
+    }
+
+    // the first row with the key wins when there's more than one
+    UAPrimaryKeyIndexEntry *first = nil;
+    if ([value isKindOfClass:[NSMutableArray class]]) {
+        for (UAPrimaryKeyIndexEntry *entry in value) {
+            [self refreshEntry:entry];
+            if (first == nil || entry.section.index < first.section.index || (entry.section == first.section && entry.row < first.row)) {
+                first = entry;
+            }
+        }
+    } else {
+        first = value;
+        [self refreshEntry:first];
+    }
+
+    return [NSIndexPath indexPathForRow:(NSInteger)first.row inSection:(NSInteger)first.section.index];
+}
+
+- (void)refreshStaleSections {
+    if (!self.usable || self.needsRebuild) {
+        return;
+    }
+    for (UAPrimaryKeyIndexSection *section in self.sections) {
+        if (section.staleFromRow != NSNotFound) {
+            [self refreshSection:section];
+        }
+    }
+    self.hasStaleSections = NO;
+}
+
+#pragma mark - Indexing
+
+- (UAPrimaryKeyIndexSection *)emptySectionAtIndex:(NSUInteger)sectionIndex capacity:(NSUInteger)capacity {
+    UAPrimaryKeyIndexSection *section = [[UAPrimaryKeyIndexSection alloc] init];
+    section.index = sectionIndex;
+    section.staleFromRow = NSNotFound;
+    section.rows = [[NSMutableArray alloc] initWithCapacity:capacity];
+    return section;
+}
+
+- (UAPrimaryKeyIndexSection *)indexedSectionOfRows:(NSArray *)rows atIndex:(NSUInteger)sectionIndex {
+    UAPrimaryKeyIndexSection *section = [self emptySectionAtIndex:sectionIndex capacity:rows.count];
+    for (NSUInteger rowIndex = 0; rowIndex < rows.count && self.usable; rowIndex++) {
+        [section.rows addObject:[self entryForObject:rows[rowIndex] inSection:section atRow:rowIndex]];
+    }
+    return section;
+}
+
+// the entry for a row, added to the keys, or NSNull if the object has no key
+- (id)entryForObject:(id)object inSection:(UAPrimaryKeyIndexSection *)section atRow:(NSUInteger)row {
+    return [self entryForKey:[self indexedKeyForObject:object] inSection:section atRow:row];
+}
+
+- (id)entryForKey:(nullable id)key inSection:(UAPrimaryKeyIndexSection *)section atRow:(NSUInteger)row {
+    if (key == nil) {
+        return [NSNull null];
+    }
+
+    UAPrimaryKeyIndexEntry *entry = [[UAPrimaryKeyIndexEntry alloc] init];
+    entry.section = section;
+    entry.row = row;
+    entry.key = key;
+
+    id existing = [self.entries objectForKey:key];
+    if (existing == nil) {
+        [self.entries setObject:entry forKey:key];
+    } else if ([existing isKindOfClass:[NSMutableArray class]]) {
+        [existing addObject:entry];
+    } else {
+        [self.entries setObject:[[NSMutableArray alloc] initWithObjects:existing, entry, nil] forKey:key];
+    }
+    return entry;
+}
+
+- (void)removeEntry:(id)entry {
+    if (entry == [NSNull null]) {
+        return;
+    }
+
+    id key = ((UAPrimaryKeyIndexEntry *)entry).key;
+    id existing = [self.entries objectForKey:key];
+    if (existing == entry) {
+        [self.entries removeObjectForKey:key];
+
+    // whoever is left with the key keeps it, which is worked out when it's next looked up
+    } else if ([existing isKindOfClass:[NSMutableArray class]]) {
+        [existing removeObjectIdenticalTo:entry];
+        if ([existing count] == 1) {
+            [self.entries setObject:[existing firstObject] forKey:key];
+        }
+    }
+}
+
+- (void)refreshEntry:(UAPrimaryKeyIndexEntry *)entry {
+    // has it been shifted since we last looked?
+    UAPrimaryKeyIndexSection *section = entry.section;
+    if (section.staleFromRow != NSNotFound && entry.row >= section.staleFromRow) {
+        [self refreshSection:section];
+    }
+}
+
+- (void)refreshSection:(UAPrimaryKeyIndexSection *)section {
+    // every entry is in the position of its row, so renumbering is just counting
+    NSMutableArray *rows = section.rows;
+    NSUInteger count = rows.count;
+    for (NSUInteger rowIndex = section.staleFromRow; rowIndex < count; rowIndex++) {
+        id entry = rows[rowIndex];
+        if (entry != [NSNull null]) {
+            ((UAPrimaryKeyIndexEntry *)entry).row = rowIndex;
+        }
+    }
+    section.staleFromRow = NSNotFound;
+}
+
+- (void)markSection:(UAPrimaryKeyIndexSection *)section staleFromRow:(NSUInteger)row {
+    // anything past the end of the section has nothing to renumber
+    if (row >= section.rows.count) {
+        return;
+    }
+    if (section.staleFromRow == NSNotFound || row < section.staleFromRow) {
+        section.staleFromRow = row;
+    }
+    self.hasStaleSections = YES;
+}
+
+- (nullable UAPrimaryKeyIndexSection *)sectionForIndexPath:(NSIndexPath *)indexPath {
+    NSUInteger sectionIndex = self.twoDimensional ? (NSUInteger)indexPath.section : 0;
+    if (sectionIndex >= self.sections.count) {
+        self.needsRebuild = YES;
+        return nil;
+    }
+    return self.sections[sectionIndex];
+}
+
+#pragma mark - Tracking Changes
+
+- (void)didInsertObject:(id)object atIndexPath:(NSIndexPath *)indexPath {
+    if (!self.usable || self.needsRebuild) {
+        return;
+    }
+
+    UAPrimaryKeyIndexSection *section = [self sectionForIndexPath:indexPath];
+    NSUInteger row = (NSUInteger)indexPath.row;
+    if (section == nil || row > section.rows.count) {
+        self.needsRebuild = YES;
+        return;
+    }
+
+    [section.rows insertObject:[self entryForObject:object inSection:section atRow:row] atIndex:row];
+
+    // whatever was at this row has moved down one but still has this row stored against it, so it's stale too
+    [self markSection:section staleFromRow:row];
+}
+
+- (void)didRemoveObject:(id)object atIndexPath:(NSIndexPath *)indexPath {
+    if (!self.usable || self.needsRebuild) {
+        return;
+    }
+
+    UAPrimaryKeyIndexSection *section = [self sectionForIndexPath:indexPath];
+    NSUInteger row = (NSUInteger)indexPath.row;
+    if (section == nil || row >= section.rows.count) {
+        self.needsRebuild = YES;
+        return;
+    }
+
+    [self removeEntry:section.rows[row]];
+    [section.rows removeObjectAtIndex:row];
+    [self markSection:section staleFromRow:row];
+}
+
+- (void)didReplaceObject:(id)oldObject withObject:(id)newObject atIndexPath:(NSIndexPath *)indexPath {
+    if (!self.usable || self.needsRebuild) {
+        return;
+    }
+
+    UAPrimaryKeyIndexSection *section = [self sectionForIndexPath:indexPath];
+    NSUInteger row = (NSUInteger)indexPath.row;
+    if (section == nil || row >= section.rows.count) {
+        self.needsRebuild = YES;
+        return;
+    }
+
+    // same key, same place. Nothing to do.
+    id oldEntry = section.rows[row];
+    id newKey = [self indexedKeyForObject:newObject];
+    if (oldEntry != [NSNull null] && newKey != nil && [((UAPrimaryKeyIndexEntry *)oldEntry).key isEqual:newKey]) {
+        return;
+    }
+
+    [self removeEntry:oldEntry];
+    section.rows[row] = [self entryForObject:newObject inSection:section atRow:row];
+}
+
+- (void)didInsertSection:(NSArray *)rows atIndex:(NSUInteger)sectionIndex {
+    if (!self.usable || self.needsRebuild) {
+        return;
+    }
+    if (!self.twoDimensional || sectionIndex > self.sections.count) {
+        self.needsRebuild = YES;
+        return;
+    }
+
+    // everything after it moves down one
+    for (NSUInteger i = sectionIndex; i < self.sections.count; i++) {
+        UAPrimaryKeyIndexSection *section = self.sections[i];
+        section.index = i + 1;
+    }
+
+    [self.sections insertObject:[self indexedSectionOfRows:rows atIndex:sectionIndex] atIndex:sectionIndex];
+}
+
+- (void)didRemoveSection:(NSArray *)rows atIndex:(NSUInteger)sectionIndex {
+    if (!self.usable || self.needsRebuild) {
+        return;
+    }
+    if (!self.twoDimensional || sectionIndex >= self.sections.count) {
+        self.needsRebuild = YES;
+        return;
+    }
+
+    UAPrimaryKeyIndexSection *section = self.sections[sectionIndex];
+    for (id entry in section.rows) {
+        [self removeEntry:entry];
+    }
+    [self.sections removeObjectAtIndex:sectionIndex];
+
+    // everything after it moves up one
+    for (NSUInteger i = sectionIndex; i < self.sections.count; i++) {
+        UAPrimaryKeyIndexSection *later = self.sections[i];
+        later.index = i;
+    }
+}
+
+- (void)didReplaceSection:(NSArray *)oldRows withSection:(NSArray *)newRows atIndex:(NSUInteger)sectionIndex {
+    if (!self.usable || self.needsRebuild) {
+        return;
+    }
+    if (!self.twoDimensional || sectionIndex >= self.sections.count) {
+        self.needsRebuild = YES;
+        return;
+    }
+
+    UAPrimaryKeyIndexSection *section = self.sections[sectionIndex];
+    for (id entry in section.rows) {
+        [self removeEntry:entry];
+    }
+    self.sections[sectionIndex] = [self indexedSectionOfRows:newRows atIndex:sectionIndex];
+}
+
+@end
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,86 @@
+//
+//  UASectionBuckets.h
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * The section value of each section of two dimensional data that has been grouped by a key path.
+ *
+ * Every object in a section has the same value at the key path, and the sections are in ascending order of their values
+ * (compared using compare:, with nil first). The values are counted in a hash table alongside, so whether an object has a
+ * section to go into is O(1), and finding that section or where a new one goes is O(log sections).
+ *
+ * Like UASectionOffsets it keeps a reference to the data array it was built from and is told about every change made to it.
+ * Adding, removing or replacing an object is O(1). Adding or removing a whole section only counts its own value and checks it
+ * against its new neighbours; no other section is looked at. Sections added out of order, or more than one with the same
+ * value, still work, but are searched one by one until they're in order again. The first section with a value is the one
+ * objects go into.
+ * The only section that can be empty is the last one left, which takes whatever object is added to it next.
+**/
+@interface UASectionBuckets : NSObject
+
+/**
+ * The data array the buckets were built from.
+**/
+@property (nonatomic, strong, readonly) NSArray *data;
+
+/**
+ * The key path the objects are grouped by.
+**/
+@property (nonatomic, copy, readonly) NSString *keyPath;
+
+/**
+ * Groups objects into sections by the value at the key path.
+ *
+ * The objects in each section keep the order they were supplied in. This only touches what it is given, so it is safe
+ * to use off the main thread.
+ *
+ * @param   data                    A one or two dimensional array of objects. Two dimensional data is flattened first.
+ * @param   keyPath                 The key path whose value decides the section of each object.
+ * @returns                         A new array of mutable sections in order of their values. There is always at least one.
+**/
++ (NSMutableArray *)sectionsOfData:(NSArray *)data keyPath:(NSString *)keyPath;
+
+/**
+ * Reads the section values of every section.
+ *
+ * @param   sections                An array of sections, every object in each of them having the same value at the key path.
+ * @param   keyPath                 The key path the objects are grouped by.
+ * @returns                         An initialised UASectionBuckets.
+**/
+- (instancetype)initWithSections:(NSArray *)sections keyPath:(NSString *)keyPath;
+
+/**
+ * Returns the value of the section at the specified index, NSNull if its objects have no value at the key path, or nil if it is empty.
+**/
+- (nullable id)valueOfSectionAtIndex:(NSUInteger)sectionIndex;
+
+/**
+ * Returns the index of the section the object belongs in, or NSNotFound if it needs a new one.
+**/
+- (NSUInteger)indexOfSectionForObject:(id)object;
+
+/**
+ * Returns where a new section for the object should be inserted to keep the sections in order.
+**/
+- (NSUInteger)insertionIndexOfSectionForObject:(id)object;
+
+/** @name Tracking Changes **/
+
+- (void)didInsertObject:(id)object atIndexPath:(NSIndexPath *)indexPath;
+- (void)didRemoveObject:(id)object atIndexPath:(NSIndexPath *)indexPath;
+- (void)didReplaceObject:(id)oldObject withObject:(id)newObject atIndexPath:(NSIndexPath *)indexPath;
+- (void)didInsertSection:(NSArray *)section atIndex:(NSUInteger)sectionIndex;
+- (void)didRemoveSection:(NSArray *)section atIndex:(NSUInteger)sectionIndex;
+- (void)didReplaceSection:(NSArray *)oldSection withSection:(NSArray *)newSection atIndex:(NSUInteger)sectionIndex;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,292 @@
+//
+//  UASectionBuckets.m
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import "UASectionBuckets.h"
+
+// sections are ordered by their values, with no value (NSNull) first
+static NSComparisonResult UASectionBucketsCompareValues(id value1, id value2) {
+    if (value1 == value2 || [value1 isEqual:value2]) {
+        return NSOrderedSame;
+    }
+    if (value1 == [NSNull null]) {
+        return NSOrderedAscending;
+    }
+    if (value2 == [NSNull null]) {
+        return NSOrderedDescending;
+    }
+    return [value1 compare:value2];
+}
+
+NS_ASSUME_NONNULL_BEGIN
+@interface UASectionBuckets ()
+
+@property (nonatomic, strong, readwrite) NSArray *data;
+@property (nonatomic, copy, readwrite) NSString *keyPath;
+
+// the value of each section in order, the empty marker for an empty one
+@property (nonatomic, strong) NSMutableArray *values;
+
+// how many sections have each value, so whether an object has a section to go into is a single lookup
+@property (nonatomic, strong) NSCountedSet *valueCounts;
+
+// whether the sections are known to be in order of their values, and if so whether they are. In order they can be binary searched.
+@property (nonatomic) BOOL orderIsKnown;
+@property (nonatomic) BOOL inOrder;
+
+@end
+
+@implementation UASectionBuckets
+
++ (id)emptyMarker {
+    static id marker = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        marker = [[NSObject alloc] init];
+    });
+    return marker;
+}
+
++ (id)valueOfObject:(id)object keyPath:(NSString *)keyPath {
+    return ([object valueForKeyPath:keyPath] ?: [NSNull null]);
+}
+
++ (NSMutableArray *)sectionsOfData:(NSArray *)data keyPath:(NSString *)keyPath {
+    BOOL isTwoDimensional = (data.count > 0 && [data.firstObject isKindOfClass:[NSArray class]]);
+
+    // one bucket for each value, in the order they were first seen
+    NSMapTable *buckets = [NSMapTable strongToStrongObjectsMapTable];
+    NSMutableArray *values = [[NSMutableArray alloc] init];
+    for (NSArray *section in (isTwoDimensional ? data : @[ data ])) {
+        for (id object in section) {
+            id value = [self valueOfObject:object keyPath:keyPath];
+            NSMutableArray *bucket = [buckets objectForKey:value];
+            if (bucket == nil) {
+                bucket = [[NSMutableArray alloc] init];
+                [buckets setObject:bucket forKey:value];
+                [values addObject:value];
+            }
+            [bucket addObject:object];
+        }
+    }
+
+    if (values.count == 0) {
+        return [NSMutableArray arrayWithObject:[[NSMutableArray alloc] init]];
+    }
+
+    [values sortUsingComparator:^NSComparisonResult(id value1, id value2) {
+        return UASectionBucketsCompareValues(value1, value2);
+    }];
+    NSMutableArray *sections = [[NSMutableArray alloc] initWithCapacity:values.count];
+    for (id value in values) {
+        [sections addObject:[buckets objectForKey:value]];
+    }
+    return sections;
+}
+
+- (instancetype)initWithSections:(NSArray *)sections keyPath:(NSString *)keyPath {
+    self = [super init];
+    if (self) {
+        self.data = sections;
+        self.keyPath = keyPath;
+        self.values = [[NSMutableArray alloc] initWithCapacity:sections.count];
+        self.valueCounts = [[NSCountedSet alloc] initWithCapacity:sections.count];
+        for (NSArray *section in sections) {
+            id value = [self valueOfSection:section];
+            [self.values addObject:value];
+            [self addValueToCounts:value];
+        }
+        self.orderIsKnown = NO;
+    }
+    return self;
+}
+
+- (id)valueOfSection:(NSArray *)section {
+    if (section.count == 0) {
+        return [[self class] emptyMarker];
+    }
+    return [[self class] valueOfObject:section.firstObject keyPath:self.keyPath];
+}
+
+- (void)addValueToCounts:(id)value {
+    if (value != [[self class] emptyMarker]) {
+        [self.valueCounts addObject:value];
+    }
+}
+
+- (void)removeValueFromCounts:(id)value {
+    if (value != [[self class] emptyMarker]) {
+        [self.valueCounts removeObject:value];
+    }
+}
+
+#pragma mark - Ordering
+
+- (BOOL)isValue:(id)value inOrderBeforeValue:(id)otherValue {
+    // an empty section amongst others is on its way out, and the others can't be searched around it
+    id emptyMarker = [[self class] emptyMarker];
+    return value != emptyMarker && otherValue != emptyMarker && UASectionBucketsCompareValues(value, otherValue) != NSOrderedDescending;
+}
+
+- (BOOL)isInOrder {
+    if (!self.orderIsKnown) {
+        BOOL inOrder = YES;
+        for (NSUInteger i = 1; i < self.values.count && inOrder; i++) {
+            inOrder = [self isValue:self.values[i - 1] inOrderBeforeValue:self.values[i]];
+        }
+        self.inOrder = inOrder;
+        self.orderIsKnown = YES;
+    }
+    return self.inOrder;
+}
+
+// Sections that were in order only need the pairs of neighbours that start in the range checked. Sections that weren't might
+// have been put right, which is worked out again the next time it matters.
+- (void)updateOrderOfSectionsInRange:(NSRange)range {
+    if (!self.orderIsKnown) {
+        return;
+    }
+    if (!self.inOrder) {
+        self.orderIsKnown = NO;
+        return;
+    }
+
+    NSArray *values = self.values;
+    for (NSUInteger i = MAX(range.location, 1); i <= NSMaxRange(range) && i < values.count; i++) {
+        if (![self isValue:values[i - 1] inOrderBeforeValue:values[i]]) {
+            self.inOrder = NO;
+            return;
+        }
+    }
+}
+
+#pragma mark - Lookups
+
+- (nullable id)valueOfSectionAtIndex:(NSUInteger)sectionIndex {
+    if (sectionIndex >= self.values.count) {
+        return nil;
+    }
+    id value = self.values[sectionIndex];
+    return (value == [[self class] emptyMarker] ? nil : value);
+}
+
+- (NSUInteger)indexOfSectionForObject:(id)object {
+    id value = [[self class] valueOfObject:object keyPath:self.keyPath];
+    NSArray *values = self.values;
+    if ([self.valueCounts countForObject:value] == 0) {
+
+        // the last section standing takes anything
+        if (values.count == 1 && values.firstObject == [[self class] emptyMarker]) {
+            return 0;
+        }
+        return NSNotFound;
+    }
+
+    // the first section with the value is the one objects go into
+    if ([self isInOrder]) {
+        NSUInteger low = 0;
+        NSUInteger high = values.count;
+        while (low < high) {
+            NSUInteger middle = low + (high - low) / 2;
+            if (UASectionBucketsCompareValues(values[middle], value) == NSOrderedAscending) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        return low;
+    }
+
+    id emptyMarker = [[self class] emptyMarker];
+    for (NSUInteger i = 0; i < values.count; i++) {
+        if (values[i] != emptyMarker && [values[i] isEqual:value]) {
+            return i;
+        }
+    }
+    return NSNotFound;
+}
+
+- (NSUInteger)insertionIndexOfSectionForObject:(id)object {
+    id value = [[self class] valueOfObject:object keyPath:self.keyPath];
+    id emptyMarker = [[self class] emptyMarker];
+
+    // the first section whose value comes after this one
+    NSUInteger low = 0;
+    NSUInteger high = self.values.count;
+    while (low < high) {
+        NSUInteger middle = low + (high - low) / 2;
+        id sectionValue = self.values[middle];
+        if (sectionValue == emptyMarker || UASectionBucketsCompareValues(sectionValue, value) != NSOrderedDescending) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+#pragma mark - Tracking Changes
+
+- (void)changeValueOfSectionAtIndex:(NSUInteger)sectionIndex toValue:(id)value {
+    [self removeValueFromCounts:self.values[sectionIndex]];
+    self.values[sectionIndex] = value;
+    [self addValueToCounts:value];
+    [self updateOrderOfSectionsInRange:NSMakeRange(sectionIndex, 1)];
+}
+
+// an object change only matters when it empties a section or fills an empty one
+- (void)refreshSectionAtIndex:(NSUInteger)sectionIndex {
+    if (sectionIndex >= self.values.count || sectionIndex >= self.data.count) {
+        return;
+    }
+
+    id oldValue = self.values[sectionIndex];
+    id newValue = [self valueOfSection:self.data[sectionIndex]];
+    if (oldValue == newValue || [oldValue isEqual:newValue]) {
+        return;
+    }
+    [self changeValueOfSectionAtIndex:sectionIndex toValue:newValue];
+}
+
+- (void)didInsertObject:(id)object atIndexPath:(NSIndexPath *)indexPath {
+    [self refreshSectionAtIndex:(NSUInteger)indexPath.section];
+}
+
+- (void)didRemoveObject:(id)object atIndexPath:(NSIndexPath *)indexPath {
+    [self refreshSectionAtIndex:(NSUInteger)indexPath.section];
+}
+
+- (void)didReplaceObject:(id)oldObject withObject:(id)newObject atIndexPath:(NSIndexPath *)indexPath {
+    [self refreshSectionAtIndex:(NSUInteger)indexPath.section];
+}
+
+- (void)didInsertSection:(NSArray *)section atIndex:(NSUInteger)sectionIndex {
+    id value = [self valueOfSection:section];
+    NSUInteger index = MIN(sectionIndex, self.values.count);
+    [self.values insertObject:value atIndex:index];
+    [self addValueToCounts:value];
+    [self updateOrderOfSectionsInRange:NSMakeRange(index, 1)];
+}
+
+- (void)didRemoveSection:(NSArray *)section atIndex:(NSUInteger)sectionIndex {
+    if (sectionIndex >= self.values.count) {
+        return;
+    }
+
+    [self removeValueFromCounts:self.values[sectionIndex]];
+    [self.values removeObjectAtIndex:sectionIndex];
+    [self updateOrderOfSectionsInRange:NSMakeRange(sectionIndex, 0)];
+}
+
+- (void)didReplaceSection:(NSArray *)oldSection withSection:(NSArray *)newSection atIndex:(NSUInteger)sectionIndex {
+    if (sectionIndex < self.values.count) {
+        [self changeValueOfSectionAtIndex:sectionIndex toValue:[self valueOfSection:newSection]];
+    }
+}
+
+@end
+NS_ASSUME_NONNULL_END
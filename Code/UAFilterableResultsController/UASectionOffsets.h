@@ -0,0 +1,79 @@
+//
+//  UASectionOffsets.h
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "NSIndexPath+UAIndexPathAdditions.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * A running total of the section sizes of a one or two dimensional data array.
+ *
+ * The sizes are kept in a Fenwick (binary indexed) tree, so the offset of a section from the start of the data, and the
+ * section that contains a given offset, can both be found in O(log sections). The total count is kept alongside and is O(1).
+ *
+ * Like UAPrimaryKeyIndex it keeps a reference to the data array it was built from and is told about every change made to
+ * it. Adding or removing an object is O(log sections), adding or removing a whole section rebuilds the tree in O(sections).
+**/
+@interface UASectionOffsets : NSObject
+
+/**
+ * The data array the offsets were built from.
+**/
+@property (nonatomic, strong, readonly) NSArray *data;
+
+/**
+ * The total number of objects in every section.
+**/
+@property (nonatomic, readonly) NSUInteger count;
+
+/**
+ * The number of sections. This is always 1 for one dimensional data.
+**/
+@property (nonatomic, readonly) NSUInteger numberOfSections;
+
+/**
+ * A counter that changes every time the offsets are told about a change, for detecting mutation during enumeration.
+**/
+@property (nonatomic, readonly) unsigned long mutations;
+
+/**
+ * Adds up the sections of the supplied data.
+ *
+ * @param   data                    A one or two dimensional array of data objects.
+ * @param   twoDimensional          Whether the data should be treated as an array of sections.
+ * @returns                         An initialised UASectionOffsets.
+**/
+- (instancetype)initWithData:(NSArray *)data twoDimensional:(BOOL)twoDimensional;
+
+/**
+ * Returns the number of objects in the sections before the specified one.
+**/
+- (NSUInteger)offsetOfSection:(NSUInteger)sectionIndex;
+
+/**
+ * Returns the position of the specified index path counting across all sections, or NSNotFound if it is out of bounds.
+**/
+- (NSUInteger)offsetOfIndexPath:(NSIndexPath *)indexPath;
+
+/**
+ * Returns the index path of the object at the specified position counting across all sections, or nil if it is out of bounds.
+**/
+- (nullable NSIndexPath *)indexPathForOffset:(NSUInteger)offset;
+
+/** @name Tracking Changes **/
+
+- (void)didInsertObjectAtIndexPath:(NSIndexPath *)indexPath;
+- (void)didRemoveObjectAtIndexPath:(NSIndexPath *)indexPath;
+- (void)didInsertSection:(NSArray *)section atIndex:(NSUInteger)sectionIndex;
+- (void)didRemoveSection:(NSArray *)section atIndex:(NSUInteger)sectionIndex;
+- (void)didReplaceSection:(NSArray *)oldSection withSection:(NSArray *)newSection atIndex:(NSUInteger)sectionIndex;
+
+@end
+
+NS_ASSUME_NONNULL_END
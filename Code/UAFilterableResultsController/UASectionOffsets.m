@@ -0,0 +1,179 @@
+//
+//  UASectionOffsets.m
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import "UASectionOffsets.h"
+
+NS_ASSUME_NONNULL_BEGIN
+@interface UASectionOffsets ()
+
+@property (nonatomic, strong, readwrite) NSArray *data;
+@property (nonatomic, readwrite) NSUInteger count;
+@property (nonatomic, readwrite) NSUInteger numberOfSections;
+@property (nonatomic, readwrite) unsigned long mutations;
+
+@property (nonatomic) BOOL twoDimensional;
+
+// the size of each section, and the Fenwick tree over them (1-based, so tree[0] is unused)
+@property (nonatomic) NSUInteger *sizes;
+@property (nonatomic) NSUInteger *tree;
+@property (nonatomic) NSUInteger capacity;
+
+@end
+
+@implementation UASectionOffsets
+
+- (instancetype)initWithData:(NSArray *)data twoDimensional:(BOOL)twoDimensional {
+    self = [super init];
+    if (self) {
+        self.data = data;
+        self.twoDimensional = twoDimensional;
+
+        NSUInteger sectionCount = (twoDimensional ? data.count : 1);
+        [self ensureCapacity:sectionCount];
+        for (NSUInteger sectionIndex = 0; sectionIndex < sectionCount; sectionIndex++) {
+            self.sizes[sectionIndex] = (twoDimensional ? [data[sectionIndex] count] : data.count);
+        }
+        self.numberOfSections = sectionCount;
+        [self rebuildTree];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    free(_sizes);
+    free(_tree);
+}
+
+- (void)ensureCapacity:(NSUInteger)sectionCount {
+    if (sectionCount <= self.capacity && self.sizes != NULL) {
+        return;
+    }
+
+    NSUInteger capacity = MAX(MAX(sectionCount, self.capacity * 2), 8);
+    self.sizes = realloc(self.sizes, capacity * sizeof(NSUInteger));
+    self.tree = realloc(self.tree, (capacity + 1) * sizeof(NSUInteger));
+    self.capacity = capacity;
+}
+
+// builds the tree from the sizes in O(sections) by pushing each node's total up to its parent
+- (void)rebuildTree {
+    NSUInteger sectionCount = self.numberOfSections;
+    NSUInteger *tree = self.tree;
+    NSUInteger count = 0;
+
+    for (NSUInteger i = 1; i <= sectionCount; i++) {
+        tree[i] = self.sizes[i - 1];
+        count += tree[i];
+    }
+    for (NSUInteger i = 1; i <= sectionCount; i++) {
+        NSUInteger parent = i + (i & -i);
+        if (parent <= sectionCount) {
+            tree[parent] += tree[i];
+        }
+    }
+    self.count = count;
+}
+
+- (void)addToSectionAtIndex:(NSUInteger)sectionIndex delta:(NSInteger)delta {
+    NSParameterAssert(sectionIndex < self.numberOfSections);
+
+    self.mutations = (self.mutations + 1);
+    self.sizes[sectionIndex] = (NSUInteger)((NSInteger)self.sizes[sectionIndex] + delta);
+    self.count = (NSUInteger)((NSInteger)self.count + delta);
+
+    NSUInteger *tree = self.tree;
+    for (NSUInteger i = sectionIndex + 1; i <= self.numberOfSections; i += (i & -i)) {
+        tree[i] = (NSUInteger)((NSInteger)tree[i] + delta);
+    }
+}
+
+#pragma mark - Offsets
+
+- (NSUInteger)offsetOfSection:(NSUInteger)sectionIndex {
+    NSParameterAssert(sectionIndex <= self.numberOfSections);
+
+    NSUInteger offset = 0;
+    const NSUInteger *tree = self.tree;
+    for (NSUInteger i = sectionIndex; i > 0; i -= (i & -i)) {
+        offset += tree[i];
+    }
+    return offset;
+}
+
+- (NSUInteger)offsetOfIndexPath:(NSIndexPath *)indexPath {
+    NSUInteger sectionIndex = (self.twoDimensional ? (NSUInteger)indexPath.section : 0);
+    if (sectionIndex >= self.numberOfSections || (NSUInteger)indexPath.row >= self.sizes[sectionIndex]) {
+        return NSNotFound;
+    }
+    return [self offsetOfSection:sectionIndex] + (NSUInteger)indexPath.row;
+}
+
+- (nullable NSIndexPath *)indexPathForOffset:(NSUInteger)offset {
+    if (offset >= self.count) {
+        return nil;
+    }
+
+    // walk down the tree skipping every run of sections that ends at or before the offset, which leaves us just before
+    // the first non-empty section that contains it
+    NSUInteger sectionCount = self.numberOfSections;
+    NSUInteger step = 1;
+    while (step * 2 <= sectionCount) {
+        step *= 2;
+    }
+
+    const NSUInteger *tree = self.tree;
+    NSUInteger position = 0;
+    NSUInteger remaining = offset;
+    for (; step > 0; step /= 2) {
+        if (position + step <= sectionCount && tree[position + step] <= remaining) {
+            position += step;
+            remaining -= tree[position];
+        }
+    }
+
+    return [NSIndexPath indexPathForRow:(NSInteger)remaining inSection:(NSInteger)position];
+}
+
+#pragma mark - Tracking Changes
+
+- (void)didInsertObjectAtIndexPath:(NSIndexPath *)indexPath {
+    [self addToSectionAtIndex:(self.twoDimensional ? (NSUInteger)indexPath.section : 0) delta:1];
+}
+
+- (void)didRemoveObjectAtIndexPath:(NSIndexPath *)indexPath {
+    [self addToSectionAtIndex:(self.twoDimensional ? (NSUInteger)indexPath.section : 0) delta:-1];
+}
+
+- (void)didInsertSection:(NSArray *)section atIndex:(NSUInteger)sectionIndex {
+    NSParameterAssert(self.twoDimensional);
+    NSParameterAssert(sectionIndex <= self.numberOfSections);
+
+    [self ensureCapacity:self.numberOfSections + 1];
+    memmove(self.sizes + sectionIndex + 1, self.sizes + sectionIndex, (self.numberOfSections - sectionIndex) * sizeof(NSUInteger));
+    self.sizes[sectionIndex] = section.count;
+    self.numberOfSections = (self.numberOfSections + 1);
+    self.mutations = (self.mutations + 1);
+    [self rebuildTree];
+}
+
+- (void)didRemoveSection:(NSArray *)section atIndex:(NSUInteger)sectionIndex {
+    NSParameterAssert(self.twoDimensional);
+    NSParameterAssert(sectionIndex < self.numberOfSections);
+
+    memmove(self.sizes + sectionIndex, self.sizes + sectionIndex + 1, (self.numberOfSections - sectionIndex - 1) * sizeof(NSUInteger));
+    self.numberOfSections = (self.numberOfSections - 1);
+    self.mutations = (self.mutations + 1);
+    [self rebuildTree];
+}
+
+- (void)didReplaceSection:(NSArray *)oldSection withSection:(NSArray *)newSection atIndex:(NSUInteger)sectionIndex {
+    [self addToSectionAtIndex:sectionIndex delta:(NSInteger)newSection.count - (NSInteger)self.sizes[sectionIndex]];
+}
+
+@end
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,58 @@
+//
+//  UATextSearchFilter.h
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import "UAFilter.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * A filter that matches objects whose text at any of the key paths contains the query, ignoring case and diacritics.
+ *
+ * It matches the same objects as a predicate of "keyPath CONTAINS[cd] query" for each key path joined with OR, and that is
+ * what its -predicate is. But when it is applied by a UAFilterableResultsController, the controller keeps a trigram index
+ * of the text at those key paths (see UATextSearchIndex) that is built once and kept up to date as objects change. Each new
+ * query then only looks at the objects that share its trigrams, and a query that extends the previous one only looks at the
+ * objects that matched before.
+ *
+ * For search-as-you-type, give every search filter the same group so each keystroke replaces the previous filter.
+**/
+@interface UATextSearchFilter : UAFilter
+
+/**
+ * The text to look for.
+**/
+@property (nonatomic, copy, readonly) NSString *query;
+
+/**
+ * The key paths whose text is searched.
+**/
+@property (nonatomic, copy, readonly) NSArray *keyPaths;
+
+/**
+ * Creates a text search filter.
+ *
+ * @param   query                   The text to look for. An empty query matches everything.
+ * @param   keyPaths                The key paths to search, whose values should be strings or collections of strings.
+ * @returns                         An allocated and initialised UATextSearchFilter.
+**/
++ (UATextSearchFilter *)filterWithQuery:(NSString *)query keyPaths:(NSArray *)keyPaths;
+
+/**
+ * Creates a text search filter with the specified title and group.
+ *
+ * @param   title                   The title of the filter, not used internally.
+ * @param   groupTitle              The title of a group that this filter belongs to. Filters from the same group replace each other.
+ * @param   query                   The text to look for. An empty query matches everything.
+ * @param   keyPaths                The key paths to search, whose values should be strings or collections of strings.
+ * @returns                         An allocated and initialised UATextSearchFilter.
+**/
++ (UATextSearchFilter *)filterWithTitle:(nullable NSString *)title group:(nullable NSString *)groupTitle query:(NSString *)query keyPaths:(NSArray *)keyPaths;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,129 @@
+//
+//  UATextSearchFilter.m
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import "UATextSearchFilter.h"
+#import "UAFilterableResultsController+Private.h"
+
+// the documents that matched, and the index and generation they were looked up in, so they're always read together
+@interface UATextSearchFilterResults : NSObject
+
+@property (nonatomic, strong) NSIndexSet *documents;
+@property (nonatomic, weak) UATextSearchIndex *index;
+@property (nonatomic) NSUInteger generation;
+
+@end
+
+@implementation UATextSearchFilterResults
+@end
+
+NS_ASSUME_NONNULL_BEGIN
+@interface UATextSearchFilter ()
+
+@property (nonatomic, copy, readwrite) NSString *query;
+@property (nonatomic, copy, readwrite) NSArray *keyPaths;
+@property (nonatomic, copy) NSString *foldedQuery;
+
+@property (atomic, strong, readwrite, nullable) UATextSearchIndex *searchIndex;
+@property (atomic, strong, nullable) UATextSearchFilterResults *results;
+@property (nonatomic, strong, nullable) NSPredicate *indexedPredicate;
+
+@end
+
+@implementation UATextSearchFilter
+
++ (UATextSearchFilter *)filterWithQuery:(NSString *)query keyPaths:(NSArray *)keyPaths {
+    return [self filterWithTitle:nil group:nil query:query keyPaths:keyPaths];
+}
+
++ (UATextSearchFilter *)filterWithTitle:(nullable NSString *)title group:(nullable NSString *)groupTitle query:(NSString *)query keyPaths:(NSArray *)keyPaths {
+    NSParameterAssert(query != nil);
+    NSParameterAssert(keyPaths.count > 0);
+
+    UATextSearchFilter *filter = [[UATextSearchFilter alloc] init];
+    [filter setTitle:title];
+    [filter setGroupTitle:groupTitle];
+    filter.query = query;
+    filter.keyPaths = keyPaths;
+    filter.foldedQuery = [UATextSearchIndex foldedString:query];
+
+    // the same thing as a plain predicate, for when there's no index to hand
+    if (query.length > 0) {
+        NSMutableArray *subpredicates = [[NSMutableArray alloc] initWithCapacity:keyPaths.count];
+        for (NSString *keyPath in keyPaths) {
+            [subpredicates addObject:[NSPredicate predicateWithFormat:@"%K CONTAINS[cd] %@", keyPath, query]];
+        }
+        [filter setPredicate:[NSCompoundPredicate orPredicateWithSubpredicates:subpredicates]];
+    }
+    return filter;
+}
+
+- (NSPredicate *)evaluatedPredicate {
+    if (self.query.length == 0) {
+        return nil;
+    }
+    if (self.searchIndex == nil) {
+        return [super evaluatedPredicate];
+    }
+
+    // the same predicate object is handed out for as long as we're using this index
+    if (self.indexedPredicate == nil) {
+        __weak UATextSearchFilter *filter = self;
+        self.indexedPredicate = [NSPredicate predicateWithBlock:^BOOL(id evaluatedObject, NSDictionary *bindings) {
+            return [filter indexedEvaluateWithObject:evaluatedObject];
+        }];
+    }
+    return self.indexedPredicate;
+}
+
+- (BOOL)indexedEvaluateWithObject:(id)object {
+    UATextSearchIndex *index = self.searchIndex;
+    UATextSearchFilterResults *results = self.results;
+
+    // the looked up results are good for anything that was in the index at the time
+    if (results != nil && results.index == index && results.generation == index.generation) {
+        NSUInteger document = [index documentOfObject:object];
+        if (document != NSNotFound) {
+            return [results.documents containsIndex:document];
+        }
+    }
+    return [index object:object containsFoldedQuery:self.foldedQuery];
+}
+
+@end
+
+#pragma mark - Searching
+
+@implementation UATextSearchFilter (Searching)
+
+- (BOOL)isPreparedWithIndex:(UATextSearchIndex *)index {
+    UATextSearchFilterResults *results = self.results;
+    return (self.searchIndex == index && results != nil && results.index == index && results.generation == index.generation);
+}
+
+- (void)prepareWithIndex:(UATextSearchIndex *)index {
+    [self attachToIndex:index];
+    [self lookUpQueryInIndex:index];
+}
+
+- (void)attachToIndex:(UATextSearchIndex *)index {
+    if (self.searchIndex != index) {
+        self.searchIndex = index;
+        self.indexedPredicate = nil;
+    }
+}
+
+- (void)lookUpQueryInIndex:(UATextSearchIndex *)index {
+    UATextSearchFilterResults *results = [[UATextSearchFilterResults alloc] init];
+    results.index = index;
+    results.generation = index.generation;
+    results.documents = [index documentsMatchingQuery:self.query];
+    self.results = results;
+}
+
+@end
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,93 @@
+//
+//  UATextSearchIndex.h
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * A trigram inverted index over the text found at a set of key paths of each object in the data.
+ *
+ * The strings at each key path are folded the same way as CONTAINS[cd] (case and diacritic insensitive) and every run of three
+ * characters is recorded against the object. A query is answered by intersecting the lists of the query's trigrams, smallest
+ * first, and then checking the few candidates that are left actually contain the query. Queries shorter than three characters
+ * check every object, which is still much cheaper than a predicate as the text is already folded.
+ *
+ * The most recent query and its results are remembered, so a query that contains the previous one (as when someone keeps typing)
+ * only has to check the objects that matched last time.
+ *
+ * Objects are recognised by identity. Lookups are safe from any thread; changes must all be made from one.
+**/
+@interface UATextSearchIndex : NSObject
+
+/**
+ * The key paths whose text is indexed.
+**/
+@property (nonatomic, copy, readonly) NSArray *keyPaths;
+
+/**
+ * The data the index was last built from.
+**/
+@property (nonatomic, weak, readonly, nullable) NSArray *data;
+
+/**
+ * Bumped every time an object is added to or removed from the index.
+**/
+@property (atomic, readonly) NSUInteger generation;
+
+/**
+ * Folds a string the way CONTAINS[cd] compares them.
+**/
++ (NSString *)foldedString:(NSString *)string;
+
+/**
+ * Creates an empty index.
+ *
+ * @param   keyPaths                The key paths to read the text of each object from. Strings, and collections of strings, are indexed.
+ * @returns                         An initialised UATextSearchIndex.
+**/
+- (instancetype)initWithKeyPaths:(NSArray *)keyPaths;
+
+/**
+ * Throws away everything in the index and indexes every object in the data.
+ *
+ * @param   data                    A one or two dimensional array of data objects.
+ * @param   twoDimensional          Whether the data should be treated as an array of sections.
+**/
+- (void)rebuildWithData:(NSArray *)data twoDimensional:(BOOL)twoDimensional;
+
+/**
+ * Returns the document number of an object in the index, or NSNotFound if it hasn't been indexed.
+**/
+- (NSUInteger)documentOfObject:(id)object;
+
+/**
+ * Returns the document numbers of every object whose text contains the query.
+ *
+ * @param   query                   The text to look for. It is folded before it is looked up.
+ * @returns                         The matching document numbers, every document if the query is empty.
+**/
+- (NSIndexSet *)documentsMatchingQuery:(NSString *)query;
+
+/**
+ * Checks an object's text directly, without using the index. This is used for objects that haven't been indexed.
+ *
+ * @param   object                  The object to check.
+ * @param   foldedQuery             The query, already folded with +foldedString:.
+ * @returns                         YES if the text of the object contains the query.
+**/
+- (BOOL)object:(id)object containsFoldedQuery:(NSString *)foldedQuery;
+
+/** @name Tracking Changes **/
+
+- (void)addObject:(id)object;
+- (void)removeObject:(id)object;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,315 @@
+//
+//  UATextSearchIndex.m
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import "UATextSearchIndex.h"
+#import <pthread.h>
+
+// keeps the strings of different key paths apart, so no trigram spans two of them
+static const unichar UATextSearchIndexSeparator = 0x1F;
+
+// three UTF-16 characters packed into one key
+static inline NSNumber *UATextSearchIndexTrigram(const unichar *characters) {
+    return @(((unsigned long long)characters[0] << 32) | ((unsigned long long)characters[1] << 16) | (unsigned long long)characters[2]);
+}
+
+#pragma mark Documents
+
+// an indexed object, which can appear in the data more than once
+@interface UATextSearchDocument : NSObject
+
+@property (nonatomic) NSUInteger number;
+@property (nonatomic) NSUInteger occurrences;
+
+@end
+
+@implementation UATextSearchDocument
+@end
+
+#pragma mark - Implementation
+
+NS_ASSUME_NONNULL_BEGIN
+@interface UATextSearchIndex () {
+    pthread_rwlock_t _lock;
+}
+
+@property (nonatomic, copy, readwrite) NSArray *keyPaths;
+@property (nonatomic, weak, readwrite, nullable) NSArray *data;
+@property (atomic, readwrite) NSUInteger generation;
+
+// object to UATextSearchDocument, by identity
+@property (nonatomic, strong) NSMapTable *documents;
+
+// the folded text of each document by number, NSNull once it's been removed
+@property (nonatomic, strong) NSMutableArray *texts;
+@property (nonatomic, strong) NSMutableIndexSet *allDocuments;
+
+// the numbers of removed documents, handed out again before texts grows so it stays the size of the live documents
+@property (nonatomic, strong) NSMutableIndexSet *freeDocuments;
+
+// trigram to the numbers of the documents that contain it
+@property (nonatomic, strong) NSMutableDictionary *postings;
+
+// the previous query, so the next one can start from its results
+@property (nonatomic, copy, nullable) NSString *lastQuery;
+@property (nonatomic, strong, nullable) NSIndexSet *lastResults;
+@property (nonatomic) NSUInteger lastGeneration;
+
+@end
+
+@implementation UATextSearchIndex
+
++ (NSString *)foldedString:(NSString *)string {
+    return [string stringByFoldingWithOptions:(NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch) locale:nil];
+}
+
+- (instancetype)initWithKeyPaths:(NSArray *)keyPaths {
+    NSParameterAssert(keyPaths.count > 0);
+
+    self = [super init];
+    if (self) {
+        pthread_rwlock_init(&_lock, NULL);
+        self.keyPaths = keyPaths;
+        [self reset];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    pthread_rwlock_destroy(&_lock);
+}
+
+- (void)reset {
+    self.documents = [NSMapTable mapTableWithKeyOptions:(NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality)
+                                           valueOptions:NSPointerFunctionsStrongMemory];
+    self.texts = [[NSMutableArray alloc] init];
+    self.allDocuments = [[NSMutableIndexSet alloc] init];
+    self.freeDocuments = [[NSMutableIndexSet alloc] init];
+    self.postings = [[NSMutableDictionary alloc] init];
+    self.lastQuery = nil;
+    self.lastResults = nil;
+}
+
+#pragma mark - Text
+
+- (NSString *)foldedTextOfObject:(id)object {
+    NSMutableArray *strings = [[NSMutableArray alloc] initWithCapacity:self.keyPaths.count];
+    for (NSString *keyPath in self.keyPaths) {
+        id value = nil;
+        @try {
+            value = [object valueForKeyPath:keyPath];
+        } @catch (NSException *exception) {
+            continue;
+        }
+
+        // the strings in a collection are each searched, like CONTAINS on a to-many key path
+        NSArray *values = ([value isKindOfClass:[NSArray class]] || [value isKindOfClass:[NSSet class]] ? [value allObjects] : (value != nil ? @[ value ] : @[]));
+        for (id item in values) {
+            if ([item isKindOfClass:[NSString class]]) {
+                [strings addObject:[[self class] foldedString:item]];
+            }
+        }
+    }
+    return [strings componentsJoinedByString:[NSString stringWithCharacters:&UATextSearchIndexSeparator length:1]];
+}
+
+- (void)enumerateTrigramsOfText:(NSString *)text usingBlock:(void (^)(NSNumber *trigram))block {
+    NSUInteger length = text.length;
+    if (length < 3) {
+        return;
+    }
+
+    unichar *characters = malloc(length * sizeof(unichar));
+    if (characters == NULL) {
+        [NSException raise:NSMallocException format:@"Could not make room for %lu characters.", (unsigned long)length];
+    }
+    [text getCharacters:characters range:NSMakeRange(0, length)];
+    for (NSUInteger i = 0; i + 2 < length; i++) {
+        if (characters[i] != UATextSearchIndexSeparator && characters[i + 1] != UATextSearchIndexSeparator && characters[i + 2] != UATextSearchIndexSeparator) {
+            block(UATextSearchIndexTrigram(characters + i));
+        }
+    }
+    free(characters);
+}
+
+#pragma mark - Building
+
+- (void)rebuildWithData:(NSArray *)data twoDimensional:(BOOL)twoDimensional {
+    pthread_rwlock_wrlock(&_lock);
+    @try {
+        [self reset];
+        for (NSArray *section in (twoDimensional ? data : @[ data ])) {
+            for (id object in section) {
+                [self indexObject:object];
+            }
+        }
+        self.data = data;
+        self.generation = self.generation + 1;
+    } @finally {
+        pthread_rwlock_unlock(&_lock);
+    }
+}
+
+- (void)addObject:(id)object {
+    pthread_rwlock_wrlock(&_lock);
+    @try {
+        [self indexObject:object];
+        self.generation = self.generation + 1;
+    } @finally {
+        pthread_rwlock_unlock(&_lock);
+    }
+}
+
+- (void)removeObject:(id)object {
+    pthread_rwlock_wrlock(&_lock);
+    @try {
+        UATextSearchDocument *document = [self.documents objectForKey:object];
+        if (document != nil && --document.occurrences == 0) {
+            NSUInteger number = document.number;
+            NSMutableDictionary *postings = self.postings;
+            [self enumerateTrigramsOfText:self.texts[number] usingBlock:^(NSNumber *trigram) {
+                NSMutableIndexSet *posting = postings[trigram];
+                [posting removeIndex:number];
+                if (posting.count == 0) {
+                    [postings removeObjectForKey:trigram];
+                }
+            }];
+            self.texts[number] = [NSNull null];
+            [self.allDocuments removeIndex:number];
+            [self.freeDocuments addIndex:number];
+            [self.documents removeObjectForKey:object];
+        }
+        self.generation = self.generation + 1;
+    } @finally {
+        pthread_rwlock_unlock(&_lock);
+    }
+}
+
+// must be called with the write lock held
+- (void)indexObject:(id)object {
+    UATextSearchDocument *document = [self.documents objectForKey:object];
+    if (document != nil) {
+        document.occurrences++;
+        return;
+    }
+
+    // a number is only reused in a later generation, so no earlier results can mistake the new document for the old one
+    document = [[UATextSearchDocument alloc] init];
+    document.number = (self.freeDocuments.count > 0 ? self.freeDocuments.firstIndex : self.texts.count);
+    document.occurrences = 1;
+    [self.documents setObject:document forKey:object];
+
+    NSString *text = [self foldedTextOfObject:object];
+    if (document.number < self.texts.count) {
+        [self.freeDocuments removeIndex:document.number];
+        self.texts[document.number] = text;
+    } else {
+        [self.texts addObject:text];
+    }
+    [self.allDocuments addIndex:document.number];
+
+    NSMutableDictionary *postings = self.postings;
+    NSUInteger number = document.number;
+    [self enumerateTrigramsOfText:text usingBlock:^(NSNumber *trigram) {
+        NSMutableIndexSet *posting = postings[trigram];
+        if (posting == nil) {
+            posting = [[NSMutableIndexSet alloc] init];
+            postings[trigram] = posting;
+        }
+        [posting addIndex:number];
+    }];
+}
+
+#pragma mark - Searching
+
+- (NSUInteger)documentOfObject:(id)object {
+    NSUInteger number = NSNotFound;
+    pthread_rwlock_rdlock(&_lock);
+    UATextSearchDocument *document = [self.documents objectForKey:object];
+    if (document != nil) {
+        number = document.number;
+    }
+    pthread_rwlock_unlock(&_lock);
+    return number;
+}
+
+- (NSIndexSet *)documentsMatchingQuery:(NSString *)query {
+    NSString *foldedQuery = [[self class] foldedString:query];
+
+    // the last query is remembered, so this needs the write lock
+    NSIndexSet *results = nil;
+    pthread_rwlock_wrlock(&_lock);
+    @try {
+        results = [self documentsMatchingFoldedQuery:foldedQuery];
+        self.lastQuery = foldedQuery;
+        self.lastResults = results;
+        self.lastGeneration = self.generation;
+    } @finally {
+        pthread_rwlock_unlock(&_lock);
+    }
+    return results;
+}
+
+- (NSIndexSet *)documentsMatchingFoldedQuery:(NSString *)foldedQuery {
+    if (foldedQuery.length == 0) {
+        return [self.allDocuments copy];
+    }
+
+    // anything that contains this query contained the last one too
+    NSIndexSet *candidates = nil;
+    NSString *lastQuery = self.lastQuery;
+    if (lastQuery != nil && self.lastGeneration == self.generation && [foldedQuery rangeOfString:lastQuery options:NSLiteralSearch].location != NSNotFound) {
+        candidates = self.lastResults;
+
+    } else if (foldedQuery.length >= 3) {
+        NSMutableArray *postings = [[NSMutableArray alloc] init];
+        __block BOOL isMissingTrigram = NO;
+        [self enumerateTrigramsOfText:foldedQuery usingBlock:^(NSNumber *trigram) {
+            NSIndexSet *posting = self.postings[trigram];
+            if (posting == nil) {
+                isMissingTrigram = YES;
+            } else {
+                [postings addObject:posting];
+            }
+        }];
+        if (isMissingTrigram) {
+            return [NSIndexSet indexSet];
+        }
+
+        // intersect from the smallest list, which bounds the work
+        [postings sortUsingComparator:^NSComparisonResult(NSIndexSet *posting1, NSIndexSet *posting2) {
+            return (posting1.count < posting2.count ? NSOrderedAscending : (posting1.count > posting2.count ? NSOrderedDescending : NSOrderedSame));
+        }];
+        NSMutableIndexSet *intersection = [postings.firstObject mutableCopy];
+        for (NSUInteger i = 1; i < postings.count && intersection.count > 0; i++) {
+            NSIndexSet *posting = postings[i];
+            [intersection removeIndexes:[intersection indexesPassingTest:^BOOL(NSUInteger number, BOOL *stop) {
+                return ![posting containsIndex:number];
+            }]];
+        }
+        candidates = intersection;
+
+    } else {
+        candidates = self.allDocuments;
+    }
+
+    // sharing trigrams doesn't mean they're in the right order, so each candidate is checked
+    NSArray *texts = self.texts;
+    return [candidates indexesPassingTest:^BOOL(NSUInteger number, BOOL *stop) {
+        return ([texts[number] rangeOfString:foldedQuery options:NSLiteralSearch].location != NSNotFound);
+    }];
+}
+
+- (BOOL)object:(id)object containsFoldedQuery:(NSString *)foldedQuery {
+    if (foldedQuery.length == 0) {
+        return YES;
+    }
+    return ([[self foldedTextOfObject:object] rangeOfString:foldedQuery options:NSLiteralSearch].location != NSNotFound);
+}
+
+@end
+NS_ASSUME_NONNULL_END
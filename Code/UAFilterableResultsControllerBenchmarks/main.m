@@ -0,0 +1,251 @@
+//
+//  main.m
+//  UAFilterableResultsControllerBenchmarks
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <time.h>
+#import "UAFilterableResultsController.h"
+#import "UAFilterableResultsController+Private.h"
+
+#pragma mark - Benchmark Objects
+
+@interface UABenchmarkObject : NSObject
+
+@property (nonatomic, strong) NSNumber *identifier;
+@property (nonatomic, strong) NSString *name;
+@property (nonatomic) NSInteger score;
+
+@end
+
+@implementation UABenchmarkObject
+
++ (instancetype)objectWithIdentifier:(NSUInteger)identifier score:(NSInteger)score {
+    UABenchmarkObject *object = [[self alloc] init];
+    object.identifier = @(identifier);
+    object.name = [NSString stringWithFormat:@"Object %lu", (unsigned long)identifier];
+    object.score = score;
+    return object;
+}
+
+@end
+
+#pragma mark - Delegate
+
+// counts the changes rather than doing anything with them, so the diffing and notifying is all we measure
+@interface UABenchmarkDelegate : NSObject <UAFilterableResultsControllerDelegate>
+
+@property (nonatomic) NSUInteger numberOfChanges;
+
+@end
+
+@implementation UABenchmarkDelegate
+
+- (id)filterableResultsController:(UAFilterableResultsController *)controller cellForItemWithObject:(id)object atIndexPath:(NSIndexPath *)indexPath {
+    return [NSNull null];
+}
+
+- (void)filterableResultsController:(UAFilterableResultsController *)controller didChangeObject:(id)anObject atIndexPath:(NSIndexPath *)indexPath forChangeType:(UAFilterableResultsChangeType)type newIndexPath:(NSIndexPath *)newIndexPath {
+    self.numberOfChanges++;
+}
+
+@end
+
+#pragma mark - Timing
+
+static double UABenchmarkNow(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+// the setup block is run before each iteration and isn't timed, whatever it returns is passed to the timed block
+static NSDictionary *UABenchmarkRun(NSString *name, NSUInteger rows, NSUInteger iterations, id (^setup)(void), void (^block)(id state)) {
+    NSMutableArray *times = [[NSMutableArray alloc] initWithCapacity:iterations];
+    for (NSUInteger i = 0; i < iterations; i++) {
+        @autoreleasepool {
+            id state = setup != nil ? setup() : nil;
+
+            double start = UABenchmarkNow();
+            block(state);
+            [times addObject:@(UABenchmarkNow() - start)];
+        }
+    }
+
+    [times sortUsingSelector:@selector(compare:)];
+    double total = 0;
+    for (NSNumber *time in times) {
+        total += time.doubleValue;
+    }
+    double median = (iterations % 2 == 1) ? [times[iterations / 2] doubleValue] : ([times[iterations / 2 - 1] doubleValue] + [times[iterations / 2] doubleValue]) / 2;
+
+    fprintf(stderr, "%-16s %9lu rows  min %10.3f ms  median %10.3f ms\n", name.UTF8String, (unsigned long)rows, [times.firstObject doubleValue] * 1000, median * 1000);
+
+    return @{ @"benchmark": name,
+              @"rows": @(rows),
+              @"iterations": @(iterations),
+              @"min": times.firstObject,
+              @"median": @(median),
+              @"mean": @(total / iterations),
+              @"max": times.lastObject };
+}
+
+#pragma mark - Data
+
+static NSArray *UABenchmarkData(NSUInteger rows) {
+    NSMutableArray *data = [[NSMutableArray alloc] initWithCapacity:rows];
+    for (NSUInteger i = 0; i < rows; i++) {
+        [data addObject:[UABenchmarkObject objectWithIdentifier:i score:(NSInteger)arc4random_uniform(100)]];
+    }
+    return data;
+}
+
+// drops one in every hundred rows, adds as many new ones and moves a few, about what a refresh from a server looks like
+static NSArray *UABenchmarkChangedData(NSArray *data) {
+    NSMutableArray *changed = [[NSMutableArray alloc] initWithCapacity:data.count];
+    NSUInteger nextIdentifier = data.count;
+    for (NSUInteger i = 0; i < data.count; i++) {
+        if (i % 100 == 0) {
+            [changed addObject:[UABenchmarkObject objectWithIdentifier:nextIdentifier++ score:(NSInteger)arc4random_uniform(100)]];
+        } else {
+            [changed addObject:data[i]];
+        }
+    }
+    for (NSUInteger i = 50; i + 25 < changed.count; i += 1000) {
+        [changed exchangeObjectAtIndex:i withObjectAtIndex:i + 25];
+    }
+    return changed;
+}
+
+static UAFilterableResultsController *UABenchmarkController(UABenchmarkDelegate *delegate, NSArray *data) {
+    UAFilterableResultsController *controller = [[UAFilterableResultsController alloc] initWithPrimaryKeyPath:@"identifier" delegate:delegate];
+    [controller setData:data];
+
+    // pretend a table view has loaded so changes are diffed and notified
+    controller.tableViewHasLoaded = YES;
+    return controller;
+}
+
+#pragma mark - Main
+
+static void UABenchmarkUsage(void) {
+    fprintf(stderr, "usage: uafrc-benchmark [--sizes 1000,10000,100000,1000000] [--iterations 5] [--lookups 10000] [--output results.json]\n");
+}
+
+int main(int argc, const char * argv[]) {
+    @autoreleasepool {
+        NSArray *sizes = @[ @1000, @10000, @100000, @1000000 ];
+        NSUInteger iterations = 5;
+        NSUInteger lookups = 10000;
+        NSString *outputPath = nil;
+
+        for (int i = 1; i < argc; i++) {
+            NSString *argument = @(argv[i]);
+            NSString *value = (i + 1 < argc) ? @(argv[i + 1]) : nil;
+            if (value == nil) {
+                UABenchmarkUsage();
+                return 1;
+            }
+
+            if ([argument isEqualToString:@"--sizes"]) {
+                NSMutableArray *parsed = [[NSMutableArray alloc] init];
+                for (NSString *size in [value componentsSeparatedByString:@","]) {
+                    [parsed addObject:@(MAX(size.integerValue, 1))];
+                }
+                sizes = parsed;
+            } else if ([argument isEqualToString:@"--iterations"]) {
+                iterations = (NSUInteger)MAX(value.integerValue, 1);
+            } else if ([argument isEqualToString:@"--lookups"]) {
+                lookups = (NSUInteger)MAX(value.integerValue, 1);
+            } else if ([argument isEqualToString:@"--output"]) {
+                outputPath = value;
+            } else {
+                UABenchmarkUsage();
+                return 1;
+            }
+            i++;
+        }
+
+        NSMutableArray *results = [[NSMutableArray alloc] init];
+        UABenchmarkDelegate *delegate = [[UABenchmarkDelegate alloc] init];
+
+        for (NSNumber *size in sizes) {
+            NSUInteger rows = size.unsignedIntegerValue;
+            NSArray *data = UABenchmarkData(rows);
+            NSArray *changedData = UABenchmarkChangedData(data);
+
+            // loading data into an empty controller
+            [results addObject:UABenchmarkRun(@"setData", rows, iterations, ^id {
+                return [[UAFilterableResultsController alloc] initWithPrimaryKeyPath:@"identifier" delegate:delegate];
+            }, ^(UAFilterableResultsController *controller) {
+                [controller setData:data];
+            })];
+
+            // replacing loaded data, which diffs the old and new and notifies every change
+            [results addObject:UABenchmarkRun(@"diff", rows, iterations, ^id {
+                return UABenchmarkController(delegate, data);
+            }, ^(UAFilterableResultsController *controller) {
+                [controller setData:changedData];
+            })];
+
+            // filtering out about half of the rows
+            UAFilter *filter = [UAFilter filterWithPredicate:[NSPredicate predicateWithFormat:@"score < 50"]];
+            [results addObject:UABenchmarkRun(@"applyFilters", rows, iterations, ^id {
+                return UABenchmarkController(delegate, data);
+            }, ^(UAFilterableResultsController *controller) {
+                [controller addFilter:filter];
+            })];
+
+            // merging in the changed rows by primary key
+            NSArray *mergedObjects = [changedData filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"identifier >= %lu", (unsigned long)rows]];
+            [results addObject:UABenchmarkRun(@"mergeObjects", rows, iterations, ^id {
+                return UABenchmarkController(delegate, data);
+            }, ^(UAFilterableResultsController *controller) {
+                [controller mergeObjects:mergedObjects];
+            })];
+
+            // random primary key lookups, the index is built before we start timing
+            NSMutableArray *keys = [[NSMutableArray alloc] initWithCapacity:lookups];
+            for (NSUInteger i = 0; i < lookups; i++) {
+                [keys addObject:@(arc4random_uniform((uint32_t)rows))];
+            }
+            NSMutableDictionary *lookupResult = [UABenchmarkRun(@"primaryKeyLookup", rows, iterations, ^id {
+                UAFilterableResultsController *controller = UABenchmarkController(delegate, data);
+                [controller indexPathOfObjectWithPrimaryKey:keys.firstObject];
+                return controller;
+            }, ^(UAFilterableResultsController *controller) {
+                for (NSNumber *key in keys) {
+                    [controller indexPathOfObjectWithPrimaryKey:key];
+                }
+            }) mutableCopy];
+            lookupResult[@"lookups"] = @(lookups);
+            [results addObject:lookupResult];
+        }
+
+        NSDictionary *report = @{ @"suite": @"UAFilterableResultsController",
+                                  @"timestamp": @((long long)[[NSDate date] timeIntervalSince1970]),
+                                  @"unit": @"seconds",
+                                  @"results": results };
+
+        NSError *error = nil;
+        NSData *json = [NSJSONSerialization dataWithJSONObject:report options:NSJSONWritingPrettyPrinted error:&error];
+        if (json == nil) {
+            fprintf(stderr, "Could not write the results: %s\n", error.localizedDescription.UTF8String);
+            return 1;
+        }
+
+        if (outputPath != nil) {
+            if (![json writeToFile:outputPath options:NSDataWritingAtomic error:&error]) {
+                fprintf(stderr, "Could not write the results to %s: %s\n", outputPath.UTF8String, error.localizedDescription.UTF8String);
+                return 1;
+            }
+        } else {
+            fwrite(json.bytes, 1, json.length, stdout);
+            fputc('\n', stdout);
+        }
+    }
+    return 0;
+}
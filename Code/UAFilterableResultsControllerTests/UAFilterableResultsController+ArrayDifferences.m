@@ -237,7 +237,95 @@ describe(@"UAFilterableResultsController: Array Differences", ^{
             [[delegateMock should] receive:@selector(filterableResultsController:didChangeObject:atIndexPath:forChangeType:newIndexPath:) withCount:3];
             [controller setData:@[ obj1, obj3 ]];
         });
+
+        it(@"should only move the objects that changed their relative order", ^{
+            
+            // set initial data
+            NSDictionary *obj1 = @{ @"id": @"1", @"firstName": @"Test", @"lastName": @"User" };
+            NSDictionary *obj2 = @{ @"id": @"2", @"firstName": @"John", @"lastName": @"Citizen" };
+            NSDictionary *obj3 = @{ @"id": @"3", @"firstName": @"Jane", @"lastName": @"Citizen" };
+            [controller setData:@[ obj1, obj2, obj3 ]];
+            
+            __block NSUInteger calls = 0;
+            [delegateMock stub:@selector(filterableResultsController:didChangeObject:atIndexPath:forChangeType:newIndexPath:)
+                     withBlock:^id(NSArray *params)
+            {
+                if (calls == 0)
+                {
+                    [[params[1] should] equal:obj3];
+                    [[params[2] should] equal:[NSIndexPath indexPathForRow:2 inSection:0]];
+                    [[params[3] should] equal:theValue(UAFilterableResultsChangeMove)];
+                    [[params[4] should] equal:[NSIndexPath indexPathForRow:0 inSection:0]];
+                    
+                } else if (calls == 1)
+                {
+                    [[params[1] should] equal:obj1];
+                    [[params[2] should] equal:[NSIndexPath indexPathForRow:0 inSection:0]];
+                    [[params[3] should] equal:theValue(UAFilterableResultsChangeUpdate)];
+                    [[params[4] should] equal:[NSNull null]];
+                    
+                } else if (calls == 2)
+                {
+                    [[params[1] should] equal:obj2];
+                    [[params[2] should] equal:[NSIndexPath indexPathForRow:1 inSection:0]];
+                    [[params[3] should] equal:theValue(UAFilterableResultsChangeUpdate)];
+                    [[params[4] should] equal:[NSNull null]];
+                    
+                }
+                calls++;
+                return nil;
+            }];
+            
+            [[delegateMock should] receive:@selector(filterableResultsController:didChangeObject:atIndexPath:forChangeType:newIndexPath:) withCount:3];
+            [controller setData:@[ obj3, obj1, obj2 ]];
+        });
+    });
+
+    context(@"when delivering changesets", ^{
+
+        __block UAFilterableResultsController *controller;
+        __block id delegateMock;
+        beforeEach(^{
+
+            delegateMock = [KWMock nullMockForProtocol:@protocol(UAFilterableResultsControllerChangesetDelegate)];
+            controller = [[UAFilterableResultsController alloc] initWithPrimaryKeyPath:@"id" delegate:delegateMock];
+            [controller setData:@[ @{ @"id": @"1" }, @{ @"id": @"2" }, @{ @"id": @"3" } ]];
+
+            // pretend the table view has loaded, otherwise no delegate messages are sent
+            [controller setTableViewHasLoaded:YES];
+        });
+        afterEach(^{
+
+            controller = nil;
+        });
+
+        it(@"should deliver the whole batch as one changeset", ^{
+
+            KWCaptureSpy *spy = [delegateMock captureArgument:@selector(filterableResultsController:didChangeContentWithChangeset:) atIndex:1];
+            [[delegateMock shouldNot] receive:@selector(filterableResultsController:didChangeObject:atIndexPath:forChangeType:newIndexPath:)];
+            [[delegateMock should] receive:@selector(filterableResultsControllerDidChangeContent:) withCount:1];
+
+            [controller setData:@[ @{ @"id": @"3" }, @{ @"id": @"1" }, @{ @"id": @"4" } ]];
+
+            UAFilterableResultsChangeset *changeset = spy.argument;
+            [[theValue(changeset.numberOfDeletions) should] equal:theValue(1)];
+            [[theValue(changeset.numberOfInsertions) should] equal:theValue(1)];
+            [[theValue(changeset.numberOfMoves + changeset.numberOfUpdates) should] equal:theValue(2)];
+            [[[changeset deletedIndexPaths] should] equal:@[ [NSIndexPath indexPathForRow:1 inSection:0] ]];
+            [[[changeset insertedIndexPaths] should] equal:@[ [NSIndexPath indexPathForRow:2 inSection:0] ]];
+            [[theValue(changeset.deletions[0].toRow) should] equal:theValue(NSNotFound)];
+        });
+
+        it(@"should collect nested batches into the outermost changeset", ^{
+
+            [[delegateMock should] receive:@selector(filterableResultsController:didChangeContentWithChangeset:) withCount:1];
+
+            [controller beginUpdates];
+            [controller addObject:@{ @"id": @"5" }];
+            [controller removeObjectAtIndexPath:[NSIndexPath indexPathForRow:0 inSection:0]];
+            [controller endUpdates];
+        });
     });
 });
 
-SPEC_END
\ No newline at end of file
+SPEC_END
@@ -8,6 +8,33 @@
 
 #import <Kiwi/Kiwi.h>
 #import "UAFilterableResultsController.h"
+#import "UAFilterableResultsController+Private.h"
+#import "UAPagedArray.h"
+
+// serves the numbers 0 to count - 1 in a single section, counting the pages it is asked for
+@interface UAFilterableResultsControllerTestDataProvider : NSObject <UAFilterableResultsDataProvider>
+
+@property (nonatomic) NSUInteger count;
+@property (nonatomic) NSUInteger numberOfPagesFetched;
+
+@end
+
+@implementation UAFilterableResultsControllerTestDataProvider
+
+- (NSUInteger)numberOfObjectsInSection:(NSUInteger)section {
+    return self.count;
+}
+
+- (NSArray *)objectsInSection:(NSUInteger)section range:(NSRange)range {
+    self.numberOfPagesFetched++;
+    NSMutableArray *objects = [[NSMutableArray alloc] initWithCapacity:range.length];
+    for (NSUInteger i = range.location; i < NSMaxRange(range); i++) {
+        [objects addObject:@(i)];
+    }
+    return objects;
+}
+
+@end
 
 SPEC_BEGIN(UAFilterableResultsController_BasicData)
 
@@ -210,6 +237,23 @@ describe(@"UAFilterableResultsController: Basic Data and Retrieval Setting", ^
                [[[objects objectAtIndex:7] should] equal:@8];
                [[[objects objectAtIndex:8] should] equal:@9];
            });
+
+        it(@"should enumerate the flattened array via -allObjects without copying it", ^{
+
+            NSArray *objects = [controller allObjects];
+            NSMutableArray *enumerated = [[NSMutableArray alloc] init];
+            for (id object in objects) {
+                [enumerated addObject:object];
+            }
+            [[enumerated should] equal:@[ @1, @2, @3, @4, @5, @6, @7, @8, @9 ]];
+
+            // it's a view of the data, so it sees changes until it's copied
+            NSArray *snapshot = [objects copy];
+            [controller addObject:@10 inSection:0];
+            [[objects should] haveCountOf:10];
+            [[[objects objectAtIndex:4] should] equal:@10];
+            [[snapshot should] haveCountOf:9];
+        });
         
         it(@"should return the objects via -objectAtIndexPath:", ^{
             
@@ -389,6 +433,320 @@ describe(@"UAFilterableResultsController: Basic Data and Retrieval Setting", ^
             [[theValue(indexPath5.row) should] equal:1 withDelta:0];
         });
     });
+
+    context(@"when setting data asynchronously", ^{
+
+        __block UAFilterableResultsController *controller;
+        __block id delegateMock;
+        beforeEach(^{
+
+            delegateMock = [KWMock nullMockForProtocol:@protocol(UAFilterableResultsControllerDelegate)];
+            controller = [[UAFilterableResultsController alloc] initWithPrimaryKeyPath:@"id" delegate:delegateMock];
+            [controller setData:@[ @{ @"id": @"1" }, @{ @"id": @"2" } ]];
+            [controller setTableViewHasLoaded:YES];
+        });
+        afterEach(^{
+
+            controller = nil;
+        });
+
+        it(@"should apply the data and notify the delegate in one batch", ^{
+
+            __block BOOL didFinish = NO;
+            [[delegateMock shouldEventually] receive:@selector(filterableResultsControllerWillChangeContent:) withCount:1];
+            [[delegateMock shouldEventually] receive:@selector(filterableResultsController:didChangeObject:atIndexPath:forChangeType:newIndexPath:) withCount:3];
+            [[delegateMock shouldEventually] receive:@selector(filterableResultsControllerDidChangeContent:) withCount:1];
+
+            [controller setData:@[ @{ @"id": @"2" }, @{ @"id": @"3" } ] completion:^(BOOL finished) {
+                didFinish = finished;
+            }];
+
+            [[expectFutureValue(theValue(didFinish)) shouldEventually] beYes];
+            [[expectFutureValue(theValue([controller numberOfObjects])) shouldEventually] equal:theValue(2)];
+            [[expectFutureValue([controller objectAtIndexPath:[NSIndexPath indexPathForRow:1 inSection:0]][@"id"]) shouldEventually] equal:@"3"];
+        });
+
+        it(@"should abandon an earlier request when a newer one arrives", ^{
+
+            __block BOOL firstFinished = YES;
+            __block BOOL secondFinished = NO;
+            [controller setData:@[ @{ @"id": @"4" } ] completion:^(BOOL finished) {
+                firstFinished = finished;
+            }];
+            [controller setData:@[ @{ @"id": @"5" }, @{ @"id": @"6" } ] completion:^(BOOL finished) {
+                secondFinished = finished;
+            }];
+
+            [[expectFutureValue(theValue(secondFinished)) shouldEventually] beYes];
+            [[expectFutureValue(theValue(firstFinished)) shouldEventually] beNo];
+            [[expectFutureValue(theValue([controller numberOfObjects])) shouldEventually] equal:theValue(2)];
+        });
+
+        it(@"should work out the changes to the filtered data in the background", ^{
+
+            [controller addFilter:[UAFilter filterWithPredicate:[NSPredicate predicateWithFormat:@"id != '1'"]]];
+
+            __block BOOL didFinish = NO;
+            [[delegateMock shouldEventually] receive:@selector(filterableResultsController:didChangeObject:atIndexPath:forChangeType:newIndexPath:) withCount:2];
+            [controller setData:@[ @{ @"id": @"1" }, @{ @"id": @"3" } ] completion:^(BOOL finished) {
+                didFinish = finished;
+            }];
+
+            [[expectFutureValue(theValue(didFinish)) shouldEventually] beYes];
+            [[expectFutureValue([controller filteredObjectAtIndexPath:[NSIndexPath indexPathForRow:0 inSection:0]][@"id"]) shouldEventually] equal:@"3"];
+        });
+    });
+
+    context(@"when setting sorted data", ^{
+
+        __block UAFilterableResultsController *controller;
+        beforeEach(^{
+
+            controller = [[UAFilterableResultsController alloc] initWithPrimaryKeyPath:@"id" delegate:nil];
+        });
+        afterEach(^{
+
+            controller = nil;
+        });
+
+        it(@"should sort by each key path in turn using -setData:sortKeyPath:sortOptions:", ^{
+
+            [controller setData:@[ @{ @"id": @"1", @"last": @"smith", @"first": @"Bob" },
+                                   @{ @"id": @"2", @"last": @"Jones", @"first": @"Amy" },
+                                   @{ @"id": @"3", @"last": @"Smith", @"first": @"Alice" },
+                                   @{ @"id": @"4", @"first": @"Zed" } ]
+                    sortKeyPath:@"last,first"
+                    sortOptions:NSCaseInsensitiveSearch];
+
+            // missing values first, then case insensitively by last and then first name
+            [[[controller.data valueForKey:@"id"] should] equal:@[ @"4", @"2", @"3", @"1" ]];
+        });
+
+        it(@"should sort the same in parallel", ^{
+
+            NSMutableArray *objects = [[NSMutableArray alloc] init];
+            for (NSUInteger i = 0; i < 5000; i++) {
+                [objects addObject:@{ @"id": @(i), @"name": [NSString stringWithFormat:@"%lu", (unsigned long)((i * 7919) % 5000)] }];
+            }
+
+            [controller setData:objects sortKeyPath:@"name" sortOptions:NSNumericSearch];
+            NSArray *serial = [controller.data valueForKey:@"id"];
+
+            controller.sortsInParallel = YES;
+            controller.parallelSortingThreshold = 100;
+            [controller setData:[objects reverseObjectEnumerator].allObjects sortKeyPath:@"name" sortOptions:NSNumericSearch];
+
+            [[[controller.data valueForKey:@"id"] should] equal:serial];
+            [[[controller.data.firstObject objectForKey:@"name"] should] equal:@"0"];
+            [[[controller.data.lastObject objectForKey:@"name"] should] equal:@"4999"];
+        });
+    });
+
+    context(@"when converting between offsets and index paths", ^{
+
+        __block UAFilterableResultsController *controller;
+        beforeEach(^{
+
+            controller = [[UAFilterableResultsController alloc] initWithPrimaryKeyPath:nil delegate:nil];
+            [controller setData:@[ @[ @1, @2, @3, @4 ], @[ ], @[ @5, @6, @7, @8, @9 ] ]];
+        });
+        afterEach(^{
+
+            controller = nil;
+        });
+
+        it(@"should map offsets to index paths across sections", ^{
+
+            [[theValue([controller numberOfObjects]) should] equal:theValue(9)];
+            [[[controller indexPathOfObjectAtOffset:0] should] equal:[NSIndexPath indexPathForRow:0 inSection:0]];
+            [[[controller indexPathOfObjectAtOffset:3] should] equal:[NSIndexPath indexPathForRow:3 inSection:0]];
+            [[[controller indexPathOfObjectAtOffset:4] should] equal:[NSIndexPath indexPathForRow:0 inSection:2]];
+            [[[controller indexPathOfObjectAtOffset:8] should] equal:[NSIndexPath indexPathForRow:4 inSection:2]];
+            [[controller indexPathOfObjectAtOffset:9] shouldBeNil];
+
+            [[theValue([controller offsetOfObjectAtIndexPath:[NSIndexPath indexPathForRow:2 inSection:2]]) should] equal:theValue(6)];
+            [[theValue([controller offsetOfObjectAtIndexPath:[NSIndexPath indexPathForRow:0 inSection:1]]) should] equal:theValue(NSNotFound)];
+        });
+
+        it(@"should keep the offsets up to date as objects and sections change", ^{
+
+            [controller addObject:@10 inSection:1];
+            [controller removeObjectAtIndexPath:[NSIndexPath indexPathForRow:0 inSection:0]];
+            [controller insertSection:@[ @11, @12 ] atIndex:0];
+
+            [[theValue([controller numberOfObjects]) should] equal:theValue(11)];
+            [[[controller indexPathOfObjectAtOffset:2] should] equal:[NSIndexPath indexPathForRow:0 inSection:1]];
+            [[[controller indexPathOfObjectAtOffset:5] should] equal:[NSIndexPath indexPathForRow:0 inSection:2]];
+            [[[controller objectAtIndexPath:[controller indexPathOfObjectAtOffset:6]] should] equal:@5];
+
+            [controller removeSectionAtIndex:1];
+            [[theValue([controller numberOfObjects]) should] equal:theValue(8)];
+            [[[controller objectAtIndexPath:[controller indexPathOfObjectAtOffset:2]] should] equal:@10];
+        });
+
+        it(@"should map offsets in the filtered data", ^{
+
+            [controller addFilter:[UAFilter filterWithPredicate:[NSPredicate predicateWithFormat:@"SELF > 3"]]];
+
+            [[theValue([controller numberOfFilteredObjects]) should] equal:theValue(6)];
+            [[[controller filteredObjectAtIndexPath:[controller filteredIndexPathOfObjectAtOffset:1]] should] equal:@5];
+            [[theValue([controller filteredOffsetOfObjectAtIndexPath:[NSIndexPath indexPathForRow:4 inSection:2]]) should] equal:theValue(5)];
+
+            [controller addObject:@20 inSection:0];
+            [[theValue([controller numberOfFilteredObjects]) should] equal:theValue(7)];
+            [[[controller filteredIndexPathOfObjectAtOffset:1] should] equal:[NSIndexPath indexPathForRow:1 inSection:0]];
+        });
+    });
+
+    context(@"when reading paged data from a data provider", ^{
+
+        __block UAFilterableResultsController *controller;
+        __block UAFilterableResultsControllerTestDataProvider *provider;
+        beforeEach(^{
+
+            provider = [[UAFilterableResultsControllerTestDataProvider alloc] init];
+            provider.count = 1000000;
+            controller = [[UAFilterableResultsController alloc] initWithPrimaryKeyPath:nil delegate:nil];
+            [controller setDataProvider:provider pageSize:100 maximumResidentPages:2];
+        });
+        afterEach(^{
+
+            controller = nil;
+            provider = nil;
+        });
+
+        it(@"should know the number of objects without fetching any pages", ^{
+
+            [[theValue([controller numberOfObjects]) should] equal:theValue(1000000)];
+            [[theValue(provider.numberOfPagesFetched) should] equal:theValue(0)];
+        });
+
+        it(@"should fetch only the page an object is on", ^{
+
+            [[[controller objectAtIndexPath:[NSIndexPath indexPathForRow:523456 inSection:0]] should] equal:@523456];
+            [[[controller objectAtIndexPath:[NSIndexPath indexPathForRow:523499 inSection:0]] should] equal:@523499];
+            [[theValue(provider.numberOfPagesFetched) should] equal:theValue(1)];
+        });
+
+        it(@"should let go of the least recently used page", ^{
+
+            [controller objectAtIndexPath:[NSIndexPath indexPathForRow:0 inSection:0]];
+            [controller objectAtIndexPath:[NSIndexPath indexPathForRow:100 inSection:0]];
+            [controller objectAtIndexPath:[NSIndexPath indexPathForRow:1 inSection:0]];
+            [controller objectAtIndexPath:[NSIndexPath indexPathForRow:200 inSection:0]];
+            [[theValue(provider.numberOfPagesFetched) should] equal:theValue(3)];
+
+            [controller objectAtIndexPath:[NSIndexPath indexPathForRow:2 inSection:0]];
+            [[theValue(provider.numberOfPagesFetched) should] equal:theValue(3)];
+            [controller objectAtIndexPath:[NSIndexPath indexPathForRow:101 inSection:0]];
+            [[theValue(provider.numberOfPagesFetched) should] equal:theValue(4)];
+        });
+
+        it(@"should keep a section once it has been changed", ^{
+
+            [controller addObject:@-1];
+
+            [[theValue([(UAPagedArray *)controller.data isMaterialized]) should] beYes];
+            [[theValue([controller numberOfObjects]) should] equal:theValue(1000001)];
+            [[[controller objectAtIndexPath:[NSIndexPath indexPathForRow:1000000 inSection:0]] should] equal:@-1];
+        });
+
+        it(@"should snapshot the data without fetching every page", ^{
+
+            UAFilterableResultsSnapshot *snapshot = [controller snapshot];
+            [[snapshot shouldNot] beNil];
+            [[theValue(provider.numberOfPagesFetched) should] equal:theValue(0)];
+
+            [[[snapshot objectAtIndexPath:[NSIndexPath indexPathForRow:523456 inSection:0]] should] equal:@523456];
+            [[theValue(provider.numberOfPagesFetched) should] equal:theValue(1)];
+        });
+
+        it(@"should keep every page it hands out in one go, even with room for only one", ^{
+
+            provider.count = 250;
+            [controller setDataProvider:provider pageSize:10 maximumResidentPages:1];
+
+            NSUInteger expected = 0;
+            for (NSNumber *number in [controller allObjects]) {
+                [[number should] equal:@(expected)];
+                expected++;
+            }
+            [[theValue(expected) should] equal:theValue(250)];
+
+            id __unsafe_unretained objects[25];
+            [controller.data getObjects:objects range:NSMakeRange(5, 25)];
+            [[objects[0] should] equal:@5];
+            [[objects[24] should] equal:@29];
+        });
+    });
+
+    context(@"when taking snapshots of the data", ^{
+
+        __block UAFilterableResultsController *controller;
+        beforeEach(^{
+
+            controller = [[UAFilterableResultsController alloc] initWithPrimaryKeyPath:nil delegate:nil];
+            [controller setData:@[ @[ @1, @2, @3 ], @[ @4, @5 ] ]];
+        });
+        afterEach(^{
+
+            controller = nil;
+        });
+
+        it(@"should share the data until it changes", ^{
+
+            UAFilterableResultsSnapshot *snapshot = [controller snapshot];
+            [[[controller snapshot] should] beIdenticalTo:snapshot];
+
+            [controller addObject:@6 inSection:1];
+            [[[controller snapshot] shouldNot] beIdenticalTo:snapshot];
+        });
+
+        it(@"should keep what it saw as objects and sections change", ^{
+
+            UAFilterableResultsSnapshot *snapshot = [controller snapshot];
+            [controller addObject:@6 inSection:1];
+            [controller replaceObjectAtIndexPath:[NSIndexPath indexPathForRow:0 inSection:0] withObject:@10];
+            [controller insertSection:@[ @7 ] atIndex:0];
+            [controller removeSectionAtIndex:2];
+
+            [[theValue(snapshot.numberOfSections) should] equal:theValue(2)];
+            [[theValue([snapshot numberOfObjectsInSection:1]) should] equal:theValue(2)];
+            [[[snapshot objectAtIndexPath:[NSIndexPath indexPathForRow:0 inSection:0]] should] equal:@1];
+            [[snapshot.data should] equal:@[ @[ @1, @2, @3 ], @[ @4, @5 ] ]];
+            [[controller.data should] equal:@[ @[ @7 ], @[ @10, @2, @3 ] ]];
+        });
+
+        it(@"should keep one dimensional data", ^{
+
+            [controller setData:@[ @1, @2, @3 ]];
+            UAFilterableResultsSnapshot *snapshot = [controller snapshot];
+            [controller removeObject:@2];
+
+            [[snapshot.data should] equal:@[ @1, @2, @3 ]];
+            [[[controller snapshot].data should] equal:@[ @1, @3 ]];
+        });
+
+        it(@"should keep large one dimensional data as rows change around it", ^{
+
+            NSMutableArray *numbers = [[NSMutableArray alloc] init];
+            for (NSUInteger i = 0; i < 3000; i++) {
+                [numbers addObject:@(i)];
+            }
+            [controller setData:numbers];
+
+            UAFilterableResultsSnapshot *snapshot = [controller snapshot];
+            [controller removeObjectAtIndexPath:[NSIndexPath indexPathForRow:0 inSection:0]];
+            [controller replaceObjectAtIndexPath:[NSIndexPath indexPathForRow:2500 inSection:0] withObject:@-1];
+            [controller addObject:@3000];
+
+            [[[snapshot objectAtIndexPath:[NSIndexPath indexPathForRow:0 inSection:0]] should] equal:@0];
+            [[[snapshot objectAtIndexPath:[NSIndexPath indexPathForRow:1500 inSection:0]] should] equal:@1500];
+            [[[snapshot objectAtIndexPath:[NSIndexPath indexPathForRow:2501 inSection:0]] should] equal:@2501];
+            [[theValue([snapshot numberOfObjectsInSection:0]) should] equal:theValue(3000)];
+            [[snapshot.data should] equal:numbers];
+        });
+    });
 });
 
-SPEC_END
\ No newline at end of file
+SPEC_END
@@ -0,0 +1,571 @@
+//
+//  UAFilterableResultsController+Filters.m
+//  UAFilterableResultsController
+//
+//  Created by Unsigned Apps on 17/10/2026.
+//  Copyright (c) 2026 Unsigned Apps. All rights reserved.
+//
+
+#import <Kiwi/Kiwi.h>
+#import "UAFilterableResultsController.h"
+
+#import "UAFilterableResultsController+Private.h"
+#import "UACompiledPredicate.h"
+#import "UAFilteredSection.h"
+
+// answers to both getAge and age, the first of which is the one key value coding uses
+@interface UAFilterableResultsControllerTestPerson : NSObject
+
+@property (nonatomic) NSInteger age;
+
+@end
+
+@implementation UAFilterableResultsControllerTestPerson
+
+- (NSInteger)getAge {
+    return self.age * 2;
+}
+
+@end
+
+SPEC_BEGIN(UAFilterableResultsController_Filters)
+
+describe(@"UAFilterableResultsController: Filters", ^{
+
+    context(@"when changing single objects in filtered one dimensional data", ^{
+        __block UAFilterableResultsController *controller;
+        __block id delegateMock;
+        beforeEach(^{
+
+            delegateMock = [KWMock nullMockForProtocol:@protocol(UAFilterableResultsControllerDelegate)];
+            controller = [[UAFilterableResultsController alloc] initWithPrimaryKeyPath:@"id" delegate:delegateMock];
+            [controller setData:@[ @{ @"id": @"1", @"age": @10 }, @{ @"id": @"2", @"age": @20 }, @{ @"id": @"3", @"age": @30 } ]];
+            [controller addFilter:[UAFilter filterWithPredicate:[NSPredicate predicateWithFormat:@"age >= 20"]]];
+
+            // pretend the table view has loaded, otherwise no delegate messages are sent
+            [controller setTableViewHasLoaded:YES];
+        });
+        afterEach(^{
+
+            controller = nil;
+        });
+
+        it(@"should insert a matching object at its filtered index path", ^{
+
+            NSDictionary *obj4 = @{ @"id": @"4", @"age": @40 };
+            [delegateMock stub:@selector(filterableResultsController:didChangeObject:atIndexPath:forChangeType:newIndexPath:)
+                     withBlock:^id(NSArray *params)
+            {
+                [[params[1] should] equal:obj4];
+                [[params[2] should] equal:[NSNull null]];
+                [[params[3] should] equal:theValue(UAFilterableResultsChangeInsert)];
+                [[params[4] should] equal:[NSIndexPath indexPathForRow:2 inSection:0]];
+                return nil;
+            }];
+
+            [[delegateMock should] receive:@selector(filterableResultsController:didChangeObject:atIndexPath:forChangeType:newIndexPath:) withCount:1];
+            [controller addObject:obj4];
+
+            [[controller.filteredData should] haveCountOf:3];
+            [[[controller filteredIndexPathOfObjectWithPrimaryKey:@"4"] should] equal:[NSIndexPath indexPathForRow:2 inSection:0]];
+        });
+
+        it(@"should not notify about an object that does not match", ^{
+
+            [[delegateMock shouldNot] receive:@selector(filterableResultsController:didChangeObject:atIndexPath:forChangeType:newIndexPath:)];
+            [controller addObject:@{ @"id": @"4", @"age": @5 }];
+
+            [[controller.filteredData should] haveCountOf:2];
+        });
+
+        it(@"should delete an object that no longer matches when it is replaced", ^{
+
+            [delegateMock stub:@selector(filterableResultsController:didChangeObject:atIndexPath:forChangeType:newIndexPath:)
+                     withBlock:^id(NSArray *params)
+            {
+                [[params[2] should] equal:[NSIndexPath indexPathForRow:0 inSection:0]];
+                [[params[3] should] equal:theValue(UAFilterableResultsChangeDelete)];
+                return nil;
+            }];
+
+            [[delegateMock should] receive:@selector(filterableResultsController:didChangeObject:atIndexPath:forChangeType:newIndexPath:) withCount:1];
+            [controller replaceObject:@{ @"id": @"2", @"age": @15 }];
+
+            [[controller.filteredData should] haveCountOf:1];
+            [[[controller filteredObjectAtIndexPath:[NSIndexPath indexPathForRow:0 inSection:0]][@"id"] should] equal:@"3"];
+        });
+
+        it(@"should tell the same object apart by its row when it shows up twice", ^{
+
+            NSDictionary *obj = @{ @"id": @"1", @"age": @20 };
+            [controller setData:@[ obj, @{ @"id": @"2", @"age": @10 }, obj ]];
+            [delegateMock stub:@selector(filterableResultsController:didChangeObject:atIndexPath:forChangeType:newIndexPath:)
+                     withBlock:^id(NSArray *params)
+            {
+                [[params[2] should] equal:[NSIndexPath indexPathForRow:1 inSection:0]];
+                [[params[3] should] equal:theValue(UAFilterableResultsChangeDelete)];
+                return nil;
+            }];
+
+            [[delegateMock should] receive:@selector(filterableResultsController:didChangeObject:atIndexPath:forChangeType:newIndexPath:) withCount:1];
+            [controller removeObjectAtIndexPath:[NSIndexPath indexPathForRow:2 inSection:0]];
+
+            [[controller.filteredData should] haveCountOf:1];
+            [[theValue([(UAFilteredSection *)controller.filteredData rowAtIndex:0]) should] equal:theValue(0)];
+        });
+    });
+
+    context(@"when narrowing and widening the filters", ^{
+        __block UAFilterableResultsController *controller;
+        __block UAFilter *adults;
+        __block UAFilter *seniors;
+        beforeEach(^{
+
+            controller = [[UAFilterableResultsController alloc] initWithPrimaryKeyPath:@"id" delegate:nil];
+            [controller setData:@[
+                                  @[ @{ @"id": @"1", @"age": @10 }, @{ @"id": @"2", @"age": @20 } ],
+                                  @[ @{ @"id": @"3", @"age": @30 }, @{ @"id": @"4", @"age": @70 } ]
+                                  ]];
+            adults = [UAFilter filterWithTitle:@"Adults" group:nil predicate:[NSPredicate predicateWithFormat:@"age >= 18"]];
+            seniors = [UAFilter filterWithTitle:@"Seniors" group:nil predicate:[NSPredicate predicateWithFormat:@"age >= 65"]];
+        });
+        afterEach(^{
+
+            controller = nil;
+        });
+
+        it(@"should only keep the rows that pass an added filter", ^{
+
+            [controller addFilter:adults];
+            [[[controller.filteredData objectAtIndex:0] should] haveCountOf:1];
+            [[[controller.filteredData objectAtIndex:1] should] haveCountOf:2];
+
+            [controller addFilter:seniors];
+            [[[controller.filteredData objectAtIndex:0] should] haveCountOf:0];
+            [[[controller.filteredData objectAtIndex:1] should] haveCountOf:1];
+            [[[controller filteredObjectAtIndexPath:[NSIndexPath indexPathForRow:0 inSection:1]][@"id"] should] equal:@"4"];
+        });
+
+        it(@"should keep a bitmap for each applied filter when toggling filters in a group", ^{
+
+            UAFilter *minors = [UAFilter filterWithTitle:@"Minors" group:@"Age" predicate:[NSPredicate predicateWithFormat:@"age < 18"]];
+            UAFilter *grownUps = [UAFilter filterWithTitle:@"Grown Ups" group:@"Age" predicate:[NSPredicate predicateWithFormat:@"age >= 18"]];
+            UAFilter *even = [UAFilter filterWithTitle:@"Even" group:nil predicate:[NSPredicate predicateWithFormat:@"id IN {'2', '4'}"]];
+
+            [controller addFilters:@[ even, minors ]];
+            [[theValue(controller.filterBitmaps.count) should] equal:theValue(2)];
+            [[[controller.filteredData objectAtIndex:0] should] haveCountOf:0];
+
+            [controller addFilter:grownUps];
+            [[theValue(controller.filterBitmaps.count) should] equal:theValue(2)];
+            [[controller.filterBitmaps objectForKey:minors.evaluatedPredicate] shouldBeNil];
+            [[[controller.filteredData objectAtIndex:0] should] haveCountOf:1];
+            [[[controller.filteredData objectAtIndex:1] should] haveCountOf:1];
+            [[[controller filteredObjectAtIndexPath:[NSIndexPath indexPathForRow:0 inSection:1]][@"id"] should] equal:@"4"];
+        });
+
+        it(@"should only evaluate an added filter against the visible rows and finish its bitmap when widening", ^{
+
+            [controller addFilter:adults];
+            [controller addFilter:seniors];
+            UAFilterBitmap *bitmap = [controller.filterBitmaps objectForKey:seniors.evaluatedPredicate];
+            [[theValue(bitmap.numberOfUnevaluatedRows) should] equal:theValue(1)];
+            [[[controller.filteredData objectAtIndex:1] should] haveCountOf:1];
+
+            [controller removeFilter:adults];
+            [[theValue(bitmap.isComplete) should] beYes];
+            [[[controller.filteredData objectAtIndex:0] should] haveCountOf:0];
+            [[[controller filteredObjectAtIndexPath:[NSIndexPath indexPathForRow:0 inSection:1]][@"id"] should] equal:@"4"];
+        });
+
+        it(@"should keep the bitmaps up to date as objects are added and removed", ^{
+
+            [controller addFilters:@[ adults, seniors ]];
+            UAFilterBitmap *bitmap = [controller.filterBitmaps objectForKey:adults.evaluatedPredicate];
+
+            [controller addObject:@{ @"id": @"5", @"age": @80 }];
+            [controller removeObjectWithPrimaryKey:@"2"];
+            [[[controller.filterBitmaps objectForKey:adults.evaluatedPredicate] should] beIdenticalTo:bitmap];
+            [[theValue(bitmap.count) should] equal:theValue(4)];
+            [[theValue([bitmap containsIndex:0]) should] beNo];
+            [[theValue([bitmap containsIndex:1]) should] beYes];
+            [[theValue([bitmap containsIndex:3]) should] beYes];
+
+            [controller removeFilter:seniors];
+            [[[controller.filteredData objectAtIndex:0] should] haveCountOf:0];
+            [[[controller.filteredData objectAtIndex:1] should] haveCountOf:3];
+            [[[controller filteredObjectAtIndexPath:[NSIndexPath indexPathForRow:2 inSection:1]][@"id"] should] equal:@"5"];
+        });
+
+        it(@"should bring back the rows hidden by a removed filter in their original order", ^{
+
+            [controller addFilters:@[ adults, seniors ]];
+            [controller removeFilter:seniors];
+            [[[controller.filteredData objectAtIndex:0] should] haveCountOf:1];
+            [[[controller.filteredData objectAtIndex:1] should] haveCountOf:2];
+            [[[controller filteredObjectAtIndexPath:[NSIndexPath indexPathForRow:0 inSection:1]][@"id"] should] equal:@"3"];
+            [[[controller filteredObjectAtIndexPath:[NSIndexPath indexPathForRow:1 inSection:1]][@"id"] should] equal:@"4"];
+        });
+    });
+
+    context(@"when compiling filter predicates", ^{
+        __block NSArray *objects;
+        beforeEach(^{
+
+            objects = @[
+                        @{ @"id": @"1", @"name": @"Émile", @"age": @10, @"team": @{ @"name": @"Red" } },
+                        @{ @"id": @"2", @"name": @"emma", @"age": @20, @"team": @{ @"name": @"Blue" } },
+                        @{ @"id": @"3", @"name": @"Oscar", @"age": @30, @"team": @{ @"name": @"Red" } },
+                        @{ @"id": @"4", @"name": @"Olivia", @"age": @40 },
+                        @{ @"id": @"5", @"age": [NSNull null] }
+                        ];
+        });
+        afterEach(^{
+
+            objects = nil;
+        });
+
+        it(@"should match the same objects as NSPredicate", ^{
+
+            NSArray *formats = @[
+                                 @"age >= 20",
+                                 @"age != 20",
+                                 @"age BETWEEN {15, 35}",
+                                 @"id IN {'1', '3', '9'}",
+                                 @"name BEGINSWITH[cd] 'em'",
+                                 @"name CONTAINS[c] 'LIV'",
+                                 @"name ENDSWITH 'ar'",
+                                 @"team.name == 'Red' AND NOT (age > 20)",
+                                 @"team == nil OR name ==[c] 'EMMA'",
+                                 @"age == nil",
+                                 @"name LIKE 'O*'"
+                                 ];
+
+            for (NSString *format in formats) {
+                NSPredicate *predicate = [NSPredicate predicateWithFormat:format];
+                UACompiledPredicate *compiledPredicate = [UACompiledPredicate compiledPredicateWithPredicate:predicate];
+                for (id object in objects) {
+                    [[theValue([compiledPredicate evaluateWithObject:object]) should] equal:theValue([predicate evaluateWithObject:object])];
+                }
+            }
+        });
+
+        it(@"should only compile the predicates it understands", ^{
+
+            [[theValue([UACompiledPredicate compiledPredicateWithPredicate:[NSPredicate predicateWithFormat:@"age >= 20"]].isCompiled) should] beYes];
+            [[theValue([UACompiledPredicate compiledPredicateWithPredicate:[NSPredicate predicateWithFormat:@"name MATCHES 'O.*'"]].isCompiled) should] beNo];
+        });
+
+        it(@"should read keys through the same getter as key value coding", ^{
+
+            UAFilterableResultsControllerTestPerson *person = [[UAFilterableResultsControllerTestPerson alloc] init];
+            person.age = 15;
+
+            NSPredicate *predicate = [NSPredicate predicateWithFormat:@"age >= 20"];
+            UACompiledPredicate *compiledPredicate = [UACompiledPredicate compiledPredicateWithPredicate:predicate];
+            [[theValue([predicate evaluateWithObject:person]) should] beYes];
+            [[theValue([compiledPredicate evaluateWithObject:person]) should] beYes];
+        });
+
+        it(@"should filter the data with a compiled predicate", ^{
+
+            UAFilterableResultsController *controller = [[UAFilterableResultsController alloc] initWithPrimaryKeyPath:@"id" delegate:nil];
+            [controller setData:objects];
+
+            UAFilter *filter = [UAFilter filterWithPredicate:[NSPredicate predicateWithFormat:@"age >= 20 AND name BEGINSWITH[c] 'o'"]];
+            filter.compilesPredicate = YES;
+            [[filter.evaluatedPredicate shouldNot] beIdenticalTo:filter.predicate];
+
+            [controller addFilter:filter];
+            [[controller.filteredData should] haveCountOf:2];
+            [[[controller filteredObjectAtIndexPath:[NSIndexPath indexPathForRow:0 inSection:0]][@"id"] should] equal:@"3"];
+            [[[controller filteredObjectAtIndexPath:[NSIndexPath indexPathForRow:1 inSection:0]][@"id"] should] equal:@"4"];
+        });
+    });
+
+    context(@"when filtering in parallel", ^{
+        __block NSMutableArray *sections;
+        beforeEach(^{
+
+            // uneven sections, so chunks start part way through them and some span several
+            sections = [[NSMutableArray alloc] init];
+            NSUInteger identifier = 0;
+            for (NSUInteger sectionIndex = 0; sectionIndex < 7; sectionIndex++) {
+                NSMutableArray *section = [[NSMutableArray alloc] init];
+                for (NSUInteger row = 0; row < sectionIndex * 731 + 3; row++, identifier++) {
+                    [section addObject:@{ @"id": [NSString stringWithFormat:@"%lu", (unsigned long)identifier], @"age": @(identifier % 97) }];
+                }
+                [sections addObject:section];
+            }
+        });
+        afterEach(^{
+
+            sections = nil;
+        });
+
+        it(@"should produce the same filtered data as filtering serially", ^{
+
+            UAFilter *filter = [UAFilter filterWithPredicate:[NSPredicate predicateWithFormat:@"age >= 40 AND age < 60"]];
+
+            UAFilterableResultsController *serial = [[UAFilterableResultsController alloc] initWithPrimaryKeyPath:@"id" delegate:nil];
+            [serial setData:sections];
+            [serial addFilter:filter];
+
+            UAFilterableResultsController *parallel = [[UAFilterableResultsController alloc] initWithPrimaryKeyPath:@"id" delegate:nil];
+            parallel.filtersInParallel = YES;
+            parallel.parallelFilteringThreshold = 100;
+            [parallel setData:sections];
+            [parallel addFilter:filter];
+
+            [[parallel.filteredData should] equal:serial.filteredData];
+        });
+    });
+
+    context(@"when collecting metrics", ^{
+        __block UAFilterableResultsController *controller;
+        __block id delegateMock;
+        beforeEach(^{
+
+            delegateMock = [KWMock nullMockForProtocol:@protocol(UAFilterableResultsControllerDelegate)];
+            controller = [[UAFilterableResultsController alloc] initWithPrimaryKeyPath:@"id" delegate:delegateMock];
+            controller.collectsMetrics = YES;
+            [controller setData:@[ @{ @"id": @"1", @"age": @10 }, @{ @"id": @"2", @"age": @20 }, @{ @"id": @"3", @"age": @30 } ]];
+            [controller setTableViewHasLoaded:YES];
+        });
+        afterEach(^{
+
+            controller = nil;
+        });
+
+        it(@"should count the work done applying a filter", ^{
+
+            [controller addFilter:[UAFilter filterWithPredicate:[NSPredicate predicateWithFormat:@"age >= 20"]]];
+
+            UAFilterableResultsMetrics *metrics = controller.lastMetrics;
+            [[metrics shouldNot] beNil];
+            [[theValue(metrics.numberOfPredicateEvaluations) should] equal:theValue(3)];
+            [[theValue(metrics.numberOfRowsCompared) should] equal:theValue(5)];
+            [[theValue(metrics.numberOfKeyValueLookups) should] equal:theValue(5)];
+            [[theValue(metrics.numberOfNotifications) should] beGreaterThan:theValue(2)];
+        });
+
+        it(@"should tell the metrics delegate when a batch ends", ^{
+
+            id metricsDelegateMock = [KWMock nullMockForProtocol:@protocol(UAFilterableResultsControllerMetricsDelegate)];
+            controller.metricsDelegate = metricsDelegateMock;
+
+            [[metricsDelegateMock should] receive:@selector(filterableResultsController:didFinishBatchWithMetrics:) withCount:1];
+            [[metricsDelegateMock should] receive:@selector(filterableResultsController:willBeginInterval:) withCountAtLeast:1];
+            [controller addObject:@{ @"id": @"4", @"age": @40 }];
+        });
+
+        it(@"should forget everything when turned off", ^{
+
+            controller.collectsMetrics = NO;
+            [controller addFilter:[UAFilter filterWithPredicate:[NSPredicate predicateWithFormat:@"age >= 20"]]];
+
+            [[controller.lastMetrics should] beNil];
+        });
+    });
+
+    context(@"when mapping between raw and filtered index paths", ^{
+        __block UAFilterableResultsController *controller;
+        beforeEach(^{
+
+            controller = [[UAFilterableResultsController alloc] initWithPrimaryKeyPath:@"id" delegate:nil];
+            [controller setData:@[ @[ @{ @"id": @"1", @"age": @10 }, @{ @"id": @"2", @"age": @20 }, @{ @"id": @"3", @"age": @30 } ],
+                                   @[ @{ @"id": @"4", @"age": @40 }, @{ @"id": @"5", @"age": @5 } ] ]];
+            [controller addFilter:[UAFilter filterWithPredicate:[NSPredicate predicateWithFormat:@"age >= 20"]]];
+            [controller setTableViewHasLoaded:YES];
+        });
+        afterEach(^{
+
+            controller = nil;
+        });
+
+        it(@"should keep the filtered rows rather than copies of the objects", ^{
+
+            [[controller.filteredData[0] should] beKindOfClass:[UAFilteredSection class]];
+            [[theValue([controller.filteredData[0] rowAtIndex:0]) should] equal:theValue(1)];
+            [[controller.filteredData[0][0] should] equal:@{ @"id": @"2", @"age": @20 }];
+        });
+
+        it(@"should map index paths both ways", ^{
+
+            [[[controller filteredIndexPathForIndexPath:[NSIndexPath indexPathForRow:2 inSection:0]] should] equal:[NSIndexPath indexPathForRow:1 inSection:0]];
+            [[[controller filteredIndexPathForIndexPath:[NSIndexPath indexPathForRow:0 inSection:0]] should] beNil];
+            [[[controller indexPathForFilteredIndexPath:[NSIndexPath indexPathForRow:0 inSection:1]] should] equal:[NSIndexPath indexPathForRow:0 inSection:1]];
+            [[[controller filteredIndexPathOfObjectWithPrimaryKey:@"3"] should] equal:[NSIndexPath indexPathForRow:1 inSection:0]];
+            [[[controller filteredIndexPathOfObjectWithPrimaryKey:@"5"] should] beNil];
+        });
+
+        it(@"should keep the rows up to date as objects change", ^{
+
+            [controller removeObjectWithPrimaryKey:@"1"];
+            [controller addObject:@{ @"id": @"6", @"age": @60 } inSection:0];
+            [controller replaceObject:@{ @"id": @"2", @"age": @1 }];
+
+            [[controller.filteredData[0] should] equal:@[ @{ @"id": @"3", @"age": @30 }, @{ @"id": @"6", @"age": @60 } ]];
+            [[theValue([controller.filteredData[0] isMapped]) should] beYes];
+            [[[controller indexPathForFilteredIndexPath:[NSIndexPath indexPathForRow:1 inSection:0]] should] equal:[NSIndexPath indexPathForRow:2 inSection:0]];
+        });
+    });
+
+    context(@"when searching text", ^{
+        __block UAFilterableResultsController *controller;
+        beforeEach(^{
+
+            controller = [[UAFilterableResultsController alloc] initWithPrimaryKeyPath:@"id" delegate:nil];
+            [controller setData:@[ @{ @"id": @"1", @"name": @"Crème Brûlée", @"tags": @[ @"dessert" ] },
+                                   @{ @"id": @"2", @"name": @"Creamed Corn", @"tags": @[ @"side" ] },
+                                   @{ @"id": @"3", @"name": @"Apple Crumble", @"tags": @[ @"dessert", @"baked" ] } ]];
+            [controller setTableViewHasLoaded:YES];
+        });
+        afterEach(^{
+
+            controller = nil;
+        });
+
+        it(@"should match the same objects as CONTAINS[cd]", ^{
+
+            [controller addFilter:[UATextSearchFilter filterWithQuery:@"CREME" keyPaths:@[ @"name", @"tags" ]]];
+            [[controller.filteredData should] equal:@[ @{ @"id": @"1", @"name": @"Crème Brûlée", @"tags": @[ @"dessert" ] } ]];
+
+            [controller replaceFilters:@[ [UATextSearchFilter filterWithQuery:@"dessert" keyPaths:@[ @"name", @"tags" ]] ]];
+            NSPredicate *predicate = [NSPredicate predicateWithFormat:@"name CONTAINS[cd] %@ OR ANY tags CONTAINS[cd] %@", @"dessert", @"dessert"];
+            [[controller.filteredData should] equal:[controller.allObjects filteredArrayUsingPredicate:predicate]];
+        });
+
+        it(@"should narrow the results as the query is extended", ^{
+
+            [controller addFilter:[UATextSearchFilter filterWithTitle:nil group:@"Search" query:@"cr" keyPaths:@[ @"name" ]]];
+            [[theValue([controller.filteredData count]) should] equal:theValue(3)];
+
+            [controller addFilter:[UATextSearchFilter filterWithTitle:nil group:@"Search" query:@"cre" keyPaths:@[ @"name" ]]];
+            [[theValue([controller.filteredData count]) should] equal:theValue(2)];
+
+            [controller addFilter:[UATextSearchFilter filterWithTitle:nil group:@"Search" query:@"crea" keyPaths:@[ @"name" ]]];
+            [[controller.filteredData should] equal:@[ @{ @"id": @"2", @"name": @"Creamed Corn", @"tags": @[ @"side" ] } ]];
+            [[theValue(controller.appliedFilters.count) should] equal:theValue(1)];
+        });
+
+        it(@"should keep the index up to date as objects change", ^{
+
+            [controller addFilter:[UATextSearchFilter filterWithTitle:nil group:@"Search" query:@"corn" keyPaths:@[ @"name" ]]];
+            [controller addObject:@{ @"id": @"4", @"name": @"Popcorn", @"tags": @[] }];
+            [controller replaceObject:@{ @"id": @"2", @"name": @"Creamed Spinach", @"tags": @[ @"side" ] }];
+
+            [controller addFilter:[UATextSearchFilter filterWithTitle:nil group:@"Search" query:@"orn" keyPaths:@[ @"name" ]]];
+            [[controller.filteredData should] equal:@[ @{ @"id": @"4", @"name": @"Popcorn", @"tags": @[] } ]];
+
+            [controller removeObjectWithPrimaryKey:@"4"];
+            [controller replaceFilters:@[ [UATextSearchFilter filterWithQuery:@"popcorn" keyPaths:@[ @"name" ]] ]];
+            [[controller.filteredData should] beEmpty];
+        });
+
+        it(@"should index the text again when the same filters are applied to objects changed in place", ^{
+
+            NSMutableDictionary *object = [@{ @"id": @"5", @"name": @"Rice Pudding", @"tags": @[] } mutableCopy];
+            [controller addObject:object];
+            [controller addFilter:[UATextSearchFilter filterWithQuery:@"pudding" keyPaths:@[ @"name" ]]];
+            [[controller.filteredData should] equal:@[ object ]];
+
+            object[@"name"] = @"Corn Pudding";
+            [controller replaceFilters:controller.appliedFilters];
+            [[controller.filteredData should] equal:@[ object ]];
+
+            [controller replaceFilters:@[ [UATextSearchFilter filterWithQuery:@"corn" keyPaths:@[ @"name" ]] ]];
+            [[theValue([controller.filteredData count]) should] equal:theValue(2)];
+        });
+
+        it(@"should only keep the indexes the applied filters are searching", ^{
+
+            [controller addFilter:[UATextSearchFilter filterWithTitle:nil group:@"Search" query:@"corn" keyPaths:@[ @"name" ]]];
+            [controller addFilter:[UATextSearchFilter filterWithTitle:nil group:@"Search" query:@"side" keyPaths:@[ @"tags" ]]];
+            [[controller.textSearchIndexes.allKeys should] equal:@[ @[ @"tags" ] ]];
+
+            id index = controller.textSearchIndexes[@[ @"tags" ]];
+            [controller setData:@[ @{ @"id": @"1", @"name": @"Corn Bread", @"tags": @[ @"side" ] } ]];
+            [[controller.textSearchIndexes[@[ @"tags" ]] shouldNot] beIdenticalTo:index];
+
+            [controller clearFilters];
+            [[theValue(controller.textSearchIndexes.count) should] equal:theValue(0)];
+        });
+    });
+
+    context(@"when filtering asynchronously", ^{
+        __block UAFilterableResultsController *controller;
+        __block id delegateMock;
+        beforeEach(^{
+
+            delegateMock = [KWMock nullMockForProtocol:@protocol(UAFilterableResultsControllerDelegate)];
+            controller = [[UAFilterableResultsController alloc] initWithPrimaryKeyPath:@"id" delegate:delegateMock];
+            [controller setData:@[ @{ @"id": @"1", @"age": @10 }, @{ @"id": @"2", @"age": @20 }, @{ @"id": @"3", @"age": @30 } ]];
+            [controller setTableViewHasLoaded:YES];
+        });
+        afterEach(^{
+
+            controller = nil;
+        });
+
+        it(@"should apply the filters and notify the delegate in one batch", ^{
+
+            __block BOOL didFinish = NO;
+            [[delegateMock shouldEventually] receive:@selector(filterableResultsControllerWillChangeContent:) withCount:1];
+            [[delegateMock shouldEventually] receive:@selector(filterableResultsController:didChangeObject:atIndexPath:forChangeType:newIndexPath:) withCount:1];
+            [[delegateMock shouldEventually] receive:@selector(filterableResultsControllerDidChangeContent:) withCount:1];
+
+            [controller addFilter:[UAFilter filterWithPredicate:[NSPredicate predicateWithFormat:@"age >= 20"]] completion:^(BOOL finished) {
+                didFinish = finished;
+            }];
+
+            [[controller.appliedFilters should] beEmpty];
+            [[expectFutureValue(theValue(didFinish)) shouldEventually] beYes];
+            [[expectFutureValue(theValue([controller numberOfFilteredObjects])) shouldEventually] equal:theValue(2)];
+        });
+
+        it(@"should hand over the filtered rows it worked out rather than filtering again", ^{
+
+            __block BOOL didFinish = NO;
+            [controller addFilter:[UAFilter filterWithPredicate:[NSPredicate predicateWithFormat:@"age >= 20"]] completion:^(BOOL finished) {
+                didFinish = finished;
+            }];
+
+            [[expectFutureValue(theValue(didFinish)) shouldEventually] beYes];
+            [[controller.filteredData should] beKindOfClass:[UAFilteredSection class]];
+            [[((UAFilteredSection *)controller.filteredData).section should] beIdenticalTo:controller.data];
+            [[theValue([(UAFilteredSection *)controller.filteredData rowAtIndex:0]) should] equal:theValue(1)];
+        });
+
+        it(@"should only publish the latest generation", ^{
+
+            __block BOOL firstFinished = YES;
+            __block BOOL secondFinished = NO;
+            [controller addFilter:[UAFilter filterWithTitle:nil group:@"Search" predicate:[NSPredicate predicateWithFormat:@"age >= 20"]] completion:^(BOOL finished) {
+                firstFinished = finished;
+            }];
+            [controller addFilter:[UAFilter filterWithTitle:nil group:@"Search" predicate:[NSPredicate predicateWithFormat:@"age >= 30"]] completion:^(BOOL finished) {
+                secondFinished = finished;
+            }];
+
+            [[expectFutureValue(theValue(secondFinished)) shouldEventually] beYes];
+            [[expectFutureValue(theValue(firstFinished)) shouldEventually] beNo];
+            [[expectFutureValue(theValue([controller numberOfFilteredObjects])) shouldEventually] equal:theValue(1)];
+            [[expectFutureValue(theValue(controller.appliedFilters.count)) shouldEventually] equal:theValue(1)];
+        });
+
+        it(@"should start again when the data changes underneath it", ^{
+
+            __block BOOL didFinish = NO;
+            [controller replaceFilters:@[ [UAFilter filterWithPredicate:[NSPredicate predicateWithFormat:@"age >= 20"]] ] completion:^(BOOL finished) {
+                didFinish = finished;
+            }];
+            [controller addObject:@{ @"id": @"4", @"age": @40 }];
+
+            [[expectFutureValue(theValue(didFinish)) shouldEventually] beYes];
+            [[expectFutureValue(theValue([controller numberOfFilteredObjects])) shouldEventually] equal:theValue(3)];
+        });
+    });
+});
+
+SPEC_END
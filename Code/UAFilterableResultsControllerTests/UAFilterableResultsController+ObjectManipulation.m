@@ -8,6 +8,33 @@
 
 #import <Kiwi/Kiwi.h>
 #import "UAFilterableResultsController.h"
+#import "UAFilterableResultsController+Private.h"
+
+// counts every time any rank is read
+static NSUInteger UAFilterableResultsControllerTestRankReads = 0;
+
+@interface UAFilterableResultsControllerTestRanked : NSObject
+
+@property (nonatomic, copy) NSString *identifier;
+@property (nonatomic, strong) NSNumber *rank;
+
+@end
+
+@implementation UAFilterableResultsControllerTestRanked
+
++ (instancetype)rankedWithIdentifier:(NSString *)identifier rank:(NSInteger)rank {
+    UAFilterableResultsControllerTestRanked *ranked = [[self alloc] init];
+    ranked.identifier = identifier;
+    ranked.rank = @(rank);
+    return ranked;
+}
+
+- (NSNumber *)rank {
+    UAFilterableResultsControllerTestRankReads++;
+    return _rank;
+}
+
+@end
 
 SPEC_BEGIN(UAFilterableResultsController_ObjectManipulation)
 
@@ -464,6 +491,276 @@ describe(@"UAFilterableResultsController: Object Manipulation", ^
             [[[controller objectAtIndexPath:[NSIndexPath indexPathForRow:4 inSection:1]] should] equal:@9];
         });
     });
+
+    context(@"when merging objects with a primary key", ^{
+
+        __block UAFilterableResultsController *controller;
+        __block id delegateMock;
+        beforeEach(^{
+
+            delegateMock = [KWMock nullMockForProtocol:@protocol(UAFilterableResultsControllerDelegate)];
+            controller = [[UAFilterableResultsController alloc] initWithPrimaryKeyPath:@"id" delegate:delegateMock];
+            [controller setData:@[ @{ @"id": @"1", @"name": @"One" }, @{ @"id": @"2", @"name": @"Two" }, @{ @"id": @"3", @"name": @"Three" } ]];
+
+            // pretend the table view has loaded, otherwise no delegate messages are sent
+            [controller setTableViewHasLoaded:YES];
+        });
+        afterEach(^{
+
+            controller = nil;
+        });
+
+        it(@"should replace matching objects and append new ones in a single batch", ^{
+
+            [[delegateMock should] receive:@selector(filterableResultsControllerWillChangeContent:) withCount:1];
+            [[delegateMock should] receive:@selector(filterableResultsController:didChangeObject:atIndexPath:forChangeType:newIndexPath:) withCount:4];
+            [[delegateMock should] receive:@selector(filterableResultsControllerDidChangeContent:) withCount:1];
+
+            [controller mergeObjects:@[ @{ @"id": @"3", @"name": @"Tres" }, @{ @"id": @"4", @"name": @"Four" }, @{ @"id": @"1", @"name": @"Uno" }, @{ @"id": @"5", @"name": @"Five" } ]];
+
+            [[controller.data should] haveCountOf:5];
+            [[[controller objectAtIndexPath:[NSIndexPath indexPathForRow:0 inSection:0]][@"name"] should] equal:@"Uno"];
+            [[[controller objectAtIndexPath:[NSIndexPath indexPathForRow:2 inSection:0]][@"name"] should] equal:@"Tres"];
+            [[[controller objectAtIndexPath:[NSIndexPath indexPathForRow:3 inSection:0]][@"id"] should] equal:@"4"];
+            [[[controller objectAtIndexPath:[NSIndexPath indexPathForRow:4 inSection:0]][@"id"] should] equal:@"5"];
+            [[[controller indexPathOfObjectWithPrimaryKey:@"5"] should] equal:[NSIndexPath indexPathForRow:4 inSection:0]];
+        });
+
+        it(@"should let later objects with the same key win", ^{
+
+            [controller mergeObjects:@[ @{ @"id": @"2", @"name": @"Dos" }, @{ @"id": @"6", @"name": @"Six" }, @{ @"id": @"2", @"name": @"Deux" }, @{ @"id": @"6", @"name": @"Seis" } ]];
+
+            [[controller.data should] haveCountOf:4];
+            [[[controller objectAtIndexPath:[NSIndexPath indexPathForRow:1 inSection:0]][@"name"] should] equal:@"Deux"];
+            [[[controller objectAtIndexPath:[NSIndexPath indexPathForRow:3 inSection:0]][@"name"] should] equal:@"Seis"];
+        });
+
+        it(@"should find the existing objects through the primary key index and only look up the keys of the merged ones", ^{
+
+            [[[controller indexPathOfObjectWithPrimaryKey:@"3"] should] equal:[NSIndexPath indexPathForRow:2 inSection:0]];
+            controller.collectsMetrics = YES;
+
+            [controller mergeObjects:@[ @{ @"id": @"3", @"name": @"Tres" }, @{ @"id": @"7", @"name": @"Seven" } ]];
+
+            [[theValue(controller.lastMetrics.numberOfKeyValueLookups) should] equal:theValue(2)];
+            [[[controller objectAtIndexPath:[NSIndexPath indexPathForRow:2 inSection:0]][@"name"] should] equal:@"Tres"];
+            [[[controller indexPathOfObjectWithPrimaryKey:@"7"] should] equal:[NSIndexPath indexPathForRow:3 inSection:0]];
+        });
+
+        it(@"should merge objects into sorted data using -mergeObjects:sortKeyPath:sortOptions:", ^{
+
+            [[delegateMock should] receive:@selector(filterableResultsControllerWillChangeContent:) withCount:1];
+            [[delegateMock should] receive:@selector(filterableResultsController:didChangeObject:atIndexPath:forChangeType:newIndexPath:) withCount:3];
+            [[delegateMock should] receive:@selector(filterableResultsControllerDidChangeContent:) withCount:1];
+
+            [controller mergeObjects:@[ @{ @"id": @"5", @"name": @"Five" }, @{ @"id": @"1", @"name": @"Uno" }, @{ @"id": @"0", @"name": @"Zero" } ]
+                         sortKeyPath:@"id"
+                         sortOptions:NSNumericSearch];
+
+            [[controller.data should] haveCountOf:5];
+            [[[controller objectAtIndexPath:[NSIndexPath indexPathForRow:0 inSection:0]][@"id"] should] equal:@"0"];
+            [[[controller objectAtIndexPath:[NSIndexPath indexPathForRow:1 inSection:0]][@"name"] should] equal:@"Uno"];
+            [[[controller objectAtIndexPath:[NSIndexPath indexPathForRow:2 inSection:0]][@"id"] should] equal:@"2"];
+            [[[controller objectAtIndexPath:[NSIndexPath indexPathForRow:3 inSection:0]][@"id"] should] equal:@"3"];
+            [[[controller objectAtIndexPath:[NSIndexPath indexPathForRow:4 inSection:0]][@"id"] should] equal:@"5"];
+        });
+
+        it(@"should move replaced objects whose sort key changed using -mergeObjects:sortKeyPath:sortOptions:", ^{
+
+            [controller setData:@[ @{ @"id": @"1", @"name": @"Alpha" }, @{ @"id": @"2", @"name": @"Bravo" }, @{ @"id": @"3", @"name": @"Charlie" } ]];
+
+            [[delegateMock should] receive:@selector(filterableResultsController:didChangeObject:atIndexPath:forChangeType:newIndexPath:)
+                             withArguments:controller, any(), [NSIndexPath indexPathForRow:0 inSection:0], theValue(UAFilterableResultsChangeMove), [NSIndexPath indexPathForRow:2 inSection:0]];
+
+            [controller mergeObjects:@[ @{ @"id": @"1", @"name": @"Zulu" } ]
+                         sortKeyPath:@"name"
+                         sortOptions:0];
+
+            [[[controller objectAtIndexPath:[NSIndexPath indexPathForRow:2 inSection:0]][@"name"] should] equal:@"Zulu"];
+        });
+
+        it(@"should only check the data is in order again once something has put it out of order", ^{
+
+            __block NSUInteger comparisons = 0;
+            NSComparator comparator = ^NSComparisonResult(NSDictionary *obj1, NSDictionary *obj2) {
+                comparisons++;
+                return [obj1[@"id"] compare:obj2[@"id"] options:NSNumericSearch];
+            };
+            [controller mergeObjects:@[ @{ @"id": @"5", @"name": @"Five" } ] sortComparator:comparator];
+
+            comparisons = 0;
+            [controller mergeObjects:@[ @{ @"id": @"0", @"name": @"Zero" } ] sortComparator:comparator];
+            [[theValue(comparisons) should] equal:theValue(1)];
+            [[[controller indexPathOfObjectWithPrimaryKey:@"5"] should] equal:[NSIndexPath indexPathForRow:4 inSection:0]];
+
+            [controller addObject:@{ @"id": @"4", @"name": @"Four" }];
+            [controller mergeObjects:@[ @{ @"id": @"6", @"name": @"Six" } ] sortComparator:comparator];
+            [[[controller objectAtIndexPath:[NSIndexPath indexPathForRow:4 inSection:0]][@"id"] should] equal:@"4"];
+            [[[controller objectAtIndexPath:[NSIndexPath indexPathForRow:5 inSection:0]][@"id"] should] equal:@"5"];
+            [[[controller objectAtIndexPath:[NSIndexPath indexPathForRow:6 inSection:0]][@"id"] should] equal:@"6"];
+        });
+
+        it(@"should only read the sort keys of each object once using -mergeObjects:sortKeyPath:sortOptions:", ^{
+
+            UAFilterableResultsController *rankedController = [[UAFilterableResultsController alloc] initWithPrimaryKeyPath:@"identifier" delegate:nil];
+            [rankedController setData:@[ [UAFilterableResultsControllerTestRanked rankedWithIdentifier:@"a" rank:1],
+                                         [UAFilterableResultsControllerTestRanked rankedWithIdentifier:@"b" rank:2],
+                                         [UAFilterableResultsControllerTestRanked rankedWithIdentifier:@"c" rank:4],
+                                         [UAFilterableResultsControllerTestRanked rankedWithIdentifier:@"d" rank:5] ]];
+
+            UAFilterableResultsControllerTestRankReads = 0;
+            [rankedController mergeObjects:@[ [UAFilterableResultsControllerTestRanked rankedWithIdentifier:@"e" rank:3] ]
+                               sortKeyPath:@"rank"
+                               sortOptions:0];
+
+            [[theValue(UAFilterableResultsControllerTestRankReads) should] equal:theValue(5)];
+            [[[rankedController indexPathOfObjectWithPrimaryKey:@"e"] should] equal:[NSIndexPath indexPathForRow:2 inSection:0]];
+        });
+    });
+
+    context(@"when keeping the data sorted", ^{
+
+        __block UAFilterableResultsController *controller;
+        __block id delegateMock;
+        beforeEach(^{
+
+            delegateMock = [KWMock nullMockForProtocol:@protocol(UAFilterableResultsControllerDelegate)];
+            controller = [[UAFilterableResultsController alloc] initWithPrimaryKeyPath:@"id" delegate:delegateMock];
+            [controller setData:@[ @{ @"id": @"3", @"name": @"Charlie" }, @{ @"id": @"1", @"name": @"Alpha" }, @{ @"id": @"2", @"name": @"Echo" } ]];
+            controller.sortDescriptors = @[ [NSSortDescriptor sortDescriptorWithKey:@"name" ascending:YES] ];
+
+            // pretend the table view has loaded, otherwise no delegate messages are sent
+            [controller setTableViewHasLoaded:YES];
+        });
+        afterEach(^{
+
+            controller = nil;
+        });
+
+        it(@"should sort the existing data", ^{
+
+            [[[controller.data valueForKey:@"name"] should] equal:@[ @"Alpha", @"Charlie", @"Echo" ]];
+            [[[controller indexPathOfObjectWithPrimaryKey:@"3"] should] equal:[NSIndexPath indexPathForRow:1 inSection:0]];
+        });
+
+        it(@"should insert added objects in their place", ^{
+
+            [[delegateMock should] receive:@selector(filterableResultsController:didChangeObject:atIndexPath:forChangeType:newIndexPath:)
+                             withArguments:controller, any(), nil, theValue(UAFilterableResultsChangeInsert), [NSIndexPath indexPathForRow:1 inSection:0]];
+
+            [controller addObject:@{ @"id": @"4", @"name": @"Bravo" }];
+
+            [[[controller.data valueForKey:@"name"] should] equal:@[ @"Alpha", @"Bravo", @"Charlie", @"Echo" ]];
+        });
+
+        it(@"should find the objects shifted by an insert by their primary key", ^{
+
+            [[[controller indexPathOfObjectWithPrimaryKey:@"3"] should] equal:[NSIndexPath indexPathForRow:1 inSection:0]];
+
+            [controller addObject:@{ @"id": @"4", @"name": @"Bravo" }];
+
+            [[[controller indexPathOfObjectWithPrimaryKey:@"3"] should] equal:[NSIndexPath indexPathForRow:2 inSection:0]];
+            [[[controller indexPathOfObjectWithPrimaryKey:@"4"] should] equal:[NSIndexPath indexPathForRow:1 inSection:0]];
+            [[[controller objectWithPrimaryKey:@"3"][@"name"] should] equal:@"Charlie"];
+
+            [controller removeObjectWithPrimaryKey:@"2"];
+            [[[controller.data valueForKey:@"name"] should] equal:@[ @"Alpha", @"Bravo", @"Charlie" ]];
+        });
+
+        it(@"should move replaced objects to their new place", ^{
+
+            [[delegateMock should] receive:@selector(filterableResultsController:didChangeObject:atIndexPath:forChangeType:newIndexPath:)
+                             withArguments:controller, any(), [NSIndexPath indexPathForRow:0 inSection:0], theValue(UAFilterableResultsChangeMove), [NSIndexPath indexPathForRow:2 inSection:0]];
+
+            [controller replaceObject:@{ @"id": @"1", @"name": @"Zulu" }];
+
+            [[[controller.data valueForKey:@"name"] should] equal:@[ @"Charlie", @"Echo", @"Zulu" ]];
+            [[[controller indexPathOfObjectWithPrimaryKey:@"1"] should] equal:[NSIndexPath indexPathForRow:2 inSection:0]];
+        });
+
+        it(@"should merge objects by the sort order and keep filtered data in step", ^{
+
+            [controller addFilter:[UAFilter filterWithPredicate:[NSPredicate predicateWithFormat:@"name != 'Charlie'"]]];
+            [controller mergeObjects:@[ @{ @"id": @"5", @"name": @"Delta" }, @{ @"id": @"2", @"name": @"Able" } ]];
+
+            [[[controller.data valueForKey:@"name"] should] equal:@[ @"Able", @"Alpha", @"Charlie", @"Delta" ]];
+            [[[controller.filteredData valueForKey:@"name"] should] equal:@[ @"Able", @"Alpha", @"Delta" ]];
+        });
+    });
+
+    context(@"when sectioning by a key path", ^{
+
+        __block UAFilterableResultsController *controller;
+        __block id delegateMock;
+        beforeEach(^{
+
+            delegateMock = [KWMock nullMockForProtocol:@protocol(UAFilterableResultsControllerDelegate)];
+            controller = [[UAFilterableResultsController alloc] initWithPrimaryKeyPath:@"id" delegate:delegateMock];
+            controller.sectionKeyPath = @"team";
+            [controller setData:@[ @{ @"id": @"1", @"team": @"Red" }, @{ @"id": @"2", @"team": @"Blue" }, @{ @"id": @"3", @"team": @"Red" } ]];
+
+            // pretend the table view has loaded, otherwise no delegate messages are sent
+            [controller setTableViewHasLoaded:YES];
+        });
+        afterEach(^{
+
+            controller = nil;
+        });
+
+        it(@"should group the data into sections in order of their values", ^{
+
+            [[controller.data should] haveCountOf:2];
+            [[[controller sectionValueAtIndex:0] should] equal:@"Blue"];
+            [[[controller sectionValueAtIndex:1] should] equal:@"Red"];
+            [[[controller indexPathOfObjectWithPrimaryKey:@"3"] should] equal:[NSIndexPath indexPathForRow:1 inSection:1]];
+        });
+
+        it(@"should insert a section for an object with a new value", ^{
+
+            [[delegateMock should] receive:@selector(filterableResultsController:didChangeSectionAtIndex:forChangeType:)
+                             withArguments:controller, theValue(1), theValue(UAFilterableResultsChangeInsert)];
+
+            [controller addObject:@{ @"id": @"4", @"team": @"Green" }];
+
+            [[[controller sectionValueAtIndex:1] should] equal:@"Green"];
+            [[[controller indexPathOfObjectWithPrimaryKey:@"4"] should] equal:[NSIndexPath indexPathForRow:0 inSection:1]];
+        });
+
+        it(@"should delete a section when its last object is removed", ^{
+
+            [[delegateMock should] receive:@selector(filterableResultsController:didChangeSectionAtIndex:forChangeType:)
+                             withArguments:controller, theValue(0), theValue(UAFilterableResultsChangeDelete)];
+
+            [controller removeObjectWithPrimaryKey:@"2"];
+
+            [[controller.data should] haveCountOf:1];
+            [[[controller sectionValueAtIndex:0] should] equal:@"Red"];
+        });
+
+        it(@"should move a replaced object to the section for its new value", ^{
+
+            [[delegateMock should] receive:@selector(filterableResultsController:didChangeObject:atIndexPath:forChangeType:newIndexPath:)
+                             withArguments:controller, any(), [NSIndexPath indexPathForRow:0 inSection:1], theValue(UAFilterableResultsChangeMove), [NSIndexPath indexPathForRow:1 inSection:0]];
+
+            [controller replaceObject:@{ @"id": @"1", @"team": @"Blue" }];
+
+            [[controller.data should] haveCountOf:2];
+            [[[controller indexPathOfObjectWithPrimaryKey:@"1"] should] equal:[NSIndexPath indexPathForRow:1 inSection:0]];
+            [[[controller indexPathOfObjectWithPrimaryKey:@"3"] should] equal:[NSIndexPath indexPathForRow:0 inSection:1]];
+        });
+
+        it(@"should still find sections that were added out of order or with a value that's already taken", ^{
+
+            [controller insertSection:@[ @{ @"id": @"4", @"team": @"Blue" } ] atIndex:2];
+            [controller addObject:@{ @"id": @"5", @"team": @"Blue" }];
+            [[[controller indexPathOfObjectWithPrimaryKey:@"5"] should] equal:[NSIndexPath indexPathForRow:1 inSection:0]];
+
+            [controller removeObjectWithPrimaryKey:@"2"];
+            [controller removeObjectWithPrimaryKey:@"5"];
+            [controller addObject:@{ @"id": @"6", @"team": @"Blue" }];
+            [[[controller indexPathOfObjectWithPrimaryKey:@"6"] should] equal:[NSIndexPath indexPathForRow:1 inSection:1]];
+        });
+    });
 });
 
-SPEC_END
\ No newline at end of file
+SPEC_END
@@ -124,6 +124,113 @@ describe(@"UAFilterableResultsController: Basic Data and Retrieval Setting", ^{
             [[theValue(indexPath5.row) should] equal:1 withDelta:0];
         });
     });
+
+    context(@"when manipulating indexed two dimensional dictionary data", ^{
+        
+        __block UAFilterableResultsController *controller;
+        beforeEach(^{
+            
+            controller = [[UAFilterableResultsController alloc] initWithPrimaryKeyPath:@"id" delegate:nil];
+            [controller setData:@[
+                                  @[ @{ @"id": @"1", @"firstName": @"Test", @"lastName": @"User" } ],
+                                  @[ @{ @"id": @"2", @"firstName": @"John", @"lastName": @"Citizen" }, @{ @"id": @"3", @"firstName": @"Jane", @"lastName": @"Citizen" } ]
+                                  ]];
+        });
+        afterEach(^{
+            
+            controller = nil;
+        });
+        
+        it(@"should keep the index paths up to date as objects and sections change.", ^{
+            
+            [[[controller indexPathOfObjectWithPrimaryKey:@"3"] should] equal:[NSIndexPath indexPathForRow:1 inSection:1]];
+
+            [controller removeObjectWithPrimaryKey:@"2"];
+            [[[controller indexPathOfObjectWithPrimaryKey:@"2"] should] beNil];
+            [[[controller indexPathOfObjectWithPrimaryKey:@"3"] should] equal:[NSIndexPath indexPathForRow:0 inSection:1]];
+
+            [controller insertSection:@[ @{ @"id": @"4", @"firstName": @"Another", @"lastName": @"Tester" } ] atIndex:0];
+            [[[controller indexPathOfObjectWithPrimaryKey:@"4"] should] equal:[NSIndexPath indexPathForRow:0 inSection:0]];
+            [[[controller indexPathOfObjectWithPrimaryKey:@"1"] should] equal:[NSIndexPath indexPathForRow:0 inSection:1]];
+            [[[controller indexPathOfObjectWithPrimaryKey:@"3"] should] equal:[NSIndexPath indexPathForRow:0 inSection:2]];
+
+            [controller replaceObject:@{ @"id": @"3", @"firstName": @"Janet", @"lastName": @"Citizen" }];
+            [[[controller objectWithPrimaryKey:@"3"][@"firstName"] should] equal:@"Janet"];
+        });
+
+        it(@"should hand a shared primary key on to the next object without rebuilding the index.", ^{
+
+            [controller insertSection:@[ @{ @"id": @"3", @"firstName": @"Jane", @"lastName": @"Doe" } ] atIndex:0];
+            [[[controller indexPathOfObjectWithPrimaryKey:@"3"] should] equal:[NSIndexPath indexPathForRow:0 inSection:0]];
+            UAPrimaryKeyIndex *index = controller.primaryKeyIndex;
+
+            [controller removeObjectWithPrimaryKey:@"3"];
+            [[[controller indexPathOfObjectWithPrimaryKey:@"3"] should] equal:[NSIndexPath indexPathForRow:1 inSection:2]];
+            [[[controller objectWithPrimaryKey:@"3"][@"lastName"] should] equal:@"Citizen"];
+            [[controller.primaryKeyIndex should] beIdenticalTo:index];
+        });
+    });
+
+    context(@"when used from more than one thread", ^{
+
+        __block UAFilterableResultsController *controller;
+        beforeEach(^{
+
+            controller = [[UAFilterableResultsController alloc] initWithPrimaryKeyPath:@"id" delegate:nil];
+            controller.threadSafe = YES;
+            [controller setData:@[
+                                  @[ @{ @"id": @"1", @"firstName": @"Test", @"lastName": @"User" } ],
+                                  @[ @{ @"id": @"2", @"firstName": @"John", @"lastName": @"Citizen" }, @{ @"id": @"3", @"firstName": @"Jane", @"lastName": @"Citizen" } ]
+                                  ]];
+        });
+        afterEach(^{
+
+            controller = nil;
+        });
+
+        it(@"should look objects up from a background queue.", ^{
+
+            __block NSIndexPath *indexPath = nil;
+            __block id object = nil;
+            dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+                indexPath = [controller indexPathOfObjectWithPrimaryKey:@"3"];
+                object = [controller objectWithPrimaryKey:@"2"];
+            });
+
+            [[expectFutureValue(indexPath) shouldEventually] equal:[NSIndexPath indexPathForRow:1 inSection:1]];
+            [[expectFutureValue(object[@"firstName"]) shouldEventually] equal:@"John"];
+        });
+
+        it(@"should make changes from a background queue on the delegate queue, in order.", ^{
+
+            dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+                [controller removeObjectWithPrimaryKey:@"2"];
+                [controller addObject:@{ @"id": @"4", @"firstName": @"Another", @"lastName": @"Tester" } inSection:0];
+            });
+
+            [[expectFutureValue([controller indexPathOfObjectWithPrimaryKey:@"4"]) shouldEventually] equal:[NSIndexPath indexPathForRow:1 inSection:0]];
+            [[[controller indexPathOfObjectWithPrimaryKey:@"2"] should] beNil];
+            [[[controller indexPathOfObjectWithPrimaryKey:@"3"] should] equal:[NSIndexPath indexPathForRow:0 inSection:1]];
+        });
+
+        it(@"should let the delegate wait on a lookup from another thread while it hears about a change.", ^{
+
+            id delegateMock = [KWMock nullMockForProtocol:@protocol(UAFilterableResultsControllerDelegate)];
+            controller.delegate = delegateMock;
+            [controller setTableViewHasLoaded:YES];
+
+            __block NSIndexPath *indexPath = nil;
+            [delegateMock stub:@selector(filterableResultsControllerDidChangeContent:) withBlock:^id(NSArray *params) {
+                dispatch_sync(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+                    indexPath = [controller indexPathOfObjectWithPrimaryKey:@"4"];
+                });
+                return nil;
+            }];
+
+            [controller addObject:@{ @"id": @"4", @"firstName": @"Another", @"lastName": @"Tester" } inSection:0];
+            [[indexPath should] equal:[NSIndexPath indexPathForRow:1 inSection:0]];
+        });
+    });
 });
 
 SPEC_END
\ No newline at end of file
@@ -67,6 +67,46 @@ describe(@"UAFilterableResultsController's UITableViewDataSource support", ^
         });
     });
 
+    context(@"when the delegate is replaced", ^{
+
+        __block UAFilterableResultsController *controller;
+        __block id mockDelegate;
+        beforeEach(^{
+
+            mockDelegate = [KWMock nullMockForProtocol:@protocol(UAFilterableResultsControllerDelegate)];
+            controller = [[UAFilterableResultsController alloc] initWithPrimaryKeyPath:nil delegate:mockDelegate];
+            [controller setData:@[ @1, @2, @3, @4 ]];
+        });
+        afterEach(^{
+
+            controller = nil;
+            mockDelegate = nil;
+        });
+
+        it(@"should ask the new delegate for the section header title.", ^{
+
+            id newDelegate = [KWMock nullMockForProtocol:@protocol(UAFilterableResultsControllerDelegate)];
+            controller.delegate = newDelegate;
+
+            NSString *header = @"Test Header";
+            [[mockDelegate shouldNot] receive:@selector(filterableResultsController:titleForHeaderInSection:)];
+            [[newDelegate should] receive:@selector(filterableResultsController:titleForHeaderInSection:) andReturn:header withArguments:controller, theValue(0)];
+            [[[controller tableView:nil titleForHeaderInSection:0] should] equal:header];
+        });
+
+        it(@"should stop forwarding table view methods the new delegate doesn't implement.", ^{
+
+            [[theValue([controller respondsToSelector:@selector(tableView:canEditRowAtIndexPath:)]) should] beNo];
+
+            id newDelegate = [KWMock nullMockForProtocol:@protocol(UITableViewDataSource)];
+            controller.delegate = newDelegate;
+            [[theValue([controller respondsToSelector:@selector(tableView:canEditRowAtIndexPath:)]) should] beYes];
+
+            controller.delegate = mockDelegate;
+            [[theValue([controller respondsToSelector:@selector(tableView:canEditRowAtIndexPath:)]) should] beNo];
+        });
+    });
+
     context(@"when testing one dimensional arrays with dictionary data sets", ^{
 
         __block UAFilterableResultsController *controller;